@@ -0,0 +1,113 @@
+/*
+ * V4D Core Benchmarks
+ *
+ * Usage: v4d_benchmarks [--filter <substring>] [--quick] [--json <output.json>] [--compare <baseline.json>] [--threshold <percent>]
+ * 		--filter     only run benchmarks whose name contains the given substring
+ * 		--quick      shorter samples, for a smoke run
+ * 		--json       write results to a JSON file
+ * 		--compare    compare results with a JSON file previously written with --json (ie: from another commit), exits with 1 if any benchmark regressed
+ * 		--threshold  slowdown in percent above which a benchmark is considered to have regressed (default 10)
+ */
+#include <v4d.h>
+#include "helpers/Benchmark.hpp"
+
+#include "utilities/data/Stream.bench.cxx"
+#include "utilities/data/DataStream.bench.cxx"
+#include "helpers/Base16.bench.cxx"
+#include "helpers/Base64.bench.cxx"
+#include "helpers/BaseN.bench.cxx"
+#include "utilities/crypto/AES.bench.cxx"
+#include "utilities/crypto/RSA.bench.cxx"
+#include "utilities/crypto/SHA.bench.cxx"
+#include "utilities/processing/ThreadPool.bench.cxx"
+#include "helpers/EntityComponentSystem.bench.cxx"
+#include "helpers/COMMON_OBJECT.bench.cxx"
+#include "helpers/noise.bench.cxx"
+#include "utilities/io/Socket.bench.cxx"
+#include "utilities/io/BinaryFileStream.bench.cxx"
+#include "utilities/io/ConfigFile.bench.cxx"
+#include "utilities/io/Logger.bench.cxx"
+#include "utilities/io/BinaryLogger.bench.cxx"
+#include "utilities/graphics/TransformHierarchy.bench.cxx"
+#include "utilities/graphics/VertexRepacking.bench.cxx"
+#include "utilities/graphics/MeshOptimizer.bench.cxx"
+#include "utilities/graphics/Meshlets.bench.cxx"
+#include "utilities/graphics/MeshSimplifier.bench.cxx"
+#include "utilities/graphics/VertexQuantization.bench.cxx"
+#include "utilities/graphics/Bvh.bench.cxx"
+#include "utilities/graphics/MeshFile.bench.cxx"
+#include "utilities/graphics/vulkan/TlsfAllocator.bench.cxx"
+
+#define RUN_BENCHMARKS(funcName) { LOG("Running benchmarks for " << #funcName << " ..."); funcName(); }
+
+int main(int argc, char** argv) {
+	std::string jsonFilePath = "";
+	std::string baselineFilePath = "";
+	double thresholdPercent = 10;
+	for (int i = 1; i < argc; ++i) {
+		std::string arg = argv[i];
+		if (arg == "--quick") {
+			v4d::Benchmark::SetMinSampleMilliseconds(2);
+		} else if (i + 1 < argc && arg == "--filter") {
+			v4d::Benchmark::SetFilter(argv[++i]);
+		} else if (i + 1 < argc && arg == "--json") {
+			jsonFilePath = argv[++i];
+		} else if (i + 1 < argc && arg == "--compare") {
+			baselineFilePath = argv[++i];
+		} else if (i + 1 < argc && arg == "--threshold") {
+			thresholdPercent = std::stod(argv[++i]);
+		} else {
+			LOG_ERROR("Unknown argument '" << arg << "'")
+			return -1;
+		}
+	}
+
+	if (!v4d::Init()) return -1;
+	LOG("Started benchmarks")
+
+	{
+		using namespace v4d::benchmarks;
+		RUN_BENCHMARKS( Stream )
+		RUN_BENCHMARKS( DataStream )
+		RUN_BENCHMARKS( Base16 )
+		RUN_BENCHMARKS( Base64 )
+		RUN_BENCHMARKS( BaseN )
+		RUN_BENCHMARKS( AES )
+		RUN_BENCHMARKS( RSA )
+		RUN_BENCHMARKS( SHA )
+		RUN_BENCHMARKS( ThreadPool )
+		RUN_BENCHMARKS( EntityComponentSystem )
+		RUN_BENCHMARKS( CommonObjects )
+		RUN_BENCHMARKS( Noise )
+		RUN_BENCHMARKS( Socket )
+		RUN_BENCHMARKS( BinaryFileStream )
+		RUN_BENCHMARKS( ConfigFile )
+		RUN_BENCHMARKS( Logger )
+		RUN_BENCHMARKS( BinaryLogger )
+		RUN_BENCHMARKS( TransformHierarchy )
+		RUN_BENCHMARKS( VertexRepacking )
+		RUN_BENCHMARKS( MeshOptimizer )
+		RUN_BENCHMARKS( Meshlets )
+		RUN_BENCHMARKS( MeshSimplifier )
+		RUN_BENCHMARKS( VertexQuantization )
+		RUN_BENCHMARKS( Bvh )
+		#ifdef _ENABLE_TINYGLTF
+			RUN_BENCHMARKS( MeshFile )
+		#endif
+		RUN_BENCHMARKS( TlsfAllocator )
+	}
+
+	if (jsonFilePath != "") {
+		if (!v4d::Benchmark::WriteJson(jsonFilePath)) return -1;
+		LOG("Benchmark results written to " << jsonFilePath)
+	}
+	if (baselineFilePath != "") {
+		int regressions = v4d::Benchmark::Compare(baselineFilePath, thresholdPercent);
+		if (regressions != 0) {
+			if (regressions > 0) LOG_WARN(regressions << " benchmark(s) regressed by more than " << thresholdPercent << "%")
+			return 1;
+		}
+	}
+	LOG_SUCCESS("BENCHMARKS DONE")
+	return 0;
+}
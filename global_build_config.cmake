@@ -26,7 +26,7 @@ endif()
 add_definitions(-D_V4D_PROJECT_PATH="${V4D_PROJECT_DIR}/")
 
 # Compiler optimizations and CPU Extensions
-set(BUILD_FLAGS "-mavx2")
+set(BUILD_FLAGS "-mavx2 -mf16c")
 
 if("${CMAKE_BUILD_TYPE}" STREQUAL "Debug")
 	set(BUILD_FLAGS "${BUILD_FLAGS} -O0")
@@ -0,0 +1,20 @@
+#include <v4d.h>
+#include "helpers/Benchmark.hpp"
+
+namespace v4d::benchmarks {
+	void Base16() {
+		using v4d::Benchmark;
+
+		std::vector<byte> data(1024);
+		for (size_t i = 0; i < data.size(); ++i) data[i] = byte(i * 31);
+
+		Benchmark::Run("Base16 Encode 1KB", [&data]{
+			Benchmark::DoNotOptimize(v4d::Base16::Encode(data.data(), data.size()));
+		}, data.size());
+
+		const std::string encoded = v4d::Base16::Encode(data);
+		Benchmark::Run("Base16 Decode 1KB", [&encoded]{
+			Benchmark::DoNotOptimize(v4d::Base16::Decode(encoded));
+		}, data.size());
+	}
+}
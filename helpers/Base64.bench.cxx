@@ -0,0 +1,20 @@
+#include <v4d.h>
+#include "helpers/Benchmark.hpp"
+
+namespace v4d::benchmarks {
+	void Base64() {
+		using v4d::Benchmark;
+
+		std::vector<byte> data(1024);
+		for (size_t i = 0; i < data.size(); ++i) data[i] = byte(i * 31);
+
+		Benchmark::Run("Base64 Encode 1KB", [&data]{
+			Benchmark::DoNotOptimize(v4d::Base64::Encode(data.data(), data.size()));
+		}, data.size());
+
+		const std::string encoded = v4d::Base64::Encode(data);
+		Benchmark::Run("Base64 Decode 1KB", [&encoded]{
+			Benchmark::DoNotOptimize(v4d::Base64::Decode(encoded));
+		}, data.size());
+	}
+}
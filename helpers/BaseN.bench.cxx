@@ -0,0 +1,17 @@
+#include <v4d.h>
+#include "helpers/Benchmark.hpp"
+
+namespace v4d::benchmarks {
+	void BaseN() {
+		using v4d::Benchmark;
+
+		Benchmark::Run("BaseN EncodeStringToUInt64 BASE36", []{
+			Benchmark::DoNotOptimize(v4d::BaseN::EncodeStringToUInt64("V4DBENCHMARK"));
+		});
+
+		const uint64_t value = v4d::BaseN::EncodeStringToUInt64("V4DBENCHMARK");
+		Benchmark::Run("BaseN DecodeStringFromUInt64 BASE36", [value]{
+			Benchmark::DoNotOptimize(v4d::BaseN::DecodeStringFromUInt64(value));
+		});
+	}
+}
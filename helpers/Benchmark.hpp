@@ -0,0 +1,197 @@
+/*
+ * Microbenchmark runner
+ * Part of the Vulkan4D open-source game engine under the LGPL license - https://github.com/Vulkan4D
+ *
+ * Each benchmark is calibrated so that a sample runs for at least MIN_SAMPLE_MILLISECONDS,
+ * then several samples are taken and the median time per operation is reported.
+ * Results can be written to a JSON file and compared against a previous run (ie: another commit).
+ *
+ * Usage:
+ * 		v4d::Benchmark::Run("Base64 Encode 1KB", [&]{
+ * 			v4d::Benchmark::DoNotOptimize(v4d::Base64::Encode(data));
+ * 		}, data.size()); // optional number of bytes processed per operation, to report throughput
+ * 		v4d::Benchmark::WriteJson("benchmarks.json");
+ * 		v4d::Benchmark::Compare("baseline.json");
+ */
+#pragma once
+
+#include <v4d.h>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <algorithm>
+#include <fstream>
+#include "utilities/data/json.hpp"
+
+#ifndef V4D_BENCHMARK_MIN_SAMPLE_MILLISECONDS
+	#define V4D_BENCHMARK_MIN_SAMPLE_MILLISECONDS 20
+#endif
+#ifndef V4D_BENCHMARK_SAMPLES
+	#define V4D_BENCHMARK_SAMPLES 7
+#endif
+
+namespace v4d {
+
+	class Benchmark {
+	public:
+
+		struct Result {
+			std::string name;
+			uint64_t iterations = 0; // per sample
+			double nsPerOp = 0; // median of all samples
+			double minNsPerOp = 0;
+			double meanNsPerOp = 0;
+			double bytesPerOp = 0;
+
+			double GetMegabytesPerSecond() const {
+				return nsPerOp > 0 ? bytesPerOp / nsPerOp * 1000.0 : 0;
+			}
+		};
+
+	private:
+		static inline std::vector<Result> results {};
+		static inline std::string filter {};
+		static inline double minSampleMilliseconds = V4D_BENCHMARK_MIN_SAMPLE_MILLISECONDS;
+
+		static double Now() {
+			return double(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count());
+		}
+
+		template<typename Func>
+		static double RunSample(Func& func, uint64_t iterations) {
+			double start = Now();
+			for (uint64_t i = 0; i < iterations; ++i) {
+				func();
+			}
+			return Now() - start;
+		}
+
+	public:
+
+		// Prevents the compiler from optimizing away a computed value
+		template<typename T>
+		static inline void DoNotOptimize(const T& value) {
+			asm volatile("" : : "r,m"(value) : "memory");
+		}
+
+		// Only run benchmarks whose name contains the given string
+		static void SetFilter(const std::string& str) {
+			filter = str;
+		}
+
+		// Shorter samples for a quick smoke run (results are less stable)
+		static void SetMinSampleMilliseconds(double ms) {
+			minSampleMilliseconds = ms;
+		}
+
+		static const std::vector<Result>& GetResults() {
+			return results;
+		}
+
+		/**
+		 * Runs func() repeatedly and records the median time per call
+		 * @param name unique name of this benchmark, used as the key when comparing results
+		 * @param func the operation to measure, called once per iteration
+		 * @param bytesPerOp optional number of bytes processed per call, to report throughput
+		 * @returns the recorded result, or nullptr if this benchmark was filtered out
+		 */
+		template<typename Func>
+		static const Result* Run(const std::string& name, Func&& func, double bytesPerOp = 0) {
+			if (filter != "" && name.find(filter) == std::string::npos) return nullptr;
+
+			// Warmup and calibration
+			uint64_t iterations = 1;
+			for (;;) {
+				double ns = RunSample(func, iterations);
+				if (ns >= minSampleMilliseconds * 1'000'000.0 || iterations >= (1ull << 40)) break;
+				// Aim slightly above the minimum sample time, growing at most 100x per step
+				double factor = ns > 0 ? std::min(100.0, minSampleMilliseconds * 1'200'000.0 / ns) : 100.0;
+				iterations = std::max(iterations + 1, uint64_t(double(iterations) * factor));
+			}
+
+			std::vector<double> samples(V4D_BENCHMARK_SAMPLES);
+			for (auto& sample : samples) {
+				sample = RunSample(func, iterations) / double(iterations);
+			}
+			std::sort(samples.begin(), samples.end());
+
+			Result& result = results.emplace_back();
+			result.name = name;
+			result.iterations = iterations;
+			result.nsPerOp = samples[samples.size() / 2];
+			result.minNsPerOp = samples.front();
+			for (double sample : samples) result.meanNsPerOp += sample;
+			result.meanNsPerOp /= double(samples.size());
+			result.bytesPerOp = bytesPerOp;
+
+			if (bytesPerOp > 0) {
+				LOG("    " << name << ": " << result.nsPerOp << " ns/op (min " << result.minNsPerOp << ", " << iterations << " iterations) " << result.GetMegabytesPerSecond() << " MB/s")
+			} else {
+				LOG("    " << name << ": " << result.nsPerOp << " ns/op (min " << result.minNsPerOp << ", " << iterations << " iterations)")
+			}
+			return &result;
+		}
+
+		static bool WriteJson(const std::string& filePath) {
+			nlohmann::json json;
+			json["benchmarks"] = nlohmann::json::array();
+			for (auto& result : results) {
+				json["benchmarks"].push_back({
+					{"name", result.name},
+					{"iterations", result.iterations},
+					{"ns_per_op", result.nsPerOp},
+					{"min_ns_per_op", result.minNsPerOp},
+					{"mean_ns_per_op", result.meanNsPerOp},
+					{"bytes_per_op", result.bytesPerOp},
+				});
+			}
+			std::ofstream file(filePath, std::ios::out | std::ios::trunc);
+			if (!file.is_open()) {
+				LOG_ERROR("Benchmark: Cannot open file '" << filePath << "' for writing")
+				return false;
+			}
+			file << json.dump(1, '\t') << std::endl;
+			return file.good();
+		}
+
+		/**
+		 * Compares current results with those previously written by WriteJson()
+		 * @param thresholdPercent slowdowns greater than this are reported as regressions
+		 * @returns the number of regressions, or -1 if the baseline could not be read
+		 */
+		static int Compare(const std::string& baselineFilePath, double thresholdPercent = 10) {
+			std::ifstream file(baselineFilePath);
+			if (!file.is_open()) {
+				LOG_ERROR("Benchmark: Cannot open baseline file '" << baselineFilePath << "'")
+				return -1;
+			}
+			nlohmann::json json = nlohmann::json::parse(file, nullptr, false);
+			if (json.is_discarded() || !json.contains("benchmarks")) {
+				LOG_ERROR("Benchmark: Invalid baseline file '" << baselineFilePath << "'")
+				return -1;
+			}
+			std::unordered_map<std::string, double> baseline {};
+			for (auto& entry : json["benchmarks"]) {
+				baseline[entry.value("name", "")] = entry.value("ns_per_op", 0.0);
+			}
+			int regressions = 0;
+			LOG("Comparison with " << baselineFilePath << " (negative is faster)")
+			for (auto& result : results) {
+				auto it = baseline.find(result.name);
+				if (it == baseline.end() || it->second <= 0) {
+					LOG("    " << result.name << ": new")
+					continue;
+				}
+				double deltaPercent = (result.nsPerOp - it->second) / it->second * 100.0;
+				if (deltaPercent > thresholdPercent) {
+					++regressions;
+					LOG_WARN("    " << result.name << ": +" << deltaPercent << "% (" << it->second << " -> " << result.nsPerOp << " ns/op)")
+				} else {
+					LOG("    " << result.name << ": " << (deltaPercent > 0 ? "+" : "") << deltaPercent << "% (" << it->second << " -> " << result.nsPerOp << " ns/op)")
+				}
+			}
+			return regressions;
+		}
+	};
+
+}
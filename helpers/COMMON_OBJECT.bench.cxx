@@ -0,0 +1,30 @@
+#include <v4d.h>
+#include "helpers/Benchmark.hpp"
+
+namespace v4d::benchmarks {
+
+	COMMON_OBJECT_CLASS(BenchmarkCommonObject, int)
+	COMMON_OBJECT_CPP(BenchmarkCommonObject, int)
+
+	void CommonObjects() {
+		using v4d::Benchmark;
+
+		std::vector<BenchmarkCommonObject> objects {};
+		objects.reserve(1000);
+		for (int i = 0; i < 1000; ++i) objects.emplace_back(i);
+
+		// Construction inserts into the global list and destruction erases from it
+		Benchmark::Run("COMMON_OBJECT insert/erase with 1000 live objects", []{
+			BenchmarkCommonObject obj {5};
+			Benchmark::DoNotOptimize(obj);
+		});
+
+		Benchmark::Run("COMMON_OBJECT ForEach 1000", []{
+			int sum = 0;
+			BenchmarkCommonObject::ForEach([&sum](BenchmarkCommonObject* obj){
+				sum += *obj;
+			});
+			Benchmark::DoNotOptimize(sum);
+		});
+	}
+}
@@ -0,0 +1,48 @@
+#include <v4d.h>
+#include "helpers/Benchmark.hpp"
+#include "helpers/EntityComponentSystem.hpp"
+
+struct BenchmarkTransform {
+	float position[3];
+	float velocity[3];
+};
+
+class BenchmarkEntity {
+	V4D_ENTITY_DECLARE_CLASS(BenchmarkEntity)
+	V4D_ENTITY_DECLARE_COMPONENT(BenchmarkEntity, BenchmarkTransform, transform)
+};
+V4D_ENTITY_DEFINE_CLASS(BenchmarkEntity)
+V4D_ENTITY_DEFINE_COMPONENT(BenchmarkEntity, BenchmarkTransform, transform)
+
+namespace v4d::benchmarks {
+	void EntityComponentSystem() {
+		using v4d::Benchmark;
+
+		for (int i = 0; i < 10000; ++i) {
+			auto entity = BenchmarkEntity::Create();
+			if (i % 2 == 0) entity->Add_transform(BenchmarkTransform{{0,0,0}, {1,2,3}});
+		}
+
+		Benchmark::Run("ECS ForEach entity 10k", []{
+			size_t count = 0;
+			BenchmarkEntity::ForEach([&count](auto entity){
+				count += entity->GetIndex();
+			});
+			Benchmark::DoNotOptimize(count);
+		});
+
+		Benchmark::Run("ECS Component ForEach 5k", []{
+			BenchmarkEntity::transformComponents.ForEach([](auto, auto& transform){
+				for (int i = 0; i < 3; ++i) transform.position[i] += transform.velocity[i];
+			});
+		});
+
+		Benchmark::Run("ECS Create/Destroy entity", []{
+			auto entity = BenchmarkEntity::Create();
+			entity->Add_transform();
+			entity->Destroy();
+		});
+
+		BenchmarkEntity::ClearAll();
+	}
+}
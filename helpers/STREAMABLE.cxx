@@ -0,0 +1,238 @@
+#include <v4d.h>
+#include <random>
+#include "utilities/data/DataStream.hpp"
+#include "helpers/STREAMABLE.hpp"
+
+namespace v4d::tests::Streamable_Schemas {
+	// Three versions of the same struct, as they would exist in different builds
+	struct PlayerV1 { STREAMABLE_VERSIONED(PlayerV1, id, name, position)
+		uint32_t id = 0;
+		std::string name = "unnamed";
+		std::array<float, 3> position {0,0,0};
+	};
+	// added health and tags, reordered position
+	struct PlayerV2 { STREAMABLE_VERSIONED(PlayerV2, id, position, name, health, tags)
+		uint32_t id = 0;
+		std::array<float, 3> position {0,0,0};
+		std::string name = "unnamed";
+		int32_t health = 100;
+		std::vector<std::string> tags {};
+	};
+	// removed name, changed the type of health (seen as a different field)
+	struct PlayerV3 { STREAMABLE_VERSIONED(PlayerV3, id, position, health)
+		uint32_t id = 0;
+		std::array<float, 3> position {0,0,0};
+		int64_t health = 50;
+	};
+	struct Nested { STREAMABLE_VERSIONED(Nested, players, flags)
+		std::vector<PlayerV2> players {};
+		uint8_t flags = 7;
+	};
+}
+
+namespace v4d::tests {
+	int Streamable() {
+		using namespace Streamable_Schemas;
+
+		{// Test 1 (same schema, with a trailing value to make sure the whole struct is consumed)
+			v4d::data::DataStream stream(1024);
+			PlayerV2 in {};
+			in.id = 42;
+			in.position = {1.5f, 2.5f, 3.5f};
+			in.name = "test";
+			in.health = 12;
+			in.tags = {"a", "bc"};
+			stream << in << uint32_t(0xdeadbeef);
+			stream.Flush();
+			PlayerV2 out = PlayerV2::ConstructFromStream(stream);
+			if (out.id != 42 || out.position[2] != 3.5f || out.name != "test" || out.health != 12 || out.tags.size() != 2 || out.tags[1] != "bc") {
+				LOG_ERROR("v4d::tests::Streamable ERROR 1.1 (round trip with the same schema)")
+				return 1;
+			}
+			if (stream.Read<uint32_t>() != 0xdeadbeef) {
+				LOG_ERROR("v4d::tests::Streamable ERROR 1.2 (trailing value)")
+				return 1;
+			}
+		}
+
+		{// Test 2 (older writer, missing fields keep their defaults)
+			v4d::data::DataStream stream(1024);
+			PlayerV1 in {};
+			in.id = 7;
+			in.name = "old";
+			in.position = {4, 5, 6};
+			stream << in << uint32_t(0xdeadbeef);
+			stream.Flush();
+			PlayerV2 out {};
+			out.health = 1;
+			out.tags = {"stale"};
+			stream >> out;
+			if (out.id != 7 || out.name != "old" || out.position[0] != 4 || out.health != 100 || out.tags.size() != 0) {
+				LOG_ERROR("v4d::tests::Streamable ERROR 2.1 (read an older schema)")
+				return 2;
+			}
+			if (stream.Read<uint32_t>() != 0xdeadbeef) {
+				LOG_ERROR("v4d::tests::Streamable ERROR 2.2 (trailing value)")
+				return 2;
+			}
+		}
+
+		{// Test 3 (newer writer, unknown fields are skipped, a changed type is defaulted)
+			v4d::data::DataStream stream(1024);
+			stream.SetEncoding(v4d::data::Stream::ENCODING::VARINT);
+			PlayerV2 in {};
+			in.id = 9;
+			in.position = {1, 2, 3};
+			in.name = "new";
+			in.health = 3;
+			in.tags = {"x", "y", "z"};
+			stream << in << uint32_t(0xdeadbeef);
+			stream.Flush();
+			PlayerV3 out = PlayerV3::ConstructFromStream(stream);
+			if (out.id != 9 || out.position[1] != 2 || out.health != 50) {
+				LOG_ERROR("v4d::tests::Streamable ERROR 3.1 (read a newer schema)")
+				return 3;
+			}
+			if (stream.Read<uint32_t>() != 0xdeadbeef) {
+				LOG_ERROR("v4d::tests::Streamable ERROR 3.2 (trailing value)")
+				return 3;
+			}
+		}
+
+		{// Test 4 (nested versioned structs in a container)
+			v4d::data::DataStream stream(1024);
+			Nested in {};
+			in.players.resize(3);
+			in.players[2].name = "third";
+			in.flags = 2;
+			stream << in;
+			stream.Flush();
+			Nested out = Nested::ConstructFromStream(stream);
+			if (out.players.size() != 3 || out.players[2].name != "third" || out.flags != 2) {
+				LOG_ERROR("v4d::tests::Streamable ERROR 4 (nested)")
+				return 4;
+			}
+		}
+
+		{// Test 5 (fuzzing: random values through mismatched schemas, then random corruptions of the bytes)
+			std::mt19937 rng(1234);
+			auto randomString = [&rng]{
+				std::string str(rng() % 20, ' ');
+				for (auto& c : str) c = char(rng());
+				return str;
+			};
+			auto randomPlayer = [&]{
+				PlayerV2 player {};
+				player.id = rng();
+				player.position = {float(rng() % 1000), float(rng() % 1000), float(rng() % 1000)};
+				player.name = randomString();
+				player.health = int32_t(rng());
+				player.tags.resize(rng() % 4);
+				for (auto& tag : player.tags) tag = randomString();
+				return player;
+			};
+			for (int i = 0; i < 2000; ++i) {
+				v4d::data::DataStream stream(1024);
+				if (rng() % 2) stream.SetEncoding(v4d::data::Stream::ENCODING::VARINT);
+				PlayerV2 player = randomPlayer();
+				int writerVersion = rng() % 3;
+				switch (writerVersion) {
+					case 0: {
+						PlayerV1 v1 {};
+						v1.id = player.id; v1.name = player.name; v1.position = player.position;
+						stream << v1;
+					}break;
+					case 1: stream << player; break;
+					case 2: {
+						PlayerV3 v3 {};
+						v3.id = player.id; v3.position = player.position; v3.health = player.health;
+						stream << v3;
+					}break;
+				}
+				stream.Flush();
+				std::vector<byte> bytes = stream.GetData();
+
+				// Intact bytes must read the common fields back with every reader
+				v4d::data::ReadOnlyStream intact(bytes);
+				intact.SetEncoding(stream.GetEncoding());
+				PlayerV1 v1 = PlayerV1::ConstructFromStream(intact);
+				v4d::data::ReadOnlyStream intact2(bytes);
+				intact2.SetEncoding(stream.GetEncoding());
+				PlayerV2 v2 = PlayerV2::ConstructFromStream(intact2);
+				if (v1.id != player.id || v2.id != player.id || v1.position != player.position || v2.position != player.position
+					|| v1.name != (writerVersion == 2? "unnamed" : player.name)
+					|| v2.health != (writerVersion == 1? player.health : 100)
+					|| !intact.IsDataBufferEnd() || !intact2.IsDataBufferEnd()
+				) {
+					LOG_ERROR("v4d::tests::Streamable ERROR 5.1 (fuzz iteration " << i << ", writer version " << (writerVersion+1) << ")")
+					return 5;
+				}
+
+				// Corrupted bytes may read garbage but must never crash nor allocate unbounded memory
+				switch (rng() % 3) {
+					case 0: bytes.resize(rng() % (bytes.size() + 1)); break;
+					case 1: for (int j = rng() % 4; j >= 0 && bytes.size() > 0; --j) bytes[rng() % bytes.size()] = byte(rng()); break;
+					case 2: for (int j = rng() % 16; j >= 0; --j) bytes.insert(bytes.begin() + (rng() % (bytes.size() + 1)), byte(rng())); break;
+				}
+				v4d::data::ReadOnlyStream corrupted(bytes);
+				corrupted.SetEncoding(stream.GetEncoding());
+				switch (rng() % 3) {
+					case 0: {PlayerV1 out; corrupted >> out;}break;
+					case 1: {PlayerV2 out; corrupted >> out;}break;
+					case 2: {PlayerV3 out; corrupted >> out;}break;
+				}
+			}
+		}
+
+		{// Test 6 (schema negotiation: the field table is skipped once the same schema was received, nested scratch streams are reused)
+			v4d::data::DataStream stream(1024);
+			Nested in {};
+			in.players.resize(2);
+			in.players[1].name = "second";
+			in.flags = 3;
+			stream << in;
+			const size_t fullSize = stream.GetWriteBufferSize();
+			stream.Flush();
+			Nested out = Nested::ConstructFromStream(stream);
+			stream << in;
+			if (out.players.size() != 2 || stream.GetWriteBufferSize() != fullSize) {
+				LOG_ERROR("v4d::tests::Streamable ERROR 6.1 (field table skipped without negotiation)")
+				return 6;
+			}
+			stream.Flush();
+			out = Nested::ConstructFromStream(stream);
+			stream.SetSchemaNegotiation(true);
+			stream << in;
+			stream.Flush();
+			out = Nested::ConstructFromStream(stream); // learns the schemas of Nested and PlayerV2
+			stream << in << uint32_t(0xdeadbeef);
+			const size_t negotiatedSize = stream.GetWriteBufferSize() - 4;
+			stream.Flush();
+			out = {};
+			out = Nested::ConstructFromStream(stream);
+			if (negotiatedSize >= fullSize || out.players.size() != 2 || out.players[1].name != "second" || out.flags != 3 || stream.Read<uint32_t>() != 0xdeadbeef) {
+				LOG_ERROR("v4d::tests::Streamable ERROR 6.2 (negotiated size " << negotiatedSize << ", full size " << fullSize << ")")
+				return 6;
+			}
+		}
+
+		{// Test 7 (field sizes that each fit in the stream but not together reject the whole header)
+			v4d::data::DataStream stream(1024);
+			stream << uint32_t(0) << uint8_t(3);
+			stream << v4d::data::__V4D_StreamableFieldTag("id", sizeof(uint32_t)) << uint8_t(4);
+			stream << uint16_t(1) << uint8_t(60);
+			stream << uint16_t(2) << uint8_t(60);
+			stream << uint32_t(5);
+			stream.WriteBytes(std::vector<byte>(66, 0).data(), 66);
+			stream.Flush();
+			v4d::data::ReadOnlyStream bytes(stream.GetData());
+			PlayerV1 out = PlayerV1::ConstructFromStream(bytes);
+			if (out.id != 0 || out.name != "unnamed") {
+				LOG_ERROR("v4d::tests::Streamable ERROR 7 (fields larger than the stream in total)")
+				return 7;
+			}
+		}
+
+		return 0;
+	}
+}
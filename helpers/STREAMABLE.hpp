@@ -1,16 +1,234 @@
+#pragma once
 
 #include "utilities/data/Stream.h"
+#include "utilities/data/ReadOnlyStream.h"
 #include "utilities/io/Socket.h"
+#include <cstddef>
+#include <array>
+#include <memory>
+#include <string_view>
 
 #define __V4D__STREAMABLE_WRITE(m) stream << obj.m;
 #define __V4D__STREAMABLE_READ(m) stream >> obj.m;
+#define __V4D__STREAMABLE_PACKED(m) packed = packed && offsetof(__V4D_T, m) == offset && v4d::data::IS_TRIVIALLY_STREAMABLE<decltype(__V4D_T::m)>; offset += sizeof(__V4D_T::m);
+// When all members are trivially streamable, listed in declaration order and without padding, the whole struct is written with a single memcpy (same bytes as writing each member)
 #define STREAMABLE(structName, ...) \
+template<typename __V4D_T> requires std::is_same_v<__V4D_T, structName> \
+friend constexpr bool __V4D_IsStreamablePacked(const __V4D_T*) { \
+	if constexpr (!std::is_trivially_copyable_v<__V4D_T> || !std::is_standard_layout_v<__V4D_T>) { \
+		return false; \
+	} else { \
+		bool packed = true; \
+		size_t offset = 0; \
+		FOR_EACH(__V4D__STREAMABLE_PACKED, __VA_ARGS__) \
+		return packed && offset == sizeof(__V4D_T); \
+	} \
+} \
+friend v4d::data::Stream& operator<<(v4d::data::Stream& stream, const structName& obj) { \
+	if constexpr (v4d::data::IS_TRIVIALLY_STREAMABLE<structName>) { \
+		return stream.WriteBytes(reinterpret_cast<const byte*>(&obj), sizeof(structName)); \
+	} else { \
+		FOR_EACH(__V4D__STREAMABLE_WRITE, __VA_ARGS__) \
+		return stream; \
+	} \
+} \
+friend v4d::data::Stream& operator>>(v4d::data::Stream& stream, structName& obj) { \
+	if constexpr (v4d::data::IS_TRIVIALLY_STREAMABLE<structName>) { \
+		return stream.ReadBytes(reinterpret_cast<byte*>(&obj), sizeof(structName)); \
+	} else { \
+		FOR_EACH(__V4D__STREAMABLE_READ, __VA_ARGS__) \
+		return stream; \
+	} \
+} \
+[[nodiscard]] static structName ConstructFromStream(v4d::data::Stream& stream) { \
+	structName data; \
+	stream >> data; \
+	return data; \
+} \
+[[nodiscard]] static structName ConstructFromStream(v4d::data::Stream* stream) { \
+	structName data; \
+	*stream >> data; \
+	return data; \
+} \
+[[nodiscard]] static structName ConstructFromStream(v4d::io::SocketPtr& stream) { \
+	structName data; \
+	*stream >> data; \
+	return data; \
+}
+
+#ifndef V4D_STREAMABLE_VERSIONED_MAX_FIELDS
+	#define V4D_STREAMABLE_VERSIONED_MAX_FIELDS 256 // a schema header with more fields is considered corrupted
+#endif
+#ifndef V4D_STREAMABLE_VERSIONED_MAX_FIELD_SIZE
+	#define V4D_STREAMABLE_VERSIONED_MAX_FIELD_SIZE 16777216 // a field larger than this (in bytes) is considered corrupted
+#endif
+#ifndef V4D_STREAMABLE_VERSIONED_MAX_SIZE
+	#define V4D_STREAMABLE_VERSIONED_MAX_SIZE 16777216 // fields adding up to more than this (in bytes) are considered corrupted
+#endif
+
+namespace v4d::data {
+	
+	// FNV-1a
+	constexpr uint32_t __V4D_StreamableHash(std::string_view str, uint32_t hash = 2166136261u) {
+		for (char c : str) hash = (hash ^ uint8_t(c)) * 16777619u;
+		return hash;
+	}
+	
+	// A field is identified by its name and size, so that changing the type of a member is seen as removing the old field and adding a new one
+	constexpr uint16_t __V4D_StreamableFieldTag(std::string_view name, size_t size) {
+		uint32_t hash = __V4D_StreamableHash(name);
+		for (size_t i = 0; i < sizeof(size); ++i) hash = (hash ^ uint8_t(size >> (i * 8))) * 16777619u;
+		return uint16_t(hash ^ (hash >> 16));
+	}
+	
+	template<size_t N>
+	constexpr uint32_t __V4D_StreamableSchemaHash(const std::array<uint16_t, N>& tags) {
+		uint32_t hash = 2166136261u;
+		for (uint16_t tag : tags) {
+			hash = (hash ^ uint8_t(tag)) * 16777619u;
+			hash = (hash ^ uint8_t(tag >> 8)) * 16777619u;
+		}
+		return hash;
+	}
+	
+	template<size_t N>
+	constexpr bool __V4D_StreamableTagsAreUnique(const std::array<uint16_t, N>& tags) {
+		for (size_t i = 0; i < N; ++i) for (size_t j = i + 1; j < N; ++j) if (tags[i] == tags[j]) return false;
+		return true;
+	}
+	
+	// Scratch stream for the fields of a STREAMABLE_VERSIONED struct being written, one per nesting level and thread, reused by all writes
+	class __V4D_StreamableScratch {
+		inline static thread_local std::vector<std::unique_ptr<Stream>> streams {};
+		inline static thread_local size_t depth = 0;
+		static Stream& Acquire() {
+			if (depth == streams.size()) {
+				streams.push_back(std::make_unique<Stream>(256));
+				streams.back()->autoFlush = false;
+			}
+			return *streams[depth++];
+		}
+	public:
+		Stream& fields;
+		__V4D_StreamableScratch(Stream::ENCODING encoding) : fields(Acquire()) {
+			fields.SetEncoding(encoding);
+		}
+		~__V4D_StreamableScratch() {
+			fields.ClearWriteBuffer();
+			--depth;
+		}
+	};
+	
+	// Skips the field table of a schema that matches the reader's
+	inline void __V4D_SkipStreamableFieldTable(Stream& stream, size_t count) {
+		for (size_t i = 0; i < count; ++i) {
+			stream.Read<uint16_t>();
+			stream.ReadSize();
+		}
+	}
+	
+	/**
+	 * Reads the field table and payloads of a schema that differs from the reader's
+	 * @param readField called with the tag and the isolated payload of each field, in the writer's order
+	 * @returns false if the header is corrupted, in which case the stream position is undefined
+	 */
+	template<typename ReadField>
+	bool __V4D_ReadStreamableFields(Stream& stream, size_t count, ReadField&& readField) {
+		if (count > V4D_STREAMABLE_VERSIONED_MAX_FIELDS) return false;
+		std::vector<std::pair<uint16_t, size_t>> fields(count);
+		size_t totalSize = 0;
+		for (auto& [tag, size] : fields) {
+			tag = stream.Read<uint16_t>();
+			size = stream.ReadSize();
+			if (size > V4D_STREAMABLE_VERSIONED_MAX_FIELD_SIZE) return false;
+			totalSize += size;
+		}
+		// All payloads follow the table, so together they must fit in what is left of the stream before any of them is allocated
+		if (totalSize > V4D_STREAMABLE_VERSIONED_MAX_SIZE || totalSize > stream.GetReadableSize()) return false;
+		// Fields of an in-memory stream are read in place
+		ReadOnlyStream* source = dynamic_cast<ReadOnlyStream*>(&stream);
+		for (auto& [tag, size] : fields) {
+			std::span<const byte> view = source? source->ReadBytesView(size) : std::span<const byte>{};
+			ReadOnlyStream field = source? ReadOnlyStream::Wrap(view.data(), view.size()) : ReadOnlyStream(size);
+			if (!source) stream.ReadBytes(field._GetReadBuffer_().data(), size);
+			field.SetEncoding(stream.GetEncoding());
+			readField(tag, field);
+		}
+		return true;
+	}
+	
+}
+
+#define __V4D__STREAMABLE_VERSIONED_TAG(m) v4d::data::__V4D_StreamableFieldTag(#m, sizeof(__V4D_T::m)),
+#define __V4D__STREAMABLE_VERSIONED_WRITE(m) fields << obj.m; fieldEnds[index++] = fields.GetWriteBufferSize();
+#define __V4D__STREAMABLE_VERSIONED_READ_FIELD(m) if (tag == tags[index]) { field >> obj.m; found[index] = true; return; } ++index;
+#define __V4D__STREAMABLE_VERSIONED_DEFAULT(m) if (!found[index]) obj.m = defaults.m; ++index;
+/**
+ * Same as STREAMABLE, with a schema header so that builds with different versions of the struct can exchange it (ie: during rolling upgrades).
+ * Wire format: uint32 schema hash, field count, (uint16 tag, payload size) per field, then the members written memberwise.
+ * Counts and sizes are written with Stream::WriteSize, so they take 1 or 9 bytes, or are a varint with ENCODING::VARINT.
+ * A reader with the same schema hash skips the field table and reads memberwise as usual,
+ * with Stream::SetSchemaNegotiation, the field count is 0 and there is no field table once the same schema was received from the peer,
+ * otherwise fields are matched by tag: unknown fields are skipped and missing fields keep the struct's default member values.
+ * Tags are derived from member names and sizes, members may be added, removed or reordered but not renamed.
+ * The struct must be default-constructible and copy-assignable.
+ * A corrupted header resets the struct to its default values. Field count and sizes are bounded by the V4D_STREAMABLE_VERSIONED_MAX_* values,
+ * and their total by the stream's GetReadableSize(), which is only an upper bound for streams that know their size.
+ */
+#define STREAMABLE_VERSIONED(structName, ...) \
+template<typename __V4D_T = structName> \
+static constexpr auto __V4D_StreamableTags() { \
+	constexpr std::array tags { FOR_EACH(__V4D__STREAMABLE_VERSIONED_TAG, __VA_ARGS__) }; \
+	static_assert(v4d::data::__V4D_StreamableTagsAreUnique(tags), "STREAMABLE_VERSIONED field tag collision, rename one of the members"); \
+	return tags; \
+} \
+template<typename __V4D_T> requires std::is_same_v<__V4D_T, structName> \
+friend constexpr bool __V4D_IsStreamablePacked(const __V4D_T*) { \
+	return false; \
+} \
 friend v4d::data::Stream& operator<<(v4d::data::Stream& stream, const structName& obj) { \
-	FOR_EACH(__V4D__STREAMABLE_WRITE, __VA_ARGS__) \
+	constexpr auto tags = structName::__V4D_StreamableTags(); \
+	constexpr uint32_t schemaHash = v4d::data::__V4D_StreamableSchemaHash(tags); \
+	if (stream.HasPeerSchema(schemaHash)) { \
+		stream << schemaHash; \
+		stream.WriteSize(0); \
+		FOR_EACH(__V4D__STREAMABLE_WRITE, __VA_ARGS__) \
+		return stream; \
+	} \
+	v4d::data::__V4D_StreamableScratch scratch(stream.GetEncoding()); \
+	v4d::data::Stream& fields = scratch.fields; \
+	std::array<size_t, tags.size()> fieldEnds; \
+	size_t index = 0; \
+	FOR_EACH(__V4D__STREAMABLE_VERSIONED_WRITE, __VA_ARGS__) \
+	stream << schemaHash; \
+	stream.WriteSize(tags.size()); \
+	for (index = 0; index < tags.size(); ++index) { \
+		stream << tags[index]; \
+		stream.WriteSize(fieldEnds[index] - (index > 0 ? fieldEnds[index - 1] : 0)); \
+	} \
+	stream.EmplaceStream(fields); \
 	return stream; \
 } \
 friend v4d::data::Stream& operator>>(v4d::data::Stream& stream, structName& obj) { \
-	FOR_EACH(__V4D__STREAMABLE_READ, __VA_ARGS__) \
+	constexpr auto tags = structName::__V4D_StreamableTags(); \
+	uint32_t schemaHash = stream.Read<uint32_t>(); \
+	size_t count = stream.ReadSize(); \
+	if (schemaHash == v4d::data::__V4D_StreamableSchemaHash(tags) && (count == tags.size() || count == 0)) { \
+		stream.AddPeerSchema(schemaHash); \
+		v4d::data::__V4D_SkipStreamableFieldTable(stream, count); \
+		FOR_EACH(__V4D__STREAMABLE_READ, __VA_ARGS__) \
+	} else { \
+		std::array<bool, tags.size()> found {}; \
+		if (!v4d::data::__V4D_ReadStreamableFields(stream, count, [&](uint16_t tag, v4d::data::Stream& field){ \
+			size_t index = 0; \
+			FOR_EACH(__V4D__STREAMABLE_VERSIONED_READ_FIELD, __VA_ARGS__) \
+		})) { \
+			found.fill(false); \
+		} \
+		const structName defaults {}; \
+		size_t index = 0; \
+		FOR_EACH(__V4D__STREAMABLE_VERSIONED_DEFAULT, __VA_ARGS__) \
+	} \
 	return stream; \
 } \
 [[nodiscard]] static structName ConstructFromStream(v4d::data::Stream& stream) { \
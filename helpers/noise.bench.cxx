@@ -0,0 +1,37 @@
+#include <v4d.h>
+#include "helpers/Benchmark.hpp"
+#include "helpers/noise.hpp"
+
+namespace v4d::benchmarks {
+	void Noise() {
+		using v4d::Benchmark;
+
+		glm::vec3 posf {0.5f, 1.25f, -3.75f};
+		glm::dvec3 posd {0.5, 1.25, -3.75};
+
+		Benchmark::Run("noise QuickNoise vec3", [&posf]{
+			posf.x += 0.01f;
+			Benchmark::DoNotOptimize(v4d::noise::QuickNoise(posf));
+		});
+
+		Benchmark::Run("noise Simplex vec3", [&posf]{
+			posf.x += 0.01f;
+			Benchmark::DoNotOptimize(v4d::noise::Simplex(posf));
+		});
+
+		Benchmark::Run("noise Simplex dvec3", [&posd]{
+			posd.x += 0.01;
+			Benchmark::DoNotOptimize(v4d::noise::Simplex(posd));
+		});
+
+		Benchmark::Run("noise SimplexFractal vec3 8 octaves", [&posf]{
+			posf.x += 0.01f;
+			Benchmark::DoNotOptimize(v4d::noise::SimplexFractal(posf, 8));
+		});
+
+		Benchmark::Run("noise FastSimplexFractal vec3 8 octaves", [&posf]{
+			posf.x += 0.01f;
+			Benchmark::DoNotOptimize(v4d::noise::FastSimplexFractal(posf, 8));
+		});
+	}
+}
@@ -0,0 +1,34 @@
+/*
+ * V4D binary log decoder
+ *
+ * Usage: v4d_logdecode <file.blog> [--no-timestamps]
+ * 		Renders a log file written by v4d::io::BinaryLogger as text in stdout
+ */
+#include <v4d.h>
+#include <iostream>
+#include "utilities/io/BinaryLogger.h"
+
+int main(int argc, char** argv) {
+	std::string filePath = "";
+	bool withTimestamps = true;
+	for (int i = 1; i < argc; ++i) {
+		std::string arg = argv[i];
+		if (arg == "--no-timestamps") {
+			withTimestamps = false;
+		} else if (filePath == "") {
+			filePath = arg;
+		} else {
+			std::cerr << "Unknown argument '" << arg << "'" << std::endl;
+			return -1;
+		}
+	}
+	if (filePath == "") {
+		std::cerr << "Usage: v4d_logdecode <file.blog> [--no-timestamps]" << std::endl;
+		return -1;
+	}
+	if (!v4d::io::BinaryLogger::Decode(filePath, std::cout, withTimestamps)) {
+		std::cerr << "'" << filePath << "' is not a valid binary log file" << std::endl;
+		return 1;
+	}
+	return 0;
+}
@@ -2,6 +2,7 @@
 #define LONG_ASS_STRING "3p9nm845y97348 57 4325 4732t5964bn325v435/4g3/5v/ghégéfv étg435 w3 T%$ V%$/$v45/%$C/45/%ff6 & & trFGD $%#$#$ J HG h FFgfsd fsdf sdfbsfw7f48 4 f87 H^%$ % ^$^ %&^&%$#^ *^$^%^&*^&*#@ @*%&( ytrgh df'eèèefààfdêf ebfwu 78ew78wew<fdsf\tdsfd\nfs fdsfdsfsdfsdfsddfsa fdsa fdsaf dsaf dsaf sadf asdf sadfsadf sadf sadfsad f  8439853956387 543 534534tg3 34 4t fsdfsdf"
 
 #include "utilities/processing/ThreadPool.cxx"
+#include "utilities/processing/Profiler.cxx"
 #include "utilities/networking/networking.cxx"
 #include "helpers/event.cxx"
 #include "helpers/Base16.cxx"
@@ -12,10 +13,28 @@
 #include "utilities/crypto/SHA.cxx"
 #include "utilities/data/DataStream.cxx"
 #include "utilities/io/BinaryFileStream.cxx"
+#include "utilities/io/FileWatcher.cxx"
+#include "utilities/io/Logger.cxx"
+#include "utilities/io/ConfigFile.cxx"
+#include "utilities/io/BinaryLogger.cxx"
 #include "utilities/io/Socket.cxx"
+#include "utilities/graphics/TransformHierarchy.cxx"
+#include "utilities/graphics/VertexRepacking.cxx"
+#include "utilities/graphics/MeshOptimizer.cxx"
+#include "utilities/graphics/Meshlets.cxx"
+#include "utilities/graphics/MeshSimplifier.cxx"
+#include "utilities/graphics/VertexQuantization.cxx"
+#include "utilities/graphics/Bvh.cxx"
+#include "utilities/graphics/MeshFile.cxx"
+#include "utilities/graphics/vulkan/BufferPool.cxx"
+#include "utilities/graphics/vulkan/TlsfAllocator.cxx"
+#include "utilities/graphics/vulkan/MemoryAllocationTracker.cxx"
+#include "utilities/graphics/vulkan/StagingRing.cxx"
+#include "utilities/graphics/vulkan/DeferredReleaseQueue.cxx"
 #include "utilities/graphics/VulkanInstance.cxx"
 #include "helpers/EntityComponentSystem.cxx"
 #include "helpers/COMMON_OBJECT.cxx"
+#include "helpers/STREAMABLE.cxx"
 
 #define RUN_UNIT_TESTS(funcName, ...) { LOG("Running tests for " << #funcName << " ..."); result += funcName(__VA_ARGS__); if (result != 0) { LOG_ERROR("UNIT TESTS FAILED"); return result; } }
 #define START_UNIT_TESTS using namespace v4d::tests; int main() { LOG("Started unit tests"); int result = 0; { if (!v4d::Init()) return -1;
@@ -27,6 +46,7 @@ namespace v4d::tests {
 		{
 
 			// RUN_UNIT_TESTS( ThreadPool )
+			RUN_UNIT_TESTS( Profiler )
 			RUN_UNIT_TESTS( Event )
 			RUN_UNIT_TESTS( Base16 )
 			RUN_UNIT_TESTS( Base64 )
@@ -35,9 +55,29 @@ namespace v4d::tests {
 			RUN_UNIT_TESTS( RSA )
 			RUN_UNIT_TESTS( SHA )
 			RUN_UNIT_TESTS( DataStream )
+			RUN_UNIT_TESTS( Streamable )
 			RUN_UNIT_TESTS( BinaryFileStream )
+			RUN_UNIT_TESTS( FileWatcher )
+			RUN_UNIT_TESTS( Logger )
+			RUN_UNIT_TESTS( ConfigFile )
+			RUN_UNIT_TESTS( BinaryLogger )
 			RUN_UNIT_TESTS( Socket )
 			RUN_UNIT_TESTS( Networking )
+			RUN_UNIT_TESTS( TransformHierarchy )
+			RUN_UNIT_TESTS( VertexRepacking )
+			RUN_UNIT_TESTS( MeshOptimizer )
+			RUN_UNIT_TESTS( Meshlets )
+			RUN_UNIT_TESTS( MeshSimplifier )
+			RUN_UNIT_TESTS( VertexQuantization )
+			RUN_UNIT_TESTS( Bvh )
+			#ifdef _ENABLE_TINYGLTF
+				RUN_UNIT_TESTS( MeshFile )
+			#endif
+			RUN_UNIT_TESTS( BufferPool )
+			RUN_UNIT_TESTS( TlsfAllocator )
+			RUN_UNIT_TESTS( MemoryAllocationTracker )
+			RUN_UNIT_TESTS( StagingRing )
+			RUN_UNIT_TESTS( DeferredReleaseQueue )
 			RUN_UNIT_TESTS( VulkanInstance )
 			RUN_UNIT_TESTS( EntityComponentSystem )
 			RUN_UNIT_TESTS( CommonObjects )
@@ -0,0 +1,22 @@
+#include <v4d.h>
+#include "helpers/Benchmark.hpp"
+#include "utilities/crypto/AES.h"
+
+namespace v4d::benchmarks {
+	void AES() {
+		using v4d::Benchmark;
+
+		v4d::crypto::AES aes(256);
+		std::vector<byte> data(4096);
+		for (size_t i = 0; i < data.size(); ++i) data[i] = byte(i * 13);
+
+		Benchmark::Run("AES-256 Encrypt 4KB", [&]{
+			Benchmark::DoNotOptimize(aes.Encrypt(data.data(), data.size()));
+		}, data.size());
+
+		const std::vector<byte> encrypted = aes.Encrypt(data.data(), data.size());
+		Benchmark::Run("AES-256 Decrypt 4KB", [&]{
+			Benchmark::DoNotOptimize(aes.Decrypt(encrypted.data(), encrypted.size()));
+		}, data.size());
+	}
+}
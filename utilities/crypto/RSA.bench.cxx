@@ -0,0 +1,31 @@
+#include <v4d.h>
+#include "helpers/Benchmark.hpp"
+#include "utilities/crypto/RSA.h"
+
+namespace v4d::benchmarks {
+	void RSA() {
+		using v4d::Benchmark;
+
+		v4d::crypto::RSA rsa(2048, 3);
+		std::vector<byte> data(128);
+		for (size_t i = 0; i < data.size(); ++i) data[i] = byte(i * 7);
+
+		Benchmark::Run("RSA-2048 Encrypt 128B", [&]{
+			Benchmark::DoNotOptimize(rsa.Encrypt(data.data(), data.size()));
+		}, data.size());
+
+		const std::vector<byte> encrypted = rsa.Encrypt(data.data(), data.size());
+		Benchmark::Run("RSA-2048 Decrypt 128B", [&]{
+			Benchmark::DoNotOptimize(rsa.Decrypt(encrypted.data(), encrypted.size()));
+		}, data.size());
+
+		Benchmark::Run("RSA-2048 Sign 128B", [&]{
+			Benchmark::DoNotOptimize(rsa.Sign(data));
+		}, data.size());
+
+		const std::vector<byte> signature = rsa.Sign(data);
+		Benchmark::Run("RSA-2048 Verify 128B", [&]{
+			Benchmark::DoNotOptimize(rsa.Verify(data, signature));
+		}, data.size());
+	}
+}
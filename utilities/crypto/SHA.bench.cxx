@@ -0,0 +1,24 @@
+#include <v4d.h>
+#include "helpers/Benchmark.hpp"
+#include "utilities/crypto/SHA.h"
+
+namespace v4d::benchmarks {
+	void SHA() {
+		using v4d::Benchmark;
+
+		std::vector<byte> data(4096);
+		for (size_t i = 0; i < data.size(); ++i) data[i] = byte(i * 17);
+
+		Benchmark::Run("SHA1 4KB", [&data]{
+			Benchmark::DoNotOptimize(v4d::crypto::SHA1(data));
+		}, data.size());
+
+		Benchmark::Run("SHA256 4KB", [&data]{
+			Benchmark::DoNotOptimize(v4d::crypto::SHA256(data));
+		}, data.size());
+
+		Benchmark::Run("SHA512 4KB", [&data]{
+			Benchmark::DoNotOptimize(v4d::crypto::SHA512(data));
+		}, data.size());
+	}
+}
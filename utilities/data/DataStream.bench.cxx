@@ -0,0 +1,72 @@
+#include <v4d.h>
+#include "helpers/Benchmark.hpp"
+#include <thread>
+#include "utilities/data/DataStream.hpp"
+#include "utilities/data/SpscDataStream.hpp"
+
+namespace v4d::benchmarks {
+	void DataStream() {
+		using v4d::Benchmark;
+
+		Benchmark::Run("DataStream Write/Flush/Read 100 int", []{
+			static v4d::data::DataStream stream(1024);
+			for (int i = 0; i < 100; ++i) stream << i;
+			stream.Flush();
+			int sum = 0;
+			for (int i = 0; i < 100; ++i) sum += stream.Read<int>();
+			Benchmark::DoNotOptimize(sum);
+		}, 100 * sizeof(int));
+
+		{
+			std::vector<byte> bytes(65536, 7);
+			Benchmark::Run("DataStream Write/Flush/Read 64KB", [&bytes]{
+				static v4d::data::DataStream stream(65536 + 64);
+				stream << bytes;
+				stream.Flush();
+				auto data = stream.Read<std::vector, byte>();
+				Benchmark::DoNotOptimize(data.data());
+			}, bytes.size());
+		}
+
+		// In-process pipe between two threads, mutex/condition_variable vs lock-free ring
+		auto pipeBenchmarks = [](const std::string& name, auto makePipe){
+			const int messages = 256;
+			const std::vector<byte> message(1024, 7);
+			auto pipe = makePipe();
+			Benchmark::Run(name + " Throughput 256x1KB messages", [&]{
+				std::thread producer([&]{
+					for (int i = 0; i < messages; ++i) {
+						*pipe << message;
+						pipe->Flush();
+					}
+				});
+				size_t total = 0;
+				for (int i = 0; i < messages; ++i) total += pipe->template Read<std::vector, byte>().size();
+				producer.join();
+				Benchmark::DoNotOptimize(total);
+			}, messages * message.size());
+
+			const int roundTrips = 100;
+			auto ping = makePipe();
+			auto pong = makePipe();
+			Benchmark::Run(name + " Latency 100 round trips", [&]{
+				std::thread echo([&]{
+					for (int i = 0; i < roundTrips; ++i) {
+						*pong << ping->template Read<int>();
+						pong->Flush();
+					}
+				});
+				int sum = 0;
+				for (int i = 0; i < roundTrips; ++i) {
+					*ping << i;
+					ping->Flush();
+					sum += pong->template Read<int>();
+				}
+				echo.join();
+				Benchmark::DoNotOptimize(sum);
+			});
+		};
+		pipeBenchmarks("DataStream", []{return std::make_unique<v4d::data::DataStream>(65536);});
+		pipeBenchmarks("SpscDataStream", []{return std::make_unique<v4d::data::SpscDataStream>(65536, 2048);});
+	}
+}
@@ -1,6 +1,27 @@
 #include <v4d.h>
 #include <thread>
 #include "utilities/data/DataStream.hpp"
+#include "utilities/data/ReadOnlyStream.h"
+#include "utilities/data/SpscDataStream.hpp"
+#include "helpers/STREAMABLE.hpp"
+
+namespace v4d::tests::DataStream_Structs {
+	struct Packed { STREAMABLE(Packed, x, y, z, id)
+		float x, y, z;
+		uint32_t id;
+	};
+	struct Padded { STREAMABLE(Padded, id, value)
+		uint32_t id;
+		double value;
+	};
+	struct WithString { STREAMABLE(WithString, name, position)
+		std::string name;
+		Packed position;
+	};
+	static_assert(v4d::data::IS_TRIVIALLY_STREAMABLE<Packed>);
+	static_assert(!v4d::data::IS_TRIVIALLY_STREAMABLE<Padded>);
+	static_assert(!v4d::data::IS_TRIVIALLY_STREAMABLE<WithString>);
+}
 
 namespace v4d::tests {
 	int DataStream() {
@@ -202,6 +223,143 @@ namespace v4d::tests {
 			}
 		}
 
+		{// Test 10 (VARINT encoding for sizes and compact integers)
+			using v4d::data::Stream;
+			bs.SetEncoding(Stream::ENCODING::VARINT);
+			bs.WriteCompact<uint32_t>(5); // 1 byte
+			bs.WriteCompact<int32_t>(-3); // 1 byte
+			bs.WriteCompact<uint64_t>(300); // 2 bytes
+			bs.WriteCompact<int64_t>(std::numeric_limits<int64_t>::min()); // 10 bytes
+			bs.WriteCompact<uint64_t>(std::numeric_limits<uint64_t>::max()); // 10 bytes
+			bs << v4d::data::Compact<int16_t>(-64); // 1 byte
+			bs << std::string(200, 'x'); // 2 bytes size
+			bs << std::vector<int>{1, 2, 3}; // 1 byte size
+			size_t size = bs.GetWriteBufferSize();
+			if (size != 1+1+2+10+10+1+2+200+1+12) {
+				LOG_ERROR("v4d::tests::DataStream ERROR 10.1 (wrong VARINT encoded size " << size << ")")
+				return 10;
+			}
+			bs.Flush();
+			if (bs.ReadCompact<uint32_t>() != 5
+			 || bs.ReadCompact<int32_t>() != -3
+			 || bs.ReadCompact<uint64_t>() != 300
+			 || bs.ReadCompact<int64_t>() != std::numeric_limits<int64_t>::min()
+			 || bs.ReadCompact<uint64_t>() != std::numeric_limits<uint64_t>::max()
+			 || bs.Read<v4d::data::Compact<int16_t>>() != -64
+			 || bs.Read<std::string>() != std::string(200, 'x')
+			 || bs.Read<std::vector, int>() != std::vector<int>{1, 2, 3}
+			) {
+				LOG_ERROR("v4d::tests::DataStream ERROR 10.2 (wrong VARINT decoded values)")
+				return 10;
+			}
+			
+			// LEGACY encoding keeps full-width compact integers and 1-or-9 bytes sizes
+			bs.SetEncoding(Stream::ENCODING::LEGACY);
+			bs.WriteCompact<uint32_t>(5);
+			bs << std::string(300, 'x');
+			size = bs.GetWriteBufferSize();
+			bs.Flush();
+			if (size != 4+9+300 || bs.ReadCompact<uint32_t>() != 5 || bs.Read<std::string>().size() != 300) {
+				LOG_ERROR("v4d::tests::DataStream ERROR 10.3 (wrong LEGACY encoding)")
+				return 10;
+			}
+		}
+
+		{// Test 11 (memcpy fast path gives the same bytes as member-wise writes, padded structs keep their raw layout in containers, containers of STREAMABLE structs)
+			using namespace v4d::tests::DataStream_Structs;
+			std::vector<Packed> packed {{1.5f, 2.5f, 3.5f, 7}, {-1, 0, 1, 8}};
+			std::vector<Padded> padded {{1, 0.5}, {2, 1.5}};
+			std::vector<WithString> withString {{"first", {1, 2, 3, 4}}, {"second", {5, 6, 7, 8}}};
+			bs << packed << padded << withString;
+			size_t size = bs.GetWriteBufferSize();
+			if (size != 1+2*16 + 1+2*sizeof(Padded) + 1+2*(1+16)+5+6) {
+				LOG_ERROR("v4d::tests::DataStream ERROR 11.1 (wrong size " << size << ")")
+				return 11;
+			}
+			bs.Flush();
+			auto packed2 = bs.Read<std::vector, Packed>();
+			auto padded2 = bs.Read<std::vector, Padded>();
+			auto withString2 = bs.Read<std::vector, WithString>();
+			if (packed2.size() != 2 || packed2[1].x != -1 || packed2[1].id != 8
+			 || padded2.size() != 2 || padded2[1].id != 2 || padded2[1].value != 1.5
+			 || withString2.size() != 2 || withString2[1].name != "second" || withString2[1].position.id != 8
+			) {
+				LOG_ERROR("v4d::tests::DataStream ERROR 11.2 (wrong values)")
+				return 11;
+			}
+			
+			// Same bytes as before STREAMABLE structs had a fast path: Write() and containers memcpy sizeof(Padded) including padding, operator<< is member-wise
+			Padded item;
+			memset(&item, 0xAB, sizeof(item));
+			item.id = 3;
+			item.value = 2.5;
+			v4d::data::Stream stream(256);
+			stream.autoFlush = false;
+			stream.SetEncoding(v4d::data::Stream::ENCODING::LEGACY);
+			stream.Write(item);
+			stream << std::vector<Padded>{item, item};
+			stream << item;
+			std::vector<byte> expected(reinterpret_cast<const byte*>(&item), reinterpret_cast<const byte*>(&item) + sizeof(item));
+			expected.push_back(2);
+			expected.insert(expected.end(), reinterpret_cast<const byte*>(&item), reinterpret_cast<const byte*>(&item) + sizeof(item));
+			expected.insert(expected.end(), reinterpret_cast<const byte*>(&item), reinterpret_cast<const byte*>(&item) + sizeof(item));
+			expected.insert(expected.end(), reinterpret_cast<const byte*>(&item.id), reinterpret_cast<const byte*>(&item.id) + sizeof(item.id));
+			expected.insert(expected.end(), reinterpret_cast<const byte*>(&item.value), reinterpret_cast<const byte*>(&item.value) + sizeof(item.value));
+			if (stream._GetWriteBuffer_() != expected) {
+				LOG_ERROR("v4d::tests::DataStream ERROR 11.3 (padded struct bytes differ from the original encoding)")
+				return 11;
+			}
+		}
+
+		{// Test 12 (zero-copy ReadOnlyStream over an external buffer)
+			v4d::data::Stream inner(64);
+			inner << std::string("nested") << 99;
+			v4d::data::Stream writer(256);
+			writer << std::string("hello") << std::vector<byte>{1, 2, 3} << 42;
+			writer.WriteStream(inner);
+			const std::vector<byte> buffer = writer._GetWriteBuffer_();
+			auto stream = v4d::data::ReadOnlyStream::Wrap(buffer.data(), buffer.size());
+			std::string_view str = stream.ReadStringView();
+			auto bytes = stream.ReadByteVectorView();
+			int value = stream.Read<int>();
+			auto innerView = stream.ReadStreamView();
+			if (str != "hello" || (const byte*)str.data() != buffer.data() + 1 || bytes.size() != 3 || bytes[2] != 3 || value != 42) {
+				LOG_ERROR("v4d::tests::DataStream ERROR 12.1 (views)")
+				return 12;
+			}
+			if (innerView.ReadStringView() != "nested" || innerView.Read<int>() != 99 || !innerView.IsDataBufferEnd() || !stream.IsDataBufferEnd()) {
+				LOG_ERROR("v4d::tests::DataStream ERROR 12.2 (nested stream view)")
+				return 12;
+			}
+			if (stream.ReadBytesView(1).size() != 0 || stream.ReadStringView() != "") {
+				LOG_ERROR("v4d::tests::DataStream ERROR 12.3 (view past the end)")
+				return 12;
+			}
+		}
+
+		{// Test 13 (lock-free SPSC variant, with a ring smaller than some messages)
+			v4d::data::SpscDataStream pipe(256, 64);
+			const int count = 10000;
+			std::thread producer([&pipe]{
+				for (int i = 0; i < count; ++i) {
+					pipe << i;
+					if (i % 100 == 0) pipe << std::string(i % 1000, 'x');
+					if (i % 7 == 0) pipe.Flush();
+				}
+				pipe.Flush();
+			});
+			int errors = 0;
+			for (int i = 0; i < count; ++i) {
+				if (pipe.Read<int>() != i) ++errors;
+				if (i % 100 == 0 && pipe.Read<std::string>() != std::string(i % 1000, 'x')) ++errors;
+			}
+			producer.join();
+			if (errors != 0 || pipe.GetAvailableSize() != 0 || pipe.GetCapacity() != 256) {
+				LOG_ERROR("v4d::tests::DataStream ERROR 13 (" << errors << " wrong values through SpscDataStream)")
+				return 13;
+			}
+		}
+
 		return result;
 	}
 }
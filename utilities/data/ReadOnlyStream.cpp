@@ -10,6 +10,8 @@ namespace v4d::data {
 		ImportData(bytes.data(), bytes.size());
 	}
 
+	ReadOnlyStream::ReadOnlyStream(std::vector<byte>&& bytes) : Stream(0), dataBuffer(std::move(bytes)) {}
+
 	ReadOnlyStream::ReadOnlyStream(const byte* data, size_t size) : Stream(0), dataBuffer(size) {
 		ImportData(data, size);
 	}
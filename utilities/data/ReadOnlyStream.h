@@ -1,6 +1,8 @@
 #pragma once
 
 #include <cstring>
+#include <string_view>
+#include <span>
 #include "utilities/data/Stream.h"
 
 namespace v4d::data {
@@ -9,16 +11,41 @@ namespace v4d::data {
 		std::vector<byte> dataBuffer{};
 		size_t dataBufferCursor = 0;
 
+		// Externally owned buffer (see Wrap), used instead of dataBuffer when not null
+		const byte* externalData = nullptr;
+		size_t externalSize = 0;
+
+		const byte* GetDataPtr() const {
+			return externalData? externalData : dataBuffer.data();
+		}
+		size_t GetDataSize() const {
+			return externalData? externalSize : dataBuffer.size();
+		}
+
 	public:
 
 		ReadOnlyStream();
 		ReadOnlyStream(size_t bufferSize);
 		ReadOnlyStream(const std::vector<byte>& bytes);
+		ReadOnlyStream(std::vector<byte>&& bytes);
 		ReadOnlyStream(const byte* data, size_t size);
 		virtual ~ReadOnlyStream();
 
+		/**
+		 * Reads directly from an externally owned buffer (ie: mmap region, socket slab, arena chunk) without copying it in.
+		 * The buffer must outlive this stream and all views read from it (ReadStringView, ReadBytesView...).
+		 */
+		static ReadOnlyStream Wrap(const byte* data, size_t size) {
+			ReadOnlyStream stream;
+			stream.externalData = data;
+			stream.externalSize = size;
+			return stream;
+		}
+
 		void ImportData(const byte* data, size_t size) {
 			assert(data);
+			externalData = nullptr;
+			externalSize = 0;
 			if (size > 0) {
 				dataBuffer.resize(size);
 				memcpy(dataBuffer.data(), data, size);
@@ -26,25 +53,77 @@ namespace v4d::data {
 		}
 
 		size_t GetDataBufferRemaining() const {
-			return dataBuffer.size() - dataBufferCursor;
+			return GetDataSize() - dataBufferCursor;
 		}
-		
+
 		bool IsDataBufferEnd() const {
-			return dataBufferCursor == dataBuffer.size();
+			return dataBufferCursor == GetDataSize();
+		}
+
+		size_t GetReadableSize() override {
+			return GetDataBufferRemaining();
 		}
 
 		virtual std::vector<byte> GetData() override {
 			LockRead();
 				// Copy and return buffer
-				std::vector<byte> buf = dataBuffer;
+				std::vector<byte> buf(GetDataPtr(), GetDataPtr() + GetDataSize());
 			UnlockRead();
 			return buf;
 		}
 
+		// Copies a wrapped external buffer in, since the caller may modify it
 		std::vector<byte>& _GetReadBuffer_() override {
+			if (externalData) {
+				dataBuffer.assign(externalData, externalData + externalSize);
+				externalData = nullptr;
+				externalSize = 0;
+			}
 			return dataBuffer;
 		}
 
+	public: // Zero-copy reads, the returned views point into this stream's buffer and are only valid as long as it is
+
+		// Next n bytes, or an empty span if there are not enough bytes left
+		std::span<const byte> ReadBytesView(size_t n) {
+			LockRead();
+				std::span<const byte> view {};
+				if (n > GetDataBufferRemaining()) {
+					ReadBytes_OnError("ReadOnlyStream view exceeds readable data");
+				} else {
+					view = {GetDataPtr() + dataBufferCursor, n};
+					dataBufferCursor += n;
+				}
+			UnlockRead();
+			return view;
+		}
+
+		// Reads a std::string as written by Write<std::string>
+		std::string_view ReadStringView() {
+			LockRead();
+				auto bytes = ReadBytesView(ReadSize());
+			UnlockRead();
+			return {reinterpret_cast<const char*>(bytes.data()), bytes.size()};
+		}
+
+		// Reads a byte vector as written by Write<std::vector, byte>
+		std::span<const byte> ReadByteVectorView() {
+			LockRead();
+				auto bytes = ReadBytesView(ReadSize());
+			UnlockRead();
+			return bytes;
+		}
+
+		// Reads a stream as written by WriteStream(), sharing this stream's buffer
+		ReadOnlyStream ReadStreamView() {
+			LockRead();
+				auto bytes = ReadBytesView(ReadSize());
+			UnlockRead();
+			ReadOnlyStream stream = Wrap(bytes.data(), bytes.size());
+			stream.SetEncoding(GetEncoding());
+			return stream;
+		}
+
 	protected:
 
 		virtual void Send() override {}
@@ -53,7 +132,7 @@ namespace v4d::data {
 			if (n > GetDataBufferRemaining()) {
 				return 0;
 			}
-			std::memcpy(data, dataBuffer.data() + dataBufferCursor, n);
+			std::memcpy(data, GetDataPtr() + dataBufferCursor, n);
 			dataBufferCursor += n;
 			return n;
 		}
@@ -0,0 +1,202 @@
+/*
+ * Lock-free single-producer/single-consumer DataStream
+ * Part of the Vulkan4D open-source game engine under the LGPL license - https://github.com/Vulkan4D
+ *
+ * Same usage as DataStream, for the case where exactly one thread writes (and flushes) and exactly one other thread reads.
+ * Flushed bytes are copied once into a fixed-size ring buffer, Send() blocks while the ring is full and reads block until enough bytes were flushed.
+ * Head and tail indices live on their own cache lines. A blocked thread yields a few times then waits with std::atomic wait/notify (futex on Linux),
+ * and is only notified once enough data or room is available, so that there is no syscall per message.
+ *
+ * 		v4d::data::SpscDataStream pipe(65536);
+ * 		// simulation thread
+ * 		pipe << update;
+ * 		pipe.Flush();
+ * 		// network thread
+ * 		pipe >> update;
+ */
+#pragma once
+
+#include <atomic>
+#include <thread>
+#include <cstring>
+#include <algorithm>
+#include "utilities/data/Stream.h"
+
+#ifndef V4D_SPSC_DATASTREAM_SPIN_COUNT
+	#define V4D_SPSC_DATASTREAM_SPIN_COUNT 64 // number of yields before blocking on the futex
+#endif
+
+namespace v4d::data {
+	class SpscDataStream : public Stream {
+		static constexpr size_t CACHE_LINE_SIZE = 64;
+
+		// Positions are 32-bit so that they can be waited on directly with a futex, they wrap around and are only compared through differences
+		using Position = uint32_t;
+		static constexpr size_t MAX_CAPACITY = size_t(1) << 30;
+
+		static bool Reached(Position position, Position target) {
+			return Position(position - target) < (Position(1) << 31);
+		}
+
+		std::vector<byte> ring;
+		const Position mask;
+
+		// Written by the producer only (cachedTail is the last tail it has seen, to avoid reading the consumer's cache line on every Send)
+		struct alignas(CACHE_LINE_SIZE) ProducerState {
+			std::atomic<Position> head {0}; // total number of bytes ever sent (modulo 2^32)
+			Position cachedTail = 0;
+		} producer;
+
+		// Written by the consumer only
+		struct alignas(CACHE_LINE_SIZE) ConsumerState {
+			std::atomic<Position> tail {0}; // total number of bytes ever received (modulo 2^32)
+			Position cachedHead = 0;
+		} consumer;
+
+		// Set by a blocked thread with the position it is waiting for, so that the other thread only wakes it up once there is enough to do.
+		// A blocked thread waits on its own wakeup counter rather than on head/tail, which change (and would end the wait) with every chunk,
+		// causing a context switch per message when both threads share a core.
+		struct alignas(CACHE_LINE_SIZE) WaitState {
+			std::atomic<bool> producerWaiting {false};
+			std::atomic<bool> consumerWaiting {false};
+			std::atomic<Position> producerWaitingForTail {0};
+			std::atomic<Position> consumerWaitingForHead {0};
+			std::atomic<uint32_t> producerWakeups {0};
+			std::atomic<uint32_t> consumerWakeups {0};
+		} waiting;
+
+		// Yields a few times first (cheaper than a futex round trip, and lets the other thread run if both share a core)
+		static void Wait(std::atomic<uint32_t>& wakeups, uint32_t old) {
+			for (int i = 0; i < V4D_SPSC_DATASTREAM_SPIN_COUNT; ++i) {
+				if (wakeups.load(std::memory_order_acquire) != old) return;
+				std::this_thread::yield();
+			}
+			wakeups.wait(old, std::memory_order_acquire);
+		}
+
+		static size_t RoundUpToPowerOfTwo(size_t size) {
+			size_t capacity = 64;
+			while (capacity < size && capacity < MAX_CAPACITY) capacity <<= 1;
+			return capacity;
+		}
+
+	public:
+
+		/**
+		 * @param capacity size of the ring buffer in bytes, rounded up to a power of two (at most 1 GB)
+		 * @param bufferSize size of the write buffer, which is automatically flushed when full
+		 */
+		SpscDataStream(size_t capacity = 65536, size_t bufferSize = 1024) : Stream(bufferSize), ring(RoundUpToPowerOfTwo(capacity)), mask(Position(ring.size() - 1)) {}
+
+		DELETE_COPY_MOVE_CONSTRUCTORS(SpscDataStream)
+
+		size_t GetCapacity() const {
+			return ring.size();
+		}
+
+		// Number of flushed bytes that have not been read yet (only exact from the consumer thread)
+		size_t GetAvailableSize() const {
+			return Position(producer.head.load(std::memory_order_acquire) - consumer.tail.load(std::memory_order_relaxed));
+		}
+
+		// Unread bytes, without consuming them (consumer thread only)
+		virtual std::vector<byte> GetData() override {
+			Position tail = consumer.tail.load(std::memory_order_relaxed);
+			Position head = producer.head.load(std::memory_order_acquire);
+			std::vector<byte> data(Position(head - tail));
+			CopyOut(tail, data.data(), data.size());
+			return data;
+		}
+
+	private:
+
+		void CopyIn(Position position, const byte* data, size_t n) {
+			size_t offset = position & mask;
+			size_t first = std::min(n, ring.size() - offset);
+			std::memcpy(ring.data() + offset, data, first);
+			std::memcpy(ring.data(), data + first, n - first);
+		}
+
+		void CopyOut(Position position, byte* data, size_t n) const {
+			size_t offset = position & mask;
+			size_t first = std::min(n, ring.size() - offset);
+			std::memcpy(data, ring.data() + offset, first);
+			std::memcpy(data + first, ring.data(), n - first);
+		}
+
+	protected:
+
+		// Producer thread
+		virtual void Send() override {
+			const byte* data = _GetWriteBuffer_().data();
+			size_t n = _GetWriteBuffer_().size();
+			Position head = producer.head.load(std::memory_order_relaxed);
+			while (n > 0) {
+				size_t free = ring.size() - Position(head - producer.cachedTail);
+				if (free == 0) {
+					producer.cachedTail = consumer.tail.load(std::memory_order_acquire);
+					if (Position(head - producer.cachedTail) == ring.size()) {
+						// Ring is full, wait until the consumer has made room for the rest of the data (or a quarter of the ring)
+						Position wantedTail = Position(head - ring.size() + std::min(n, ring.size() / 4));
+						waiting.producerWaitingForTail.store(wantedTail, std::memory_order_relaxed);
+						waiting.producerWaiting.store(true, std::memory_order_seq_cst);
+						for (;;) {
+							uint32_t wakeups = waiting.producerWakeups.load(std::memory_order_seq_cst);
+							if (Reached(consumer.tail.load(std::memory_order_seq_cst), wantedTail)) break;
+							Wait(waiting.producerWakeups, wakeups);
+						}
+						waiting.producerWaiting.store(false, std::memory_order_relaxed);
+					}
+					continue;
+				}
+				size_t chunk = std::min(n, free);
+				CopyIn(head, data, chunk);
+				head += Position(chunk);
+				data += chunk;
+				n -= chunk;
+				producer.head.store(head, std::memory_order_seq_cst);
+				if (waiting.consumerWaiting.load(std::memory_order_seq_cst) && Reached(head, waiting.consumerWaitingForHead.load(std::memory_order_relaxed))) {
+					waiting.consumerWakeups.fetch_add(1, std::memory_order_seq_cst);
+					waiting.consumerWakeups.notify_one();
+				}
+			}
+		}
+
+		// Consumer thread, blocks until n bytes have been received (messages larger than the ring are received in chunks)
+		virtual size_t Receive(byte* data, size_t n) override {
+			Position tail = consumer.tail.load(std::memory_order_relaxed);
+			size_t remaining = n;
+			while (remaining > 0) {
+				size_t available = Position(consumer.cachedHead - tail);
+				if (available == 0) {
+					consumer.cachedHead = producer.head.load(std::memory_order_acquire);
+					if (consumer.cachedHead == tail) {
+						// Ring is empty, wait until the producer has sent the rest of the data (or half of the ring)
+						Position wantedHead = Position(tail + std::min(remaining, ring.size() / 2));
+						waiting.consumerWaitingForHead.store(wantedHead, std::memory_order_relaxed);
+						waiting.consumerWaiting.store(true, std::memory_order_seq_cst);
+						for (;;) {
+							uint32_t wakeups = waiting.consumerWakeups.load(std::memory_order_seq_cst);
+							if (Reached(producer.head.load(std::memory_order_seq_cst), wantedHead)) break;
+							Wait(waiting.consumerWakeups, wakeups);
+						}
+						waiting.consumerWaiting.store(false, std::memory_order_relaxed);
+					}
+					continue;
+				}
+				size_t chunk = std::min(remaining, available);
+				CopyOut(tail, data, chunk);
+				tail += Position(chunk);
+				data += chunk;
+				remaining -= chunk;
+				consumer.tail.store(tail, std::memory_order_seq_cst);
+				if (waiting.producerWaiting.load(std::memory_order_seq_cst) && Reached(tail, waiting.producerWaitingForTail.load(std::memory_order_relaxed))) {
+					waiting.producerWakeups.fetch_add(1, std::memory_order_seq_cst);
+					waiting.producerWakeups.notify_one();
+				}
+			}
+			return n;
+		}
+
+	};
+}
@@ -0,0 +1,161 @@
+#include <v4d.h>
+#include "helpers/Benchmark.hpp"
+#include "utilities/data/Stream.h"
+#include "utilities/data/ReadOnlyStream.h"
+#include "helpers/STREAMABLE.hpp"
+
+namespace v4d::benchmarks {
+
+	// Typical entity update: small ids and deltas
+	struct BenchmarkEntityUpdate {
+		uint32_t id;
+		int32_t dx, dy, dz;
+		uint16_t flags;
+	};
+
+	struct BenchmarkVertex { STREAMABLE(BenchmarkVertex, x, y, z)
+		float x, y, z;
+	};
+
+	static void WriteEntityUpdates(v4d::data::Stream& stream, const std::vector<BenchmarkEntityUpdate>& updates) {
+		stream.WriteSize(updates.size());
+		for (auto& u : updates) {
+			stream.WriteCompact(u.id);
+			stream.WriteCompact(u.dx);
+			stream.WriteCompact(u.dy);
+			stream.WriteCompact(u.dz);
+			stream.WriteCompact(u.flags);
+		}
+	}
+
+	static void ReadEntityUpdates(v4d::data::Stream& stream, std::vector<BenchmarkEntityUpdate>& updates) {
+		updates.resize(stream.ReadSize());
+		for (auto& u : updates) {
+			stream.ReadCompact(u.id);
+			stream.ReadCompact(u.dx);
+			stream.ReadCompact(u.dy);
+			stream.ReadCompact(u.dz);
+			stream.ReadCompact(u.flags);
+		}
+	}
+
+	void Stream() {
+		using v4d::Benchmark;
+
+		Benchmark::Run("Stream Write 1000 int", []{
+			static v4d::data::Stream stream(8192);
+			for (int i = 0; i < 1000; ++i) stream << i;
+			Benchmark::DoNotOptimize(stream._GetWriteBuffer_().data());
+			stream.ClearWriteBuffer();
+		}, 1000 * sizeof(int));
+
+		Benchmark::Run("Stream Write 100 std::string", []{
+			static v4d::data::Stream stream(8192);
+			static const std::string str = "Hello Benchmark! This is a moderately sized string.";
+			for (int i = 0; i < 100; ++i) stream << str;
+			Benchmark::DoNotOptimize(stream._GetWriteBuffer_().data());
+			stream.ClearWriteBuffer();
+		}, 100 * 51);
+
+		{
+			std::vector<double> values(1024, 1.5);
+			Benchmark::Run("Stream Write std::vector<double> 8KB", [&values]{
+				static v4d::data::Stream stream(16384);
+				stream << values;
+				Benchmark::DoNotOptimize(stream._GetWriteBuffer_().data());
+				stream.ClearWriteBuffer();
+			}, values.size() * sizeof(double));
+		}
+
+		{
+			std::vector<BenchmarkVertex> vertices(1024, {1.0f, 2.0f, 3.0f});
+			Benchmark::Run("Stream Write std::vector<BenchmarkVertex> 12KB", [&vertices]{
+				static v4d::data::Stream stream(16384);
+				stream << vertices;
+				Benchmark::DoNotOptimize(stream._GetWriteBuffer_().data());
+				stream.ClearWriteBuffer();
+			}, vertices.size() * sizeof(BenchmarkVertex));
+
+			v4d::data::Stream stream(16384);
+			stream << vertices;
+			const std::vector<byte> data = stream.GetData();
+			Benchmark::Run("ReadOnlyStream Read std::vector<BenchmarkVertex> 12KB", [&data]{
+				v4d::data::ReadOnlyStream stream(data);
+				auto values = stream.Read<std::vector, BenchmarkVertex>();
+				Benchmark::DoNotOptimize(values.data());
+			}, data.size());
+		}
+
+		{
+			v4d::data::Stream stream(8192);
+			for (int i = 0; i < 1000; ++i) stream << i;
+			const std::vector<byte> data = stream.GetData();
+			// Includes the construction of the ReadOnlyStream, which copies the data
+			Benchmark::Run("ReadOnlyStream Read 1000 int", [&data]{
+				v4d::data::ReadOnlyStream stream(data);
+				int sum = 0;
+				for (int i = 0; i < 1000; ++i) sum += stream.Read<int>();
+				Benchmark::DoNotOptimize(sum);
+			}, data.size());
+		}
+
+		{
+			v4d::data::Stream stream(16384);
+			stream << std::vector<double>(1024, 1.5);
+			const std::vector<byte> data = stream.GetData();
+			Benchmark::Run("ReadOnlyStream Read std::vector<double> 8KB", [&data]{
+				v4d::data::ReadOnlyStream stream(data);
+				auto values = stream.Read<std::vector, double>();
+				Benchmark::DoNotOptimize(values.data());
+			}, data.size());
+		}
+
+		{// Copying vs zero-copy reads of a 64KB snapshot made of strings
+			v4d::data::Stream stream(65536 + 4096);
+			for (int i = 0; i < 1024; ++i) stream << std::string(63, char('a' + i % 26));
+			const std::vector<byte> data = stream.GetData();
+			Benchmark::Run("ReadOnlyStream Read 1024 std::string (copy)", [&data]{
+				v4d::data::ReadOnlyStream stream(data);
+				size_t total = 0;
+				for (int i = 0; i < 1024; ++i) total += stream.Read<std::string>().size();
+				Benchmark::DoNotOptimize(total);
+			}, data.size());
+			Benchmark::Run("ReadOnlyStream Read 1024 std::string_view (wrap)", [&data]{
+				auto stream = v4d::data::ReadOnlyStream::Wrap(data.data(), data.size());
+				size_t total = 0;
+				for (int i = 0; i < 1024; ++i) total += stream.ReadStringView().size();
+				Benchmark::DoNotOptimize(total);
+			}, data.size());
+		}
+
+		{// Encoded size and speed of 50 entity updates, with each encoding
+			std::vector<BenchmarkEntityUpdate> updates(50);
+			for (size_t i = 0; i < updates.size(); ++i) {
+				updates[i] = {uint32_t(i * 7), int32_t(i % 5) - 2, int32_t(i % 3), -int32_t(i % 40), uint16_t(i % 4)};
+			}
+			for (auto encoding : {v4d::data::Stream::ENCODING::LEGACY, v4d::data::Stream::ENCODING::VARINT}) {
+				std::string encodingName = encoding == v4d::data::Stream::ENCODING::VARINT? "VARINT" : "LEGACY";
+				v4d::data::Stream stream(4096);
+				stream.SetEncoding(encoding);
+				WriteEntityUpdates(stream, updates);
+				const std::vector<byte> data = stream.GetData();
+				LOG("    Stream " << encodingName << " 50 entity updates: " << data.size() << " bytes")
+				stream.ClearWriteBuffer();
+
+				Benchmark::Run("Stream Write " + encodingName + " 50 entity updates", [&]{
+					WriteEntityUpdates(stream, updates);
+					Benchmark::DoNotOptimize(stream._GetWriteBuffer_().data());
+					stream.ClearWriteBuffer();
+				}, data.size());
+
+				Benchmark::Run("ReadOnlyStream Read " + encodingName + " 50 entity updates", [&]{
+					v4d::data::ReadOnlyStream readStream(data);
+					readStream.SetEncoding(encoding);
+					std::vector<BenchmarkEntityUpdate> decoded;
+					ReadEntityUpdates(readStream, decoded);
+					Benchmark::DoNotOptimize(decoded.data());
+				}, data.size());
+			}
+		}
+	}
+}
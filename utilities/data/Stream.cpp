@@ -78,16 +78,22 @@ Stream& Stream::ReadBytes(byte* data, size_t n) {
 ReadOnlyStream Stream::ReadStream() {
 	std::lock_guard lock(readMutex);
 	size_t size = ReadSize();
-	if (size > 0) {
-		byte data[size];
-		ReadBytes(data, size);
-		return ReadOnlyStream(data, size);
+	const bool valid = size <= GetReadableSize();
+	if (!valid) ReadBytes_OnError("Stream size exceeds readable data");
+	// A single named return object on every path, so that it is constructed in place (NRVO)
+	ReadOnlyStream stream(valid? size : 0);
+	if (valid && size > 0) {
+		ReadBytes(stream._GetReadBuffer_().data(), size);
 	}
-	return {};
+	return stream;
 }
 void Stream::ReadStream(ReadOnlyStream& stream) {
 	std::lock_guard lock(readMutex);
 	size_t size = ReadSize();
+	if (size > GetReadableSize()) {
+		ReadBytes_OnError("Stream size exceeds readable data");
+		return;
+	}
 	if (size > 0) {
 		stream._GetReadBuffer_().resize(size);
 		ReadBytes(stream._GetReadBuffer_().data(), size);
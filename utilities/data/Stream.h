@@ -4,6 +4,11 @@
 #include <vector>
 #include <functional>
 #include <mutex>
+#include <concepts>
+#include <type_traits>
+#include <iterator>
+#include <limits>
+#include <algorithm>
 
 #include "utilities/io/Logger.h"
 #include "utilities/crypto/Crypto.h"
@@ -12,7 +17,68 @@ namespace v4d::data {
 
 	class ReadOnlyStream;
 
+	// Integer wrapper that is always written via WriteCompact(), to be used as a STREAMABLE member for small ids and deltas
+	template<std::integral T>
+	struct Compact {
+		T value = 0;
+		Compact() = default;
+		Compact(T value) : value(value) {}
+		operator T() const {return value;}
+		Compact& operator=(T v) {value = v; return *this;}
+	};
+	template<typename T> inline constexpr bool IS_COMPACT = false;
+	template<typename T> inline constexpr bool IS_COMPACT<Compact<T>> = true;
+
+	// Types whose bytes can be written as-is with a single memcpy (trivially copyable, without padding)
+	template<typename T>
+	constexpr bool __V4D_IsTriviallyStreamable() {
+		if constexpr (!std::is_trivially_copyable_v<T> || IS_COMPACT<T>) {
+			return false;
+		} else if constexpr (requires (const T* obj) { __V4D_IsStreamablePacked(obj); }) {
+			// STREAMABLE struct, its listed members must cover the whole struct in declaration order
+			return __V4D_IsStreamablePacked(static_cast<const T*>(nullptr));
+		} else if constexpr (std::is_arithmetic_v<T> || std::is_enum_v<T> || std::has_unique_object_representations_v<T>) {
+			return true;
+		} else if constexpr (std::is_array_v<T>) {
+			return __V4D_IsTriviallyStreamable<std::remove_cv_t<std::remove_all_extents_t<T>>>();
+		} else if constexpr (requires { typename T::col_type; T::length(); }) {
+			// glm matrices
+			return sizeof(T) == size_t(T::length()) * sizeof(typename T::col_type) && __V4D_IsTriviallyStreamable<typename T::col_type>();
+		} else if constexpr (requires { typename T::value_type; T::length(); }) {
+			// glm vectors
+			return sizeof(T) == size_t(T::length()) * sizeof(typename T::value_type) && __V4D_IsTriviallyStreamable<typename T::value_type>();
+		} else if constexpr (requires { typename T::value_type; std::tuple_size<T>::value; }) {
+			// std::array
+			return sizeof(T) == std::tuple_size_v<T> * sizeof(typename T::value_type) && __V4D_IsTriviallyStreamable<typename T::value_type>();
+		} else {
+			return false;
+		}
+	}
+	template<typename T> inline constexpr bool IS_TRIVIALLY_STREAMABLE = __V4D_IsTriviallyStreamable<std::remove_cvref_t<T>>();
+
+	// Containers that store trivially streamable items contiguously (ie: std::vector but not std::vector<bool> nor std::deque)
+	template<typename C> inline constexpr bool IS_TRIVIALLY_STREAMABLE_CONTAINER = 
+		IS_TRIVIALLY_STREAMABLE<typename C::value_type> && std::contiguous_iterator<typename C::iterator>;
+
+	// Structs that define STREAMABLE(...) or STREAMABLE_VERSIONED(...)
+	template<typename T> inline constexpr bool IS_STREAMABLE_STRUCT = requires (const T* obj) { __V4D_IsStreamablePacked(obj); };
+	template<typename T> inline constexpr bool IS_STREAMABLE_VERSIONED = requires { T::__V4D_StreamableTags(); };
+	
+	/**
+	 * Structs that Write()/Read() and containers stream member-wise with their STREAMABLE operators.
+	 * Trivially copyable STREAMABLE structs are written as their raw sizeof(T) bytes instead, including padding, as they always were.
+	 */
+	template<typename T> inline constexpr bool IS_MEMBERWISE_STREAMABLE = IS_STREAMABLE_VERSIONED<T> || (IS_STREAMABLE_STRUCT<T> && !std::is_trivially_copyable_v<T>);
+
 	class V4DLIB Stream {
+	public:
+
+		// Wire format of sizes and Compact integers, must be the same on both ends (see SetEncoding)
+		enum class ENCODING : byte {
+			LEGACY = 0, // sizes on 1 or 9 bytes, all integers at full width
+			VARINT = 1, // sizes and Compact integers as LEB128 varints (zig-zag for signed integers)
+		};
+		static constexpr ENCODING LATEST_ENCODING = ENCODING::VARINT;
 
 	private: // members
 
@@ -25,6 +91,13 @@ namespace v4d::data {
 		
 		std::recursive_mutex writeMutex, readMutex;
 		
+		ENCODING encoding = ENCODING::LEGACY;
+		
+		// Schema hashes of STREAMABLE_VERSIONED structs received from the other end (see SetSchemaNegotiation)
+		bool schemaNegotiation = false;
+		std::vector<uint32_t> peerSchemaHashes {};
+		mutable std::mutex peerSchemaMutex;
+		
 	public: // optional Begin/End lambdas for safe and flexible usage when passing socket ptr to a module or function for it to send streams
 		std::function<void()> Begin = [](){};
 		std::function<void()> End = [](){};
@@ -92,6 +165,41 @@ namespace v4d::data {
 			return writeBuffer;
 		}
 
+		// Upper bound of the number of bytes that can still be read, used to reject corrupted sizes before allocating (unknown for most streams, capped for sockets)
+		virtual size_t GetReadableSize() {
+			return std::numeric_limits<size_t>::max();
+		}
+
+		// Encoding (LEGACY by default, so that peers that do not negotiate it keep working)
+		// Streams read with ReadStream() do not inherit this encoding, it must be set on them explicitly
+		void SetEncoding(ENCODING enc) {
+			std::scoped_lock lock(readMutex, writeMutex);
+			encoding = enc;
+		}
+		ENCODING GetEncoding() const {
+			return encoding;
+		}
+		
+		/**
+		 * Disabled by default, only for streams whose reads and writes are with the same peer (ie: sockets)
+		 * Once a STREAMABLE_VERSIONED struct has been received with the same schema as ours, the ones we send afterwards skip their field table
+		 */
+		void SetSchemaNegotiation(bool enable) {
+			std::lock_guard lock(peerSchemaMutex);
+			schemaNegotiation = enable;
+			if (!enable) peerSchemaHashes.clear();
+		}
+		void AddPeerSchema(uint32_t schemaHash) {
+			std::lock_guard lock(peerSchemaMutex);
+			if (schemaNegotiation && std::find(peerSchemaHashes.begin(), peerSchemaHashes.end(), schemaHash) == peerSchemaHashes.end()) {
+				peerSchemaHashes.push_back(schemaHash);
+			}
+		}
+		bool HasPeerSchema(uint32_t schemaHash) const {
+			std::lock_guard lock(peerSchemaMutex);
+			return std::find(peerSchemaHashes.begin(), peerSchemaHashes.end(), schemaHash) != peerSchemaHashes.end();
+		}
+
 	public: // Constructor & Destructor
 
 		Stream(size_t bufferSize = 512, bool useReadBuffer = false) : useReadBuffer(useReadBuffer), readBufferCursor(0) {
@@ -103,7 +211,7 @@ namespace v4d::data {
 			}
 		}
 		
-		Stream(const Stream& stream) : useReadBuffer(stream.useReadBuffer), readBufferCursor(0) {
+		Stream(const Stream& stream) : useReadBuffer(stream.useReadBuffer), readBufferCursor(0), encoding(stream.encoding) {
 			writeBuffer = stream.writeBuffer;
 			if (useReadBuffer) readBuffer = stream.readBuffer;
 		}
@@ -141,29 +249,26 @@ namespace v4d::data {
 
 		template<typename T>
 		Stream& Write(const T& data) {
-			if constexpr (std::is_same_v<T, std::string>) {
+			using U = std::remove_cvref_t<T>;
+			if constexpr (std::is_same_v<U, std::string>) {
 				// std::string
 				std::lock_guard lock(writeMutex);
 				WriteSize(data.size());
-				#ifdef V4D_STREAM_UNSAFE_FAST_REINTERPRET_CAST
-					return WriteBytes(reinterpret_cast<const byte*>(data.c_str()), data.size());
-				#else
-					if (data.size() > 0) {
-						byte bytes[data.size()];
-						memcpy(bytes, data.c_str(), data.size());
-						return WriteBytes(bytes, data.size());
-					} else {
-						return *this;
-					}
-				#endif
+				return WriteBytes(reinterpret_cast<const byte*>(data.data()), data.size());
+			} else if constexpr (IS_COMPACT<U>) {
+				return WriteCompact(data.value);
+			} else if constexpr (IS_MEMBERWISE_STREAMABLE<U>) {
+				return *this << static_cast<const U&>(data);
+			} else if constexpr (IS_TRIVIALLY_STREAMABLE<U>) {
+				return WriteBytes(reinterpret_cast<const byte*>(&data), sizeof(U));
 			} else {
 				// Any other type
 				#ifdef V4D_STREAM_UNSAFE_FAST_REINTERPRET_CAST
-					return WriteBytes(reinterpret_cast<const byte*>(&data), sizeof(T));
+					return WriteBytes(reinterpret_cast<const byte*>(&data), sizeof(U));
 				#else
-					byte bytes[sizeof(T)];
-					memcpy(bytes, &data, sizeof(T));
-					return WriteBytes(bytes, sizeof(T));
+					byte bytes[sizeof(U)];
+					memcpy(bytes, &data, sizeof(U));
+					return WriteBytes(bytes, sizeof(U));
 				#endif
 			}
 		}
@@ -173,22 +278,22 @@ namespace v4d::data {
 				// std::string
 				std::lock_guard lock(readMutex);
 				size_t size(ReadSize());
-				if (size <= 0) {
-					data = "";
+				if (size > GetReadableSize()) {
+					ReadBytes_OnError("Stream string size exceeds readable data");
+					data.clear();
 					return *this;
 				}
-				byte bytes[size];
-				#ifdef V4D_STREAM_UNSAFE_FAST_REINTERPRET_CAST
-					ReadBytes(bytes, size);
-					data = std::string(reinterpret_cast<char const*>(bytes), size);
-				#else
-					char chars[size + 1];
-					ReadBytes(bytes, size);
-					memcpy(chars, bytes, size);
-					chars[size] = 0;
-					data = chars;
-				#endif
+				data.resize(size);
+				if (size > 0) {
+					ReadBytes(reinterpret_cast<byte*>(data.data()), size);
+				}
 				return *this;
+			} else if constexpr (IS_COMPACT<T>) {
+				return ReadCompact(data.value);
+			} else if constexpr (IS_MEMBERWISE_STREAMABLE<T>) {
+				return *this >> data;
+			} else if constexpr (IS_TRIVIALLY_STREAMABLE<T>) {
+				return ReadBytes(reinterpret_cast<byte*>(&data), sizeof(T));
 			} else {
 				// Any other type
 				#ifdef V4D_STREAM_UNSAFE_FAST_REINTERPRET_CAST
@@ -232,10 +337,12 @@ namespace v4d::data {
 
 
 
-		// Variable-Size size (1 or 9 bytes)
+		// Variable-Size size (LEGACY: 1 or 9 bytes, VARINT: 1 to 10 bytes)
 		void WriteSize(size_t size) {
 			std::lock_guard lock(writeMutex);
-			if (size < MAXBYTE) {
+			if (encoding == ENCODING::VARINT) {
+				WriteVarUInt(size);
+			} else if (size < MAXBYTE) {
 				Write<byte>((byte)size);
 			} else {
 				Write<byte>((byte)MAXBYTE);
@@ -244,6 +351,9 @@ namespace v4d::data {
 		}
 		size_t ReadSize() {
 			std::lock_guard lock(readMutex);
+			if (encoding == ENCODING::VARINT) {
+				return ReadVarUInt();
+			}
 			size_t size = Read<byte>();
 			if (size == MAXBYTE) {
 				Read<size_t>(size);
@@ -252,30 +362,109 @@ namespace v4d::data {
 		}
 
 
+		// LEB128 varint (7 bits per byte, least significant group first, high bit set when more bytes follow), regardless of the encoding
+		void WriteVarUInt(uint64_t value) {
+			byte bytes[10];
+			size_t n = 0;
+			while (value >= 0x80) {
+				bytes[n++] = byte(value) | 0x80;
+				value >>= 7;
+			}
+			bytes[n++] = byte(value);
+			WriteBytes(bytes, n);
+		}
+		uint64_t ReadVarUInt() {
+			std::lock_guard lock(readMutex);
+			uint64_t value = 0;
+			for (int shift = 0; shift < 64; shift += 7) {
+				byte b = Read<byte>();
+				value |= uint64_t(b & 0x7f) << shift;
+				if ((b & 0x80) == 0) return value;
+			}
+			ReadBytes_OnError("Stream varint is longer than 10 bytes");
+			return value;
+		}
+		// Zig-zag maps signed integers to unsigned ones so that small negative values also take few bytes (0, -1, 1, -2... -> 0, 1, 2, 3...)
+		void WriteVarInt(int64_t value) {
+			WriteVarUInt((uint64_t(value) << 1) ^ uint64_t(value >> 63));
+		}
+		int64_t ReadVarInt() {
+			uint64_t value = ReadVarUInt();
+			return int64_t(value >> 1) ^ -int64_t(value & 1);
+		}
+
+
+		// Integers that are usually small (ids, counts, deltas...), as varints with the VARINT encoding or at full width with the LEGACY encoding
+		template<std::integral T>
+		Stream& WriteCompact(T value) {
+			std::lock_guard lock(writeMutex);
+			if (encoding == ENCODING::VARINT && sizeof(T) > 1) {
+				if constexpr (std::is_signed_v<T>) WriteVarInt(value);
+				else WriteVarUInt(value);
+				return *this;
+			}
+			return Write<T>(value);
+		}
+		template<std::integral T>
+		Stream& ReadCompact(T& value) {
+			std::lock_guard lock(readMutex);
+			if (encoding == ENCODING::VARINT && sizeof(T) > 1) {
+				if constexpr (std::is_signed_v<T>) value = T(ReadVarInt());
+				else value = T(ReadVarUInt());
+				return *this;
+			}
+			return Read<T>(value);
+		}
+		template<std::integral T>
+		T ReadCompact() {
+			T value = 0;
+			ReadCompact(value);
+			return value;
+		}
+
+
 		// Containers (vector or other containers that have the following methods: .size(), .clear(), .reserve() and .push_back())
 		template<template<typename, typename> class Container, typename T>
 		Stream& Write(const Container<T, std::allocator<T>>& data) {
 			std::lock_guard lock(writeMutex);
 			WriteSize(data.size());
-			#ifdef V4D_STREAM_UNSAFE_FAST_RW_BYTES_FOR_CONTAINERS
+			if constexpr (IS_TRIVIALLY_STREAMABLE_CONTAINER<Container<T, std::allocator<T>>>) {
 				WriteBytes(reinterpret_cast<const byte*>(data.data()), data.size() * sizeof(T));
-			#else
-				for (const T& item : data) Write<T>(item);
-			#endif
+			} else {
+				#ifdef V4D_STREAM_UNSAFE_FAST_RW_BYTES_FOR_CONTAINERS
+					WriteBytes(reinterpret_cast<const byte*>(data.data()), data.size() * sizeof(T));
+				#else
+					for (const T& item : data) Write<T>(item);
+				#endif
+			}
 			return *this;
 		}
 		template<template<typename, typename> class Container, typename T>
 		Stream& Read(Container<T, std::allocator<T>>& data) {
 			std::lock_guard lock(readMutex);
 			size_t size {ReadSize()};
-			#ifdef V4D_STREAM_UNSAFE_FAST_RW_BYTES_FOR_CONTAINERS
+			if constexpr (IS_TRIVIALLY_STREAMABLE_CONTAINER<Container<T, std::allocator<T>>>) {
+				if (size > GetReadableSize() / sizeof(T)) {
+					ReadBytes_OnError("Stream container size exceeds readable data");
+					data.clear();
+					return *this;
+				}
 				data.resize(size);
 				ReadBytes(reinterpret_cast<byte*>(data.data()), size * sizeof(T));
-			#else
-				data.clear();
-				data.reserve(size);
-				for (size_t i = 0; i < size; i++) data.push_back(Read<T>());
-			#endif
+			} else {
+				#ifdef V4D_STREAM_UNSAFE_FAST_RW_BYTES_FOR_CONTAINERS
+					data.resize(size);
+					ReadBytes(reinterpret_cast<byte*>(data.data()), size * sizeof(T));
+				#else
+					data.clear();
+					if (size > GetReadableSize()) { // each item takes at least one byte
+						ReadBytes_OnError("Stream container size exceeds readable data");
+						return *this;
+					}
+					data.reserve(size);
+					for (size_t i = 0; i < size; i++) data.push_back(Read<T>());
+				#endif
+			}
 			return *this;
 		}
 		// Return-Read with container
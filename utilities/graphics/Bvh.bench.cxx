@@ -0,0 +1,110 @@
+#include <v4d.h>
+#include "helpers/Benchmark.hpp"
+#include "utilities/graphics/Bvh.h"
+
+namespace v4d::benchmarks {
+	void Bvh() {
+		using v4d::Benchmark;
+		using namespace v4d::graphics;
+
+		// Closed sphere of radius 1 with 256 rings of 512 segments (262k triangles)
+		const uint32_t rings = 256, segments = 512;
+		std::vector<float> positions {0, 0, 1, 0, 0, -1};
+		for (uint32_t r = 1; r < rings; ++r) for (uint32_t s = 0; s < segments; ++s) {
+			float theta = float(r) / rings * 3.14159265f, phi = float(s) / segments * 6.28318531f;
+			positions.insert(positions.end(), {std::sin(theta) * std::cos(phi), std::sin(theta) * std::sin(phi), std::cos(theta)});
+		}
+		auto ringVertex = [&](uint32_t r, uint32_t s){return 2 + (r-1) * segments + s % segments;};
+		std::vector<uint32_t> indices {};
+		for (uint32_t s = 0; s < segments; ++s) {
+			indices.insert(indices.end(), {0, ringVertex(1, s), ringVertex(1, s+1)});
+			indices.insert(indices.end(), {1, ringVertex(rings-1, s+1), ringVertex(rings-1, s)});
+			for (uint32_t r = 1; r < rings-1; ++r) {
+				indices.insert(indices.end(), {ringVertex(r, s), ringVertex(r+1, s), ringVertex(r+1, s+1)});
+				indices.insert(indices.end(), {ringVertex(r, s), ringVertex(r+1, s+1), ringVertex(r, s+1)});
+			}
+		}
+		const size_t triangleCount = indices.size() / 3;
+
+		TriangleBvh sphere {};
+		sphere.Build(indices.data(), indices.size(), positions.data(), 12);
+		LOG("    Bvh sphere: " << triangleCount << " triangles, " << sphere.GetBvh().GetNodes().size() << " nodes, SAH cost " << sphere.GetBvh().GetSahCost())
+
+		Benchmark::Run("Bvh Build sphere 262k triangles", [&]{
+			TriangleBvh bvh {};
+			bvh.Build(indices.data(), indices.size(), positions.data(), 12);
+			Benchmark::DoNotOptimize(bvh.GetTriangleCount());
+		}, double(triangleCount * sizeof(Aabb)));
+
+		Benchmark::Run("Bvh Refit sphere 262k triangles", [&]{
+			sphere.Refit(positions.data(), 12);
+			Benchmark::DoNotOptimize(sphere.GetBounds());
+		}, double(triangleCount * sizeof(Aabb)));
+
+		// Primary rays from a camera looking at the sphere, most of them hit
+		const int resolution = 256;
+		std::vector<BvhRay> rays(resolution * resolution);
+		for (int y = 0; y < resolution; ++y) for (int x = 0; x < resolution; ++x) {
+			BvhRay& ray = rays[y * resolution + x];
+			ray.origin = glm::vec3(0.3f, -0.2f, 3);
+			ray.direction = glm::vec3((float(x) / resolution - 0.5f) * 0.8f, (float(y) / resolution - 0.5f) * 0.8f, -1);
+		}
+		auto logRaysPerSecond = [&](const Benchmark::Result* result){
+			if (result) LOG("    " << result->name << ": " << (double(rays.size()) / result->nsPerOp * 1000.0) << " Mrays/s")
+		};
+		logRaysPerSecond(Benchmark::Run("Bvh Raycast sphere 64k primary rays", [&]{
+			BvhHit hit;
+			uint32_t hits = 0;
+			for (const auto& ray : rays) hits += sphere.Raycast(ray, hit);
+			Benchmark::DoNotOptimize(hits);
+		}));
+		logRaysPerSecond(Benchmark::Run("Bvh Occluded sphere 64k primary rays", [&]{
+			uint32_t hits = 0;
+			for (const auto& ray : rays) hits += sphere.Occluded(ray);
+			Benchmark::DoNotOptimize(hits);
+		}));
+
+		// City of 100k boxes on a grid, as instances for visibility and physics queries
+		const int citySize = 316;
+		std::vector<Aabb> buildings {};
+		for (int z = 0; z < citySize; ++z) for (int x = 0; x < citySize; ++x) {
+			float height = float((x * 7 + z * 13) % 17 + 1);
+			buildings.push_back({glm::vec3(x * 10.0f, 0, z * 10.0f), glm::vec3(x * 10.0f + 6, height, z * 10.0f + 6)});
+		}
+		v4d::graphics::Bvh city {};
+		city.Build(buildings.data(), buildings.size());
+		LOG("    Bvh city: " << buildings.size() << " boxes, " << city.GetNodes().size() << " nodes, SAH cost " << city.GetSahCost())
+
+		Benchmark::Run("Bvh Build city 100k boxes", [&]{
+			v4d::graphics::Bvh bvh {};
+			bvh.Build(buildings.data(), buildings.size());
+			Benchmark::DoNotOptimize(bvh.GetNodes().size());
+		}, double(buildings.size() * sizeof(Aabb)));
+
+		// View frustum of 90 degrees looking along the grid diagonal, far plane at 500
+		BvhFrustum frustum {};
+		const glm::vec3 eye(100, 10, 100), forward = glm::normalize(glm::vec3(1, 0, 1)), right = glm::normalize(glm::vec3(1, 0, -1)), up(0, 1, 0);
+		const glm::vec3 normals[6] {forward, -forward, glm::normalize(forward + right), glm::normalize(forward - right), glm::normalize(forward + up), glm::normalize(forward - up)};
+		for (int p = 0; p < 6; ++p) frustum.planes[p] = glm::vec4(normals[p], -glm::dot(normals[p], eye));
+		frustum.planes[1].w += 500;
+		std::vector<uint32_t> visible {};
+		city.QueryFrustum(frustum, visible);
+		LOG("    Bvh city frustum: " << visible.size() << " visible boxes")
+		Benchmark::Run("Bvh QueryFrustum city 100k boxes", [&]{
+			visible.clear();
+			city.QueryFrustum(frustum, visible);
+			Benchmark::DoNotOptimize(visible.size());
+		});
+
+		// Broad phase of a thousand small moving objects
+		std::vector<uint32_t> overlaps {};
+		Benchmark::Run("Bvh QueryAabb city 1000 boxes", [&]{
+			overlaps.clear();
+			for (int i = 0; i < 1000; ++i) {
+				glm::vec3 p(float(i * 37 % citySize) * 10.0f + 5, float(i % 10), float(i * 91 % citySize) * 10.0f + 5);
+				city.QueryAabb({p - glm::vec3(2), p + glm::vec3(2)}, overlaps);
+			}
+			Benchmark::DoNotOptimize(overlaps.size());
+		});
+	}
+}
@@ -0,0 +1,351 @@
+#include "Bvh.h"
+#include <algorithm>
+#include <numeric>
+#include "utilities/graphics/Mesh.hpp"
+#include "utilities/graphics/vulkan/raytracing/AccelerationStructure.h"
+
+namespace v4d::graphics {
+
+	void Bvh::Build(const Aabb* bounds, size_t count) {
+		Clear();
+		if (count == 0) return;
+		primitives.resize(count);
+		std::iota(primitives.begin(), primitives.end(), 0u);
+		std::vector<glm::vec3> centers(count);
+		for (size_t i = 0; i < count; ++i) centers[i] = bounds[i].Center();
+
+		nodes.reserve(count * 2 - 1);
+		nodes.emplace_back();
+		struct Task {
+			uint32_t node;
+			uint32_t begin;
+			uint32_t end;
+			uint32_t depth;
+		};
+		std::vector<Task> tasks {{0, 0, uint32_t(count), 0}};
+		struct Bin {
+			Aabb bounds {};
+			uint32_t count = 0;
+		};
+		Bin bins[V4D_BVH_BINS];
+		float leftAreas[V4D_BVH_BINS];
+		uint32_t leftCounts[V4D_BVH_BINS];
+
+		while (!tasks.empty()) {
+			const Task task = tasks.back();
+			tasks.pop_back();
+			const uint32_t primitiveCount = task.end - task.begin;
+			Aabb nodeBounds {}, centerBounds {};
+			for (uint32_t i = task.begin; i < task.end; ++i) {
+				nodeBounds.Grow(bounds[primitives[i]]);
+				centerBounds.Grow(centers[primitives[i]]);
+			}
+			nodes[task.node].bounds = nodeBounds;
+			nodes[task.node].first = task.begin;
+			nodes[task.node].count = primitiveCount;
+			if (primitiveCount == 1 || task.depth >= V4D_BVH_MAX_DEPTH - 1) continue;
+
+			// Binned SAH, split between bins of primitive centers along the axis with the lowest cost
+			// Small nodes use fewer bins, evaluating all of them would cost more than binning their few primitives
+			const uint32_t binCount = std::min(uint32_t(V4D_BVH_BINS), primitiveCount);
+			const float area = nodeBounds.SurfaceArea();
+			const float inverseArea = area > 0? 1.0f / area : 0.0f;
+			float bestCost = FLT_MAX;
+			int bestAxis = -1;
+			uint32_t bestSplit = 0;
+			for (int axis = 0; axis < 3; ++axis) {
+				const float extent = centerBounds.max[axis] - centerBounds.min[axis];
+				if (extent <= 0) continue;
+				const float binScale = float(binCount) / extent;
+				for (uint32_t b = 0; b < binCount; ++b) bins[b] = {};
+				for (uint32_t i = task.begin; i < task.end; ++i) {
+					const uint32_t primitive = primitives[i];
+					const uint32_t b = std::min(binCount - 1, uint32_t((centers[primitive][axis] - centerBounds.min[axis]) * binScale));
+					bins[b].count++;
+					bins[b].bounds.Grow(bounds[primitive]);
+				}
+				Aabb accumulated {};
+				uint32_t accumulatedCount = 0;
+				for (uint32_t b = 0; b < binCount - 1; ++b) {
+					accumulated.Grow(bins[b].bounds);
+					accumulatedCount += bins[b].count;
+					leftAreas[b] = accumulated.SurfaceArea();
+					leftCounts[b] = accumulatedCount;
+				}
+				accumulated = {};
+				accumulatedCount = 0;
+				for (uint32_t b = binCount - 1; b > 0; --b) {
+					accumulated.Grow(bins[b].bounds);
+					accumulatedCount += bins[b].count;
+					if (leftCounts[b-1] == 0 || accumulatedCount == 0) continue;
+					const float cost = V4D_BVH_TRAVERSAL_COST + (leftAreas[b-1] * float(leftCounts[b-1]) + accumulated.SurfaceArea() * float(accumulatedCount)) * inverseArea;
+					if (cost < bestCost) {
+						bestCost = cost;
+						bestAxis = axis;
+						bestSplit = b;
+					}
+				}
+			}
+
+			uint32_t middle;
+			if (bestAxis < 0) {
+				// All centers are at the same position, split in the middle only if the leaf would be too large
+				if (primitiveCount <= V4D_BVH_MAX_LEAF_PRIMITIVES) continue;
+				middle = task.begin + primitiveCount / 2;
+			} else {
+				if (bestCost >= float(primitiveCount) && primitiveCount <= V4D_BVH_MAX_LEAF_PRIMITIVES) continue;
+				const float binScale = float(binCount) / (centerBounds.max[bestAxis] - centerBounds.min[bestAxis]);
+				const float minCenter = centerBounds.min[bestAxis];
+				middle = uint32_t(std::partition(primitives.begin() + task.begin, primitives.begin() + task.end, [&](uint32_t primitive){
+					return std::min(binCount - 1, uint32_t((centers[primitive][bestAxis] - minCenter) * binScale)) < bestSplit;
+				}) - primitives.begin());
+			}
+
+			const uint32_t left = uint32_t(nodes.size());
+			nodes.emplace_back();
+			nodes.emplace_back();
+			nodes[task.node].first = left;
+			nodes[task.node].count = 0;
+			tasks.push_back({left + 1, middle, task.end, task.depth + 1});
+			tasks.push_back({left, task.begin, middle, task.depth + 1});
+		}
+
+		primitiveBounds.resize(count);
+		for (size_t i = 0; i < count; ++i) primitiveBounds[i] = bounds[primitives[i]];
+	}
+
+	void Bvh::Refit(const Aabb* bounds) {
+		// Children always come after their parent
+		for (size_t i = nodes.size(); i-- > 0;) {
+			BvhNode& node = nodes[i];
+			node.bounds = {};
+			if (node.IsLeaf()) {
+				for (uint32_t p = node.first; p < node.first + node.count; ++p) {
+					primitiveBounds[p] = bounds[primitives[p]];
+					node.bounds.Grow(primitiveBounds[p]);
+				}
+			} else {
+				node.bounds.Grow(nodes[node.first].bounds);
+				node.bounds.Grow(nodes[node.first + 1].bounds);
+			}
+		}
+	}
+
+	void Bvh::Clear() {
+		nodes.clear();
+		primitives.clear();
+		primitiveBounds.clear();
+	}
+
+	float Bvh::GetSahCost() const {
+		if (nodes.empty()) return 0;
+		const float rootArea = nodes[0].bounds.SurfaceArea();
+		if (rootArea <= 0) return float(primitives.size());
+		float cost = 0;
+		for (const auto& node : nodes) {
+			cost += node.bounds.SurfaceArea() / rootArea * (node.IsLeaf()? float(node.count) : V4D_BVH_TRAVERSAL_COST);
+		}
+		return cost;
+	}
+
+	// Returns -1 if the box is outside of a plane, clears the bits of the planes it is entirely inside of
+	static int TestFrustumPlanes(const BvhFrustum& frustum, const Aabb& bounds, uint32_t& planeMask) {
+		for (int p = 0; p < 6; ++p) {
+			if (!(planeMask & (1u << p))) continue;
+			const glm::vec4& plane = frustum.planes[p];
+			const glm::vec3 farthest(plane.x >= 0? bounds.max.x : bounds.min.x, plane.y >= 0? bounds.max.y : bounds.min.y, plane.z >= 0? bounds.max.z : bounds.min.z);
+			if (plane.x * farthest.x + plane.y * farthest.y + plane.z * farthest.z + plane.w < 0) return -1;
+			const glm::vec3 nearest(plane.x >= 0? bounds.min.x : bounds.max.x, plane.y >= 0? bounds.min.y : bounds.max.y, plane.z >= 0? bounds.min.z : bounds.max.z);
+			if (plane.x * nearest.x + plane.y * nearest.y + plane.z * nearest.z + plane.w >= 0) planeMask &= ~(1u << p);
+		}
+		return 0;
+	}
+
+	void Bvh::QueryFrustum(const BvhFrustum& frustum, std::vector<uint32_t>& result) const {
+		if (nodes.empty()) return;
+		struct {uint32_t node; uint32_t planeMask;} stack[V4D_BVH_MAX_DEPTH * 2];
+		uint32_t stackSize = 0;
+		stack[stackSize++] = {0, 0x3f};
+		while (stackSize > 0) {
+			const auto [index, parentMask] = stack[--stackSize];
+			const BvhNode& node = nodes[index];
+			// Only test the planes that the parent was not entirely inside of
+			uint32_t planeMask = parentMask;
+			if (TestFrustumPlanes(frustum, node.bounds, planeMask) < 0) continue;
+			if (planeMask == 0) {
+				// Entirely inside, the primitives of a subtree are contiguous from its leftmost to its rightmost leaf
+				uint32_t first = index, last = index;
+				while (!nodes[first].IsLeaf()) first = nodes[first].first;
+				while (!nodes[last].IsLeaf()) last = nodes[last].first + 1;
+				result.insert(result.end(), primitives.begin() + nodes[first].first, primitives.begin() + nodes[last].first + nodes[last].count);
+			} else if (node.IsLeaf()) {
+				for (uint32_t p = node.first; p < node.first + node.count; ++p) {
+					uint32_t primitiveMask = planeMask;
+					if (TestFrustumPlanes(frustum, primitiveBounds[p], primitiveMask) == 0) result.push_back(primitives[p]);
+				}
+			} else {
+				stack[stackSize++] = {node.first + 1, planeMask};
+				stack[stackSize++] = {node.first, planeMask};
+			}
+		}
+	}
+
+	void Bvh::QueryAabb(const Aabb& box, std::vector<uint32_t>& result) const {
+		if (nodes.empty() || !nodes[0].bounds.Overlaps(box)) return;
+		uint32_t stack[V4D_BVH_MAX_DEPTH * 2];
+		uint32_t stackSize = 0;
+		stack[stackSize++] = 0;
+		while (stackSize > 0) {
+			const BvhNode& node = nodes[stack[--stackSize]];
+			if (node.IsLeaf()) {
+				for (uint32_t p = node.first; p < node.first + node.count; ++p) {
+					if (primitiveBounds[p].Overlaps(box)) result.push_back(primitives[p]);
+				}
+				continue;
+			}
+			if (nodes[node.first + 1].bounds.Overlaps(box)) stack[stackSize++] = node.first + 1;
+			if (nodes[node.first].bounds.Overlaps(box)) stack[stackSize++] = node.first;
+		}
+	}
+
+	template<typename T>
+	void TriangleBvh::BuildTriangles(const T* indices, size_t indexCount, const float* positions, size_t positionStride) {
+		Clear();
+		this->indices.assign(indices, indices + indexCount - indexCount % 3);
+		std::vector<Aabb> bounds {};
+		UpdateTriangles(positions, positionStride, bounds);
+		bvh.Build(bounds.data(), bounds.size());
+		// Store triangles in leaf order
+		std::vector<Triangle> ordered(triangles.size());
+		const auto& order = bvh.GetPrimitives();
+		for (size_t i = 0; i < ordered.size(); ++i) ordered[i] = triangles[order[i]];
+		triangles.swap(ordered);
+	}
+
+	void TriangleBvh::UpdateTriangles(const float* positions, size_t positionStride, std::vector<Aabb>& bounds) {
+		const size_t count = indices.size() / 3;
+		const auto& order = bvh.GetPrimitives();
+		bounds.resize(count);
+		triangles.resize(count);
+		auto position = [&](uint32_t index){
+			const float* p = reinterpret_cast<const float*>(reinterpret_cast<const byte*>(positions) + size_t(index) * positionStride);
+			return glm::vec3(p[0], p[1], p[2]);
+		};
+		for (size_t i = 0; i < count; ++i) {
+			const uint32_t triangle = order.empty()? uint32_t(i) : order[i];
+			const glm::vec3 v0 = position(indices[triangle*3]), v1 = position(indices[triangle*3+1]), v2 = position(indices[triangle*3+2]);
+			triangles[i] = {v0, v1 - v0, v2 - v0};
+			bounds[triangle].min = glm::min(glm::min(v0, v1), v2);
+			bounds[triangle].max = glm::max(glm::max(v0, v1), v2);
+		}
+	}
+
+	void TriangleBvh::Build(const uint32_t* indices, size_t indexCount, const float* positions, size_t positionStride) {
+		BuildTriangles(indices, indexCount, positions, positionStride);
+	}
+
+	void TriangleBvh::Build(const uint16_t* indices, size_t indexCount, const float* positions, size_t positionStride) {
+		BuildTriangles(indices, indexCount, positions, positionStride);
+	}
+
+	void TriangleBvh::Refit(const float* positions, size_t positionStride) {
+		std::vector<Aabb> bounds {};
+		UpdateTriangles(positions, positionStride, bounds);
+		bvh.Refit(bounds.data());
+	}
+
+	void TriangleBvh::Clear() {
+		bvh.Clear();
+		triangles.clear();
+		indices.clear();
+	}
+
+	bool TriangleBvh::Raycast(const BvhRay& ray, BvhHit& hit, bool cullBackFaces) const {
+		hit = {};
+		hit.t = ray.tMax;
+		const auto& order = bvh.GetPrimitives();
+		bvh.RaycastOrdered(ray, [&](uint32_t i, float& tMax){
+			// Möller-Trumbore, det > 0 for counter-clockwise triangles facing the ray
+			const Triangle& triangle = triangles[i];
+			const glm::vec3 p = glm::cross(ray.direction, triangle.edge2);
+			const float det = glm::dot(triangle.edge1, p);
+			if (cullBackFaces? det <= 0 : det == 0) return false;
+			const float inverseDet = 1.0f / det;
+			const glm::vec3 s = ray.origin - triangle.v0;
+			const float u = glm::dot(s, p) * inverseDet;
+			if (u < 0 || u > 1) return false;
+			const glm::vec3 q = glm::cross(s, triangle.edge1);
+			const float v = glm::dot(ray.direction, q) * inverseDet;
+			if (v < 0 || u + v > 1) return false;
+			const float t = glm::dot(triangle.edge2, q) * inverseDet;
+			if (t < ray.tMin || t >= tMax) return false;
+			tMax = t;
+			hit.primitive = order[i];
+			hit.t = t;
+			hit.barycentrics = glm::vec2(u, v);
+			return false;
+		});
+		return hit.IsHit();
+	}
+
+	bool TriangleBvh::Occluded(const BvhRay& ray) const {
+		bool occluded = false;
+		bvh.RaycastOrdered(ray, [&](uint32_t i, float& tMax){
+			const Triangle& triangle = triangles[i];
+			const glm::vec3 p = glm::cross(ray.direction, triangle.edge2);
+			const float det = glm::dot(triangle.edge1, p);
+			if (det == 0) return false;
+			const float inverseDet = 1.0f / det;
+			const glm::vec3 s = ray.origin - triangle.v0;
+			const float u = glm::dot(s, p) * inverseDet;
+			if (u < 0 || u > 1) return false;
+			const glm::vec3 q = glm::cross(s, triangle.edge1);
+			const float v = glm::dot(ray.direction, q) * inverseDet;
+			if (v < 0 || u + v > 1) return false;
+			const float t = glm::dot(triangle.edge2, q) * inverseDet;
+			occluded = t >= ray.tMin && t <= tMax;
+			return occluded;
+		});
+		return occluded;
+	}
+
+	Aabb TransformAabb(const Aabb& bounds, const glm::mat3x4& transform) {
+		if (bounds.IsEmpty()) return bounds;
+		const glm::vec3 center = bounds.Center(), extent = (bounds.max - bounds.min) * 0.5f;
+		Aabb result {};
+		for (int row = 0; row < 3; ++row) {
+			const glm::vec4& r = transform[row];
+			const float c = r.x * center.x + r.y * center.y + r.z * center.z + r.w;
+			const float e = std::abs(r.x) * extent.x + std::abs(r.y) * extent.y + std::abs(r.z) * extent.z;
+			result.min[row] = c - e;
+			result.max[row] = c + e;
+		}
+		return result;
+	}
+
+	BvhRay TransformRayToInstance(const BvhRay& ray, const glm::mat3x4& transform) {
+		// Inverse of the 3x3 part from its cofactors
+		const glm::vec3 r0(transform[0].x, transform[0].y, transform[0].z), r1(transform[1].x, transform[1].y, transform[1].z), r2(transform[2].x, transform[2].y, transform[2].z);
+		const glm::vec3 c0 = glm::cross(r1, r2), c1 = glm::cross(r2, r0), c2 = glm::cross(r0, r1);
+		const float inverseDet = 1.0f / glm::dot(r0, c0);
+		// inverse = transpose(c0, c1, c2) / det, its rows are the x, y and z components of the cofactor columns
+		auto inverse = [&](const glm::vec3& v){
+			return glm::vec3(c0.x * v.x + c1.x * v.y + c2.x * v.z, c0.y * v.x + c1.y * v.y + c2.y * v.z, c0.z * v.x + c1.z * v.y + c2.z * v.z) * inverseDet;
+		};
+		BvhRay local = ray;
+		local.origin = inverse(ray.origin - glm::vec3(transform[0].w, transform[1].w, transform[2].w));
+		local.direction = inverse(ray.direction);
+		return local;
+	}
+
+	void TriangleBvh::Build(const mesh::Geometry& geometry) {
+		const float* positions = reinterpret_cast<const float*>(geometry.vertexBufferPtr_f32vec3);
+		if (geometry.indexBufferPtr_u16) Build(geometry.indexBufferPtr_u16, geometry.indexCount, positions, sizeof(mesh::VertexPositionF32Vec3));
+		else if (geometry.indexBufferPtr_u32) Build(geometry.indexBufferPtr_u32, geometry.indexCount, positions, sizeof(mesh::VertexPositionF32Vec3));
+		else Clear();
+	}
+
+	void ComputeInstanceBounds(const vulkan::raytracing::RayTracingBLASInstance* instances, size_t count, const Aabb* localBounds, Aabb* dst) {
+		for (size_t i = 0; i < count; ++i) dst[i] = TransformAabb(localBounds[i], instances[i].transform);
+	}
+}
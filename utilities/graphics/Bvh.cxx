@@ -0,0 +1,266 @@
+#include <v4d.h>
+#include <algorithm>
+#include <cmath>
+#include "utilities/graphics/Bvh.h"
+
+namespace v4d::tests {
+	int Bvh() {
+		using namespace v4d::graphics;
+
+		uint64_t seed = 1;
+		auto random = [&seed](float min, float max){
+			seed = seed * 6364136223846793005ull + 1442695040888963407ull;
+			return min + float(seed >> 40) / float(1 << 24) * (max - min);
+		};
+
+		// Random small triangles in a 20 unit cube
+		const size_t triangleCount = 3000;
+		std::vector<float> positions {};
+		std::vector<uint32_t> indices {};
+		for (uint32_t i = 0; i < triangleCount; ++i) {
+			glm::vec3 center(random(-10, 10), random(-10, 10), random(-10, 10));
+			for (int v = 0; v < 3; ++v) {
+				positions.insert(positions.end(), {center.x + random(-0.5f, 0.5f), center.y + random(-0.5f, 0.5f), center.z + random(-0.5f, 0.5f)});
+				indices.push_back(i*3 + v);
+			}
+		}
+		std::vector<Aabb> triangleBounds(triangleCount);
+		auto vertex = [&](uint32_t triangle, int v){return glm::vec3(positions[indices[triangle*3+v]*3], positions[indices[triangle*3+v]*3+1], positions[indices[triangle*3+v]*3+2]);};
+		auto updateBounds = [&]{
+			for (uint32_t i = 0; i < triangleCount; ++i) {
+				triangleBounds[i] = {};
+				for (int v = 0; v < 3; ++v) triangleBounds[i].Grow(vertex(i, v));
+			}
+		};
+		updateBounds();
+
+		// Reference closest hit without the hierarchy
+		auto bruteForceRaycast = [&](const BvhRay& ray, BvhHit& hit){
+			hit = {};
+			for (uint32_t i = 0; i < triangleCount; ++i) {
+				glm::vec3 v0 = vertex(i, 0), e1 = vertex(i, 1) - v0, e2 = vertex(i, 2) - v0;
+				glm::vec3 p = glm::cross(ray.direction, e2);
+				float det = glm::dot(e1, p);
+				if (det == 0) continue;
+				glm::vec3 s = ray.origin - v0;
+				float u = glm::dot(s, p) / det;
+				glm::vec3 q = glm::cross(s, e1);
+				float v = glm::dot(ray.direction, q) / det;
+				float t = glm::dot(e2, q) / det;
+				if (u < 0 || v < 0 || u + v > 1 || t < ray.tMin || t > ray.tMax || t >= hit.t) continue;
+				hit.primitive = i;
+				hit.t = t;
+			}
+			return hit.IsHit();
+		};
+		auto randomRay = [&]{
+			BvhRay ray {};
+			ray.origin = glm::vec3(random(-15, 15), random(-15, 15), random(-15, 15));
+			ray.direction = glm::vec3(random(-1, 1), random(-1, 1), random(-1, 1));
+			return ray;
+		};
+
+		{// Test 1 (structure)
+			v4d::graphics::Bvh bvh {};
+			bvh.Build(triangleBounds.data(), triangleCount);
+			const auto& nodes = bvh.GetNodes();
+			const auto& primitives = bvh.GetPrimitives();
+			std::vector<int> seen(triangleCount, 0);
+			for (auto p : primitives) seen[p]++;
+			if (primitives.size() != triangleCount || std::count(seen.begin(), seen.end(), 1) != (int)triangleCount) {
+				LOG_ERROR("v4d::tests::Bvh ERROR 1.1 (primitives)")
+				return 1;
+			}
+			auto contains = [](const Aabb& outer, const Aabb& inner){
+				return outer.min.x <= inner.min.x && outer.min.y <= inner.min.y && outer.min.z <= inner.min.z && outer.max.x >= inner.max.x && outer.max.y >= inner.max.y && outer.max.z >= inner.max.z;
+			};
+			size_t leafPrimitives = 0;
+			for (size_t i = 0; i < nodes.size(); ++i) {
+				const auto& node = nodes[i];
+				if (node.IsLeaf()) {
+					leafPrimitives += node.count;
+					for (uint32_t p = node.first; p < node.first + node.count; ++p) {
+						if (!contains(node.bounds, triangleBounds[primitives[p]])) {
+							LOG_ERROR("v4d::tests::Bvh ERROR 1.2 (leaf " << i << ")")
+							return 1;
+						}
+					}
+				} else if (node.first <= i || node.first + 1 >= nodes.size() || !contains(node.bounds, nodes[node.first].bounds) || !contains(node.bounds, nodes[node.first + 1].bounds)) {
+					LOG_ERROR("v4d::tests::Bvh ERROR 1.3 (node " << i << ")")
+					return 1;
+				}
+			}
+			// Splitting must be much better than testing every primitive
+			if (leafPrimitives != triangleCount || bvh.GetSahCost() > triangleCount * 0.02f) {
+				LOG_ERROR("v4d::tests::Bvh ERROR 1.4 (SAH cost " << bvh.GetSahCost() << ")")
+				return 1;
+			}
+		}
+
+		{// Test 2 (rays against the brute force result)
+			TriangleBvh bvh {};
+			bvh.Build(indices.data(), indices.size(), positions.data(), 12);
+			std::vector<uint16_t> indices16(indices.begin(), indices.end());
+			TriangleBvh bvh16 {};
+			bvh16.Build(indices16.data(), indices16.size(), positions.data(), 12);
+			int hits = 0;
+			for (int i = 0; i < 1000; ++i) {
+				BvhRay ray = randomRay();
+				if (i % 4 == 0) ray.tMax = random(1, 20);
+				BvhHit expected, hit, hit16;
+				bool hasExpected = bruteForceRaycast(ray, expected);
+				bool hasHit = bvh.Raycast(ray, hit);
+				bvh16.Raycast(ray, hit16);
+				if (hasExpected != hasHit || (hasHit && (hit.primitive != expected.primitive || std::abs(hit.t - expected.t) > 1e-4f)) || hit16.primitive != hit.primitive) {
+					LOG_ERROR("v4d::tests::Bvh ERROR 2.1 (ray " << i << ": " << hit.primitive << " instead of " << expected.primitive << ")")
+					return 2;
+				}
+				if (bvh.Occluded(ray) != hasHit) {
+					LOG_ERROR("v4d::tests::Bvh ERROR 2.2 (ray " << i << ")")
+					return 2;
+				}
+				if (hasHit) {
+					++hits;
+					// Hit point from barycentrics
+					glm::vec3 v0 = vertex(hit.primitive, 0), v1 = vertex(hit.primitive, 1), v2 = vertex(hit.primitive, 2);
+					glm::vec3 point = v0 * (1 - hit.barycentrics.x - hit.barycentrics.y) + v1 * hit.barycentrics.x + v2 * hit.barycentrics.y;
+					if (glm::length(point - (ray.origin + ray.direction * hit.t)) > 1e-3f) {
+						LOG_ERROR("v4d::tests::Bvh ERROR 2.3 (ray " << i << ")")
+						return 2;
+					}
+					// Back face culling only keeps front facing triangles
+					BvhHit front;
+					if (bvh.Raycast(ray, front, true) && glm::dot(glm::cross(vertex(front.primitive, 1) - vertex(front.primitive, 0), vertex(front.primitive, 2) - vertex(front.primitive, 0)), ray.direction) >= 0) {
+						LOG_ERROR("v4d::tests::Bvh ERROR 2.4 (ray " << i << ")")
+						return 2;
+					}
+				}
+			}
+			if (hits < 100) {
+				LOG_ERROR("v4d::tests::Bvh ERROR 2.5 (only " << hits << " hits)")
+				return 2;
+			}
+
+			// Refit after moving the vertices
+			for (size_t i = 0; i < positions.size(); i += 3) {
+				positions[i] += 3.0f + positions[i+1] * 0.1f;
+				positions[i+2] *= 1.5f;
+			}
+			updateBounds();
+			bvh.Refit(positions.data(), 12);
+			for (int i = 0; i < 300; ++i) {
+				BvhRay ray = randomRay();
+				BvhHit expected, hit;
+				if (bruteForceRaycast(ray, expected) != bvh.Raycast(ray, hit) || hit.primitive != expected.primitive) {
+					LOG_ERROR("v4d::tests::Bvh ERROR 2.6 (refit ray " << i << ")")
+					return 2;
+				}
+			}
+		}
+
+		{// Test 3 (frustum and box queries)
+			v4d::graphics::Bvh bvh {};
+			bvh.Build(triangleBounds.data(), triangleCount);
+			auto overlapsFrustum = [](const BvhFrustum& frustum, const Aabb& box){
+				for (auto& plane : frustum.planes) {
+					glm::vec3 farthest(plane.x >= 0? box.max.x : box.min.x, plane.y >= 0? box.max.y : box.min.y, plane.z >= 0? box.max.z : box.min.z);
+					if (glm::dot(glm::vec3(plane.x, plane.y, plane.z), farthest) + plane.w < 0) return false;
+				}
+				return true;
+			};
+			for (int i = 0; i < 50; ++i) {
+				// Random box shaped frustum with slanted sides
+				glm::vec3 center(random(-10, 10), random(-10, 10), random(-10, 10));
+				float size = random(0.5f, 15);
+				BvhFrustum frustum {};
+				for (int axis = 0; axis < 3; ++axis) {
+					glm::vec3 n(0);
+					n[axis] = 1;
+					n[(axis+1)%3] = random(-0.3f, 0.3f);
+					frustum.planes[axis*2] = glm::vec4(n, size - glm::dot(n, center));
+					frustum.planes[axis*2+1] = glm::vec4(-n, size + glm::dot(n, center));
+				}
+				std::vector<uint32_t> result {}, expected {};
+				bvh.QueryFrustum(frustum, result);
+				for (uint32_t p = 0; p < triangleCount; ++p) if (overlapsFrustum(frustum, triangleBounds[p])) expected.push_back(p);
+				std::sort(result.begin(), result.end());
+				if (result != expected) {
+					LOG_ERROR("v4d::tests::Bvh ERROR 3.1 (frustum " << i << ": " << result.size() << " instead of " << expected.size() << ")")
+					return 3;
+				}
+				Aabb box {center - glm::vec3(size * 0.3f), center + glm::vec3(size * 0.2f)};
+				result.clear();
+				expected.clear();
+				bvh.QueryAabb(box, result);
+				for (uint32_t p = 0; p < triangleCount; ++p) if (box.Overlaps(triangleBounds[p])) expected.push_back(p);
+				std::sort(result.begin(), result.end());
+				if (result != expected) {
+					LOG_ERROR("v4d::tests::Bvh ERROR 3.2 (box " << i << ": " << result.size() << " instead of " << expected.size() << ")")
+					return 3;
+				}
+			}
+		}
+
+		{// Test 4 (degenerate inputs)
+			v4d::graphics::Bvh bvh {};
+			std::vector<uint32_t> result {};
+			bvh.Build(nullptr, 0);
+			bvh.QueryAabb(Aabb{glm::vec3(-1), glm::vec3(1)}, result);
+			bool visited = false;
+			bvh.Raycast(BvhRay{}, [&](uint32_t, float&){visited = true; return false;});
+			if (!result.empty() || visited || bvh.GetNodes().size() != 0) {
+				LOG_ERROR("v4d::tests::Bvh ERROR 4.1 (empty)")
+				return 4;
+			}
+			// Many identical boxes must still be split into small leaves
+			std::vector<Aabb> same(100, Aabb{glm::vec3(1), glm::vec3(2)});
+			bvh.Build(same.data(), same.size());
+			for (auto& node : bvh.GetNodes()) {
+				if (node.count > V4D_BVH_MAX_LEAF_PRIMITIVES) {
+					LOG_ERROR("v4d::tests::Bvh ERROR 4.2 (leaf of " << node.count << ")")
+					return 4;
+				}
+			}
+			int count = 0;
+			BvhRay ray {glm::vec3(1.5f, 1.5f, -5), glm::vec3(0, 0, 1)};
+			bvh.Raycast(ray, [&](uint32_t, float&){++count; return false;});
+			if (count != 100) {
+				LOG_ERROR("v4d::tests::Bvh ERROR 4.3 (" << count << " primitives visited)")
+				return 4;
+			}
+			count = 0;
+			bvh.Raycast(ray, [&](uint32_t, float&){return ++count == 3;});
+			if (count != 3) {
+				LOG_ERROR("v4d::tests::Bvh ERROR 4.4 (traversal not stopped)")
+				return 4;
+			}
+		}
+
+		{// Test 5 (instance transforms)
+			// Row-major rotation of 90 degrees around z, scale of 2 and translation (10, 0, 5)
+			glm::mat3x4 transform(1);
+			transform[0] = glm::vec4(0, -2, 0, 10);
+			transform[1] = glm::vec4(2, 0, 0, 0);
+			transform[2] = glm::vec4(0, 0, 2, 5);
+			Aabb local {glm::vec3(0, 0, 0), glm::vec3(1, 2, 3)};
+			Aabb world = TransformAabb(local, transform);
+			if (glm::length(world.min - glm::vec3(6, 0, 5)) > 1e-5f || glm::length(world.max - glm::vec3(10, 2, 11)) > 1e-5f) {
+				LOG_ERROR("v4d::tests::Bvh ERROR 5.1 (bounds)")
+				return 5;
+			}
+			// A local triangle hit through the instance must be at the same t as in world space
+			const float triangle[] {0,0,0, 1,0,0, 0,1,0};
+			const uint32_t triangleIndices[] {0, 1, 2};
+			TriangleBvh blas {};
+			blas.Build(triangleIndices, 3, triangle, 12);
+			BvhRay ray {glm::vec3(9, 0.5f, 10), glm::vec3(0, 0, -1)};
+			BvhHit hit;
+			if (!blas.Raycast(TransformRayToInstance(ray, transform), hit) || std::abs(hit.t - 5) > 1e-5f) {
+				LOG_ERROR("v4d::tests::Bvh ERROR 5.2 (instance ray t=" << hit.t << ")")
+				return 5;
+			}
+		}
+
+		return 0;
+	}
+}
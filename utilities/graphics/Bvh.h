@@ -0,0 +1,223 @@
+/*
+ * CPU bounding volume hierarchy for picking, physics queries and visibility without a GPU
+ * Part of the Vulkan4D open-source game engine under the LGPL license - https://github.com/Vulkan4D
+ *
+ * Bvh is built over primitive bounding boxes with a binned surface area heuristic, and can be refit in place when primitives move without changing topology.
+ * TriangleBvh adds exact ray/triangle intersection for a mesh geometry, the instance helpers compute world bounds of ray tracing instances so that the same Bvh serves as a CPU top level.
+ * Nodes are stored depth-first with both children of a node next to each other, so a parent always comes before its children.
+ */
+#pragma once
+
+#include <v4d.h>
+#include <vector>
+#include <cfloat>
+
+#ifndef V4D_BVH_BINS
+	#define V4D_BVH_BINS 16 // SAH split candidates per axis
+#endif
+#ifndef V4D_BVH_MAX_LEAF_PRIMITIVES
+	#define V4D_BVH_MAX_LEAF_PRIMITIVES 8 // leaves may hold up to this many primitives when splitting does not pay off
+#endif
+#ifndef V4D_BVH_TRAVERSAL_COST
+	#define V4D_BVH_TRAVERSAL_COST 1.0f // cost of visiting a node relative to intersecting a primitive
+#endif
+#define V4D_BVH_MAX_DEPTH 64
+
+namespace v4d::graphics {
+
+	namespace mesh {struct Geometry;}
+	namespace vulkan::raytracing {struct RayTracingBLASInstance;}
+
+	struct Aabb {
+		glm::vec3 min {FLT_MAX};
+		glm::vec3 max {-FLT_MAX};
+		void Grow(const glm::vec3& p) {
+			min = glm::min(min, p);
+			max = glm::max(max, p);
+		}
+		void Grow(const Aabb& other) {
+			min = glm::min(min, other.min);
+			max = glm::max(max, other.max);
+		}
+		bool IsEmpty() const {return min.x > max.x;}
+		glm::vec3 Center() const {return (min + max) * 0.5f;}
+		float SurfaceArea() const {
+			if (IsEmpty()) return 0;
+			glm::vec3 e = max - min;
+			return 2.0f * (e.x * e.y + e.y * e.z + e.z * e.x);
+		}
+		bool Overlaps(const Aabb& other) const {
+			return min.x <= other.max.x && max.x >= other.min.x && min.y <= other.max.y && max.y >= other.min.y && min.z <= other.max.z && max.z >= other.min.z;
+		}
+	};
+
+	struct BvhNode {
+		Aabb bounds {};
+		uint32_t first = 0; // first primitive for leaves, first of the two children otherwise
+		uint32_t count = 0; // number of primitives, 0 for inner nodes
+		bool IsLeaf() const {return count > 0;}
+	};
+
+	struct BvhRay {
+		glm::vec3 origin {0};
+		glm::vec3 direction {0,0,1}; // does not need to be normalized, distances are in units of its length
+		float tMin = 0;
+		float tMax = FLT_MAX;
+	};
+
+	struct BvhHit {
+		uint32_t primitive = ~0u;
+		float t = FLT_MAX;
+		glm::vec2 barycentrics {0}; // weights of the second and third vertices of a triangle
+		bool IsHit() const {return primitive != ~0u;}
+	};
+
+	// Plane normals (xyz) point inside, a point p is inside when dot(xyz, p) + w >= 0
+	struct BvhFrustum {
+		glm::vec4 planes[6];
+	};
+
+	class V4DLIB Bvh {
+		std::vector<BvhNode> nodes {};
+		std::vector<uint32_t> primitives {}; // primitive ids in leaf order
+		std::vector<Aabb> primitiveBounds {}; // in leaf order
+
+		static bool IntersectBounds(const Aabb& bounds, const glm::vec3& origin, const glm::vec3& inverseDirection, float tMin, float tMax, float& tEntry) {
+			glm::vec3 t0 = (bounds.min - origin) * inverseDirection;
+			glm::vec3 t1 = (bounds.max - origin) * inverseDirection;
+			glm::vec3 tNear = glm::min(t0, t1), tFar = glm::max(t0, t1);
+			tEntry = std::max(std::max(tNear.x, tNear.y), std::max(tNear.z, tMin));
+			float tExit = std::min(std::min(tFar.x, tFar.y), std::min(tFar.z, tMax));
+			return tEntry <= tExit;
+		}
+
+	public:
+		// Builds the hierarchy over count primitive bounds
+		void Build(const Aabb* bounds, size_t count);
+
+		// Updates node bounds after the primitives moved, bounds must be in the same order as given to Build()
+		void Refit(const Aabb* bounds);
+
+		void Clear();
+
+		const std::vector<BvhNode>& GetNodes() const {return nodes;}
+		const std::vector<uint32_t>& GetPrimitives() const {return primitives;}
+		size_t GetPrimitiveCount() const {return primitives.size();}
+		Aabb GetBounds() const {return nodes.empty()? Aabb{} : nodes[0].bounds;}
+
+		// Sum of the expected traversal and intersection costs, relative to the root surface area
+		float GetSahCost() const;
+
+		/**
+		 * Visits the leaves hit by a ray from near to far
+		 * intersect(uint32_t i, float& tMax) is called for the primitive GetPrimitives()[i], so that per-primitive data can be stored in leaf order
+		 * It returns true to stop the traversal and may shorten tMax when it finds a closer hit
+		 */
+		template<typename IntersectFunc>
+		void RaycastOrdered(const BvhRay& ray, IntersectFunc&& intersect) const {
+			if (nodes.empty()) return;
+			const glm::vec3 inverseDirection(1.0f / ray.direction.x, 1.0f / ray.direction.y, 1.0f / ray.direction.z);
+			float tMax = ray.tMax, tEntry;
+			if (!IntersectBounds(nodes[0].bounds, ray.origin, inverseDirection, ray.tMin, tMax, tEntry)) return;
+			struct {uint32_t node; float tEntry;} stack[V4D_BVH_MAX_DEPTH];
+			uint32_t stackSize = 0;
+			uint32_t current = 0;
+			for (;;) {
+				const BvhNode& node = nodes[current];
+				if (node.IsLeaf()) {
+					for (uint32_t i = 0; i < node.count; ++i) {
+						if (intersect(node.first + i, tMax)) return;
+					}
+				} else {
+					float tLeft, tRight;
+					bool hitLeft = IntersectBounds(nodes[node.first].bounds, ray.origin, inverseDirection, ray.tMin, tMax, tLeft);
+					bool hitRight = IntersectBounds(nodes[node.first + 1].bounds, ray.origin, inverseDirection, ray.tMin, tMax, tRight);
+					if (hitLeft && hitRight) {
+						if (tRight < tLeft) {
+							stack[stackSize++] = {node.first, tLeft};
+							current = node.first + 1;
+						} else {
+							stack[stackSize++] = {node.first + 1, tRight};
+							current = node.first;
+						}
+						continue;
+					}
+					if (hitLeft || hitRight) {
+						current = hitLeft? node.first : node.first + 1;
+						continue;
+					}
+				}
+				// Pop the next node that is still closer than the closest hit
+				for (;;) {
+					if (stackSize == 0) return;
+					--stackSize;
+					if (stack[stackSize].tEntry <= tMax) break;
+				}
+				current = stack[stackSize].node;
+			}
+		}
+
+		// Same as RaycastOrdered() with intersect(uint32_t primitive, float& tMax) receiving primitive ids
+		template<typename IntersectFunc>
+		void Raycast(const BvhRay& ray, IntersectFunc&& intersect) const {
+			RaycastOrdered(ray, [&](uint32_t i, float& tMax){return intersect(primitives[i], tMax);});
+		}
+
+		// Appends the ids of the primitives whose bounds intersect the frustum or the box
+		void QueryFrustum(const BvhFrustum& frustum, std::vector<uint32_t>& result) const;
+		void QueryAabb(const Aabb& box, std::vector<uint32_t>& result) const;
+	};
+
+	class V4DLIB TriangleBvh {
+		struct Triangle {
+			glm::vec3 v0;
+			glm::vec3 edge1;
+			glm::vec3 edge2;
+		};
+		Bvh bvh {};
+		std::vector<Triangle> triangles {}; // in the bvh leaf order
+		std::vector<uint32_t> indices {}; // 3 vertex indices per triangle, in the input order
+
+		template<typename T> void BuildTriangles(const T* indices, size_t indexCount, const float* positions, size_t positionStride);
+		void UpdateTriangles(const float* positions, size_t positionStride, std::vector<Aabb>& bounds);
+
+	public:
+		/**
+		 * Builds the hierarchy of a triangle list, positions are 3 floats every positionStride bytes
+		 * Hit primitives are triangle numbers (index / 3) in the given index buffer
+		 */
+		void Build(const uint32_t* indices, size_t indexCount, const float* positions, size_t positionStride);
+		void Build(const uint16_t* indices, size_t indexCount, const float* positions, size_t positionStride);
+		void Build(const mesh::Geometry& geometry);
+
+		// Same indices, moved vertices (ie: skinned or deformed meshes)
+		void Refit(const float* positions, size_t positionStride);
+
+		void Clear();
+
+		const Bvh& GetBvh() const {return bvh;}
+		size_t GetTriangleCount() const {return triangles.size();}
+		Aabb GetBounds() const {return bvh.GetBounds();}
+
+		// Closest hit, optionally ignoring back faces (counter-clockwise triangles are front facing)
+		bool Raycast(const BvhRay& ray, BvhHit& hit, bool cullBackFaces = false) const;
+
+		// Any hit within the ray interval, for occlusion and line of sight
+		bool Occluded(const BvhRay& ray) const;
+	};
+
+	/**
+	 * World bounds of a local box transformed by a ray tracing instance transform
+	 * The transform is row-major like VkTransformMatrixKHR, transform[row] holds the rotation/scale row followed by the translation
+	 */
+	V4DLIB Aabb TransformAabb(const Aabb& bounds, const glm::mat3x4& transform);
+
+	/**
+	 * World bounds of count instances, localBounds[i] being the bounds of the bottom level structure referenced by instances[i] (ie: TriangleBvh::GetBounds())
+	 * The result can be given to Bvh::Build() to query instances without the GPU
+	 */
+	V4DLIB void ComputeInstanceBounds(const vulkan::raytracing::RayTracingBLASInstance* instances, size_t count, const Aabb* localBounds, Aabb* dst);
+
+	// Ray in the local space of an instance, with the same t values as the world space ray
+	V4DLIB BvhRay TransformRayToInstance(const BvhRay& ray, const glm::mat3x4& transform);
+}
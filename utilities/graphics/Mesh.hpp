@@ -5,6 +5,9 @@
 #include "utilities/graphics/vulkan/Loader.h"
 #include "utilities/graphics/vulkan/Device.h"
 #include "utilities/graphics/vulkan/ShaderProgram.h"
+#include "utilities/graphics/Meshlets.h"
+#include "utilities/graphics/MeshSimplifier.h"
+#include "utilities/graphics/VertexQuantization.h"
 
 namespace v4d::graphics {
 	namespace mesh {
@@ -109,9 +112,10 @@ namespace v4d::graphics {
 			std::shared_ptr<SamplerObject> albedoTexture = nullptr;
 			std::shared_ptr<SamplerObject> normalTexture = nullptr;
 			std::shared_ptr<SamplerObject> pbrTexture = nullptr;
-			uint32_t indexCount = 0;
+			uint32_t indexCount = 0; // full resolution indices (lods[0])
+			uint32_t lodIndexCount = 0; // indices of the coarser lods, stored right after the indexCount full resolution ones (0 if not generated)
 			uint32_t vertexCount = 0;
-			uint32_t firstIndex = 0;
+			uint32_t firstIndex = 0; // in the mesh's 16-bit or 32-bit indices, lods firstIndex are relative to it
 			Index16* indexBufferPtr_u16 = nullptr;
 			Index32* indexBufferPtr_u32 = nullptr;
 			VertexPositionF32Vec3* vertexBufferPtr_f32vec3 = nullptr;
@@ -126,19 +130,23 @@ namespace v4d::graphics {
 			uint32_t firstTexCoord1 = 0;
 			VertexTangentF32Vec4* tangentBufferPtr_f32vec4 = nullptr;
 			uint32_t firstTangent = 0;
+			std::vector<LodLevel> lods {}; // lods[0] is the full resolution geometry, coarser levels follow it in the same index buffer (empty if not generated)
+			Meshlets meshlets {}; // clusters of this geometry's triangles, vertices are relative to firstVertex
 		};
 	}
 	
 	struct Mesh {
 		std::vector<mesh::Geometry> geometries {};
 		uint32_t geometriesCount = 0;
-		uint32_t index16Count = 0;
-		uint32_t index32Count = 0;
+		uint32_t index16Count = 0; // indices of all geometries that use 16-bit indices, coarser lods included
+		uint32_t index32Count = 0; // indices of all geometries that use 32-bit indices, coarser lods included
 		uint32_t vertexPositionCount = 0;
 		uint32_t vertexNormalCount = 0;
 		uint32_t vertexColorCount = 0;
 		uint32_t vertexTexCoord0Count = 0;
 		uint32_t vertexTexCoord1Count = 0;
 		uint32_t vertexTangentCount = 0;
+		uint32_t meshletCount = 0;
+		std::vector<std::vector<byte>> repackedData {}; // geometry data that could not be used in place in the file buffers (interleaved, converted or triangulated)
 	};
 }
@@ -0,0 +1,36 @@
+#ifdef _ENABLE_TINYGLTF
+
+#include <v4d.h>
+#include "helpers/Benchmark.hpp"
+#include "utilities/io/FilePath.h"
+#include "utilities/graphics/MeshFile.h"
+#include "utilities/graphics/MeshFile.test.hpp"
+
+namespace v4d::benchmarks {
+	void MeshFile() {
+		using v4d::Benchmark;
+		using v4d::graphics::MeshFile;
+		using v4d::tests::MeshFile_Files::WriteGridsGlb;
+
+		// 64 meshes of 8k triangles each, reloaded for every iteration since instances are only cached while referenced
+		v4d::io::FilePath::CreateDirectory("testfiles_");
+		if (!WriteGridsGlb("testfiles_/bench_MeshFile.glb", 64, 64)) {
+			LOG_ERROR("Failed to write testfiles_/bench_MeshFile.glb")
+			return;
+		}
+
+		MeshFile::SetParallelMeshLoading(false);
+		Benchmark::Run("MeshFile load 64 meshes of 8k triangles, serial", [&]{
+			auto file = MeshFile::GetInstance("testfiles_/bench_MeshFile.glb");
+			Benchmark::DoNotOptimize(file->GetNodeCount());
+		});
+
+		MeshFile::SetParallelMeshLoading(true);
+		Benchmark::Run("MeshFile load 64 meshes of 8k triangles, one task per mesh on the loading thread pool", [&]{
+			auto file = MeshFile::GetInstance("testfiles_/bench_MeshFile.glb");
+			Benchmark::DoNotOptimize(file->GetNodeCount());
+		});
+	}
+}
+
+#endif
@@ -2,6 +2,12 @@
 
 #define TINYGLTF_IMPLEMENTATION
 #include "MeshFile.h"
+#include "utilities/processing/Profiler.h"
+#include "utilities/processing/ThreadPool.h"
+#include "utilities/graphics/VertexRepacking.h"
+#include "utilities/graphics/MeshOptimizer.h"
+#include "utilities/graphics/Meshlets.h"
+#include "utilities/graphics/MeshSimplifier.h"
 
 namespace v4d::graphics {
 
@@ -42,24 +48,11 @@ static glm::dmat4 GetLocalTransform(const tinygltf::Node& node) {
 	}
 }
 
-static glm::dmat4 GetLocalTransform(const std::vector<tinygltf::Node>& nodes, int nodeIndex) {
-	return GetLocalTransform(nodes[nodeIndex]);
-}
-
-static glm::dmat4 GetAbsoluteTransform(std::map<int/*child*/, int/*parent*/>& childParentMap, std::vector<tinygltf::Node>& nodes, int nodeIndex) {
-	if (childParentMap.contains(nodeIndex)) {
-		return GetAbsoluteTransform(childParentMap, nodes, childParentMap[nodeIndex]) * GetLocalTransform(nodes, nodeIndex);
-	} else {
-		return GetLocalTransform(nodes, nodeIndex);
-	}
-}
-
-static void FillNodeHierarchy(std::unique_ptr<mesh::Node>& root, const tinygltf::Node& node, const std::vector<tinygltf::Node>& allNodes) {
+static void FillNodeHierarchy(std::unique_ptr<mesh::Node>& root, const TransformHierarchy& transforms, int nodeIndex, const std::vector<tinygltf::Node>& allNodes) {
 	root = std::make_unique<mesh::Node>();
-	root->transform = GetLocalTransform(node);
-	for (auto& childIndex : node.children) {
-		auto& childNode = allNodes[childIndex];
-		FillNodeHierarchy(root->children[childNode.name], childNode, allNodes);
+	root->transform = transforms.GetLocalTransform(nodeIndex);
+	for (auto& childIndex : allNodes[nodeIndex].children) {
+		FillNodeHierarchy(root->children[allNodes[childIndex].name], transforms, childIndex, allNodes);
 	}
 }
 
@@ -80,16 +73,247 @@ static VkSamplerAddressMode GetVkSamplerAddressModeFromGltf(int wrap) {
 	return VK_SAMPLER_ADDRESS_MODE_REPEAT;
 }
 
+static v4d::processing::ThreadPool<>& LoadingThreadPool() {
+	// Loading tasks never wait on other loading tasks, so a shared pool cannot deadlock
+	static v4d::processing::ThreadPool<> pool;
+	static std::once_flag started;
+	std::call_once(started, []{
+		pool.RunThreads(V4D_MESHFILE_LOADING_THREADS > 0? V4D_MESHFILE_LOADING_THREADS : std::max(1u, std::thread::hardware_concurrency()));
+	});
+	return pool;
+}
+
+static std::atomic<bool> parallelMeshLoading = true;
+static std::atomic<bool> lodGeneration = bool(V4D_MESHFILE_GENERATE_LODS);
+
+// Waits for all tasks, in order, before returning false or rethrowing the first exception, since they reference the MeshFile
+static bool WaitAll(std::vector<std::future<bool>>& tasks) {
+	bool success = true;
+	std::exception_ptr exception = nullptr;
+	for (auto& task : tasks) {
+		try {
+			if (!task.get()) success = false;
+		} catch (...) {
+			if (!exception) exception = std::current_exception();
+		}
+	}
+	if (exception) std::rethrow_exception(exception);
+	return success;
+}
+
+struct DecodedImage {
+	std::vector<unsigned char> pixels {};
+	int width = 0;
+	int height = 0;
+	int bits = 8;
+	std::string error {};
+};
+
+// Same output as tinygltf's own image loader (always 4 components)
+static DecodedImage DecodeImage(const std::vector<unsigned char>& bytes) {
+	DecodedImage image {};
+	int components = 0;
+	unsigned char* data;
+	if (stbi_is_16_bit_from_memory(bytes.data(), (int)bytes.size())) {
+		data = reinterpret_cast<unsigned char*>(stbi_load_16_from_memory(bytes.data(), (int)bytes.size(), &image.width, &image.height, &components, 4));
+		image.bits = 16;
+	} else {
+		data = stbi_load_from_memory(bytes.data(), (int)bytes.size(), &image.width, &image.height, &components, 4);
+	}
+	if (!data) {
+		image.error = stbi_failure_reason()? stbi_failure_reason() : "unknown error";
+		return image;
+	}
+	image.pixels.assign(data, data + size_t(image.width) * image.height * 4 * (image.bits / 8));
+	stbi_image_free(data);
+	return image;
+}
+
+// tinygltf image loader callback, decoding runs on the loading thread pool while the rest of the file is being parsed
+static bool DeferImageDecoding(tinygltf::Image*, const int imageIndex, std::string*, std::string*, int, int, const unsigned char* bytes, int size, void* userData) {
+	auto& decodedImages = *reinterpret_cast<std::vector<std::future<DecodedImage>>*>(userData);
+	if (imageIndex < 0) return false;
+	if (decodedImages.size() <= size_t(imageIndex)) decodedImages.resize(imageIndex + 1);
+	decodedImages[imageIndex] = LoadingThreadPool().Promise([bytes = std::vector<unsigned char>(bytes, bytes + size)]{
+		V4D_PROFILE_ZONE("MeshFile decode image")
+		return DecodeImage(bytes);
+	});
+	return true;
+}
+
+// Returns false if the accessor is sparse or out of the bounds of its buffer view
+static bool GetStridedAccessor(const tinygltf::Model& model, int accessorIndex, mesh::StridedAccessor& accessor) {
+	if (accessorIndex < 0 || size_t(accessorIndex) >= model.accessors.size()) return false;
+	auto& gltfAccessor = model.accessors[accessorIndex];
+	if (gltfAccessor.sparse.isSparse || gltfAccessor.bufferView < 0) return false;
+	switch (gltfAccessor.type) {
+		case TINYGLTF_TYPE_SCALAR: case TINYGLTF_TYPE_VEC2: case TINYGLTF_TYPE_VEC3: case TINYGLTF_TYPE_VEC4: break;
+		default: return false;
+	}
+	auto& bufferView = model.bufferViews[gltfAccessor.bufferView];
+	auto& buffer = model.buffers[bufferView.buffer];
+	int stride = gltfAccessor.ByteStride(bufferView);
+	if (stride <= 0) return false;
+	accessor.count = gltfAccessor.count;
+	accessor.stride = size_t(stride);
+	accessor.componentType = mesh::ComponentType(gltfAccessor.componentType);
+	accessor.componentCount = tinygltf::GetNumComponentsInType(gltfAccessor.type);
+	accessor.normalized = gltfAccessor.normalized;
+	if (accessor.ComponentSize() == 0) return false;
+	const size_t size = accessor.count == 0? 0 : (accessor.count - 1) * accessor.stride + accessor.ElementSize();
+	if (gltfAccessor.byteOffset + size > bufferView.byteLength || bufferView.byteOffset + bufferView.byteLength > buffer.data.size()) return false;
+	accessor.data = buffer.data.data() + bufferView.byteOffset + gltfAccessor.byteOffset;
+	return true;
+}
+
+// Tightly packed 32-bit float attributes are used in place, others are repacked into the mesh
+template<typename T>
+static T* GetFloatAttribute(const mesh::StridedAccessor& vertices, Mesh& meshData, float fill = 0) {
+	constexpr int componentCount = sizeof(T) / sizeof(float);
+	if (vertices.componentType == mesh::ComponentType::FLOAT && vertices.componentCount == componentCount && vertices.IsTightlyPacked()) {
+		return reinterpret_cast<T*>(const_cast<byte*>(vertices.data));
+	}
+	auto& data = meshData.repackedData.emplace_back(vertices.count * sizeof(T));
+	if (!mesh::RepackFloats(vertices, reinterpret_cast<float*>(data.data()), componentCount, fill)) return nullptr;
+	return reinterpret_cast<T*>(data.data());
+}
+
+// Tightly packed triangle lists are used in place, others are repacked and triangulated into the mesh
+template<typename T>
+static T* GetTriangleListIndices(const mesh::StridedAccessor* indices, size_t vertexCount, mesh::PrimitiveMode mode, Mesh& meshData, uint32_t& indexCount) {
+	using namespace mesh;
+	const size_t count = indices? indices->count : vertexCount;
+	indexCount = (uint32_t)TriangleListIndexCount(mode, count);
+	if (indexCount == 0) return nullptr;
+	if (indices && mode == PrimitiveMode::TRIANGLES && indices->componentType == (sizeof(T) == 2? ComponentType::UNSIGNED_SHORT : ComponentType::UNSIGNED_INT) && indices->IsTightlyPacked()) {
+		return reinterpret_cast<T*>(const_cast<byte*>(indices->data));
+	}
+	auto& data = meshData.repackedData.emplace_back(indexCount * sizeof(T));
+	T* dst = reinterpret_cast<T*>(data.data());
+	if (!indices) {
+		Triangulate(mode, (const T*)nullptr, count, dst);
+	} else if (mode == PrimitiveMode::TRIANGLES) {
+		StridedAccessor triangles = *indices;
+		triangles.count = indexCount;
+		if (!RepackIndices(triangles, dst)) return nullptr;
+	} else {
+		std::vector<T> source(count);
+		if (!RepackIndices(*indices, source.data())) return nullptr;
+		Triangulate(mode, source.data(), count, dst);
+	}
+	return dst;
+}
+
+template<typename T>
+static bool IndicesInRange(const T* indices, size_t indexCount, size_t vertexCount) {
+	T max = 0;
+	for (size_t i = 0; i < indexCount; ++i) max = std::max(max, indices[i]);
+	return max < vertexCount;
+}
+
+static bool IsRepacked(const Mesh& meshData, const void* data) {
+	auto* ptr = reinterpret_cast<const byte*>(data);
+	for (auto& repacked : meshData.repackedData) {
+		if (ptr >= repacked.data() && ptr < repacked.data() + repacked.size()) return true;
+	}
+	return false;
+}
+
+// Vertex attributes are remapped in place if they belong to the mesh, otherwise into a copy since file buffers may be shared between geometries
+template<typename V>
+static void RemapVertexAttribute(V*& vertices, size_t vertexCount, const std::vector<uint32_t>& remap, Mesh& meshData) {
+	if (!vertices) return;
+	std::vector<byte> remapped(vertexCount * sizeof(V));
+	mesh::RemapVertices(vertices, remapped.data(), vertexCount, sizeof(V), remap);
+	if (IsRepacked(meshData, vertices)) {
+		memcpy(vertices, remapped.data(), remapped.size());
+	} else {
+		vertices = reinterpret_cast<V*>(meshData.repackedData.emplace_back(std::move(remapped)).data());
+	}
+}
+
+// Reorders triangles for the vertex cache then for overdraw, and vertices in the order they are used
+template<typename T>
+static void OptimizeGeometry(mesh::Geometry& geometry, T*& indices, Mesh& meshData) {
+	if (!IsRepacked(meshData, indices)) {
+		auto& copy = meshData.repackedData.emplace_back(geometry.indexCount * sizeof(T));
+		memcpy(copy.data(), indices, copy.size());
+		indices = reinterpret_cast<T*>(copy.data());
+	}
+	mesh::OptimizeVertexCache(indices, geometry.indexCount, geometry.vertexCount);
+	mesh::OptimizeOverdraw(indices, geometry.indexCount, reinterpret_cast<const float*>(geometry.vertexBufferPtr_f32vec3), sizeof(mesh::VertexPositionF32Vec3), geometry.vertexCount);
+	auto remap = mesh::OptimizeVertexFetch(indices, geometry.indexCount, geometry.vertexCount);
+	RemapVertexAttribute(geometry.vertexBufferPtr_f32vec3, geometry.vertexCount, remap, meshData);
+	RemapVertexAttribute(geometry.normalBufferPtr_f32vec3, geometry.vertexCount, remap, meshData);
+	RemapVertexAttribute(geometry.colorBufferPtr_f32vec4, geometry.vertexCount, remap, meshData);
+	RemapVertexAttribute(geometry.texCoord0BufferPtr_f32vec2, geometry.vertexCount, remap, meshData);
+	RemapVertexAttribute(geometry.texCoord1BufferPtr_f32vec2, geometry.vertexCount, remap, meshData);
+	RemapVertexAttribute(geometry.tangentBufferPtr_f32vec4, geometry.vertexCount, remap, meshData);
+}
+
+// Coarser levels of detail are appended to the indices in a new buffer, each reordered for the vertex cache
+template<typename T>
+static void GenerateLods(mesh::Geometry& geometry, T*& indices, Mesh& meshData) {
+	std::vector<T> lodIndices {};
+	geometry.lods = mesh::GenerateLodChain(lodIndices, indices, geometry.indexCount, reinterpret_cast<const float*>(geometry.vertexBufferPtr_f32vec3), sizeof(mesh::VertexPositionF32Vec3), geometry.vertexCount);
+	if (geometry.lods.size() <= 1) return;
+	for (size_t i = 1; i < geometry.lods.size(); ++i) {
+		mesh::OptimizeVertexCache(lodIndices.data() + geometry.lods[i].firstIndex, geometry.lods[i].indexCount, geometry.vertexCount);
+	}
+	auto& data = meshData.repackedData.emplace_back(lodIndices.size() * sizeof(T));
+	memcpy(data.data(), lodIndices.data(), data.size());
+	indices = reinterpret_cast<T*>(data.data());
+	geometry.lodIndexCount = uint32_t(lodIndices.size()) - geometry.indexCount;
+}
+
 MeshFilePtr MeshFile::GetInstance(const std::string& filePath)
 	STATIC_CLASS_INSTANCES_CPP(filePath, MeshFile, filePath)
 
+void MeshFile::SetParallelMeshLoading(bool parallel) {
+	parallelMeshLoading = parallel;
+}
+
+void MeshFile::SetLodGeneration(bool generate) {
+	lodGeneration = generate;
+}
+
 MeshFile::MeshFile(const std::string& filePath) : filePath(filePath) {
+	V4D_PROFILE_ZONE("MeshFile load")
 	LOG("Loading glTF model " << filePath)
 	using namespace tinygltf;
 	TinyGLTF loader;
 	std::string err;
 	std::string warn;
-	if (!loader.LoadBinaryFromFile(&gltfModel, &err, &warn, filePath)) {
+	bool loaded;
+	std::vector<std::future<DecodedImage>> decodedImages {};
+	loader.SetImageLoader(DeferImageDecoding, &decodedImages);
+	{
+		V4D_PROFILE_ZONE("MeshFile parse glTF")
+		loaded = loader.LoadBinaryFromFile(&gltfModel, &err, &warn, filePath);
+	}
+	
+	// Decoded images are moved into the model in image order, so that the result does not depend on scheduling
+	{
+		V4D_PROFILE_ZONE("MeshFile wait images")
+		for (size_t i = 0; i < decodedImages.size(); ++i) if (decodedImages[i].valid()) {
+			DecodedImage decoded = decodedImages[i].get();
+			if (!loaded || i >= gltfModel.images.size()) continue;
+			if (decoded.error != "") {
+				loaded = false;
+				err += "Failed to decode image " + std::to_string(i) + " '" + gltfModel.images[i].name + "': " + decoded.error + "\n";
+				continue;
+			}
+			auto& image = gltfModel.images[i];
+			image.width = decoded.width;
+			image.height = decoded.height;
+			image.component = 4;
+			image.bits = decoded.bits;
+			image.pixel_type = decoded.bits == 16? TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT : TINYGLTF_COMPONENT_TYPE_UNSIGNED_BYTE;
+			image.image = std::move(decoded.pixels);
+		}
+	}
+	
+	if (!loaded) {
 		throw std::runtime_error(err);
 	}
 	if (warn != "") LOG(warn)
@@ -102,205 +326,231 @@ bool MeshFile::Load() {
 	using namespace mesh;
 	
 	// Load textures
-	for (auto& image : gltfModel.images) {
-		textures.emplace_back(std::make_shared<TextureObject>(image.width, image.height, image.component, image.image.data(), image.image.size()));
+	{
+		V4D_PROFILE_ZONE("MeshFile textures")
+		textures.reserve(gltfModel.images.size());
+		for (auto& image : gltfModel.images) {
+			textures.emplace_back(std::make_shared<TextureObject>(image.width, image.height, image.component, image.image.data(), image.image.size()));
+		}
 	}
 	
-	// Load nodes hierarchy
-	std::map<int/*child*/, int/*parent*/> childParentMap {};
-	for (size_t i = 0; i < gltfModel.nodes.size(); ++i) {
-		for (auto& child : gltfModel.nodes[i].children) {
-			childParentMap[child] = i;
+	V4D_PROFILE_ZONE("MeshFile nodes")
+	
+	// Load nodes hierarchy, absolute transforms are computed in a single pass
+	const uint32_t nodeCount = (uint32_t)gltfModel.nodes.size();
+	std::vector<uint32_t> parents(nodeCount, TransformHierarchy::NO_PARENT);
+	std::vector<glm::dmat4> localTransforms(nodeCount);
+	size_t meshCount = 0;
+	for (uint32_t i = 0; i < nodeCount; ++i) {
+		auto& node = gltfModel.nodes[i];
+		localTransforms[i] = GetLocalTransform(node);
+		for (auto& child : node.children) {
+			ASSERT_OR_RETURN_FALSE(child >= 0 && uint32_t(child) < nodeCount);
+			parents[child] = i;
 		}
+		if (node.mesh != -1) ++meshCount;
 	}
-	for (size_t i = 0; i < gltfModel.nodes.size(); ++i) if (!childParentMap.contains(i)) {
-		auto& childNode = gltfModel.nodes[i];
-		FillNodeHierarchy(rootNode.children[childNode.name], childNode, gltfModel.nodes);
+	ASSERT_OR_RETURN_FALSE(transforms.Build(parents, localTransforms));
+	for (uint32_t i = 0; i < nodeCount; ++i) if (parents[i] == TransformHierarchy::NO_PARENT) {
+		FillNodeHierarchy(rootNode.children[gltfModel.nodes[i].name], transforms, i, gltfModel.nodes);
 	}
 	
-	// Load meshes and transforms
-	for (size_t i = 0; i < gltfModel.nodes.size(); ++i) {
+	// Load meshes, one task per mesh node, each mesh keeps the order of its primitives
+	nodeMeshes.assign(nodeCount, NO_MESH);
+	meshNodes.reserve(meshCount);
+	for (uint32_t i = 0; i < nodeCount; ++i) {
 		auto& node = gltfModel.nodes[i];
-		transforms[node.name] = GetAbsoluteTransform(childParentMap, gltfModel.nodes, i);
-		
+		nodeIds[node.name] = i;
 		if (node.mesh != -1) {
-			// LOG("Loading mesh node '" << node.name << "'")
-			
-			auto& meshData = meshes[node.name];
-			auto& geometryPrimitives = meshData.geometries;
-			
-			geometryPrimitives.reserve(gltfModel.meshes[node.mesh].primitives.size());
-			
-			for (auto& p : gltfModel.meshes[node.mesh].primitives) {
-				ASSERT_OR_RETURN_FALSE(p.mode == TINYGLTF_MODE_TRIANGLES);
-				auto* geometry = &geometryPrimitives.emplace_back();
-				
-				{// Indices
-					auto& primitiveIndices = gltfModel.accessors[p.indices];
-					auto& indexBufferView = gltfModel.bufferViews[primitiveIndices.bufferView];
-					ASSERT_OR_RETURN_FALSE(indexBufferView.byteStride == 0); // Only supports tightly packed buffers
-					ASSERT_OR_RETURN_FALSE(indexBufferView.byteLength > 0);
-					geometry->indexCount = primitiveIndices.count;
-					switch (primitiveIndices.componentType) {
-						case TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT : {
-							ASSERT_OR_RETURN_FALSE(indexBufferView.byteLength == primitiveIndices.count * sizeof(Index16));
-							geometry->indexBufferPtr_u16 = reinterpret_cast<Index16*>(&gltfModel.buffers[indexBufferView.buffer].data.data()[indexBufferView.byteOffset]);
-							geometry->firstIndex = meshData.index16Count;
-							meshData.index16Count += primitiveIndices.count;
-						break;}
-						case TINYGLTF_COMPONENT_TYPE_UNSIGNED_INT: {
-							ASSERT_OR_RETURN_FALSE(indexBufferView.byteLength == primitiveIndices.count * sizeof(Index32));
-							geometry->indexBufferPtr_u32 = reinterpret_cast<Index32*>(&gltfModel.buffers[indexBufferView.buffer].data.data()[indexBufferView.byteOffset]);
-							geometry->firstIndex = meshData.index32Count;
-							meshData.index32Count += primitiveIndices.count;
-						break;}
-						default: throw std::runtime_error("Index buffer only supports 16 or 32 bits unsigned integer components");
-					}
-					ASSERT_OR_RETURN_FALSE(geometry->indexCount > 0);
-					ASSERT_OR_RETURN_FALSE(geometry->indexBufferPtr_u16 || geometry->indexBufferPtr_u32);
+			nodeMeshes[i] = (uint32_t)meshNodes.size();
+			meshNodes.push_back(i);
+		}
+	}
+	meshes.resize(meshNodes.size());
+	if (!parallelMeshLoading) {
+		for (size_t i = 0; i < meshes.size(); ++i) {
+			V4D_PROFILE_ZONE("MeshFile mesh")
+			if (!LoadMesh(gltfModel.nodes[meshNodes[i]].mesh, meshes[i])) return false;
+		}
+		return true;
+	}
+	std::vector<std::future<bool>> meshesLoaded {};
+	meshesLoaded.reserve(meshes.size());
+	for (size_t i = 0; i < meshes.size(); ++i) {
+		meshesLoaded.push_back(LoadingThreadPool().Promise([this, i]{
+			V4D_PROFILE_ZONE("MeshFile mesh")
+			return LoadMesh(gltfModel.nodes[meshNodes[i]].mesh, meshes[i]);
+		}));
+	}
+	return WaitAll(meshesLoaded);
+}
+
+bool MeshFile::LoadMesh(int meshIndex, Mesh& meshData) {
+	using namespace mesh;
+	
+	auto& geometryPrimitives = meshData.geometries;
+	
+	geometryPrimitives.reserve(gltfModel.meshes[meshIndex].primitives.size());
+	
+	for (auto& p : gltfModel.meshes[meshIndex].primitives) {
+		const auto mode = PrimitiveMode(p.mode);
+		if (mode != PrimitiveMode::TRIANGLES && mode != PrimitiveMode::TRIANGLE_STRIP && mode != PrimitiveMode::TRIANGLE_FAN) {
+			LOG_WARN("Skipping primitive with mode " << p.mode << " in mesh '" << gltfModel.meshes[meshIndex].name << "', only triangles, strips and fans are supported")
+			continue;
+		}
+		auto* geometry = &geometryPrimitives.emplace_back();
+		
+		size_t vertexPositionCount = 0;
+		size_t vertexNormalCount = 0;
+		size_t vertexColorCount = 0;
+		size_t vertexTexCoord0Count = 0;
+		size_t vertexTexCoord1Count = 0;
+		size_t vertexTangentCount = 0;
+		
+		{// Vertex data, attributes that are not tightly packed 32-bit floats are repacked into the mesh
+			auto getVertices = [&](int accessorIndex, StridedAccessor& vertices){
+				if (!GetStridedAccessor(gltfModel, accessorIndex, vertices)) return false;
+				if (geometry->vertexCount != 0 && geometry->vertexCount != vertices.count) return false;
+				geometry->vertexCount = vertices.count;
+				return true;
+			};
+			for (auto&[name,accessorIndex] : p.attributes) {
+				StridedAccessor vertices {};
+				if (name == "POSITION") {
+					ASSERT_OR_RETURN_FALSE(getVertices(accessorIndex, vertices) && vertices.componentCount == 3);
+					geometry->vertexBufferPtr_f32vec3 = GetFloatAttribute<VertexPositionF32Vec3>(vertices, meshData);
+					ASSERT_OR_RETURN_FALSE(geometry->vertexBufferPtr_f32vec3);
+					geometry->firstVertex = meshData.vertexPositionCount;
+					meshData.vertexPositionCount += vertices.count;
+					vertexPositionCount += vertices.count;
+				}
+				else if (name == "NORMAL") {
+					ASSERT_OR_RETURN_FALSE(getVertices(accessorIndex, vertices) && vertices.componentCount == 3);
+					geometry->normalBufferPtr_f32vec3 = GetFloatAttribute<VertexNormalF32Vec3>(vertices, meshData);
+					ASSERT_OR_RETURN_FALSE(geometry->normalBufferPtr_f32vec3);
+					geometry->firstNormal = meshData.vertexNormalCount;
+					meshData.vertexNormalCount += vertices.count;
+					vertexNormalCount += vertices.count;
 				}
-				
-				size_t vertexPositionCount = 0;
-				size_t vertexNormalCount = 0;
-				size_t vertexColorCount = 0;
-				size_t vertexTexCoord0Count = 0;
-				size_t vertexTexCoord1Count = 0;
-				size_t vertexTangentCount = 0;
-				
-				{// Vertex data
-					for (auto&[name,accessorIndex] : p.attributes) {
-						if (name == "POSITION") {
-							auto& vertices = gltfModel.accessors[accessorIndex];
-							ASSERT_OR_RETURN_FALSE(geometry->vertexCount == 0 || geometry->vertexCount == vertices.count);
-							geometry->vertexCount = vertices.count;
-							auto& vertexBufferView = gltfModel.bufferViews[vertices.bufferView];
-							ASSERT_OR_RETURN_FALSE(vertices.componentType == TINYGLTF_COMPONENT_TYPE_FLOAT);
-							ASSERT_OR_RETURN_FALSE(vertexBufferView.byteStride == 0); // Only supports tightly packed buffers
-							ASSERT_OR_RETURN_FALSE(vertexBufferView.byteLength > 0);
-							ASSERT_OR_RETURN_FALSE(vertexBufferView.byteLength == vertices.count * sizeof(VertexPositionF32Vec3));
-							geometry->vertexBufferPtr_f32vec3 = reinterpret_cast<VertexPositionF32Vec3*>(&gltfModel.buffers[vertexBufferView.buffer].data.data()[vertexBufferView.byteOffset]);
-							geometry->firstVertex = meshData.vertexPositionCount;
-							meshData.vertexPositionCount += vertices.count;
-							vertexPositionCount += vertices.count;
-						}
-						else if (name == "NORMAL") {
-							auto& vertices = gltfModel.accessors[accessorIndex];
-							ASSERT_OR_RETURN_FALSE(geometry->vertexCount == 0 || geometry->vertexCount == vertices.count);
-							geometry->vertexCount = vertices.count;
-							auto& vertexBufferView = gltfModel.bufferViews[vertices.bufferView];
-							ASSERT_OR_RETURN_FALSE(vertices.componentType == TINYGLTF_COMPONENT_TYPE_FLOAT);
-							ASSERT_OR_RETURN_FALSE(vertexBufferView.byteStride == 0); // Only supports tightly packed buffers
-							ASSERT_OR_RETURN_FALSE(vertexBufferView.byteLength > 0);
-							ASSERT_OR_RETURN_FALSE(vertexBufferView.byteLength == vertices.count * sizeof(VertexNormalF32Vec3));
-							geometry->normalBufferPtr_f32vec3 = reinterpret_cast<VertexNormalF32Vec3*>(&gltfModel.buffers[vertexBufferView.buffer].data.data()[vertexBufferView.byteOffset]);
-							geometry->firstNormal = meshData.vertexNormalCount;
-							meshData.vertexNormalCount += vertices.count;
-							vertexNormalCount += vertices.count;
-						}
-						else if (name == "TANGENT") {
-							auto& vertices = gltfModel.accessors[accessorIndex];
-							ASSERT_OR_RETURN_FALSE(geometry->vertexCount == 0 || geometry->vertexCount == vertices.count);
-							geometry->vertexCount = vertices.count;
-							auto& vertexBufferView = gltfModel.bufferViews[vertices.bufferView];
-							ASSERT_OR_RETURN_FALSE(vertices.componentType == TINYGLTF_COMPONENT_TYPE_FLOAT);
-							ASSERT_OR_RETURN_FALSE(vertexBufferView.byteStride == 0); // Only supports tightly packed buffers
-							ASSERT_OR_RETURN_FALSE(vertexBufferView.byteLength > 0);
-							ASSERT_OR_RETURN_FALSE(vertexBufferView.byteLength == vertices.count * sizeof(VertexTangentF32Vec4));
-							geometry->tangentBufferPtr_f32vec4 = reinterpret_cast<VertexTangentF32Vec4*>(&gltfModel.buffers[vertexBufferView.buffer].data.data()[vertexBufferView.byteOffset]);
-							geometry->firstTangent = meshData.vertexTangentCount;
-							meshData.vertexTangentCount += vertices.count;
-							vertexTangentCount += vertices.count;
-						}
-						else if (name == "TEXCOORD_0") {
-							auto& vertices = gltfModel.accessors[accessorIndex];
-							ASSERT_OR_RETURN_FALSE(geometry->vertexCount == 0 || geometry->vertexCount == vertices.count);
-							geometry->vertexCount = vertices.count;
-							auto& vertexBufferView = gltfModel.bufferViews[vertices.bufferView];
-							ASSERT_OR_RETURN_FALSE(vertices.componentType == TINYGLTF_COMPONENT_TYPE_FLOAT);
-							ASSERT_OR_RETURN_FALSE(vertexBufferView.byteStride == 0); // Only supports tightly packed buffers
-							ASSERT_OR_RETURN_FALSE(vertexBufferView.byteLength > 0);
-							ASSERT_OR_RETURN_FALSE(vertexBufferView.byteLength == vertices.count * sizeof(VertexUvF32Vec2));
-							geometry->texCoord0BufferPtr_f32vec2 = reinterpret_cast<VertexUvF32Vec2*>(&gltfModel.buffers[vertexBufferView.buffer].data.data()[vertexBufferView.byteOffset]);
-							geometry->firstTexCoord0 = meshData.vertexTexCoord0Count;
-							meshData.vertexTexCoord0Count += vertices.count;
-							vertexTexCoord0Count += vertices.count;
-						}
-						else if (name == "TEXCOORD_1") {
-							auto& vertices = gltfModel.accessors[accessorIndex];
-							ASSERT_OR_RETURN_FALSE(geometry->vertexCount == 0 || geometry->vertexCount == vertices.count);
-							geometry->vertexCount = vertices.count;
-							auto& vertexBufferView = gltfModel.bufferViews[vertices.bufferView];
-							ASSERT_OR_RETURN_FALSE(vertices.componentType == TINYGLTF_COMPONENT_TYPE_FLOAT);
-							ASSERT_OR_RETURN_FALSE(vertexBufferView.byteStride == 0); // Only supports tightly packed buffers
-							ASSERT_OR_RETURN_FALSE(vertexBufferView.byteLength > 0);
-							ASSERT_OR_RETURN_FALSE(vertexBufferView.byteLength == vertices.count * sizeof(VertexUvF32Vec2));
-							geometry->texCoord1BufferPtr_f32vec2 = reinterpret_cast<VertexUvF32Vec2*>(&gltfModel.buffers[vertexBufferView.buffer].data.data()[vertexBufferView.byteOffset]);
-							geometry->firstTexCoord1 = meshData.vertexTexCoord1Count;
-							meshData.vertexTexCoord1Count += vertices.count;
-							vertexTexCoord1Count += vertices.count;
-						}
-						else if (name == "COLOR_0") {
-							auto& vertices = gltfModel.accessors[accessorIndex];
-							ASSERT_OR_RETURN_FALSE(geometry->vertexCount == 0 || geometry->vertexCount == vertices.count);
-							geometry->vertexCount = vertices.count;
-							auto& vertexBufferView = gltfModel.bufferViews[vertices.bufferView];
-							ASSERT_OR_RETURN_FALSE(vertexBufferView.byteStride == 0); // Only supports tightly packed buffers
-							ASSERT_OR_RETURN_FALSE(vertexBufferView.byteLength > 0);
-							switch (vertices.componentType) {
-								case TINYGLTF_COMPONENT_TYPE_FLOAT: {
-									ASSERT_OR_RETURN_FALSE(vertexBufferView.byteLength == vertices.count * sizeof(VertexColorF32Vec4));
-									geometry->colorBufferPtr_f32vec4 = reinterpret_cast<VertexColorF32Vec4*>(&gltfModel.buffers[vertexBufferView.buffer].data.data()[vertexBufferView.byteOffset]);
-									geometry->firstColor = meshData.vertexColorCount;
-									meshData.vertexColorCount += vertices.count;
-									vertexColorCount += vertices.count;
-								break;}
-								default: throw std::runtime_error("Vertex Color attributes only supports 32-bit float components");
-							}
-						}
-					}
-					ASSERT_OR_RETURN_FALSE(geometry->vertexCount > 0);
+				else if (name == "TANGENT") {
+					ASSERT_OR_RETURN_FALSE(getVertices(accessorIndex, vertices) && vertices.componentCount == 4);
+					geometry->tangentBufferPtr_f32vec4 = GetFloatAttribute<VertexTangentF32Vec4>(vertices, meshData);
+					ASSERT_OR_RETURN_FALSE(geometry->tangentBufferPtr_f32vec4);
+					geometry->firstTangent = meshData.vertexTangentCount;
+					meshData.vertexTangentCount += vertices.count;
+					vertexTangentCount += vertices.count;
 				}
-				
-				ASSERT_OR_RETURN_FALSE(vertexPositionCount > 0);
-				ASSERT_OR_RETURN_FALSE(vertexNormalCount == vertexPositionCount);
-				ASSERT_OR_RETURN_FALSE(vertexColorCount == 0 || vertexColorCount == vertexPositionCount);
-				ASSERT_OR_RETURN_FALSE(vertexTexCoord0Count == 0 || vertexTexCoord0Count == vertexPositionCount);
-				ASSERT_OR_RETURN_FALSE(vertexTexCoord1Count == 0 || vertexTexCoord1Count == vertexPositionCount);
-				ASSERT_OR_RETURN_FALSE(vertexTangentCount == 0 || vertexTangentCount == vertexPositionCount);
-				
-				if (p.material != -1) {// Material
-					tinygltf::Material material = gltfModel.materials[p.material];
-					geometry->materialName = material.name;
-					geometry->baseColor = glm::vec4(material.pbrMetallicRoughness.baseColorFactor[0], material.pbrMetallicRoughness.baseColorFactor[1], material.pbrMetallicRoughness.baseColorFactor[2], material.pbrMetallicRoughness.baseColorFactor[3]);
-					geometry->metallic = float(material.pbrMetallicRoughness.metallicFactor);
-					geometry->roughness = float(material.pbrMetallicRoughness.roughnessFactor);
-					// Normal texture
-					if (material.normalTexture.index != -1) {
-						auto& texture = gltfModel.textures[material.normalTexture.index];
-						auto& sampler = gltfModel.samplers[texture.sampler];
-						geometry->normalTexture = std::make_shared<SamplerObject>(textures[texture.source], GetVkFilterFromGltf(sampler.magFilter), GetVkFilterFromGltf(sampler.minFilter), GetVkSamplerAddressModeFromGltf(sampler.wrapS), GetVkSamplerAddressModeFromGltf(sampler.wrapT), GetVkSamplerAddressModeFromGltf(sampler.wrapR));
-						// uint8_t texCoordIndex = material.normalTexture.texCoord; // 0/1 for texCoord0/texCoord1
-					}
-					// Albedo texture
-					if (material.pbrMetallicRoughness.baseColorTexture.index != -1) {
-						auto& texture = gltfModel.textures[material.pbrMetallicRoughness.baseColorTexture.index];
-						auto& sampler = gltfModel.samplers[texture.sampler];
-						geometry->albedoTexture = std::make_shared<SamplerObject>(textures[texture.source], GetVkFilterFromGltf(sampler.magFilter), GetVkFilterFromGltf(sampler.minFilter), GetVkSamplerAddressModeFromGltf(sampler.wrapS), GetVkSamplerAddressModeFromGltf(sampler.wrapT), GetVkSamplerAddressModeFromGltf(sampler.wrapR));
-						// uint8_t texCoordIndex = material.pbrMetallicRoughness.baseColorTexture.texCoord; // 0/1 for texCoord0/texCoord1
-					}
-					// PBR texture (When exported from Blender's glTF (glb) binary exporter, we get a 3-component texture R=AO, G=Roughness, B=Metallic)
-					if (material.pbrMetallicRoughness.metallicRoughnessTexture.index != -1) {
-						auto& texture = gltfModel.textures[material.pbrMetallicRoughness.metallicRoughnessTexture.index];
-						auto& sampler = gltfModel.samplers[texture.sampler];
-						geometry->pbrTexture = std::make_shared<SamplerObject>(textures[texture.source], GetVkFilterFromGltf(sampler.magFilter), GetVkFilterFromGltf(sampler.minFilter), GetVkSamplerAddressModeFromGltf(sampler.wrapS), GetVkSamplerAddressModeFromGltf(sampler.wrapT), GetVkSamplerAddressModeFromGltf(sampler.wrapR));
-						// uint8_t texCoordIndex = material.pbrMetallicRoughness.pbrTexture.texCoord; // 0/1 for texCoord0/texCoord1
-					}
-					// material.alphaMode // OPAQUE | MASK | BLEND???
+				else if (name == "TEXCOORD_0") {
+					ASSERT_OR_RETURN_FALSE(getVertices(accessorIndex, vertices) && vertices.componentCount == 2);
+					geometry->texCoord0BufferPtr_f32vec2 = GetFloatAttribute<VertexUvF32Vec2>(vertices, meshData);
+					ASSERT_OR_RETURN_FALSE(geometry->texCoord0BufferPtr_f32vec2);
+					geometry->firstTexCoord0 = meshData.vertexTexCoord0Count;
+					meshData.vertexTexCoord0Count += vertices.count;
+					vertexTexCoord0Count += vertices.count;
 				}
-				
-				meshData.geometriesCount++;
+				else if (name == "TEXCOORD_1") {
+					ASSERT_OR_RETURN_FALSE(getVertices(accessorIndex, vertices) && vertices.componentCount == 2);
+					geometry->texCoord1BufferPtr_f32vec2 = GetFloatAttribute<VertexUvF32Vec2>(vertices, meshData);
+					ASSERT_OR_RETURN_FALSE(geometry->texCoord1BufferPtr_f32vec2);
+					geometry->firstTexCoord1 = meshData.vertexTexCoord1Count;
+					meshData.vertexTexCoord1Count += vertices.count;
+					vertexTexCoord1Count += vertices.count;
+				}
+				else if (name == "COLOR_0") {
+					// RGB colors get an alpha of 1
+					ASSERT_OR_RETURN_FALSE(getVertices(accessorIndex, vertices) && (vertices.componentCount == 3 || vertices.componentCount == 4));
+					geometry->colorBufferPtr_f32vec4 = GetFloatAttribute<VertexColorF32Vec4>(vertices, meshData, 1.0f);
+					ASSERT_OR_RETURN_FALSE(geometry->colorBufferPtr_f32vec4);
+					geometry->firstColor = meshData.vertexColorCount;
+					meshData.vertexColorCount += vertices.count;
+					vertexColorCount += vertices.count;
+				}
+			}
+			ASSERT_OR_RETURN_FALSE(geometry->vertexCount > 0);
+		}
+		
+		{// Indices, strips and fans are converted to triangle lists, non-indexed primitives get sequential indices
+			StridedAccessor indices {};
+			const bool indexed = p.indices != -1;
+			if (indexed) {
+				ASSERT_OR_RETURN_FALSE(GetStridedAccessor(gltfModel, p.indices, indices) && indices.componentCount == 1);
+			}
+			if (indexed? indices.componentType == ComponentType::UNSIGNED_INT : geometry->vertexCount > 65536) {
+				geometry->indexBufferPtr_u32 = GetTriangleListIndices<Index32>(indexed? &indices : nullptr, geometry->vertexCount, mode, meshData, geometry->indexCount);
+				ASSERT_OR_RETURN_FALSE(geometry->indexBufferPtr_u32);
+				geometry->firstIndex = meshData.index32Count;
+				meshData.index32Count += geometry->indexCount;
+			} else {
+				geometry->indexBufferPtr_u16 = GetTriangleListIndices<Index16>(indexed? &indices : nullptr, geometry->vertexCount, mode, meshData, geometry->indexCount);
+				ASSERT_OR_RETURN_FALSE(geometry->indexBufferPtr_u16);
+				geometry->firstIndex = meshData.index16Count;
+				meshData.index16Count += geometry->indexCount;
 			}
+			ASSERT_OR_RETURN_FALSE(geometry->indexCount > 0);
+			// The mesh optimizer, simplifier and meshlet builder index per-vertex arrays without checking, so a file referencing missing vertices is rejected here
+			ASSERT_OR_RETURN_FALSE(geometry->indexBufferPtr_u16? IndicesInRange(geometry->indexBufferPtr_u16, geometry->indexCount, geometry->vertexCount) : IndicesInRange(geometry->indexBufferPtr_u32, geometry->indexCount, geometry->vertexCount));
 		}
+		
+		ASSERT_OR_RETURN_FALSE(vertexPositionCount > 0);
+		ASSERT_OR_RETURN_FALSE(vertexNormalCount == vertexPositionCount);
+		ASSERT_OR_RETURN_FALSE(vertexColorCount == 0 || vertexColorCount == vertexPositionCount);
+		ASSERT_OR_RETURN_FALSE(vertexTexCoord0Count == 0 || vertexTexCoord0Count == vertexPositionCount);
+		ASSERT_OR_RETURN_FALSE(vertexTexCoord1Count == 0 || vertexTexCoord1Count == vertexPositionCount);
+		ASSERT_OR_RETURN_FALSE(vertexTangentCount == 0 || vertexTangentCount == vertexPositionCount);
+		
+		#if V4D_MESHFILE_OPTIMIZE_MESHES
+			if (geometry->indexBufferPtr_u16) OptimizeGeometry(*geometry, geometry->indexBufferPtr_u16, meshData);
+			else OptimizeGeometry(*geometry, geometry->indexBufferPtr_u32, meshData);
+		#endif
+		
+		if (lodGeneration) {
+			// Coarser lods are counted in the mesh indices so that the next geometries start after them
+			if (geometry->indexBufferPtr_u16) {
+				GenerateLods(*geometry, geometry->indexBufferPtr_u16, meshData);
+				meshData.index16Count += geometry->lodIndexCount;
+			} else {
+				GenerateLods(*geometry, geometry->indexBufferPtr_u32, meshData);
+				meshData.index32Count += geometry->lodIndexCount;
+			}
+		}
+		
+		#if V4D_MESHFILE_BUILD_MESHLETS
+			if (geometry->indexBufferPtr_u16) geometry->meshlets = mesh::BuildMeshlets(geometry->indexBufferPtr_u16, geometry->indexCount, reinterpret_cast<const float*>(geometry->vertexBufferPtr_f32vec3), sizeof(VertexPositionF32Vec3), geometry->vertexCount);
+			else geometry->meshlets = mesh::BuildMeshlets(geometry->indexBufferPtr_u32, geometry->indexCount, reinterpret_cast<const float*>(geometry->vertexBufferPtr_f32vec3), sizeof(VertexPositionF32Vec3), geometry->vertexCount);
+			meshData.meshletCount += uint32_t(geometry->meshlets.meshlets.size());
+		#endif
+		
+		if (p.material != -1) {// Material
+			tinygltf::Material material = gltfModel.materials[p.material];
+			geometry->materialName = material.name;
+			geometry->baseColor = glm::vec4(material.pbrMetallicRoughness.baseColorFactor[0], material.pbrMetallicRoughness.baseColorFactor[1], material.pbrMetallicRoughness.baseColorFactor[2], material.pbrMetallicRoughness.baseColorFactor[3]);
+			geometry->metallic = float(material.pbrMetallicRoughness.metallicFactor);
+			geometry->roughness = float(material.pbrMetallicRoughness.roughnessFactor);
+			// Normal texture
+			if (material.normalTexture.index != -1) {
+				auto& texture = gltfModel.textures[material.normalTexture.index];
+				auto& sampler = gltfModel.samplers[texture.sampler];
+				geometry->normalTexture = std::make_shared<SamplerObject>(textures[texture.source], GetVkFilterFromGltf(sampler.magFilter), GetVkFilterFromGltf(sampler.minFilter), GetVkSamplerAddressModeFromGltf(sampler.wrapS), GetVkSamplerAddressModeFromGltf(sampler.wrapT), GetVkSamplerAddressModeFromGltf(sampler.wrapR));
+				// uint8_t texCoordIndex = material.normalTexture.texCoord; // 0/1 for texCoord0/texCoord1
+			}
+			// Albedo texture
+			if (material.pbrMetallicRoughness.baseColorTexture.index != -1) {
+				auto& texture = gltfModel.textures[material.pbrMetallicRoughness.baseColorTexture.index];
+				auto& sampler = gltfModel.samplers[texture.sampler];
+				geometry->albedoTexture = std::make_shared<SamplerObject>(textures[texture.source], GetVkFilterFromGltf(sampler.magFilter), GetVkFilterFromGltf(sampler.minFilter), GetVkSamplerAddressModeFromGltf(sampler.wrapS), GetVkSamplerAddressModeFromGltf(sampler.wrapT), GetVkSamplerAddressModeFromGltf(sampler.wrapR));
+				// uint8_t texCoordIndex = material.pbrMetallicRoughness.baseColorTexture.texCoord; // 0/1 for texCoord0/texCoord1
+			}
+			// PBR texture (When exported from Blender's glTF (glb) binary exporter, we get a 3-component texture R=AO, G=Roughness, B=Metallic)
+			if (material.pbrMetallicRoughness.metallicRoughnessTexture.index != -1) {
+				auto& texture = gltfModel.textures[material.pbrMetallicRoughness.metallicRoughnessTexture.index];
+				auto& sampler = gltfModel.samplers[texture.sampler];
+				geometry->pbrTexture = std::make_shared<SamplerObject>(textures[texture.source], GetVkFilterFromGltf(sampler.magFilter), GetVkFilterFromGltf(sampler.minFilter), GetVkSamplerAddressModeFromGltf(sampler.wrapS), GetVkSamplerAddressModeFromGltf(sampler.wrapT), GetVkSamplerAddressModeFromGltf(sampler.wrapR));
+				// uint8_t texCoordIndex = material.pbrMetallicRoughness.pbrTexture.texCoord; // 0/1 for texCoord0/texCoord1
+			}
+			// material.alphaMode // OPAQUE | MASK | BLEND???
+		}
+		
+		meshData.geometriesCount++;
 	}
 	
 	return true;
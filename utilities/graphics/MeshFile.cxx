@@ -0,0 +1,135 @@
+#ifdef _ENABLE_TINYGLTF
+
+#include <v4d.h>
+#include "utilities/io/FilePath.h"
+#include "utilities/graphics/MeshFile.h"
+#include "utilities/graphics/MeshFile.test.hpp"
+
+namespace v4d::tests {
+	int MeshFile() {
+		using v4d::graphics::MeshFile;
+		using v4d::graphics::Mesh;
+		using v4d::graphics::MeshFilePtr;
+		using namespace v4d::graphics::mesh;
+		using v4d::tests::MeshFile_Files::WriteGridsGlb;
+
+		auto sameData = [](const void* a, const void* b, size_t size){
+			return (a == nullptr) == (b == nullptr) && (!a || memcmp(a, b, size) == 0);
+		};
+		auto sameGeometry = [&](const Geometry& a, const Geometry& b){
+			if (a.indexCount != b.indexCount || a.lodIndexCount != b.lodIndexCount || a.vertexCount != b.vertexCount || a.firstIndex != b.firstIndex || a.firstVertex != b.firstVertex) return false;
+			if (!sameData(a.indexBufferPtr_u16, b.indexBufferPtr_u16, (a.indexCount + a.lodIndexCount) * sizeof(Index16))) return false;
+			if (!sameData(a.indexBufferPtr_u32, b.indexBufferPtr_u32, (a.indexCount + a.lodIndexCount) * sizeof(Index32))) return false;
+			if (!sameData(a.vertexBufferPtr_f32vec3, b.vertexBufferPtr_f32vec3, a.vertexCount * sizeof(VertexPositionF32Vec3))) return false;
+			if (!sameData(a.normalBufferPtr_f32vec3, b.normalBufferPtr_f32vec3, a.vertexCount * sizeof(VertexNormalF32Vec3))) return false;
+			if (a.lods.size() != b.lods.size() || a.meshlets.meshlets.size() != b.meshlets.meshlets.size()) return false;
+			return true;
+		};
+		auto sameMesh = [&](const Mesh& a, const Mesh& b){
+			if (a.geometriesCount != b.geometriesCount || a.geometries.size() != b.geometries.size()) return false;
+			if (a.index16Count != b.index16Count || a.index32Count != b.index32Count || a.vertexPositionCount != b.vertexPositionCount || a.meshletCount != b.meshletCount) return false;
+			for (size_t i = 0; i < a.geometries.size(); ++i) if (!sameGeometry(a.geometries[i], b.geometries[i])) return false;
+			return true;
+		};
+
+		const int meshCount = 16;
+		v4d::io::FilePath::CreateDirectory("testfiles_");
+
+		{// Test 1 (meshes extracted on the loading thread pool match a serial load)
+			if (!WriteGridsGlb("testfiles_/test_MeshFile_parallel.glb", meshCount, 32) || !WriteGridsGlb("testfiles_/test_MeshFile_serial.glb", meshCount, 32)) {
+				LOG_ERROR("v4d::tests::MeshFile ERROR 1.1 (could not write test files)")
+				return 1;
+			}
+			MeshFile::SetParallelMeshLoading(false);
+			auto serial = MeshFile::GetInstance("testfiles_/test_MeshFile_serial.glb");
+			MeshFile::SetParallelMeshLoading(true);
+			auto parallel = MeshFile::GetInstance("testfiles_/test_MeshFile_parallel.glb");
+			if (serial->GetNodeCount() != size_t(meshCount) || parallel->GetNodeCount() != size_t(meshCount)) {
+				LOG_ERROR("v4d::tests::MeshFile ERROR 1.2 (node count)")
+				return 1;
+			}
+			for (int m = 0; m < meshCount; ++m) {
+				const std::string node = "node" + std::to_string(m);
+				if (!parallel->ContainsMesh(node) || !sameMesh(parallel->GetMesh(node), serial->GetMesh(node))) {
+					LOG_ERROR("v4d::tests::MeshFile ERROR 1.3 (mesh " << m << " differs from the serial load)")
+					return 1;
+				}
+				uint32_t indexCount = 0;
+				for (auto& geometry : parallel->GetMesh(node).geometries) {
+					if (geometry.firstIndex != indexCount) break;
+					indexCount += geometry.indexCount + geometry.lodIndexCount;
+				}
+				if (indexCount != parallel->GetMesh_index16Count(node) + parallel->GetMesh_index32Count(node)) {
+					LOG_ERROR("v4d::tests::MeshFile ERROR 1.4 (index counts of mesh " << m << ")")
+					return 1;
+				}
+				if (parallel->GetTransform(node) != serial->GetTransform(node)) {
+					LOG_ERROR("v4d::tests::MeshFile ERROR 1.5 (transform of node " << m << ")")
+					return 1;
+				}
+			}
+		}
+
+		{// Test 2 (an index past the last vertex fails the load instead of reaching the mesh optimizer)
+			if (!WriteGridsGlb("testfiles_/test_MeshFile_index_out_of_range.glb", 2, 4, 1)) {
+				LOG_ERROR("v4d::tests::MeshFile ERROR 2.1 (could not write test file)")
+				return 2;
+			}
+			try {
+				MeshFile::GetInstance("testfiles_/test_MeshFile_index_out_of_range.glb");
+				LOG_ERROR("v4d::tests::MeshFile ERROR 2.2 (loaded a file with an out of range index)")
+				return 2;
+			} catch (std::runtime_error&) {}
+		}
+
+		{// Test 3 (generated levels of detail are appended after the indices of their geometry, with indices in range)
+			if (!WriteGridsGlb("testfiles_/test_MeshFile_lods.glb", 4, 32)) {
+				LOG_ERROR("v4d::tests::MeshFile ERROR 3.1 (could not write test file)")
+				return 3;
+			}
+			MeshFile::SetLodGeneration(true);
+			MeshFilePtr file = nullptr;
+			try {
+				file = MeshFile::GetInstance("testfiles_/test_MeshFile_lods.glb");
+			} catch (std::runtime_error& e) {
+				MeshFile::SetLodGeneration(bool(V4D_MESHFILE_GENERATE_LODS));
+				LOG_ERROR("v4d::tests::MeshFile ERROR 3.2 (" << e.what() << ")")
+				return 3;
+			}
+			MeshFile::SetLodGeneration(bool(V4D_MESHFILE_GENERATE_LODS));
+			for (int m = 0; m < 4; ++m) {
+				const Mesh& meshData = file->GetMesh("node" + std::to_string(m));
+				uint32_t indexCount = 0;
+				for (auto& geometry : meshData.geometries) {
+					if (geometry.lods.size() < 2 || geometry.lodIndexCount == 0 || geometry.firstIndex != indexCount) {
+						LOG_ERROR("v4d::tests::MeshFile ERROR 3.3 (mesh " << m << " has " << geometry.lods.size() << " lods)")
+						return 3;
+					}
+					for (size_t i = 1; i < geometry.lods.size(); ++i) {
+						const auto& lod = geometry.lods[i];
+						if (lod.indexCount == 0 || lod.indexCount >= geometry.lods[i-1].indexCount || lod.firstIndex + lod.indexCount > geometry.indexCount + geometry.lodIndexCount) {
+							LOG_ERROR("v4d::tests::MeshFile ERROR 3.4 (lod " << i << " of mesh " << m << ")")
+							return 3;
+						}
+					}
+					for (uint32_t i = 0; i < geometry.indexCount + geometry.lodIndexCount; ++i) {
+						uint32_t index = geometry.indexBufferPtr_u16? geometry.indexBufferPtr_u16[i] : geometry.indexBufferPtr_u32[i];
+						if (index >= geometry.vertexCount) {
+							LOG_ERROR("v4d::tests::MeshFile ERROR 3.5 (index " << index << " of mesh " << m << " out of range)")
+							return 3;
+						}
+					}
+					indexCount += geometry.indexCount + geometry.lodIndexCount;
+				}
+				if (indexCount != meshData.index16Count + meshData.index32Count) {
+					LOG_ERROR("v4d::tests::MeshFile ERROR 3.6 (index counts of mesh " << m << ")")
+					return 3;
+				}
+			}
+		}
+
+		return 0;
+	}
+}
+
+#endif
@@ -15,48 +15,104 @@
 #include <v4d.h>
 #include "utilities/io/ConfigFile.h"
 #include "utilities/graphics/Mesh.hpp"
+#include "utilities/graphics/TransformHierarchy.h"
+
+#ifndef V4D_MESHFILE_LOADING_THREADS
+	#define V4D_MESHFILE_LOADING_THREADS 0 // image decoding and mesh extraction threads, shared by all MeshFiles (0 = hardware concurrency)
+#endif
+#ifndef V4D_MESHFILE_OPTIMIZE_MESHES
+	#define V4D_MESHFILE_OPTIMIZE_MESHES 1 // reorder indices and vertices of loaded geometries for vertex cache, overdraw and vertex fetch
+#endif
+#ifndef V4D_MESHFILE_GENERATE_LODS
+	#define V4D_MESHFILE_GENERATE_LODS 0 // default for MeshFile::SetLodGeneration(), append simplified levels of detail to the indices of loaded geometries (about 0.7 s per 262k-triangle mesh)
+#endif
+#ifndef V4D_MESHFILE_BUILD_MESHLETS
+	#define V4D_MESHFILE_BUILD_MESHLETS 1 // partition loaded geometries into meshlets with culling bounds
+#endif
 
 namespace v4d::graphics {
 class V4DLIB MeshFile;
 using MeshFilePtr = std::shared_ptr<MeshFile>;
 class V4DLIB MeshFile {
+public:
+	static constexpr uint32_t NO_NODE = ~0u;
+	static constexpr uint32_t NO_MESH = ~0u;
+private:
 	std::string filePath;
 	tinygltf::Model gltfModel;
 	
-	std::unordered_map<std::string, Mesh> meshes {};
-	std::unordered_map<std::string, glm::dmat4> transforms {};
+	// Nodes are identified by their glTF node index
+	TransformHierarchy transforms {};
+	std::unordered_map<std::string, uint32_t> nodeIds {};
+	std::vector<uint32_t> nodeMeshes {}; // mesh index for each node, or NO_MESH
+	std::vector<Mesh> meshes {};
+	std::vector<uint32_t> meshNodes {}; // node id for each mesh
 	std::vector<std::shared_ptr<TextureObject>> textures {};
 	mesh::Node rootNode;
 	
 	bool Load();
+	bool LoadMesh(int meshIndex, Mesh& meshData);
 	MeshFile(const std::string& filePath);
 public:
 	static MeshFilePtr GetInstance(const std::string& filePath);
 	
+	// Meshes of files loaded after this call are extracted one after the other on the loading thread (default true, one task per mesh on the loading thread pool)
+	static void SetParallelMeshLoading(bool parallel);
+	
+	// Geometries of files loaded after this call get coarser levels of detail appended to their indices (default V4D_MESHFILE_GENERATE_LODS)
+	static void SetLodGeneration(bool generate);
+	
 	std::string GetFilePath() const {return filePath;}
 	
+	// Returns NO_NODE if there is no node with that name
+	uint32_t GetNodeId(const std::string& nodeName) const {
+		auto it = nodeIds.find(nodeName);
+		return it == nodeIds.end()? NO_NODE : it->second;
+	}
+	const std::string& GetNodeName(uint32_t node) const {
+		return gltfModel.nodes[node].name;
+	}
+	size_t GetNodeCount() const {
+		return nodeMeshes.size();
+	}
+	
 	bool ContainsMesh(const std::string& key) const {
-		return meshes.contains(key);
+		uint32_t node = GetNodeId(key);
+		return node != NO_NODE && nodeMeshes[node] != NO_MESH;
 	}
 	bool ContainsTransform(const std::string& key) const {
-		return transforms.contains(key);
+		return GetNodeId(key) != NO_NODE;
 	}
 	
 	Mesh& GetMesh(const std::string& key) {
-		return meshes.at(key);
+		return meshes.at(nodeMeshes.at(nodeIds.at(key)));
 	}
 	const Mesh& GetMesh(const std::string& key) const {
-		return meshes.at(key);
+		return meshes.at(nodeMeshes.at(nodeIds.at(key)));
 	}
 	glm::dmat4 GetTransform(const std::string& key) const {
-		return transforms.at(key);
+		return transforms.GetAbsoluteTransform(nodeIds.at(key));
+	}
+	const glm::dmat4& GetTransform(uint32_t node) const {
+		return transforms.GetAbsoluteTransform(node);
 	}
 	void ForEachMesh(std::function<void(const std::string& nodeName, Mesh& mesh, const glm::dmat4& transform)> func) {
-		for (auto&[nodeName, mesh] : meshes) {
-			func(nodeName, mesh, transforms[nodeName]);
+		for (size_t i = 0; i < meshes.size(); ++i) {
+			func(GetNodeName(meshNodes[i]), meshes[i], transforms.GetAbsoluteTransform(meshNodes[i]));
 		}
 	}
 	
+	// For animated nodes, absolute transforms of the modified subtrees are recomputed by UpdateTransforms()
+	void SetNodeTransform(uint32_t node, const glm::dmat4& localTransform) {
+		transforms.SetLocalTransform(node, localTransform);
+	}
+	void UpdateTransforms() {
+		transforms.Update();
+	}
+	const TransformHierarchy& GetTransformHierarchy() const {
+		return transforms;
+	}
+	
 	const auto& GetNodeHierarchy() const {
 		return rootNode.children;
 	}
@@ -97,6 +153,10 @@ public:
 		try {return GetMesh(nodeName).vertexTangentCount;}
 		catch (...) {return 0;}
 	}
+	uint32_t GetMesh_meshletCount(const std::string& nodeName) const {
+		try {return GetMesh(nodeName).meshletCount;}
+		catch (...) {return 0;}
+	}
 };
 }
 
@@ -0,0 +1,63 @@
+/*
+ * Test files for MeshFile, shared by its tests and benchmarks
+ * Part of the Vulkan4D open-source game engine under the LGPL license - https://github.com/Vulkan4D
+ */
+#pragma once
+
+#include <v4d.h>
+#include <fstream>
+#include <cmath>
+#include <cstring>
+
+namespace v4d::tests::MeshFile_Files {
+	// Writes a glb file with one node per mesh, each mesh a wavy grid of (gridSize+1)² vertices with 16-bit indices
+	// indexOffset is added to the last index of the first mesh (0 for a valid file)
+	inline bool WriteGridsGlb(const std::string& path, int meshCount, int gridSize, uint32_t indexOffset = 0) {
+		const int vertexCount = (gridSize+1) * (gridSize+1);
+		const int indexCount = gridSize * gridSize * 6;
+		std::vector<byte> bin {};
+		std::string bufferViews = "", accessors = "", meshes = "", nodes = "", sceneNodes = "";
+		auto append = [&bin](const void* data, size_t size){
+			size_t offset = bin.size();
+			bin.resize(offset + ((size + 3) & ~size_t(3)));
+			memcpy(bin.data() + offset, data, size);
+			return offset;
+		};
+		for (int m = 0; m < meshCount; ++m) {
+			std::vector<float> positions {}, normals {};
+			for (int y = 0; y <= gridSize; ++y) for (int x = 0; x <= gridSize; ++x) {
+				positions.insert(positions.end(), {float(x), std::sin(0.3f * x + 0.7f * m) * std::cos(0.2f * y), float(y)});
+				normals.insert(normals.end(), {0, 1, 0});
+			}
+			std::vector<uint16_t> indices {};
+			for (int y = 0; y < gridSize; ++y) for (int x = 0; x < gridSize; ++x) {
+				uint16_t i = uint16_t(y * (gridSize+1) + x);
+				indices.insert(indices.end(), {i, uint16_t(i + gridSize + 1), uint16_t(i + 1), uint16_t(i + 1), uint16_t(i + gridSize + 1), uint16_t(i + gridSize + 2)});
+			}
+			if (m == 0) indices.back() += uint16_t(indexOffset);
+			const std::string sep = m? "," : "";
+			const int view = m * 3;
+			bufferViews += sep + "{\"buffer\":0,\"byteOffset\":" + std::to_string(append(positions.data(), positions.size() * 4)) + ",\"byteLength\":" + std::to_string(positions.size() * 4) + "}";
+			bufferViews += ",{\"buffer\":0,\"byteOffset\":" + std::to_string(append(normals.data(), normals.size() * 4)) + ",\"byteLength\":" + std::to_string(normals.size() * 4) + "}";
+			bufferViews += ",{\"buffer\":0,\"byteOffset\":" + std::to_string(append(indices.data(), indices.size() * 2)) + ",\"byteLength\":" + std::to_string(indices.size() * 2) + "}";
+			accessors += sep + "{\"bufferView\":" + std::to_string(view) + ",\"componentType\":5126,\"count\":" + std::to_string(vertexCount) + ",\"type\":\"VEC3\",\"min\":[0,-1,0],\"max\":[" + std::to_string(gridSize) + ",1," + std::to_string(gridSize) + "]}";
+			accessors += ",{\"bufferView\":" + std::to_string(view+1) + ",\"componentType\":5126,\"count\":" + std::to_string(vertexCount) + ",\"type\":\"VEC3\"}";
+			accessors += ",{\"bufferView\":" + std::to_string(view+2) + ",\"componentType\":5123,\"count\":" + std::to_string(indexCount) + ",\"type\":\"SCALAR\"}";
+			meshes += sep + "{\"name\":\"grid" + std::to_string(m) + "\",\"primitives\":[{\"attributes\":{\"POSITION\":" + std::to_string(view) + ",\"NORMAL\":" + std::to_string(view+1) + "},\"indices\":" + std::to_string(view+2) + "}]}";
+			nodes += sep + "{\"name\":\"node" + std::to_string(m) + "\",\"mesh\":" + std::to_string(m) + ",\"translation\":[" + std::to_string(m) + ",0,0]}";
+			sceneNodes += sep + std::to_string(m);
+		}
+		std::string json = "{\"asset\":{\"version\":\"2.0\"},\"scene\":0,\"scenes\":[{\"nodes\":[" + sceneNodes + "]}],\"nodes\":[" + nodes + "],\"meshes\":[" + meshes + "],\"accessors\":[" + accessors + "],\"bufferViews\":[" + bufferViews + "],\"buffers\":[{\"byteLength\":" + std::to_string(bin.size()) + "}]}";
+		json.resize((json.size() + 3) & ~size_t(3), ' ');
+		const uint32_t header[] {0x46546C67, 2, uint32_t(12 + 8 + json.size() + 8 + bin.size())};
+		const uint32_t jsonChunk[] {uint32_t(json.size()), 0x4E4F534A};
+		const uint32_t binChunk[] {uint32_t(bin.size()), 0x004E4942};
+		std::ofstream file(path, std::ios::binary | std::ios::trunc);
+		file.write((const char*)header, sizeof(header));
+		file.write((const char*)jsonChunk, sizeof(jsonChunk));
+		file.write(json.data(), json.size());
+		file.write((const char*)binChunk, sizeof(binChunk));
+		file.write((const char*)bin.data(), bin.size());
+		return file.good();
+	}
+}
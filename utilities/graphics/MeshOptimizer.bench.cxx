@@ -0,0 +1,63 @@
+#include <v4d.h>
+#include "helpers/Benchmark.hpp"
+#include "utilities/graphics/MeshOptimizer.h"
+
+namespace v4d::benchmarks {
+	void MeshOptimizer() {
+		using v4d::Benchmark;
+		using namespace v4d::graphics::mesh;
+
+		// Grid of 256*256 quads (131k triangles), in row order (typical authoring order) and in random order
+		const uint32_t size = 256, vertexCount = (size+1)*(size+1);
+		std::vector<float> positions {};
+		for (uint32_t y = 0; y <= size; ++y) for (uint32_t x = 0; x <= size; ++x) positions.insert(positions.end(), {float(x), float(y), 0});
+		std::vector<uint32_t> rows {};
+		for (uint32_t y = 0; y < size; ++y) for (uint32_t x = 0; x < size; ++x) {
+			uint32_t v = y*(size+1) + x;
+			rows.insert(rows.end(), {v, v+1, v+size+1, v+1, v+size+2, v+size+1});
+		}
+		std::vector<uint32_t> shuffled = rows;
+		for (size_t t = shuffled.size()/3 - 1, seed = 1; t > 0; --t) {
+			seed = seed * 6364136223846793005ull + 1442695040888963407ull;
+			size_t other = (seed >> 33) % (t + 1);
+			std::swap_ranges(&shuffled[t*3], &shuffled[t*3+3], &shuffled[other*3]);
+		}
+
+		auto logStatistics = [&](const std::string& name, const std::vector<uint32_t>& indices){
+			auto statistics = AnalyzeVertexCache(indices.data(), indices.size(), vertexCount);
+			LOG("    MeshOptimizer " << name << ": ACMR " << statistics.acmr << ", ATVR " << statistics.atvr)
+		};
+
+		for (auto&[name, input] : {std::pair<std::string, const std::vector<uint32_t>&>{"rows", rows}, {"shuffled", shuffled}}) {
+			std::vector<uint32_t> indices = input;
+			logStatistics(name + " (before)", indices);
+			OptimizeVertexCache(indices.data(), indices.size(), vertexCount);
+			logStatistics(name + " after OptimizeVertexCache", indices);
+			OptimizeOverdraw(indices.data(), indices.size(), positions.data(), 12, vertexCount);
+			logStatistics(name + " after OptimizeOverdraw", indices);
+
+			Benchmark::Run("MeshOptimizer OptimizeVertexCache 131k triangles " + name, [&]{
+				indices = input;
+				OptimizeVertexCache(indices.data(), indices.size(), vertexCount);
+				Benchmark::DoNotOptimize(indices[0]);
+			});
+		}
+
+		std::vector<uint32_t> indices = shuffled;
+		OptimizeVertexCache(indices.data(), indices.size(), vertexCount);
+		std::vector<uint32_t> optimized = indices;
+		Benchmark::Run("MeshOptimizer OptimizeOverdraw 131k triangles", [&]{
+			indices = optimized;
+			OptimizeOverdraw(indices.data(), indices.size(), positions.data(), 12, vertexCount);
+			Benchmark::DoNotOptimize(indices[0]);
+		});
+
+		std::vector<float> remapped(positions.size());
+		Benchmark::Run("MeshOptimizer OptimizeVertexFetch + RemapVertices 131k triangles", [&]{
+			indices = optimized;
+			auto remap = OptimizeVertexFetch(indices.data(), indices.size(), vertexCount);
+			RemapVertices(positions.data(), remapped.data(), vertexCount, 12, remap);
+			Benchmark::DoNotOptimize(remapped[0]);
+		});
+	}
+}
@@ -0,0 +1,241 @@
+#include "MeshOptimizer.h"
+#include <algorithm>
+#include <cstring>
+
+namespace v4d::graphics::mesh {
+
+// FIFO cache, a vertex is still cached if less than cacheSize vertices were inserted after it
+struct VertexCache {
+	std::vector<uint32_t> insertionTime;
+	uint32_t time;
+	size_t size;
+	VertexCache(size_t vertexCount, size_t cacheSize) : insertionTime(vertexCount, 0), time(uint32_t(cacheSize) + 1), size(cacheSize) {}
+	bool IsCached(uint32_t vertex) const {return time - insertionTime[vertex] <= size;}
+	// Returns true if it was a miss
+	bool Use(uint32_t vertex) {
+		if (IsCached(vertex)) return false;
+		insertionTime[vertex] = time++;
+		return true;
+	}
+	void Flush() {time += uint32_t(size) + 1;}
+};
+
+template<typename T>
+static VertexCacheStatistics AnalyzeVertexCache(const T* indices, size_t indexCount, size_t vertexCount, size_t cacheSize) {
+	VertexCacheStatistics statistics {};
+	const size_t triangleCount = indexCount / 3;
+	if (triangleCount == 0 || vertexCount == 0) return statistics;
+	VertexCache cache(vertexCount, cacheSize);
+	for (size_t i = 0; i < triangleCount * 3; ++i) {
+		if (cache.Use(indices[i])) ++statistics.misses;
+	}
+	statistics.acmr = float(statistics.misses) / float(triangleCount);
+	statistics.atvr = float(statistics.misses) / float(vertexCount);
+	return statistics;
+}
+
+VertexCacheStatistics AnalyzeVertexCache(const uint32_t* indices, size_t indexCount, size_t vertexCount, size_t cacheSize) {
+	return AnalyzeVertexCache<uint32_t>(indices, indexCount, vertexCount, cacheSize);
+}
+VertexCacheStatistics AnalyzeVertexCache(const uint16_t* indices, size_t indexCount, size_t vertexCount, size_t cacheSize) {
+	return AnalyzeVertexCache<uint16_t>(indices, indexCount, vertexCount, cacheSize);
+}
+
+template<typename T>
+static void OptimizeVertexCache(T* indices, size_t indexCount, size_t vertexCount, size_t cacheSize) {
+	const size_t triangleCount = indexCount / 3;
+	if (triangleCount == 0 || vertexCount == 0) return;
+
+	// Triangles using each vertex (CSR), the number of live triangles decreases as they are emitted
+	std::vector<uint32_t> liveTriangles(vertexCount, 0);
+	for (size_t i = 0; i < triangleCount * 3; ++i) ++liveTriangles[indices[i]];
+	std::vector<uint32_t> firstTriangle(vertexCount + 1, 0);
+	for (size_t v = 0; v < vertexCount; ++v) firstTriangle[v + 1] = firstTriangle[v] + liveTriangles[v];
+	std::vector<uint32_t> adjacency(triangleCount * 3);
+	{
+		std::vector<uint32_t> next(firstTriangle.begin(), firstTriangle.end() - 1);
+		for (size_t i = 0; i < triangleCount * 3; ++i) adjacency[next[indices[i]]++] = uint32_t(i / 3);
+	}
+
+	VertexCache cache(vertexCount, cacheSize);
+	std::vector<bool> emitted(triangleCount, false);
+	std::vector<uint32_t> deadEnds {};
+	std::vector<uint32_t> candidates {};
+	std::vector<T> output {};
+	output.reserve(triangleCount * 3);
+	size_t cursor = 1;
+	int64_t fanningVertex = 0;
+
+	while (fanningVertex >= 0) {
+		// Emit all remaining triangles around the fanning vertex
+		candidates.clear();
+		for (uint32_t i = firstTriangle[fanningVertex]; i < firstTriangle[fanningVertex + 1]; ++i) {
+			uint32_t triangle = adjacency[i];
+			if (emitted[triangle]) continue;
+			emitted[triangle] = true;
+			for (int c = 0; c < 3; ++c) {
+				uint32_t v = indices[triangle * 3 + c];
+				output.push_back(T(v));
+				deadEnds.push_back(v);
+				candidates.push_back(v);
+				--liveTriangles[v];
+				cache.Use(v);
+			}
+		}
+
+		// Next fanning vertex, the oldest candidate that would still be cached after emitting its remaining triangles
+		fanningVertex = -1;
+		int64_t bestPriority = -1;
+		for (uint32_t v : candidates) if (liveTriangles[v] > 0) {
+			int64_t age = cache.time - cache.insertionTime[v];
+			int64_t priority = (age + 2 * int64_t(liveTriangles[v]) <= int64_t(cacheSize))? age : 0;
+			if (priority > bestPriority) {
+				bestPriority = priority;
+				fanningVertex = v;
+			}
+		}
+
+		// Dead end, continue from the most recent vertex that still has triangles, or from the next one in input order
+		if (fanningVertex == -1) {
+			while (deadEnds.size() > 0) {
+				uint32_t v = deadEnds.back();
+				deadEnds.pop_back();
+				if (liveTriangles[v] > 0) {
+					fanningVertex = v;
+					break;
+				}
+			}
+		}
+		if (fanningVertex == -1) {
+			for (; cursor < vertexCount; ++cursor) if (liveTriangles[cursor] > 0) {
+				fanningVertex = int64_t(cursor);
+				break;
+			}
+		}
+	}
+
+	memcpy(indices, output.data(), output.size() * sizeof(T));
+}
+
+void OptimizeVertexCache(uint32_t* indices, size_t indexCount, size_t vertexCount, size_t cacheSize) {
+	OptimizeVertexCache<uint32_t>(indices, indexCount, vertexCount, cacheSize);
+}
+void OptimizeVertexCache(uint16_t* indices, size_t indexCount, size_t vertexCount, size_t cacheSize) {
+	OptimizeVertexCache<uint16_t>(indices, indexCount, vertexCount, cacheSize);
+}
+
+template<typename T>
+static void OptimizeOverdraw(T* indices, size_t indexCount, const float* positions, size_t positionStride, size_t vertexCount, float threshold, size_t cacheSize) {
+	const size_t triangleCount = indexCount / 3;
+	if (triangleCount == 0 || vertexCount == 0) return;
+
+	auto position = [&](uint32_t v){
+		const float* p = reinterpret_cast<const float*>(reinterpret_cast<const byte*>(positions) + v * positionStride);
+		return glm::vec3(p[0], p[1], p[2]);
+	};
+
+	VertexCache cache(vertexCount, cacheSize);
+	auto triangleMisses = [&](size_t triangle){
+		int misses = 0;
+		for (int c = 0; c < 3; ++c) misses += cache.Use(indices[triangle * 3 + c]);
+		return misses;
+	};
+
+	// Hard boundaries, where all vertices of a triangle miss the cache so the order before does not matter
+	std::vector<size_t> hardClusters {};
+	for (size_t t = 0; t < triangleCount; ++t) {
+		if (triangleMisses(t) == 3 || t == 0) hardClusters.push_back(t);
+	}
+	hardClusters.push_back(triangleCount);
+
+	// Soft boundaries, clusters are split further wherever the cache efficiency so far stays within threshold of the whole cluster
+	struct Cluster {
+		size_t begin, end;
+		float sortKey;
+	};
+	std::vector<Cluster> clusters {};
+	for (size_t h = 0; h + 1 < hardClusters.size(); ++h) {
+		const size_t begin = hardClusters[h], end = hardClusters[h + 1];
+		cache.Flush();
+		size_t clusterMisses = 0;
+		for (size_t t = begin; t < end; ++t) clusterMisses += triangleMisses(t);
+		const float clusterThreshold = threshold * float(clusterMisses) / float(end - begin);
+		cache.Flush();
+		size_t start = begin, misses = 0;
+		for (size_t t = begin; t < end; ++t) {
+			misses += triangleMisses(t);
+			if (t + 1 == end || float(misses) / float(t + 1 - start) <= clusterThreshold) {
+				clusters.push_back({start, t + 1, 0});
+				start = t + 1;
+				misses = 0;
+				cache.Flush();
+			}
+		}
+	}
+
+	// Clusters facing away from the center of the mesh are drawn first, since they are more likely to occlude the others
+	auto centroidAndNormal = [&](size_t begin, size_t end, glm::vec3& centroid, glm::vec3& normal){
+		centroid = glm::vec3(0);
+		normal = glm::vec3(0);
+		float area = 0;
+		for (size_t t = begin; t < end; ++t) {
+			glm::vec3 a = position(indices[t * 3]), b = position(indices[t * 3 + 1]), c = position(indices[t * 3 + 2]);
+			glm::vec3 n = glm::cross(b - a, c - a); // length is twice the area
+			float triangleArea = glm::length(n);
+			centroid += (a + b + c) * (triangleArea / 3.0f);
+			normal += n;
+			area += triangleArea;
+		}
+		centroid = area > 0? centroid / area : position(indices[begin * 3]);
+	};
+	glm::vec3 meshCentroid, meshNormal;
+	centroidAndNormal(0, triangleCount, meshCentroid, meshNormal);
+	for (auto& cluster : clusters) {
+		glm::vec3 centroid, normal;
+		centroidAndNormal(cluster.begin, cluster.end, centroid, normal);
+		float length = glm::length(normal);
+		cluster.sortKey = length > 0? glm::dot(centroid - meshCentroid, normal / length) : 0;
+	}
+	std::stable_sort(clusters.begin(), clusters.end(), [](const Cluster& a, const Cluster& b){return a.sortKey > b.sortKey;});
+
+	std::vector<T> output {};
+	output.reserve(triangleCount * 3);
+	for (auto& cluster : clusters) output.insert(output.end(), indices + cluster.begin * 3, indices + cluster.end * 3);
+	memcpy(indices, output.data(), output.size() * sizeof(T));
+}
+
+void OptimizeOverdraw(uint32_t* indices, size_t indexCount, const float* positions, size_t positionStride, size_t vertexCount, float threshold, size_t cacheSize) {
+	OptimizeOverdraw<uint32_t>(indices, indexCount, positions, positionStride, vertexCount, threshold, cacheSize);
+}
+void OptimizeOverdraw(uint16_t* indices, size_t indexCount, const float* positions, size_t positionStride, size_t vertexCount, float threshold, size_t cacheSize) {
+	OptimizeOverdraw<uint16_t>(indices, indexCount, positions, positionStride, vertexCount, threshold, cacheSize);
+}
+
+template<typename T>
+static std::vector<uint32_t> OptimizeVertexFetch(T* indices, size_t indexCount, size_t vertexCount, size_t* usedVertexCount) {
+	std::vector<uint32_t> remap(vertexCount, ~0u);
+	uint32_t next = 0;
+	for (size_t i = 0; i < indexCount; ++i) {
+		uint32_t& v = remap[indices[i]];
+		if (v == ~0u) v = next++;
+		indices[i] = T(v);
+	}
+	if (usedVertexCount) *usedVertexCount = next;
+	for (auto& v : remap) if (v == ~0u) v = next++;
+	return remap;
+}
+
+std::vector<uint32_t> OptimizeVertexFetch(uint32_t* indices, size_t indexCount, size_t vertexCount, size_t* usedVertexCount) {
+	return OptimizeVertexFetch<uint32_t>(indices, indexCount, vertexCount, usedVertexCount);
+}
+std::vector<uint32_t> OptimizeVertexFetch(uint16_t* indices, size_t indexCount, size_t vertexCount, size_t* usedVertexCount) {
+	return OptimizeVertexFetch<uint16_t>(indices, indexCount, vertexCount, usedVertexCount);
+}
+
+void RemapVertices(const void* src, void* dst, size_t vertexCount, size_t vertexSize, const std::vector<uint32_t>& remap) {
+	for (size_t v = 0; v < vertexCount; ++v) {
+		memcpy(reinterpret_cast<byte*>(dst) + remap[v] * vertexSize, reinterpret_cast<const byte*>(src) + v * vertexSize, vertexSize);
+	}
+}
+
+}
@@ -0,0 +1,120 @@
+#include <v4d.h>
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include "utilities/graphics/MeshOptimizer.h"
+
+namespace v4d::tests {
+	int MeshOptimizer() {
+		using namespace v4d::graphics::mesh;
+
+		// Grid of size*size quads with triangles in a random order, like some exporters output
+		const uint32_t size = 32, vertexCount = (size+1)*(size+1);
+		std::vector<float> positions {};
+		for (uint32_t y = 0; y <= size; ++y) for (uint32_t x = 0; x <= size; ++x) positions.insert(positions.end(), {float(x), float(y), 0});
+		std::vector<uint32_t> grid {};
+		for (uint32_t y = 0; y < size; ++y) for (uint32_t x = 0; x < size; ++x) {
+			uint32_t v = y*(size+1) + x;
+			grid.insert(grid.end(), {v, v+1, v+size+1, v+1, v+size+2, v+size+1});
+		}
+		for (size_t t = grid.size()/3 - 1, seed = 1; t > 0; --t) {
+			seed = seed * 6364136223846793005ull + 1442695040888963407ull;
+			size_t other = (seed >> 33) % (t + 1);
+			std::swap_ranges(&grid[t*3], &grid[t*3+3], &grid[other*3]);
+		}
+
+		// Triangles rotated so that their smallest index is first (same winding), then sorted, to compare triangle sets
+		auto triangleSet = [](const std::vector<uint32_t>& indices){
+			std::vector<std::array<uint32_t,3>> triangles {};
+			for (size_t i = 0; i < indices.size(); i += 3) {
+				std::array<uint32_t,3> t {indices[i], indices[i+1], indices[i+2]};
+				std::rotate(t.begin(), std::min_element(t.begin(), t.end()), t.end());
+				triangles.push_back(t);
+			}
+			std::sort(triangles.begin(), triangles.end());
+			return triangles;
+		};
+
+		{// Test 1 (cache statistics)
+			const uint16_t indices[] {0,1,2, 2,1,3};
+			auto statistics = AnalyzeVertexCache(indices, 6, 4);
+			auto small = AnalyzeVertexCache(indices, 6, 4, 1);
+			if (statistics.misses != 4 || statistics.acmr != 2.0f || statistics.atvr != 1.0f || small.misses != 5) {
+				LOG_ERROR("v4d::tests::MeshOptimizer ERROR 1 (" << statistics.misses << " misses, " << small.misses << " with a cache of 1)")
+				return 1;
+			}
+		}
+
+		std::vector<uint32_t> indices = grid;
+		{// Test 2 (vertex cache)
+			auto before = AnalyzeVertexCache(indices.data(), indices.size(), vertexCount);
+			OptimizeVertexCache(indices.data(), indices.size(), vertexCount);
+			auto after = AnalyzeVertexCache(indices.data(), indices.size(), vertexCount);
+			if (triangleSet(indices) != triangleSet(grid)) {
+				LOG_ERROR("v4d::tests::MeshOptimizer ERROR 2.1 (triangles changed)")
+				return 2;
+			}
+			if (after.acmr > 0.8f || after.acmr >= before.acmr) {
+				LOG_ERROR("v4d::tests::MeshOptimizer ERROR 2.2 (ACMR " << before.acmr << " -> " << after.acmr << ")")
+				return 2;
+			}
+			std::vector<uint32_t> again = grid;
+			OptimizeVertexCache(again.data(), again.size(), vertexCount);
+			if (again != indices) {
+				LOG_ERROR("v4d::tests::MeshOptimizer ERROR 2.3 (not deterministic)")
+				return 2;
+			}
+		}
+
+		{// Test 3 (overdraw)
+			auto before = AnalyzeVertexCache(indices.data(), indices.size(), vertexCount);
+			std::vector<uint32_t> reordered = indices;
+			OptimizeOverdraw(reordered.data(), reordered.size(), positions.data(), 12, vertexCount);
+			auto after = AnalyzeVertexCache(reordered.data(), reordered.size(), vertexCount);
+			if (triangleSet(reordered) != triangleSet(grid) || after.acmr > before.acmr * 1.15f) {
+				LOG_ERROR("v4d::tests::MeshOptimizer ERROR 3.1 (ACMR " << before.acmr << " -> " << after.acmr << ")")
+				return 3;
+			}
+			// Two separate quads facing +z, the one in front should be drawn first
+			const float quads[] {-1,-1,-1, 1,-1,-1, 1,1,-1, -1,1,-1,  -1,-1,1, 1,-1,1, 1,1,1, -1,1,1};
+			std::vector<uint16_t> quadIndices {0,1,2, 0,2,3, 4,5,6, 4,6,7};
+			OptimizeOverdraw(quadIndices.data(), quadIndices.size(), quads, 12, 8);
+			if (quadIndices != std::vector<uint16_t>{4,5,6, 4,6,7, 0,1,2, 0,2,3}) {
+				LOG_ERROR("v4d::tests::MeshOptimizer ERROR 3.2 (cluster order)")
+				return 3;
+			}
+		}
+
+		{// Test 4 (vertex fetch)
+			// with an extra vertex that is not used by any triangle
+			std::vector<float> vertices = positions;
+			vertices.insert(vertices.end(), {-1, -1, -1});
+			std::vector<uint32_t> remapped = indices;
+			std::vector<uint32_t> original = remapped;
+			size_t usedVertexCount = 0;
+			auto remap = OptimizeVertexFetch(remapped.data(), remapped.size(), vertexCount + 1, &usedVertexCount);
+			uint32_t next = 0;
+			for (uint32_t v : remapped) {
+				if (v > next) {
+					LOG_ERROR("v4d::tests::MeshOptimizer ERROR 4.1 (not in first use order)")
+					return 4;
+				}
+				if (v == next) ++next;
+			}
+			std::vector<float> remappedVertices(vertices.size());
+			RemapVertices(vertices.data(), remappedVertices.data(), vertexCount + 1, 12, remap);
+			for (size_t i = 0; i < remapped.size(); ++i) {
+				if (memcmp(&remappedVertices[remapped[i]*3], &vertices[original[i]*3], 12) != 0) {
+					LOG_ERROR("v4d::tests::MeshOptimizer ERROR 4.2 (index " << i << ")")
+					return 4;
+				}
+			}
+			if (usedVertexCount != next || usedVertexCount != vertexCount || remap[vertexCount] != vertexCount || remappedVertices.back() != -1) {
+				LOG_ERROR("v4d::tests::MeshOptimizer ERROR 4.3 (" << usedVertexCount << " used vertices)")
+				return 4;
+			}
+		}
+
+		return 0;
+	}
+}
@@ -0,0 +1,55 @@
+/*
+ * Index and vertex reordering for GPU efficiency
+ * Part of the Vulkan4D open-source game engine under the LGPL license - https://github.com/Vulkan4D
+ *
+ * All functions work on triangle lists, keep the winding of each triangle and are deterministic.
+ * Indices must be smaller than vertexCount, they are not checked (MeshFile validates them when loading).
+ * Usual order: OptimizeVertexCache(), then OptimizeOverdraw(), then OptimizeVertexFetch() and RemapVertices() for each vertex attribute.
+ */
+#pragma once
+
+#include <v4d.h>
+#include <vector>
+
+#ifndef V4D_MESH_VERTEX_CACHE_SIZE
+	#define V4D_MESH_VERTEX_CACHE_SIZE 16 // number of post-transform vertices assumed to be cached by the GPU
+#endif
+#ifndef V4D_MESH_OVERDRAW_THRESHOLD
+	#define V4D_MESH_OVERDRAW_THRESHOLD 1.05f // how much worse the vertex cache efficiency may get when reordering for overdraw
+#endif
+
+namespace v4d::graphics::mesh {
+
+	struct VertexCacheStatistics {
+		size_t misses = 0; // vertex shader invocations
+		float acmr = 0; // average cache miss ratio, vertex shader invocations per triangle (0.5 at best, 3 at worst)
+		float atvr = 0; // average transformed vertex ratio, vertex shader invocations per vertex (1 at best)
+	};
+
+	// Simulates a FIFO post-transform vertex cache
+	V4DLIB VertexCacheStatistics AnalyzeVertexCache(const uint32_t* indices, size_t indexCount, size_t vertexCount, size_t cacheSize = V4D_MESH_VERTEX_CACHE_SIZE);
+	V4DLIB VertexCacheStatistics AnalyzeVertexCache(const uint16_t* indices, size_t indexCount, size_t vertexCount, size_t cacheSize = V4D_MESH_VERTEX_CACHE_SIZE);
+
+	// Reorders triangles for post-transform vertex cache locality (Tipsify, Sander et al. 2007)
+	V4DLIB void OptimizeVertexCache(uint32_t* indices, size_t indexCount, size_t vertexCount, size_t cacheSize = V4D_MESH_VERTEX_CACHE_SIZE);
+	V4DLIB void OptimizeVertexCache(uint16_t* indices, size_t indexCount, size_t vertexCount, size_t cacheSize = V4D_MESH_VERTEX_CACHE_SIZE);
+
+	/**
+	 * Reorders clusters of triangles so that the ones facing outwards are drawn first and occlude the others
+	 * Clusters are cut where the vertex cache efficiency stays within threshold of the current order, so it should be called after OptimizeVertexCache()
+	 * positions are 3 floats every positionStride bytes
+	 */
+	V4DLIB void OptimizeOverdraw(uint32_t* indices, size_t indexCount, const float* positions, size_t positionStride, size_t vertexCount, float threshold = V4D_MESH_OVERDRAW_THRESHOLD, size_t cacheSize = V4D_MESH_VERTEX_CACHE_SIZE);
+	V4DLIB void OptimizeOverdraw(uint16_t* indices, size_t indexCount, const float* positions, size_t positionStride, size_t vertexCount, float threshold = V4D_MESH_OVERDRAW_THRESHOLD, size_t cacheSize = V4D_MESH_VERTEX_CACHE_SIZE);
+
+	/**
+	 * Renumbers vertices in the order they are first used, so that vertex fetches are mostly sequential
+	 * Indices are updated and the returned remap table gives the new index of each old vertex, unused vertices are moved at the end
+	 * usedVertexCount is set to the number of vertices referenced by the indices
+	 */
+	V4DLIB std::vector<uint32_t> OptimizeVertexFetch(uint32_t* indices, size_t indexCount, size_t vertexCount, size_t* usedVertexCount = nullptr);
+	V4DLIB std::vector<uint32_t> OptimizeVertexFetch(uint16_t* indices, size_t indexCount, size_t vertexCount, size_t* usedVertexCount = nullptr);
+
+	// Moves each vertex of vertexSize bytes to its new index given by OptimizeVertexFetch(), dst cannot be the same as src
+	V4DLIB void RemapVertices(const void* src, void* dst, size_t vertexCount, size_t vertexSize, const std::vector<uint32_t>& remap);
+}
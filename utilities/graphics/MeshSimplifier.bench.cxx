@@ -0,0 +1,49 @@
+#include <v4d.h>
+#include "helpers/Benchmark.hpp"
+#include "utilities/graphics/MeshSimplifier.h"
+
+namespace v4d::benchmarks {
+	void MeshSimplifier() {
+		using v4d::Benchmark;
+		using namespace v4d::graphics::mesh;
+
+		// Closed sphere of radius 1 with 256 rings of 512 segments (262k triangles)
+		const uint32_t rings = 256, segments = 512;
+		std::vector<float> positions {0, 0, 1, 0, 0, -1};
+		for (uint32_t r = 1; r < rings; ++r) for (uint32_t s = 0; s < segments; ++s) {
+			float theta = float(r) / rings * 3.14159265f, phi = float(s) / segments * 6.28318531f;
+			positions.insert(positions.end(), {std::sin(theta) * std::cos(phi), std::sin(theta) * std::sin(phi), std::cos(theta)});
+		}
+		auto ringVertex = [&](uint32_t r, uint32_t s){return 2 + (r-1) * segments + s % segments;};
+		std::vector<uint32_t> indices {};
+		for (uint32_t s = 0; s < segments; ++s) {
+			indices.insert(indices.end(), {0, ringVertex(1, s), ringVertex(1, s+1)});
+			indices.insert(indices.end(), {1, ringVertex(rings-1, s+1), ringVertex(rings-1, s)});
+			for (uint32_t r = 1; r < rings-1; ++r) {
+				indices.insert(indices.end(), {ringVertex(r, s), ringVertex(r+1, s), ringVertex(r+1, s+1)});
+				indices.insert(indices.end(), {ringVertex(r, s), ringVertex(r+1, s+1), ringVertex(r, s+1)});
+			}
+		}
+		const size_t vertexCount = positions.size() / 3;
+
+		{
+			std::vector<uint32_t> lodIndices {};
+			auto levels = GenerateLodChain(lodIndices, indices.data(), indices.size(), positions.data(), 12, vertexCount);
+			for (size_t i = 0; i < levels.size(); ++i) {
+				LOG("    MeshSimplifier sphere LOD " << i << ": " << (levels[i].indexCount / 3) << " triangles, error " << levels[i].error)
+			}
+		}
+
+		std::vector<uint32_t> result(indices.size());
+		Benchmark::Run("MeshSimplifier SimplifyMesh 262k triangles to 10%", [&]{
+			size_t count = SimplifyMesh(result.data(), indices.data(), indices.size(), positions.data(), 12, vertexCount, indices.size() / 10, 1.0f);
+			Benchmark::DoNotOptimize(count);
+		}, double(indices.size() * sizeof(uint32_t)));
+
+		Benchmark::Run("MeshSimplifier GenerateLodChain 262k triangles", [&]{
+			std::vector<uint32_t> lodIndices {};
+			auto levels = GenerateLodChain(lodIndices, indices.data(), indices.size(), positions.data(), 12, vertexCount);
+			Benchmark::DoNotOptimize(levels.size());
+		}, double(indices.size() * sizeof(uint32_t)));
+	}
+}
@@ -0,0 +1,369 @@
+#include "MeshSimplifier.h"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
+#include <unordered_map>
+
+namespace v4d::graphics::mesh {
+
+static constexpr double BORDER_WEIGHT = 10; // keeps open borders in place relative to surfaces
+static constexpr size_t CANDIDATES_PER_COLLAPSE = 4; // most candidates are skipped because their neighbourhood is already locked in the pass
+static constexpr float MIN_LEVEL_REDUCTION = 0.9f; // a LOD level must have at most this ratio of the previous level's indices
+
+// Squared distance to a set of planes weighted by area, the error is normalized by the total weight
+struct Quadric {
+	double a00 = 0, a11 = 0, a22 = 0, a10 = 0, a20 = 0, a21 = 0;
+	double b0 = 0, b1 = 0, b2 = 0;
+	double c = 0;
+	double w = 0;
+
+	Quadric() = default;
+	// Plane dot(n, p) + d = 0, n must be normalized
+	Quadric(const glm::dvec3& n, double d, double weight)
+	: a00(weight*n.x*n.x), a11(weight*n.y*n.y), a22(weight*n.z*n.z), a10(weight*n.y*n.x), a20(weight*n.z*n.x), a21(weight*n.z*n.y)
+	, b0(weight*n.x*d), b1(weight*n.y*d), b2(weight*n.z*d)
+	, c(weight*d*d)
+	, w(weight) {}
+
+	Quadric& operator+=(const Quadric& q) {
+		a00 += q.a00; a11 += q.a11; a22 += q.a22; a10 += q.a10; a20 += q.a20; a21 += q.a21;
+		b0 += q.b0; b1 += q.b1; b2 += q.b2;
+		c += q.c;
+		w += q.w;
+		return *this;
+	}
+
+	double Error(const glm::dvec3& p) const {
+		if (w <= 0) return 0;
+		double e = p.x * (a00*p.x + a10*p.y + a20*p.z)
+				 + p.y * (a10*p.x + a11*p.y + a21*p.z)
+				 + p.z * (a20*p.x + a21*p.y + a22*p.z)
+				 + 2 * (b0*p.x + b1*p.y + b2*p.z)
+				 + c;
+		return std::abs(e) / w;
+	}
+};
+
+class Simplifier {
+	enum VertexKind : uint8_t {MANIFOLD, BORDER, LOCKED};
+	static constexpr uint32_t NONE = ~0u;
+
+	struct Collapse {
+		uint32_t from;
+		uint32_t to;
+		double cost;
+	};
+
+	const float* positions;
+	size_t positionStride;
+	size_t vertexCount;
+	std::vector<VertexKind> kinds;
+	std::vector<uint32_t> borderNext, borderPrev; // neighbours along open borders
+	std::vector<Quadric> quadrics;
+
+	// Rebuilt on each pass
+	std::vector<uint32_t> firstTriangle, adjacency;
+	std::vector<uint32_t> marks;
+	uint32_t mark = 0;
+	std::vector<uint8_t> locked;
+	std::vector<uint32_t> collapseTarget;
+	std::vector<Collapse> collapses;
+
+	glm::dvec3 Position(uint32_t v) const {
+		const float* p = reinterpret_cast<const float*>(reinterpret_cast<const byte*>(positions) + v * positionStride);
+		return glm::dvec3(p[0], p[1], p[2]);
+	}
+
+	void BuildAdjacency() {
+		std::fill(firstTriangle.begin(), firstTriangle.end(), 0);
+		for (uint32_t v : indices) ++firstTriangle[v + 1];
+		for (size_t v = 0; v < vertexCount; ++v) firstTriangle[v + 1] += firstTriangle[v];
+		adjacency.resize(indices.size());
+		std::vector<uint32_t> next(firstTriangle.begin(), firstTriangle.end() - 1);
+		for (size_t i = 0; i < indices.size(); ++i) adjacency[next[indices[i]]++] = uint32_t(i / 3);
+	}
+
+	bool CanCollapse(uint32_t from, uint32_t to) const {
+		switch (kinds[from]) {
+			case MANIFOLD: return true;
+			case BORDER: return to == borderNext[from] || to == borderPrev[from];
+			default: return false;
+		}
+	}
+
+	// The vertices shared by the neighbourhoods of from and to must be exactly the ones of their shared triangles, otherwise the collapse would make the surface non-manifold
+	// Triangles around from must also not flip
+	bool IsValidCollapse(uint32_t from, uint32_t to) {
+		const uint32_t fromMark = ++mark;
+		uint32_t sharedTriangles = 0;
+		for (uint32_t i = firstTriangle[from]; i < firstTriangle[from + 1]; ++i) {
+			const uint32_t* triangle = &indices[adjacency[i] * 3];
+			if (triangle[0] == to || triangle[1] == to || triangle[2] == to) {
+				++sharedTriangles;
+				continue;
+			}
+			// Flip test
+			glm::dvec3 p[3], q[3];
+			for (int k = 0; k < 3; ++k) {
+				p[k] = Position(triangle[k]);
+				q[k] = triangle[k] == from? Position(to) : p[k];
+			}
+			if (glm::dot(glm::cross(p[1] - p[0], p[2] - p[0]), glm::cross(q[1] - q[0], q[2] - q[0])) <= 0) return false;
+		}
+		for (uint32_t i = firstTriangle[from]; i < firstTriangle[from + 1]; ++i) {
+			const uint32_t* triangle = &indices[adjacency[i] * 3];
+			for (int k = 0; k < 3; ++k) marks[triangle[k]] = fromMark;
+		}
+		const uint32_t commonMark = ++mark;
+		uint32_t commonVertices = 0;
+		for (uint32_t i = firstTriangle[to]; i < firstTriangle[to + 1]; ++i) {
+			const uint32_t* triangle = &indices[adjacency[i] * 3];
+			for (int k = 0; k < 3; ++k) {
+				uint32_t v = triangle[k];
+				if (v != from && v != to && marks[v] == fromMark) {
+					marks[v] = commonMark;
+					++commonVertices;
+				}
+			}
+		}
+		return commonVertices == sharedTriangles;
+	}
+
+	void LockNeighbourhood(uint32_t v) {
+		for (uint32_t i = firstTriangle[v]; i < firstTriangle[v + 1]; ++i) {
+			const uint32_t* triangle = &indices[adjacency[i] * 3];
+			for (int k = 0; k < 3; ++k) locked[triangle[k]] = 1;
+		}
+	}
+
+	// Returns the number of collapsed edges
+	size_t Pass(size_t targetIndexCount, double maxCost) {
+		const size_t triangleCount = indices.size() / 3;
+		BuildAdjacency();
+
+		collapses.clear();
+		for (size_t t = 0; t < triangleCount; ++t) {
+			for (int k = 0; k < 3; ++k) {
+				uint32_t a = indices[t*3 + k], b = indices[t*3 + (k+1)%3];
+				if (CanCollapse(a, b)) collapses.push_back({a, b, quadrics[a].Error(Position(b))});
+				if (CanCollapse(b, a)) collapses.push_back({b, a, quadrics[b].Error(Position(a))});
+			}
+		}
+		if (collapses.empty()) return 0;
+
+		// Each collapse removes about two triangles, and its neighbourhood is locked for the rest of the pass so that all tests remain valid
+		// Only the cheapest candidates can be used in a pass, so they don't all need to be sorted
+		const size_t collapseGoal = std::max<size_t>(1, (triangleCount - targetIndexCount / 3) / 2);
+		auto cheaper = [](const Collapse& a, const Collapse& b){return a.cost < b.cost;};
+		size_t sorted = std::min(collapses.size(), collapseGoal * CANDIDATES_PER_COLLAPSE);
+		if (sorted < collapses.size()) std::nth_element(collapses.begin(), collapses.begin() + sorted, collapses.end(), cheaper);
+		std::sort(collapses.begin(), collapses.begin() + sorted, cheaper);
+		std::fill(locked.begin(), locked.end(), 0);
+		size_t collapsed = 0;
+		for (size_t i = 0; i < collapses.size(); ++i) {
+			if (i == sorted) {
+				if (collapsed > 0) break;
+				// None of the cheapest candidates were valid
+				std::sort(collapses.begin() + sorted, collapses.end(), cheaper);
+				sorted = collapses.size();
+			}
+			const auto& collapse = collapses[i];
+			if (collapsed >= collapseGoal || collapse.cost > maxCost) break;
+			// to may have been collapsed onto another vertex earlier in this pass, or be about to move with a neighbour's collapse
+			if (locked[collapse.from] || locked[collapse.to] || !IsValidCollapse(collapse.from, collapse.to)) continue;
+			LockNeighbourhood(collapse.from);
+			collapseTarget[collapse.from] = collapse.to;
+			quadrics[collapse.to] += quadrics[collapse.from];
+			if (kinds[collapse.from] == BORDER) {
+				// from is removed from the border whichever neighbour it collapses onto
+				uint32_t prev = borderPrev[collapse.from], next = borderNext[collapse.from];
+				borderNext[prev] = next;
+				borderPrev[next] = prev;
+			}
+			error = std::max(error, collapse.cost);
+			++collapsed;
+		}
+
+		// Remap collapsed vertices and remove the triangles that became degenerate
+		size_t indexCount = 0;
+		for (size_t t = 0; t < triangleCount; ++t) {
+			uint32_t a = collapseTarget[indices[t*3]], b = collapseTarget[indices[t*3+1]], c = collapseTarget[indices[t*3+2]];
+			if (a == b || b == c || c == a) continue;
+			indices[indexCount++] = a;
+			indices[indexCount++] = b;
+			indices[indexCount++] = c;
+		}
+		indices.resize(indexCount);
+		for (const auto& collapse : collapses) collapseTarget[collapse.from] = collapse.from;
+		return collapsed;
+	}
+
+public:
+	std::vector<uint32_t> indices {};
+	double error = 0; // largest collapse cost so far, squared distance
+	double extent = 0; // bounding box diagonal
+
+	template<typename T>
+	Simplifier(const T* sourceIndices, size_t indexCount, const float* positions, size_t positionStride, size_t vertexCount)
+	: positions(positions), positionStride(positionStride), vertexCount(vertexCount)
+	, kinds(vertexCount, MANIFOLD), borderNext(vertexCount, NONE), borderPrev(vertexCount, NONE), quadrics(vertexCount)
+	, firstTriangle(vertexCount + 1), marks(vertexCount, 0), locked(vertexCount), collapseTarget(vertexCount) {
+		for (size_t v = 0; v < vertexCount; ++v) collapseTarget[v] = uint32_t(v);
+
+		indices.reserve(indexCount);
+		for (size_t i = 0; i + 2 < indexCount; i += 3) {
+			uint32_t a = sourceIndices[i], b = sourceIndices[i+1], c = sourceIndices[i+2];
+			if (a == b || b == c || c == a) continue;
+			indices.insert(indices.end(), {a, b, c});
+		}
+
+		// Vertices that share their position with other used vertices are on attribute seams
+		std::vector<uint8_t> used(vertexCount, 0);
+		for (uint32_t v : indices) used[v] = 1;
+		std::vector<uint32_t> positionIds(vertexCount);
+		size_t positionCount = 0;
+		{
+			struct PositionHash {
+				size_t operator()(const std::array<uint32_t, 3>& p) const {return (p[0] * 73856093u) ^ (p[1] * 19349663u) ^ (p[2] * 83492791u);}
+			};
+			std::unordered_map<std::array<uint32_t, 3>, uint32_t, PositionHash> ids {};
+			ids.reserve(vertexCount);
+			std::vector<uint32_t> wedges {};
+			glm::dvec3 min {INFINITY}, max {-INFINITY};
+			for (size_t v = 0; v < vertexCount; ++v) {
+				glm::dvec3 p = Position(uint32_t(v));
+				min = glm::min(min, p);
+				max = glm::max(max, p);
+				std::array<uint32_t, 3> key;
+				for (int k = 0; k < 3; ++k) {
+					float f = float(p[k]) + 0.0f; // -0 == +0
+					std::memcpy(&key[k], &f, 4);
+				}
+				auto [it, inserted] = ids.emplace(key, uint32_t(wedges.size()));
+				if (inserted) wedges.push_back(0);
+				positionIds[v] = it->second;
+				wedges[it->second] += used[v];
+			}
+			for (size_t v = 0; v < vertexCount; ++v) if (wedges[positionIds[v]] > 1) kinds[v] = LOCKED;
+			positionCount = wedges.size();
+			if (vertexCount > 0) extent = glm::length(max - min);
+		}
+
+		// Open borders are edges without an opposite edge between the same positions, an edge used more than once in the same direction is non-manifold
+		std::vector<uint32_t> firstPositionTriangle(positionCount + 1, 0), positionAdjacency(indices.size());
+		for (uint32_t v : indices) ++firstPositionTriangle[positionIds[v] + 1];
+		for (size_t i = 0; i < positionCount; ++i) firstPositionTriangle[i + 1] += firstPositionTriangle[i];
+		{
+			std::vector<uint32_t> next(firstPositionTriangle.begin(), firstPositionTriangle.end() - 1);
+			for (size_t i = 0; i < indices.size(); ++i) positionAdjacency[next[positionIds[indices[i]]]++] = uint32_t(i / 3);
+		}
+		auto countEdges = [&](uint32_t a, uint32_t b){
+			uint32_t from = positionIds[a], to = positionIds[b], count = 0;
+			for (uint32_t i = firstPositionTriangle[from]; i < firstPositionTriangle[from + 1]; ++i) {
+				const uint32_t* triangle = &indices[positionAdjacency[i] * 3];
+				for (int k = 0; k < 3; ++k) count += positionIds[triangle[k]] == from && positionIds[triangle[(k+1)%3]] == to;
+			}
+			return count;
+		};
+		for (size_t t = 0; t < indices.size() / 3; ++t) {
+			const uint32_t* triangle = &indices[t*3];
+			glm::dvec3 p0 = Position(triangle[0]), p1 = Position(triangle[1]), p2 = Position(triangle[2]);
+			glm::dvec3 normal = glm::cross(p1 - p0, p2 - p0);
+			double area = glm::length(normal);
+			if (area > 0) {
+				normal /= area;
+				Quadric plane(normal, -glm::dot(normal, p0), area * 0.5);
+				for (int k = 0; k < 3; ++k) quadrics[triangle[k]] += plane;
+			}
+			for (int k = 0; k < 3; ++k) {
+				uint32_t a = triangle[k], b = triangle[(k+1)%3];
+				if (countEdges(a, b) > 1) {
+					kinds[a] = kinds[b] = LOCKED;
+				} else if (countEdges(b, a) == 0) {
+					if (borderNext[a] != NONE || borderPrev[b] != NONE) kinds[a] = kinds[b] = LOCKED;
+					borderNext[a] = b;
+					borderPrev[b] = a;
+					// Plane through the border edge perpendicular to the triangle
+					glm::dvec3 pa = Position(a), edge = Position(b) - pa;
+					glm::dvec3 edgeNormal = glm::cross(edge, normal);
+					double length = glm::length(edgeNormal);
+					if (area > 0 && length > 0) {
+						edgeNormal /= length;
+						Quadric border(edgeNormal, -glm::dot(edgeNormal, pa), glm::dot(edge, edge) * BORDER_WEIGHT);
+						quadrics[a] += border;
+						quadrics[b] += border;
+					}
+				}
+			}
+		}
+		for (size_t v = 0; v < vertexCount; ++v) {
+			if (kinds[v] != MANIFOLD) continue;
+			if (borderNext[v] != NONE && borderPrev[v] != NONE) kinds[v] = BORDER;
+			else if (borderNext[v] != NONE || borderPrev[v] != NONE) kinds[v] = LOCKED;
+		}
+	}
+
+	// maxError is in position units
+	void Simplify(size_t targetIndexCount, double maxError) {
+		while (indices.size() > targetIndexCount) {
+			if (Pass(targetIndexCount, maxError * maxError) == 0) break;
+		}
+	}
+
+	float Error() const {return float(std::sqrt(error));}
+};
+
+template<typename T>
+static size_t SimplifyMesh(T* destination, const T* indices, size_t indexCount, const float* positions, size_t positionStride, size_t vertexCount, size_t targetIndexCount, float targetError, float* resultError) {
+	Simplifier simplifier(indices, indexCount, positions, positionStride, vertexCount);
+	simplifier.Simplify(targetIndexCount, targetError * simplifier.extent);
+	std::copy(simplifier.indices.begin(), simplifier.indices.end(), destination);
+	if (resultError) *resultError = simplifier.Error();
+	return simplifier.indices.size();
+}
+
+size_t SimplifyMesh(uint32_t* destination, const uint32_t* indices, size_t indexCount, const float* positions, size_t positionStride, size_t vertexCount, size_t targetIndexCount, float targetError, float* resultError) {
+	return SimplifyMesh<uint32_t>(destination, indices, indexCount, positions, positionStride, vertexCount, targetIndexCount, targetError, resultError);
+}
+size_t SimplifyMesh(uint16_t* destination, const uint16_t* indices, size_t indexCount, const float* positions, size_t positionStride, size_t vertexCount, size_t targetIndexCount, float targetError, float* resultError) {
+	return SimplifyMesh<uint16_t>(destination, indices, indexCount, positions, positionStride, vertexCount, targetIndexCount, targetError, resultError);
+}
+
+template<typename T>
+static std::vector<LodLevel> GenerateLodChain(std::vector<T>& lodIndices, const T* indices, size_t indexCount, const float* positions, size_t positionStride, size_t vertexCount, size_t maxLevels, float reduction, float maxError) {
+	std::vector<LodLevel> levels {};
+	indexCount -= indexCount % 3;
+	if (indexCount == 0 || maxLevels == 0) return levels;
+	levels.push_back({uint32_t(lodIndices.size()), uint32_t(indexCount), 0});
+	lodIndices.insert(lodIndices.end(), indices, indices + indexCount);
+
+	// Levels are simplified successively from the same state, so that errors are always measured against the full resolution mesh
+	Simplifier simplifier(indices, indexCount, positions, positionStride, vertexCount);
+	while (levels.size() < maxLevels) {
+		const size_t previousCount = levels.back().indexCount;
+		simplifier.Simplify(size_t(previousCount * reduction), maxError * simplifier.extent);
+		const size_t count = simplifier.indices.size();
+		if (count == 0 || count > previousCount * MIN_LEVEL_REDUCTION) break;
+		levels.push_back({uint32_t(lodIndices.size()), uint32_t(count), simplifier.Error()});
+		lodIndices.insert(lodIndices.end(), simplifier.indices.begin(), simplifier.indices.end());
+	}
+	return levels;
+}
+
+std::vector<LodLevel> GenerateLodChain(std::vector<uint32_t>& lodIndices, const uint32_t* indices, size_t indexCount, const float* positions, size_t positionStride, size_t vertexCount, size_t maxLevels, float reduction, float maxError) {
+	return GenerateLodChain<uint32_t>(lodIndices, indices, indexCount, positions, positionStride, vertexCount, maxLevels, reduction, maxError);
+}
+std::vector<LodLevel> GenerateLodChain(std::vector<uint16_t>& lodIndices, const uint16_t* indices, size_t indexCount, const float* positions, size_t positionStride, size_t vertexCount, size_t maxLevels, float reduction, float maxError) {
+	return GenerateLodChain<uint16_t>(lodIndices, indices, indexCount, positions, positionStride, vertexCount, maxLevels, reduction, maxError);
+}
+
+size_t SelectLod(const LodLevel* levels, size_t levelCount, float distance, float projectionScale, float maxPixelError) {
+	if (distance <= 0) return 0;
+	for (size_t i = levelCount; i-- > 1;) {
+		if (levels[i].error * projectionScale / distance <= maxPixelError) return i;
+	}
+	return 0;
+}
+
+}
@@ -0,0 +1,163 @@
+#include <v4d.h>
+#include <algorithm>
+#include <cmath>
+#include "utilities/graphics/MeshSimplifier.h"
+
+namespace v4d::tests {
+	int MeshSimplifier() {
+		using namespace v4d::graphics::mesh;
+
+		// Grid of size*size quads on the z=0 plane, with the vertices of the right half duplicated along the middle column (UV seam)
+		const uint32_t size = 32, row = size + 1;
+		std::vector<float> grid {};
+		for (uint32_t y = 0; y <= size; ++y) for (uint32_t x = 0; x <= size; ++x) grid.insert(grid.end(), {float(x), float(y), 0});
+		const uint32_t seamFirstVertex = row * row;
+		for (uint32_t y = 0; y <= size; ++y) grid.insert(grid.end(), {float(size/2), float(y), 0});
+		std::vector<uint32_t> gridIndices {}, seamIndices {};
+		for (uint32_t y = 0; y < size; ++y) for (uint32_t x = 0; x < size; ++x) {
+			uint32_t v = y*row + x;
+			gridIndices.insert(gridIndices.end(), {v, v+1, v+row, v+1, v+row+1, v+row});
+			// right half uses the duplicated seam vertices
+			auto s = [&](uint32_t vertex){return (x >= size/2 && vertex % row == size/2)? seamFirstVertex + vertex / row : vertex;};
+			seamIndices.insert(seamIndices.end(), {s(v), s(v+1), s(v+row), s(v+1), s(v+row+1), s(v+row)});
+		}
+		const size_t gridVertexCount = seamFirstVertex + row;
+
+		// Closed sphere of radius 1, poles are single vertices and the rings wrap around
+		const uint32_t rings = 32, segments = 64;
+		std::vector<float> sphere {0, 0, 1, 0, 0, -1};
+		for (uint32_t r = 1; r < rings; ++r) for (uint32_t s = 0; s < segments; ++s) {
+			float theta = float(r) / rings * 3.14159265f, phi = float(s) / segments * 6.28318531f;
+			sphere.insert(sphere.end(), {std::sin(theta) * std::cos(phi), std::sin(theta) * std::sin(phi), std::cos(theta)});
+		}
+		auto ringVertex = [&](uint32_t r, uint32_t s){return 2 + (r-1) * segments + s % segments;};
+		std::vector<uint32_t> sphereIndices {};
+		for (uint32_t s = 0; s < segments; ++s) {
+			sphereIndices.insert(sphereIndices.end(), {0, ringVertex(1, s), ringVertex(1, s+1)});
+			sphereIndices.insert(sphereIndices.end(), {1, ringVertex(rings-1, s+1), ringVertex(rings-1, s)});
+			for (uint32_t r = 1; r < rings-1; ++r) {
+				sphereIndices.insert(sphereIndices.end(), {ringVertex(r, s), ringVertex(r+1, s), ringVertex(r+1, s+1)});
+				sphereIndices.insert(sphereIndices.end(), {ringVertex(r, s), ringVertex(r+1, s+1), ringVertex(r, s+1)});
+			}
+		}
+		const size_t sphereVertexCount = sphere.size() / 3;
+
+		{// Test 1 (flat grid simplifies to almost nothing without error and keeps its borders)
+			std::vector<uint32_t> result(gridIndices.size());
+			float error = -1;
+			size_t count = SimplifyMesh(result.data(), gridIndices.data(), gridIndices.size(), grid.data(), 12, gridVertexCount, 0, 0.001f, &error);
+			result.resize(count);
+			if (count == 0 || count > 8*3 || error < 0 || error > 0.001f) {
+				LOG_ERROR("v4d::tests::MeshSimplifier ERROR 1.1 (" << count << " indices, error " << error << ")")
+				return 1;
+			}
+			// the four corners must still be used
+			for (uint32_t corner : {0u, size, size*row, size*row + size}) {
+				if (std::find(result.begin(), result.end(), corner) == result.end()) {
+					LOG_ERROR("v4d::tests::MeshSimplifier ERROR 1.2 (corner " << corner << " removed)")
+					return 1;
+				}
+			}
+		}
+
+		{// Test 2 (seams are kept, no triangle crosses them)
+			std::vector<uint32_t> result(seamIndices.size());
+			size_t count = SimplifyMesh(result.data(), seamIndices.data(), seamIndices.size(), grid.data(), 12, gridVertexCount, 0, 0.001f);
+			result.resize(count);
+			if (count == 0 || count > seamIndices.size() / 4) {
+				LOG_ERROR("v4d::tests::MeshSimplifier ERROR 2.1 (" << count << " indices)")
+				return 2;
+			}
+			for (size_t t = 0; t < count / 3; ++t) {
+				bool left = false, right = false;
+				for (int k = 0; k < 3; ++k) {
+					uint32_t v = result[t*3+k];
+					if (v >= seamFirstVertex || v % row > size/2) right = true;
+					else if (v % row < size/2) left = true;
+				}
+				if (left && right) {
+					LOG_ERROR("v4d::tests::MeshSimplifier ERROR 2.2 (triangle " << t << " crosses the seam)")
+					return 2;
+				}
+			}
+			for (uint32_t y = 0; y <= size; ++y) {
+				if (std::find(result.begin(), result.end(), y*row + size/2) == result.end() || std::find(result.begin(), result.end(), seamFirstVertex + y) == result.end()) {
+					LOG_ERROR("v4d::tests::MeshSimplifier ERROR 2.3 (seam vertex " << y << " removed)")
+					return 2;
+				}
+			}
+		}
+
+		{// Test 3 (triangle count target and error bounds on a curved surface)
+			const float diagonal = std::sqrt(12.0f);
+			std::vector<uint32_t> result(sphereIndices.size());
+			float error = -1;
+			size_t target = sphereIndices.size() / 10;
+			size_t count = SimplifyMesh(result.data(), sphereIndices.data(), sphereIndices.size(), sphere.data(), 12, sphereVertexCount, target, 1.0f, &error);
+			if (count > target || count < target / 2 || error <= 0) {
+				LOG_ERROR("v4d::tests::MeshSimplifier ERROR 3.1 (" << count << " indices for a target of " << target << ", error " << error << ")")
+				return 3;
+			}
+			// Deviation of the triangles from the sphere must be within the reported error
+			float maxDeviation = 0;
+			for (size_t t = 0; t < count / 3; ++t) {
+				glm::vec3 centroid {0};
+				for (int k = 0; k < 3; ++k) centroid += glm::vec3(sphere[result[t*3+k]*3], sphere[result[t*3+k]*3+1], sphere[result[t*3+k]*3+2]) / 3.0f;
+				maxDeviation = std::max(maxDeviation, 1 - glm::length(centroid));
+			}
+			if (maxDeviation > error * 2) {
+				LOG_ERROR("v4d::tests::MeshSimplifier ERROR 3.2 (deviation " << maxDeviation << " for an error of " << error << ")")
+				return 3;
+			}
+			// A tight error limit stops before the target
+			count = SimplifyMesh(result.data(), sphereIndices.data(), sphereIndices.size(), sphere.data(), 12, sphereVertexCount, target, 0.002f, &error);
+			if (count <= target || error > 0.002f * diagonal) {
+				LOG_ERROR("v4d::tests::MeshSimplifier ERROR 3.3 (" << count << " indices, error " << error << ")")
+				return 3;
+			}
+			// 16-bit indices give the same result
+			std::vector<uint16_t> indices16(sphereIndices.begin(), sphereIndices.end()), result16(sphereIndices.size());
+			size_t count16 = SimplifyMesh(result16.data(), indices16.data(), indices16.size(), sphere.data(), 12, sphereVertexCount, target, 0.002f);
+			if (count16 != count || !std::equal(result16.begin(), result16.begin() + count16, result.begin())) {
+				LOG_ERROR("v4d::tests::MeshSimplifier ERROR 3.4 (16-bit indices)")
+				return 3;
+			}
+		}
+
+		{// Test 4 (LOD chain and selection)
+			std::vector<uint32_t> lodIndices {};
+			auto levels = GenerateLodChain(lodIndices, sphereIndices.data(), sphereIndices.size(), sphere.data(), 12, sphereVertexCount, 8, 0.5f, 0.1f);
+			if (levels.size() < 4 || levels[0].indexCount != sphereIndices.size() || !std::equal(sphereIndices.begin(), sphereIndices.end(), lodIndices.begin())) {
+				LOG_ERROR("v4d::tests::MeshSimplifier ERROR 4.1 (" << levels.size() << " levels)")
+				return 4;
+			}
+			for (size_t i = 1; i < levels.size(); ++i) {
+				if (levels[i].firstIndex != levels[i-1].firstIndex + levels[i-1].indexCount || levels[i].indexCount > levels[i-1].indexCount * 0.9f || levels[i].indexCount < levels[i-1].indexCount * 0.4f || levels[i].error < levels[i-1].error) {
+					LOG_ERROR("v4d::tests::MeshSimplifier ERROR 4.2 (level " << i << ": " << levels[i].indexCount << " indices, error " << levels[i].error << ")")
+					return 4;
+				}
+			}
+			if (lodIndices.size() != levels.back().firstIndex + levels.back().indexCount) {
+				LOG_ERROR("v4d::tests::MeshSimplifier ERROR 4.3")
+				return 4;
+			}
+			// 1080p at 60 degrees, within a pixel
+			const float projectionScale = 1080 / (2 * std::tan(0.5236f));
+			size_t previous = 0;
+			for (float distance : {0.0f, 1.0f, 10.0f, 100.0f, 1000.0f, 100000.0f}) {
+				size_t level = SelectLod(levels.data(), levels.size(), distance, projectionScale, 1.0f);
+				if (level < previous || (level > 0 && levels[level].error * projectionScale / distance > 1.0f)) {
+					LOG_ERROR("v4d::tests::MeshSimplifier ERROR 4.4 (level " << level << " at distance " << distance << ")")
+					return 4;
+				}
+				previous = level;
+			}
+			if (SelectLod(levels.data(), levels.size(), 0.0f, projectionScale, 1.0f) != 0 || SelectLod(levels.data(), levels.size(), 100000.0f, projectionScale, 1.0f) != levels.size() - 1) {
+				LOG_ERROR("v4d::tests::MeshSimplifier ERROR 4.5")
+				return 4;
+			}
+		}
+
+		return 0;
+	}
+}
@@ -0,0 +1,53 @@
+/*
+ * Quadric error mesh simplification and LOD chain generation
+ * Part of the Vulkan4D open-source game engine under the LGPL license - https://github.com/Vulkan4D
+ *
+ * Simplification collapses edges onto existing vertices, so only the indices change and all levels share the same vertex buffer.
+ * Vertices that share a position with other vertices (UV or normal seams) are never moved, and open borders only collapse along themselves.
+ * Errors are geometric deviations in position units, LOD levels can then be selected with SelectLod() from their projected size on screen.
+ */
+#pragma once
+
+#include <v4d.h>
+#include <vector>
+
+#ifndef V4D_MESH_LOD_MAX_LEVELS
+	#define V4D_MESH_LOD_MAX_LEVELS 8 // including the full resolution level
+#endif
+#ifndef V4D_MESH_LOD_REDUCTION
+	#define V4D_MESH_LOD_REDUCTION 0.5f // target index count of each level relative to the previous one
+#endif
+#ifndef V4D_MESH_LOD_MAX_ERROR
+	#define V4D_MESH_LOD_MAX_ERROR 0.05f // relative to the mesh bounding box diagonal
+#endif
+
+namespace v4d::graphics::mesh {
+
+	struct LodLevel {
+		uint32_t firstIndex = 0;
+		uint32_t indexCount = 0;
+		float error = 0; // deviation from the full resolution mesh, in position units
+	};
+
+	/**
+	 * Simplifies a triangle list until it has at most targetIndexCount indices or no edge can be collapsed within targetError (relative to the mesh bounding box diagonal)
+	 * destination must have room for indexCount indices and may be the same as indices, returns the resulting index count
+	 * positions are 3 floats every positionStride bytes, resultError receives the deviation in position units
+	 */
+	V4DLIB size_t SimplifyMesh(uint32_t* destination, const uint32_t* indices, size_t indexCount, const float* positions, size_t positionStride, size_t vertexCount, size_t targetIndexCount, float targetError, float* resultError = nullptr);
+	V4DLIB size_t SimplifyMesh(uint16_t* destination, const uint16_t* indices, size_t indexCount, const float* positions, size_t positionStride, size_t vertexCount, size_t targetIndexCount, float targetError, float* resultError = nullptr);
+
+	/**
+	 * Generates progressively coarser levels of a triangle list, all appended to lodIndices
+	 * The first level is a copy of the given indices, the following ones each target reduction times the previous index count
+	 * Stops at maxLevels, or when a level would exceed maxError (relative to the mesh bounding box diagonal) or not reduce the mesh significantly
+	 */
+	V4DLIB std::vector<LodLevel> GenerateLodChain(std::vector<uint32_t>& lodIndices, const uint32_t* indices, size_t indexCount, const float* positions, size_t positionStride, size_t vertexCount, size_t maxLevels = V4D_MESH_LOD_MAX_LEVELS, float reduction = V4D_MESH_LOD_REDUCTION, float maxError = V4D_MESH_LOD_MAX_ERROR);
+	V4DLIB std::vector<LodLevel> GenerateLodChain(std::vector<uint16_t>& lodIndices, const uint16_t* indices, size_t indexCount, const float* positions, size_t positionStride, size_t vertexCount, size_t maxLevels = V4D_MESH_LOD_MAX_LEVELS, float reduction = V4D_MESH_LOD_REDUCTION, float maxError = V4D_MESH_LOD_MAX_ERROR);
+
+	/**
+	 * Returns the coarsest level whose error projects to at most maxPixelError pixels at the given distance
+	 * projectionScale is viewportHeight / (2 * tan(fovY / 2)), levels must be ordered from the finest
+	 */
+	V4DLIB size_t SelectLod(const LodLevel* levels, size_t levelCount, float distance, float projectionScale, float maxPixelError);
+}
@@ -0,0 +1,42 @@
+#include <v4d.h>
+#include "helpers/Benchmark.hpp"
+#include "utilities/graphics/Meshlets.h"
+#include "utilities/graphics/MeshOptimizer.h"
+
+namespace v4d::benchmarks {
+	void Meshlets() {
+		using v4d::Benchmark;
+		using namespace v4d::graphics::mesh;
+
+		// Grid of 708*708 quads (1M triangles) on a wavy surface, vertex cache optimized as MeshFile does before building meshlets
+		const uint32_t size = 708, vertexCount = (size+1)*(size+1);
+		std::vector<float> positions {};
+		positions.reserve(vertexCount * 3);
+		for (uint32_t y = 0; y <= size; ++y) for (uint32_t x = 0; x <= size; ++x) positions.insert(positions.end(), {float(x), float(y), std::sin(x * 0.1f) * std::cos(y * 0.1f) * 5.0f});
+		std::vector<uint32_t> indices {};
+		indices.reserve(size * size * 6);
+		for (uint32_t y = 0; y < size; ++y) for (uint32_t x = 0; x < size; ++x) {
+			uint32_t v = y*(size+1) + x;
+			indices.insert(indices.end(), {v, v+1, v+size+1, v+1, v+size+2, v+size+1});
+		}
+		OptimizeVertexCache(indices.data(), indices.size(), vertexCount);
+		const size_t triangleCount = indices.size() / 3;
+
+		{
+			auto result = BuildMeshlets(indices.data(), indices.size(), positions.data(), 12, vertexCount);
+			size_t backfacing = 0;
+			for (auto& bounds : result.bounds) backfacing += bounds.IsBackfacing(glm::vec3(size / 2, size / 2, -100));
+			LOG("    Meshlets 1M triangles: " << result.meshlets.size() << " meshlets, " << (float(triangleCount) / result.meshlets.size()) << " triangles and " << (float(result.vertices.size()) / result.meshlets.size()) << " vertices per meshlet, " << backfacing << " culled from below")
+		}
+
+		Benchmark::Run("Meshlets BuildMeshlets 1M triangles 64/124", [&]{
+			auto result = BuildMeshlets(indices.data(), indices.size(), positions.data(), 12, vertexCount, 64, 124);
+			Benchmark::DoNotOptimize(result.meshlets.size());
+		}, double(indices.size() * sizeof(uint32_t)));
+
+		Benchmark::Run("Meshlets BuildMeshlets 1M triangles 128/256", [&]{
+			auto result = BuildMeshlets(indices.data(), indices.size(), positions.data(), 12, vertexCount, 128, 256);
+			Benchmark::DoNotOptimize(result.meshlets.size());
+		}, double(indices.size() * sizeof(uint32_t)));
+	}
+}
@@ -0,0 +1,139 @@
+#include "Meshlets.h"
+#include <algorithm>
+#include <cmath>
+
+namespace v4d::graphics::mesh {
+
+static constexpr uint16_t NO_LOCAL_INDEX = 0xffff;
+static constexpr size_t MAX_VERTICES_PER_MESHLET = 256;
+static constexpr size_t MAX_TRIANGLES_PER_MESHLET = 512;
+
+template<typename Position>
+static MeshletBounds ComputeBounds(const Meshlets& result, const Meshlet& meshlet, Position position) {
+	MeshletBounds bounds {};
+	const uint8_t* triangles = &result.triangles[meshlet.firstTriangle * 3];
+
+	// Gather the positions once, all passes below would otherwise fetch them scattered through the whole vertex buffer
+	float points[MAX_VERTICES_PER_MESHLET][3];
+	for (uint32_t i = 0; i < meshlet.vertexCount; ++i) {
+		glm::vec3 p = position(result.vertices[meshlet.firstVertex + i]);
+		points[i][0] = p.x; points[i][1] = p.y; points[i][2] = p.z;
+	}
+	auto point = [&points](uint32_t i){return glm::vec3(points[i][0], points[i][1], points[i][2]);};
+
+	// Bounding sphere (Ritter), from the two farthest points found in two passes, then grown to include all vertices
+	auto farthest = [&](const glm::vec3& from){
+		glm::vec3 farthestPoint = from;
+		float distance = 0;
+		for (uint32_t i = 0; i < meshlet.vertexCount; ++i) {
+			glm::vec3 p = point(i);
+			float d = glm::dot(p - from, p - from);
+			if (d > distance) {
+				distance = d;
+				farthestPoint = p;
+			}
+		}
+		return farthestPoint;
+	};
+	glm::vec3 a = farthest(point(0));
+	glm::vec3 b = farthest(a);
+	bounds.center = (a + b) * 0.5f;
+	bounds.radius = glm::length(b - a) * 0.5f;
+	for (uint32_t i = 0; i < meshlet.vertexCount; ++i) {
+		glm::vec3 p = point(i);
+		float distance = glm::length(p - bounds.center);
+		if (distance > bounds.radius) {
+			float radius = (bounds.radius + distance) * 0.5f;
+			bounds.center += (p - bounds.center) * ((radius - bounds.radius) / distance);
+			bounds.radius = radius;
+		}
+	}
+
+	// Normal cone, around the average of the triangle normals
+	glm::vec3 normals[MAX_TRIANGLES_PER_MESHLET];
+	const uint32_t triangleCount = meshlet.triangleCount;
+	glm::vec3 axis {0};
+	for (uint32_t t = 0; t < triangleCount; ++t) {
+		glm::vec3 p0 = point(triangles[t*3]), p1 = point(triangles[t*3+1]), p2 = point(triangles[t*3+2]);
+		glm::vec3 normal = glm::cross(p1 - p0, p2 - p0);
+		float length = glm::length(normal);
+		normals[t] = length > 0? normal / length : glm::vec3(0);
+		axis += normals[t];
+	}
+	float axisLength = glm::length(axis);
+	if (axisLength == 0) return bounds;
+	axis /= axisLength;
+	float minDot = 1;
+	for (uint32_t t = 0; t < triangleCount; ++t) {
+		if (normals[t] != glm::vec3(0)) minDot = std::min(minDot, glm::dot(normals[t], axis));
+	}
+	if (minDot <= 0) return bounds; // wider than a hemisphere, some triangles are always visible
+	// The apex is moved back along the axis until it is behind the planes of all triangles
+	float maxT = 0;
+	for (uint32_t t = 0; t < triangleCount; ++t) {
+		if (normals[t] == glm::vec3(0)) continue;
+		float dot = glm::dot(normals[t], axis);
+		maxT = std::max(maxT, glm::dot(bounds.center - point(triangles[t*3]), normals[t]) / dot);
+	}
+	bounds.coneAxis = axis;
+	bounds.coneApex = bounds.center - axis * maxT;
+	bounds.coneCutoff = std::sqrt(1 - minDot * minDot);
+	return bounds;
+}
+
+template<typename T>
+static Meshlets BuildMeshlets(const T* indices, size_t indexCount, const float* positions, size_t positionStride, size_t vertexCount, size_t maxVertices, size_t maxTriangles) {
+	Meshlets result {};
+	maxVertices = std::clamp<size_t>(maxVertices, 3, MAX_VERTICES_PER_MESHLET);
+	maxTriangles = std::clamp<size_t>(maxTriangles, 1, MAX_TRIANGLES_PER_MESHLET);
+	const size_t triangleCount = indexCount / 3;
+	if (triangleCount == 0 || vertexCount == 0) return result;
+
+	auto position = [positions, positionStride](uint32_t v){
+		const float* p = reinterpret_cast<const float*>(reinterpret_cast<const byte*>(positions) + v * positionStride);
+		return glm::vec3(p[0], p[1], p[2]);
+	};
+
+	const size_t estimatedMeshlets = triangleCount / maxTriangles + 1;
+	result.meshlets.reserve(estimatedMeshlets);
+	result.bounds.reserve(estimatedMeshlets);
+	result.vertices.reserve(std::min(triangleCount * 3, estimatedMeshlets * maxVertices));
+	result.triangles.reserve(triangleCount * 3);
+
+	std::vector<uint16_t> localIndex(vertexCount, NO_LOCAL_INDEX);
+	Meshlet meshlet {};
+	auto flush = [&]{
+		if (meshlet.triangleCount == 0) return;
+		for (uint32_t i = 0; i < meshlet.vertexCount; ++i) localIndex[result.vertices[meshlet.firstVertex + i]] = NO_LOCAL_INDEX;
+		result.meshlets.push_back(meshlet);
+		result.bounds.push_back(ComputeBounds(result, meshlet, position));
+		meshlet = {uint32_t(result.vertices.size()), uint32_t(result.triangles.size() / 3), 0, 0};
+	};
+
+	for (size_t t = 0; t < triangleCount; ++t) {
+		const T a = indices[t*3], b = indices[t*3+1], c = indices[t*3+2];
+		size_t newVertices = (localIndex[a] == NO_LOCAL_INDEX)
+			+ (localIndex[b] == NO_LOCAL_INDEX && b != a)
+			+ (localIndex[c] == NO_LOCAL_INDEX && c != a && c != b);
+		if (meshlet.vertexCount + newVertices > maxVertices || meshlet.triangleCount + 1 > maxTriangles) flush();
+		for (T v : {a, b, c}) {
+			if (localIndex[v] == NO_LOCAL_INDEX) {
+				localIndex[v] = uint16_t(meshlet.vertexCount++);
+				result.vertices.push_back(v);
+			}
+			result.triangles.push_back(uint8_t(localIndex[v]));
+		}
+		++meshlet.triangleCount;
+	}
+	flush();
+	return result;
+}
+
+Meshlets BuildMeshlets(const uint32_t* indices, size_t indexCount, const float* positions, size_t positionStride, size_t vertexCount, size_t maxVertices, size_t maxTriangles) {
+	return BuildMeshlets<uint32_t>(indices, indexCount, positions, positionStride, vertexCount, maxVertices, maxTriangles);
+}
+Meshlets BuildMeshlets(const uint16_t* indices, size_t indexCount, const float* positions, size_t positionStride, size_t vertexCount, size_t maxVertices, size_t maxTriangles) {
+	return BuildMeshlets<uint16_t>(indices, indexCount, positions, positionStride, vertexCount, maxVertices, maxTriangles);
+}
+
+}
@@ -0,0 +1,95 @@
+#include <v4d.h>
+#include <algorithm>
+#include <array>
+#include "utilities/graphics/Meshlets.h"
+#include "utilities/graphics/MeshOptimizer.h"
+
+namespace v4d::tests {
+	int Meshlets() {
+		using namespace v4d::graphics::mesh;
+
+		// Grid of size*size quads on the z=0 plane, facing +z
+		const uint32_t size = 40, vertexCount = (size+1)*(size+1);
+		std::vector<float> positions {};
+		for (uint32_t y = 0; y <= size; ++y) for (uint32_t x = 0; x <= size; ++x) positions.insert(positions.end(), {float(x), float(y), 0});
+		std::vector<uint32_t> indices {};
+		for (uint32_t y = 0; y < size; ++y) for (uint32_t x = 0; x < size; ++x) {
+			uint32_t v = y*(size+1) + x;
+			indices.insert(indices.end(), {v, v+1, v+size+1, v+1, v+size+2, v+size+1});
+		}
+		OptimizeVertexCache(indices.data(), indices.size(), vertexCount);
+		auto position = [&](uint32_t v){return glm::vec3(positions[v*3], positions[v*3+1], positions[v*3+2]);};
+
+		auto result = BuildMeshlets(indices.data(), indices.size(), positions.data(), 12, vertexCount, 64, 124);
+
+		{// Test 1 (limits, and all triangles are in meshlets in the same order and winding)
+			if (result.meshlets.size() == 0 || result.bounds.size() != result.meshlets.size() || result.triangles.size() != indices.size()) {
+				LOG_ERROR("v4d::tests::Meshlets ERROR 1.1 (" << result.meshlets.size() << " meshlets)")
+				return 1;
+			}
+			size_t i = 0;
+			for (auto& meshlet : result.meshlets) {
+				if (meshlet.vertexCount > 64 || meshlet.triangleCount > 124 || meshlet.triangleCount == 0) {
+					LOG_ERROR("v4d::tests::Meshlets ERROR 1.2 (" << meshlet.vertexCount << " vertices, " << meshlet.triangleCount << " triangles)")
+					return 1;
+				}
+				for (uint32_t t = 0; t < meshlet.triangleCount * 3; ++t, ++i) {
+					uint8_t local = result.triangles[meshlet.firstTriangle * 3 + t];
+					if (local >= meshlet.vertexCount || result.vertices[meshlet.firstVertex + local] != indices[i]) {
+						LOG_ERROR("v4d::tests::Meshlets ERROR 1.3 (index " << i << ")")
+						return 1;
+					}
+				}
+			}
+			// vertex cache ordered grid, meshlets should be mostly full
+			if (result.vertices.size() > vertexCount * 2 || result.meshlets.size() > indices.size() / 3 / 60) {
+				LOG_ERROR("v4d::tests::Meshlets ERROR 1.4 (" << result.meshlets.size() << " meshlets, " << result.vertices.size() << " vertices)")
+				return 1;
+			}
+		}
+
+		{// Test 2 (bounding spheres contain their vertices)
+			for (size_t m = 0; m < result.meshlets.size(); ++m) {
+				auto& meshlet = result.meshlets[m];
+				auto& bounds = result.bounds[m];
+				for (uint32_t i = 0; i < meshlet.vertexCount; ++i) {
+					if (glm::length(position(result.vertices[meshlet.firstVertex + i]) - bounds.center) > bounds.radius * 1.0001f) {
+						LOG_ERROR("v4d::tests::Meshlets ERROR 2 (meshlet " << m << ")")
+						return 2;
+					}
+				}
+			}
+		}
+
+		{// Test 3 (normal cones)
+			auto& bounds = result.bounds[0];
+			if (bounds.coneCutoff > 0.001f || glm::dot(bounds.coneAxis, glm::vec3(0,0,1)) < 0.999f) {
+				LOG_ERROR("v4d::tests::Meshlets ERROR 3.1 (flat meshlet cone cutoff " << bounds.coneCutoff << ")")
+				return 3;
+			}
+			if (!bounds.IsBackfacing(bounds.center + glm::vec3(0,0,-10)) || bounds.IsBackfacing(bounds.center + glm::vec3(0,0,10)) || bounds.IsBackfacing(bounds.center + glm::vec3(0,100,1))) {
+				LOG_ERROR("v4d::tests::Meshlets ERROR 3.2 (flat meshlet culling)")
+				return 3;
+			}
+			// Closed tetrahedron, always has visible triangles
+			const float tetrahedron[] {0,0,0, 1,0,0, 0,1,0, 0,0,1};
+			const uint16_t tetrahedronIndices[] {0,2,1, 0,1,3, 0,3,2, 1,2,3};
+			auto closed = BuildMeshlets(tetrahedronIndices, 12, tetrahedron, 12, 4);
+			if (closed.meshlets.size() != 1 || closed.bounds[0].coneCutoff != 1 || closed.bounds[0].IsBackfacing(glm::vec3(5,5,5))) {
+				LOG_ERROR("v4d::tests::Meshlets ERROR 3.3 (closed meshlet)")
+				return 3;
+			}
+		}
+
+		{// Test 4 (small limits, degenerate triangles)
+			const uint16_t degenerate[] {0,0,1, 1,2,3, 3,3,3};
+			auto small = BuildMeshlets(degenerate, 9, positions.data(), 12, vertexCount, 3, 1);
+			if (small.meshlets.size() != 3 || small.meshlets[0].vertexCount != 2 || small.meshlets[2].vertexCount != 1) {
+				LOG_ERROR("v4d::tests::Meshlets ERROR 4 (" << small.meshlets.size() << " meshlets)")
+				return 4;
+			}
+		}
+
+		return 0;
+	}
+}
@@ -0,0 +1,55 @@
+/*
+ * Partitioning of triangle lists into small clusters (meshlets) with bounds for culling
+ * Part of the Vulkan4D open-source game engine under the LGPL license - https://github.com/Vulkan4D
+ *
+ * Triangles are added to meshlets in index order, so indices should first be optimized with OptimizeVertexCache() for meshlets to be compact.
+ * Each meshlet has its own list of vertices (indices into the geometry) and its triangles use 8-bit indices into that list.
+ */
+#pragma once
+
+#include <v4d.h>
+#include <vector>
+
+#ifndef V4D_MESHLET_MAX_VERTICES
+	#define V4D_MESHLET_MAX_VERTICES 64 // at most 256
+#endif
+#ifndef V4D_MESHLET_MAX_TRIANGLES
+	#define V4D_MESHLET_MAX_TRIANGLES 124 // at most 512
+#endif
+
+namespace v4d::graphics::mesh {
+
+	struct Meshlet {
+		uint32_t firstVertex = 0; // in Meshlets::vertices
+		uint32_t firstTriangle = 0; // in Meshlets::triangles, divided by 3
+		uint32_t vertexCount = 0;
+		uint32_t triangleCount = 0;
+	};
+
+	struct MeshletBounds {
+		glm::vec3 center {0};
+		float radius = 0;
+		// Normal cone, all triangles are facing away from any point from which the apex is seen within the cone
+		glm::vec3 coneApex {0};
+		glm::vec3 coneAxis {0};
+		float coneCutoff = 1; // sine of the angle between the axis and the widest normal, 1 if the meshlet can never be entirely backfacing
+
+		bool IsBackfacing(const glm::vec3& cameraPosition) const {
+			return coneCutoff < 1 && glm::dot(glm::normalize(coneApex - cameraPosition), coneAxis) >= coneCutoff;
+		}
+	};
+
+	struct Meshlets {
+		std::vector<Meshlet> meshlets {};
+		std::vector<MeshletBounds> bounds {}; // one per meshlet
+		std::vector<uint32_t> vertices {}; // geometry vertex index for each meshlet vertex
+		std::vector<uint8_t> triangles {}; // 3 meshlet vertex indices per triangle
+	};
+
+	/**
+	 * Builds meshlets of at most maxVertices (up to 256) and maxTriangles (up to 512) from a triangle list
+	 * positions are 3 floats every positionStride bytes
+	 */
+	V4DLIB Meshlets BuildMeshlets(const uint32_t* indices, size_t indexCount, const float* positions, size_t positionStride, size_t vertexCount, size_t maxVertices = V4D_MESHLET_MAX_VERTICES, size_t maxTriangles = V4D_MESHLET_MAX_TRIANGLES);
+	V4DLIB Meshlets BuildMeshlets(const uint16_t* indices, size_t indexCount, const float* positions, size_t positionStride, size_t vertexCount, size_t maxVertices = V4D_MESHLET_MAX_VERTICES, size_t maxTriangles = V4D_MESHLET_MAX_TRIANGLES);
+}
@@ -1,6 +1,8 @@
 #include "Renderer.h"
 #include "utilities/graphics/vulkan/DescriptorSetObject.h"
 #include "utilities/graphics/vulkan/raytracing/RayTracingPipeline.h"
+#include "utilities/graphics/vulkan/raytracing/AccelerationStructure.h"
+#include "utilities/processing/Profiler.h"
 
 using namespace v4d::graphics;
 
@@ -93,6 +95,7 @@ void Renderer::CreateDevices() {
 
 void Renderer::DestroyDevices() {
 	renderingDevice->DeviceWaitIdle();
+	raytracing::AccelerationStructure::DestroyPools(renderingDevice);
 	renderingDevice->DestroyAllocator();
 	mainRenderingDevice = nullptr;
 	delete renderingDevice;
@@ -215,67 +218,45 @@ void Renderer::DestroySwapChain() {
 
 #pragma region Init/Load/Reset Methods
 
+void Renderer::WatchShaderFile(const std::string& metaFile, v4d::io::FileWatcher::Callback&& reload) {
+	std::lock_guard lock(shaderFileWatchesMutex);
+	if (!shaderFileWatcher) shaderFileWatcher = v4d::io::FileWatcher::Instance();
+	shaderFileWatches.push_back(shaderFileWatcher->Watch(metaFile, std::forward<v4d::io::FileWatcher::Callback>(reload)));
+}
+
 void Renderer::WatchModifiedShadersForReload(const std::vector<ShaderPipelineMetaFile>& shaderWatchers) {
-	shaderWatcherThreads.emplace_back(std::make_unique<std::thread>([watchers=shaderWatchers,this]() mutable {
-		std::vector<ShaderPipelineObject*> shadersToReload {};
-		std::vector<RayTracingPipeline*> sbtsToReload {};
-		while (state != STATE::NONE) {
-			for (auto& watcher : watchers) {
-				if (watcher.mtime == 0) {
-					watcher.mtime = watcher.file.GetLastWriteTime();
-				} else if (watcher.file.GetLastWriteTime() > watcher.mtime) {
-					watcher.mtime = 0;
-					for (auto* s : watcher.shaders) shadersToReload.push_back(s);
-					if (watcher.sbt) sbtsToReload.push_back(watcher.sbt);
-				}
-			}
-			if (shadersToReload.size() > 0 || sbtsToReload.size() > 0) {
-				RunSynchronized([=,this](){
-					ReloadShaderPipelines();
-					for (auto* s : shadersToReload) s->Reload();
-					for (auto* s : sbtsToReload) s->Reload();
-					LOG("Reloaded modified shaders")
-				});
-				shadersToReload.clear();
-				sbtsToReload.clear();
-			}
-			SLEEP(100ms)
-		}
-	}));
+	for (auto& watcher : shaderWatchers) {
+		WatchShaderFile(watcher.file, [shaders=watcher.shaders, sbt=watcher.sbt, this](const std::string&){
+			RunSynchronized([=,this](){
+				ReloadShaderPipelines();
+				for (auto* s : shaders) s->Reload();
+				if (sbt) sbt->Reload();
+				LOG("Reloaded modified shaders")
+			});
+		});
+	}
 }
 
 void Renderer::WatchModifiedShadersForReload(RayTracingPipeline& rtPipeline) {
-	shaderWatcherThreads.emplace_back(std::make_unique<std::thread>([&rtPipeline,this]() mutable {
-		double rgenModifiedTime = 0;
-		while (state != STATE::NONE) {
-			bool modified = false;
-			{
-				std::lock_guard<std::mutex> lock(rtPipeline.sharedHitGroupsMutex);
-				for (auto& [filePath, hitGroup] : rtPipeline.sharedHitGroups) {
-					if (hitGroup.modifiedTime == 0) {
-						hitGroup.modifiedTime = v4d::io::FilePath(filePath+".meta").GetLastWriteTime();
-					} else if (hitGroup.modifiedTime < v4d::io::FilePath(filePath+".meta").GetLastWriteTime()) {
-						hitGroup.modifiedTime = 0;
-						modified = true;
-					}
-				}
-			}
-			if (rgenModifiedTime == 0) {
-				rgenModifiedTime = ShaderPipelineMetaFile(rtPipeline).file.GetLastWriteTime();
-			} else if (rgenModifiedTime < ShaderPipelineMetaFile(rtPipeline).file.GetLastWriteTime()) {
-				rgenModifiedTime = 0;
-				modified = true;
-			}
-			if (modified) {
-				modified = false;
-				RunSynchronized([&rtPipeline,this](){
-					rtPipeline.Reload();
-					LOG("Reloaded modified ray-tracing shaders")
-				});
-			}
-			SLEEP(100ms)
-		}
-	}));
+	auto reload = [&rtPipeline,this](const std::string&){
+		RunSynchronized([&rtPipeline,this](){
+			rtPipeline.Reload();
+			LOG("Reloaded modified ray-tracing shaders")
+		});
+	};
+	WatchShaderFile(ShaderPipelineMetaFile(rtPipeline).file, reload);
+	std::lock_guard<std::mutex> lock(rtPipeline.sharedHitGroupsMutex);
+	for (auto& [filePath, hitGroup] : rtPipeline.sharedHitGroups) {
+		WatchShaderFile(filePath+".meta", reload);
+	}
+	// Hit groups may also be added later
+	rtPipeline.sharedHitGroupAddedCallback = [reload,this](const std::string& filePath){
+		WatchShaderFile(filePath+".meta", reload);
+	};
+	std::lock_guard watchesLock(shaderFileWatchesMutex);
+	if (std::find(watchedRayTracingPipelines.begin(), watchedRayTracingPipelines.end(), &rtPipeline) == watchedRayTracingPipelines.end()) {
+		watchedRayTracingPipelines.push_back(&rtPipeline);
+	}
 }
 
 void Renderer::RecreateSwapChain() {
@@ -383,6 +364,7 @@ void Renderer::LoadGraphicsToDevice() {
 	LoadScene();
 	
 	currentFrame = 0;
+	retiredFrame = ~0u;
 	state = STATE::LOADED;
 }
 
@@ -405,6 +387,7 @@ void Renderer::UnloadGraphicsFromDevice() {
 }
 
 bool Renderer::BeginFrame(VkSemaphore signalSemaphore, VkFence triggerFence) {
+	V4D_PROFILE_ZONE("Renderer::BeginFrame")
 	state = STATE::RUNNING;
 	
 	BeginFrame:
@@ -412,6 +395,7 @@ bool Renderer::BeginFrame(VkSemaphore signalSemaphore, VkFence triggerFence) {
 	{// Sync queue
 		std::unique_lock lock1(frameSyncMutex);
 		if (!syncQueue.empty()) {
+			V4D_PROFILE_ZONE("Renderer sync queue")
 			lock1.unlock();
 			THREAD_YIELD
 			std::lock_guard lock2(frameSyncMutex2);
@@ -426,13 +410,25 @@ bool Renderer::BeginFrame(VkSemaphore signalSemaphore, VkFence triggerFence) {
 	
 	if (state != STATE::RUNNING) return false;
 	
-	VkResult result = renderingDevice->AcquireNextImageKHR(
-		swapChain->GetHandle(), // swapChain
-		1000UL * 1000 * 5000, // timeout in nanoseconds
-		signalSemaphore,
-		triggerFence,
-		&swapChainImageIndex // output the index of the swapchain image in there
-	);
+	// Free what the previous use of this frame index was the last to use, only once per frame index since BeginFrame() may be called again when it returned false
+	if (retiredFrame != currentFrame) {
+		V4D_PROFILE_ZONE("Renderer retire frame")
+		WaitForFence(frameFences[currentFrame]);
+		RetireFrame(currentFrame);
+		retiredFrame = currentFrame;
+	}
+	
+	VkResult result;
+	{
+		V4D_PROFILE_ZONE("Renderer acquire next image")
+		result = renderingDevice->AcquireNextImageKHR(
+			swapChain->GetHandle(), // swapChain
+			1000UL * 1000 * 5000, // timeout in nanoseconds
+			signalSemaphore,
+			triggerFence,
+			&swapChainImageIndex // output the index of the swapchain image in there
+		);
+	}
 	switch (result) {
 		case VK_SUCCESS: break;
 		case VK_ERROR_OUT_OF_DATE_KHR:
@@ -492,10 +488,14 @@ void Renderer::RecordAndSubmitCommandBuffer(
 			submitInfo.pNext = &timelineSemaphoreSubmit;
 		}
 	
-	CheckVkResult("Reset command buffer", renderingDevice->ResetCommandBuffer(commandBuffer, 0));
-	CheckVkResult("Begin recording command buffer", renderingDevice->BeginCommandBuffer(commandBuffer, &beginInfo));
-		commandsToRecord(commandBuffer);
-	CheckVkResult("End recording command buffer", renderingDevice->EndCommandBuffer(commandBuffer));
+	{
+		V4D_PROFILE_ZONE("Renderer record commands")
+		CheckVkResult("Reset command buffer", renderingDevice->ResetCommandBuffer(commandBuffer, 0));
+		CheckVkResult("Begin recording command buffer", renderingDevice->BeginCommandBuffer(commandBuffer, &beginInfo));
+			commandsToRecord(commandBuffer);
+		CheckVkResult("End recording command buffer", renderingDevice->EndCommandBuffer(commandBuffer));
+	}
+	V4D_PROFILE_ZONE("Renderer queue submit")
 	ResetFence(triggerFence);
 	CheckVkResult("Queue Submit", renderingDevice->QueueSubmit(queue, 1, &submitInfo, triggerFence));
 }
@@ -547,6 +547,7 @@ void Renderer::RecordIfDirtyAndSubmitCommandBuffer(
 	const std::vector<uint64_t> signalTimelineSemaphoreValues
 ){
 	if (commandBuffer.dirty) {
+		V4D_PROFILE_ZONE("Renderer record commands")
 		commandBuffer.dirty = false;
 		
 		assert(waitSemaphores.size() == waitStages.size());
@@ -582,11 +583,18 @@ void Renderer::RecordIfDirtyAndSubmitCommandBuffer(
 			submitInfo.pNext = &timelineSemaphoreSubmit;
 		}
 		
+	V4D_PROFILE_ZONE("Renderer queue submit")
 	ResetFence(triggerFence);
 	CheckVkResult("Queue Submit", renderingDevice->QueueSubmit(commandBuffer.GetQueue().handle, 1, &submitInfo, triggerFence));
 }
 
 bool Renderer::EndFrame(const std::vector<VkSemaphore>& waitSemaphores) {
+	V4D_PROFILE_ZONE("Renderer::EndFrame")
+	
+	// An empty submission signals its fence once everything submitted before it to the queue has completed
+	ResetFence(frameFences[currentFrame]);
+	CheckVkResult("Queue Submit", renderingDevice->QueueSubmit(queues[0][0].handle, 0, nullptr, frameFences[currentFrame]));
+	
 	VkPresentInfoKHR presentInfo = {};
 		presentInfo.sType = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR;
 		presentInfo.waitSemaphoreCount = waitSemaphores.size();
@@ -681,11 +689,22 @@ Renderer::Renderer(Loader* loader, const char* applicationName, uint application
 
 Renderer::~Renderer() {
 	state = STATE::NONE;
-	for (auto& shaderWatcherThread : shaderWatcherThreads) {
-		if (shaderWatcherThread && shaderWatcherThread->joinable()) {
-			shaderWatcherThread->join();
-			shaderWatcherThread.reset();
+	// Unregister the hit group callbacks first, they may add watches until then
+	std::vector<RayTracingPipeline*> rtPipelines {};
+	{
+		std::lock_guard lock(shaderFileWatchesMutex);
+		rtPipelines.swap(watchedRayTracingPipelines);
+	}
+	for (auto* rtPipeline : rtPipelines) {
+		std::lock_guard hitGroupsLock(rtPipeline->sharedHitGroupsMutex);
+		rtPipeline->sharedHitGroupAddedCallback = nullptr;
+	}
+	{
+		std::lock_guard lock(shaderFileWatchesMutex);
+		for (auto id : shaderFileWatches) {
+			shaderFileWatcher->Unwatch(id);
 		}
+		shaderFileWatches.clear();
 	}
 	if (surface) {
 		DestroySurfaceKHR(surface, nullptr);
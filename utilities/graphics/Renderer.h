@@ -6,6 +6,7 @@
 #include <unordered_map>
 #include <string>
 #include <queue>
+#include <mutex>
 
 #include "utilities/graphics/vulkan/Loader.h"
 #include "utilities/graphics/vulkan/Instance.h"
@@ -21,6 +22,7 @@
 #include "utilities/graphics/vulkan/CommonObjects.h"
 #include "utilities/graphics/vulkan/BufferObject.h"
 #include "utilities/graphics/FramebufferedObject.hpp"
+#include "utilities/io/FileWatcher.h"
 
 // Useful macro to be used in ConfigureDeviceFeatures()
 #define V4D_ENABLE_DEVICE_FEATURE(F) \
@@ -77,7 +79,13 @@ namespace v4d::graphics {
 		std::recursive_mutex frameSyncMutex;
 		std::recursive_mutex frameSyncMutex2;
 		std::queue<std::function<void()>> syncQueue {};
-		std::vector<std::unique_ptr<std::thread>> shaderWatcherThreads {};
+		
+		// Shader files watched for modifications (see WatchModifiedShadersForReload)
+		std::shared_ptr<v4d::io::FileWatcher> shaderFileWatcher = nullptr;
+		std::vector<v4d::io::FileWatcher::WatchId> shaderFileWatches {};
+		std::mutex shaderFileWatchesMutex;
+		std::vector<RayTracingPipeline*> watchedRayTracingPipelines {}; // their sharedHitGroupAddedCallback points to this renderer until it is destroyed
+		void WatchShaderFile(const std::string& metaFile, v4d::io::FileWatcher::Callback&& reload);
 		
 		std::vector<const char*> requiredDeviceExtensions {};
 		std::vector<const char*> optionalDeviceExtensions {};
@@ -115,6 +123,14 @@ namespace v4d::graphics {
 		enum class STATE {NONE = 0, INITIALIZED, UNLOADED, LOADED, RUNNING};
 		std::atomic<STATE> state = STATE::NONE;
 		
+		// Uploads, allocated and freed with the other BufferObjects
+		RingStagingBuffer uploadRing {};
+		// Old buffers of BufferObject::Resize() that frames in flight may still use
+		DeferredReleaseQueue deferredReleases {NB_FRAMES_IN_FLIGHT};
+		// Signaled by an empty submission in EndFrame() once the main queue has completed everything submitted during that frame index
+		FenceObject frameFences[NB_FRAMES_IN_FLIGHT] {};
+		uint32_t retiredFrame = ~0u;
+		
 		// Descriptor sets
 		VkDescriptorPool descriptorPool = VK_NULL_HANDLE;
 		
@@ -235,13 +251,15 @@ namespace v4d::graphics {
 			BufferObject::ForEach([this](BufferObject*o){o->Allocate(renderingDevice);});
 		}
 		virtual void DestroyBuffers() {
+			deferredReleases.ReleaseAll();
 			BufferObject::ForEach([](BufferObject*o){o->Free();});
 		}
 		// Textures
 		virtual void LoadTextures() {
 			TextureObject::ForEach([this](TextureObject*tex){
-				tex->Create(renderingDevice);
+				tex->Create(renderingDevice, &uploadRing);
 			});
+			uploadRing.FlushAndWait(queues[0][0]);
 			SamplerObject::ForEach([this](SamplerObject*sampler){
 				sampler->Create(renderingDevice);
 			});
@@ -285,6 +303,13 @@ namespace v4d::graphics {
 			return BeginFrame(VK_NULL_HANDLE, triggerFence);
 		}
 
+		// Called by BeginFrame() once the fence of the previous use of this frame index has been waited for
+		// Only work submitted to the main queue is waited for, uploads and resizes recorded for other queues must be waited for by their module
+		void RetireFrame(uint32_t frameIndex) {
+			deferredReleases.BeginFrame(frameIndex);
+			uploadRing.BeginFrame(frameIndex);
+		}
+		
 		void WaitForFence(VkFence& fence) {
 			if (fence == VK_NULL_HANDLE) return;
 			CheckVkResult("Wait for Fence", renderingDevice->WaitForFences(1, &fence, VK_TRUE, /*timeout*/1000UL * 1000 * V4D_RENDERER_WAIT_FOR_FENCE_GLOBAL_TIMEOUT_MS));
@@ -61,24 +61,11 @@ COMMON_OBJECT_CPP(TextureObject, VkImage)
 		dirty = true;
 	}
 	
-	void TextureObject::Create(Device* device) {
+	void TextureObject::Create(Device* device, RingStagingBuffer* uploadRing) {
 		if (this->device == nullptr || dirty) {
 			this->device = device;
 			dirty = false;
 			
-			VkBufferCreateInfo bufferInfo {};{
-				bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
-				bufferInfo.size = bufferSize;
-				bufferInfo.usage = VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
-				bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
-				bufferInfo.queueFamilyIndexCount = 0;
-				bufferInfo.pQueueFamilyIndices = nullptr;
-			}
-			
-			if (!stagingBuffer) {
-				device->CreateAndAllocateBuffer(bufferInfo, MEMORY_USAGE_CPU_ONLY, stagingBuffer, &stagingBufferAllocation);
-			}
-			
 			if (VkImage(obj) == VK_NULL_HANDLE) {
 				imageInfo.extent.width = uint32_t(width);
 				imageInfo.extent.height = uint32_t(height);
@@ -97,11 +84,53 @@ COMMON_OBJECT_CPP(TextureObject, VkImage)
 						imageInfo.format = VK_FORMAT_R8G8B8A8_UNORM;
 						break;
 				}
-				Instance::CheckVkResult("Create and allocate image", device->CreateAndAllocateImage(imageInfo, memoryUsage, obj, &allocation));
+				Instance::CheckVkResult("Create and allocate image", device->CreateAndAllocateImage(imageInfo, memoryUsage, obj, &allocation, true, "TextureObject"));
 			} else {
 				assert(imageInfo.extent.width == uint32_t(width) && imageInfo.extent.height == uint32_t(height));
 			}
 			
+			VkBufferImageCopy region = {};
+				region.bufferOffset = 0;
+				region.bufferRowLength = 0;
+				region.bufferImageHeight = 0;
+				region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+				region.imageSubresource.mipLevel = 0;
+				region.imageSubresource.baseArrayLayer = 0;
+				region.imageSubresource.layerCount = 1;
+				region.imageOffset = {0, 0, 0};
+				region.imageExtent = imageInfo.extent;
+			
+			if (uploadRing && uploadRing->GetCapacity() >= bufferSize) {// Queue the upload with those of other textures, the ring is flushed by the caller
+				std::lock_guard lock(mu);
+				if (data) {
+					auto before = [this](VkCommandBuffer cmdBuffer){
+						ImageObject::TransitionImageLayout(this->device, cmdBuffer, obj, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, imageInfo.mipLevels, imageInfo.arrayLayers);
+					};
+					auto after = [this](VkCommandBuffer cmdBuffer){
+						if (imageInfo.mipLevels > 1) GenerateMipmaps(cmdBuffer);
+						ImageObject::TransitionImageLayout(this->device, cmdBuffer, obj, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_GENERAL, imageInfo.mipLevels, imageInfo.arrayLayers);
+					};
+					if (uploadRing->UploadToImage(obj, region, data, bufferSize, before, after)) return;
+					// The ring is full, upload what it has so far to make space
+					if (uploadRing->FlushAndWait(device->queues[0][0]) && uploadRing->UploadToImage(obj, region, data, bufferSize, before, after)) return;
+					// Frames in flight are still using the rest of the ring, this texture gets its own staging buffer below
+					LOG_WARN_VERBOSE("Upload ring full, a " << width << "x" << height << " texture uses its own staging buffer")
+				}
+			}
+			
+			VkBufferCreateInfo bufferInfo {};{
+				bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+				bufferInfo.size = bufferSize;
+				bufferInfo.usage = VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
+				bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+				bufferInfo.queueFamilyIndexCount = 0;
+				bufferInfo.pQueueFamilyIndices = nullptr;
+			}
+			
+			if (!stagingBuffer) {
+				device->CreateAndAllocateBuffer(bufferInfo, MEMORY_USAGE_CPU_ONLY, stagingBuffer, &stagingBufferAllocation, false, "TextureObject staging");
+			}
+			
 			{// Copy image data to staging buffer
 				std::lock_guard lock(mu);
 				if (data) {
@@ -116,17 +145,6 @@ COMMON_OBJECT_CPP(TextureObject, VkImage)
 			device->RunSingleTimeCommands(device->queues[0][0], [&](VkCommandBuffer cmdBuffer){
 				ImageObject::TransitionImageLayout(device, cmdBuffer, obj, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, imageInfo.mipLevels, imageInfo.arrayLayers);
 				
-				VkBufferImageCopy region = {};
-					region.bufferOffset = 0;
-					region.bufferRowLength = 0;
-					region.bufferImageHeight = 0;
-					region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-					region.imageSubresource.mipLevel = 0;
-					region.imageSubresource.baseArrayLayer = 0;
-					region.imageSubresource.layerCount = 1;
-					region.imageOffset = {0, 0, 0};
-					region.imageExtent = imageInfo.extent;
-
 				device->CmdCopyBufferToImage(
 					cmdBuffer,
 					stagingBuffer,
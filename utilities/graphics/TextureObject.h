@@ -3,6 +3,7 @@
 #include "stb/stb_image.h"
 #include <v4d.h>
 #include "vulkan/Device.h"
+#include "vulkan/BufferObject.h"
 
 namespace v4d::graphics {
 using namespace vulkan;
@@ -50,7 +51,9 @@ COMMON_OBJECT(TextureObject, VkImage, V4DLIB)
 	
 	~TextureObject();
 	
-	void Create(Device* device);
+	// With an uploadRing, the upload is only queued in it and this texture must stay alive until the ring is flushed
+	// keepStagingBufferAlive is then ignored, unless the ring has no room left and the texture falls back to its own staging buffer
+	void Create(Device* device, RingStagingBuffer* uploadRing = nullptr);
 	void Destroy();
 	void Load(const char* filepath);
 	
@@ -0,0 +1,55 @@
+#include <v4d.h>
+#include <map>
+#include "helpers/Benchmark.hpp"
+#include "utilities/graphics/TransformHierarchy.h"
+
+namespace v4d::benchmarks {
+	void TransformHierarchy() {
+		using v4d::Benchmark;
+		using v4d::graphics::TransformHierarchy;
+
+		// 10k nodes, 100 branches of 100 nested nodes, node ids in reverse order of the hierarchy (children listed first, like some exporters do)
+		const uint32_t count = 10000, depth = 100;
+		std::vector<uint32_t> parents(count);
+		std::vector<glm::dmat4> locals(count);
+		for (uint32_t i = 0; i < count; ++i) {
+			uint32_t level = (count - 1 - i) % depth;
+			parents[i] = level == 0? (i == count - 1? TransformHierarchy::NO_PARENT : count - 1) : i + 1;
+			locals[i] = glm::translate(glm::dmat4(1), glm::dvec3(0.01 * i, 1, 0));
+		}
+
+		// Previous MeshFile implementation, recursive through a std::map for each node
+		std::map<int, int> childParentMap {};
+		for (uint32_t i = 0; i < count; ++i) if (parents[i] != TransformHierarchy::NO_PARENT) childParentMap[i] = parents[i];
+		std::function<glm::dmat4(int)> getAbsoluteTransform = [&](int node){
+			if (childParentMap.contains(node)) return getAbsoluteTransform(childParentMap[node]) * locals[node];
+			return locals[node];
+		};
+		std::vector<glm::dmat4> absolute(count);
+		Benchmark::Run("TransformHierarchy recursive std::map 10k nodes depth 100 (previous)", [&]{
+			for (uint32_t i = 0; i < count; ++i) absolute[i] = getAbsoluteTransform(i);
+			Benchmark::DoNotOptimize(absolute[0]);
+		});
+
+		TransformHierarchy hierarchy;
+		Benchmark::Run("TransformHierarchy Build 10k nodes depth 100", [&]{
+			hierarchy.Build(parents, locals);
+			Benchmark::DoNotOptimize(hierarchy.GetAbsoluteTransform(0));
+		});
+
+		Benchmark::Run("TransformHierarchy UpdateAll 10k nodes", [&]{
+			hierarchy.UpdateAll();
+			Benchmark::DoNotOptimize(hierarchy.GetAbsoluteTransform(0));
+		});
+
+		// One animated node at half the depth of each of 10 branches
+		Benchmark::Run("TransformHierarchy Update 10 animated subtrees of 50 nodes", [&]{
+			for (uint32_t branch = 0; branch < 10; ++branch) {
+				uint32_t node = count - 1 - branch * depth - depth / 2;
+				hierarchy.SetLocalTransform(node, hierarchy.GetLocalTransform(node));
+			}
+			hierarchy.Update();
+			Benchmark::DoNotOptimize(hierarchy.GetAbsoluteTransform(0));
+		});
+	}
+}
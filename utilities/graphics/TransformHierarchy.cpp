@@ -0,0 +1,116 @@
+#include "TransformHierarchy.h"
+#include <algorithm>
+
+using namespace v4d::graphics;
+
+bool TransformHierarchy::Build(const std::vector<uint32_t>& parents, const std::vector<glm::dmat4>& localTransforms) {
+	Clear();
+	const uint32_t count = (uint32_t)parents.size();
+	if (localTransforms.size() != count) {
+		LOG_ERROR("TransformHierarchy: " << localTransforms.size() << " transforms given for " << count << " nodes")
+		return false;
+	}
+
+	// Children of each node, contiguous (CSR)
+	std::vector<uint32_t> firstChild(count + 1, 0);
+	std::vector<uint32_t> children(count);
+	for (uint32_t node = 0; node < count; ++node) {
+		uint32_t parent = parents[node];
+		if (parent == NO_PARENT) continue;
+		if (parent >= count || parent == node) {
+			LOG_ERROR("TransformHierarchy: invalid parent " << parent << " for node " << node)
+			return false;
+		}
+		++firstChild[parent + 1];
+	}
+	for (uint32_t node = 0; node < count; ++node) firstChild[node + 1] += firstChild[node];
+	{
+		std::vector<uint32_t> next(firstChild.begin(), firstChild.end() - 1);
+		for (uint32_t node = 0; node < count; ++node) {
+			if (parents[node] != NO_PARENT) children[next[parents[node]]++] = node;
+		}
+	}
+
+	// Depth-first order
+	order.reserve(count);
+	std::vector<uint32_t> stack {};
+	for (uint32_t root = 0; root < count; ++root) if (parents[root] == NO_PARENT) {
+		stack.push_back(root);
+		while (stack.size() > 0) {
+			uint32_t node = stack.back();
+			stack.pop_back();
+			order.push_back(node);
+			for (uint32_t i = firstChild[node + 1]; i > firstChild[node]; --i) {
+				stack.push_back(children[i - 1]);
+			}
+		}
+	}
+	if (order.size() != count) {
+		LOG_ERROR("TransformHierarchy: " << (count - order.size()) << " nodes are part of a cycle")
+		order.clear();
+		return false;
+	}
+
+	this->parents = parents;
+	this->localTransforms = localTransforms;
+	absoluteTransforms.resize(count);
+	orderIndex.resize(count);
+	subtreeEnd.resize(count);
+	std::vector<uint32_t> subtreeSize(count, 1);
+	for (uint32_t i = count; i > 0; --i) {
+		uint32_t node = order[i - 1];
+		orderIndex[node] = i - 1;
+		subtreeEnd[i - 1] = i - 1 + subtreeSize[node];
+		if (parents[node] != NO_PARENT) subtreeSize[parents[node]] += subtreeSize[node];
+	}
+
+	UpdateAll();
+	return true;
+}
+
+void TransformHierarchy::Clear() {
+	parents.clear();
+	localTransforms.clear();
+	absoluteTransforms.clear();
+	orderIndex.clear();
+	order.clear();
+	subtreeEnd.clear();
+	dirtyNodes.clear();
+}
+
+void TransformHierarchy::UpdateSubtree(uint32_t begin, uint32_t end) {
+	// The parent of the first node is outside of the range and already up to date
+	for (uint32_t i = begin; i < end; ++i) {
+		uint32_t node = order[i];
+		uint32_t parent = parents[node];
+		absoluteTransforms[node] = parent == NO_PARENT? localTransforms[node] : absoluteTransforms[parent] * localTransforms[node];
+	}
+}
+
+void TransformHierarchy::SetLocalTransform(uint32_t node, const glm::dmat4& transform) {
+	localTransforms[node] = transform;
+	dirtyNodes.push_back(node);
+}
+
+void TransformHierarchy::Update() {
+	if (dirtyNodes.size() == 0) return;
+	if (dirtyNodes.size() > order.size() / 4) {
+		// Sorting would cost more than updating everything
+		UpdateAll();
+		return;
+	}
+	for (auto& node : dirtyNodes) node = orderIndex[node];
+	std::sort(dirtyNodes.begin(), dirtyNodes.end());
+	uint32_t updatedEnd = 0;
+	for (uint32_t begin : dirtyNodes) {
+		if (begin < updatedEnd) continue; // within a subtree that was just updated
+		updatedEnd = subtreeEnd[begin];
+		UpdateSubtree(begin, updatedEnd);
+	}
+	dirtyNodes.clear();
+}
+
+void TransformHierarchy::UpdateAll() {
+	UpdateSubtree(0, (uint32_t)order.size());
+	dirtyNodes.clear();
+}
@@ -0,0 +1,97 @@
+#include <v4d.h>
+#include <map>
+#include "utilities/graphics/TransformHierarchy.h"
+
+namespace v4d::tests {
+	int TransformHierarchy() {
+		using v4d::graphics::TransformHierarchy;
+		const uint32_t NO_PARENT = TransformHierarchy::NO_PARENT;
+
+		// Reference, multiplying matrices up to the root for each node
+		auto absoluteTransform = [](const std::vector<uint32_t>& parents, const std::vector<glm::dmat4>& locals, uint32_t node){
+			glm::dmat4 transform = locals[node];
+			for (uint32_t parent = parents[node]; parent != NO_PARENT; parent = parents[parent]) transform = locals[parent] * transform;
+			return transform;
+		};
+		auto matches = [&](const TransformHierarchy& hierarchy, const std::vector<uint32_t>& parents, const std::vector<glm::dmat4>& locals){
+			for (uint32_t node = 0; node < parents.size(); ++node) {
+				glm::dmat4 expected = absoluteTransform(parents, locals, node);
+				for (int c = 0; c < 4; ++c) for (int r = 0; r < 4; ++r) {
+					if (std::abs(hierarchy.GetAbsoluteTransform(node)[c][r] - expected[c][r]) > 1e-9) return false;
+				}
+			}
+			return true;
+		};
+
+		// Two roots, children listed before their parents
+		//   5 -> 0 -> 3 -> 1
+		//          -> 4
+		//   2 -> 6
+		std::vector<uint32_t> parents {5, 3, NO_PARENT, 0, 0, NO_PARENT, 2};
+		std::vector<glm::dmat4> locals {};
+		for (uint32_t i = 0; i < parents.size(); ++i) {
+			locals.push_back(glm::scale(glm::translate(glm::dmat4(1), glm::dvec3(i, 2.0 * i, -1.0 * i)), glm::dvec3(1.0 + 0.1 * i)));
+		}
+
+		TransformHierarchy hierarchy;
+		{// Test 1 (absolute transforms)
+			if (!hierarchy.Build(parents, locals) || !matches(hierarchy, parents, locals)) {
+				LOG_ERROR("v4d::tests::TransformHierarchy ERROR 1 (absolute transforms)")
+				return 1;
+			}
+		}
+
+		{// Test 2 (parents before children and contiguous subtrees)
+			const auto& order = hierarchy.GetOrder();
+			for (uint32_t node = 0; node < parents.size(); ++node) {
+				if (order[hierarchy.GetOrderIndex(node)] != node || (parents[node] != NO_PARENT && hierarchy.GetOrderIndex(parents[node]) >= hierarchy.GetOrderIndex(node))) {
+					LOG_ERROR("v4d::tests::TransformHierarchy ERROR 2.1 (order)")
+					return 2;
+				}
+			}
+			if (hierarchy.GetSubtreeEnd(5) - hierarchy.GetOrderIndex(5) != 5 || hierarchy.GetSubtreeEnd(3) - hierarchy.GetOrderIndex(3) != 2 || hierarchy.GetSubtreeEnd(6) - hierarchy.GetOrderIndex(6) != 1) {
+				LOG_ERROR("v4d::tests::TransformHierarchy ERROR 2.2 (subtree ranges)")
+				return 2;
+			}
+		}
+
+		{// Test 3 (only modified subtrees are updated)
+			const glm::dmat4 node4 = hierarchy.GetAbsoluteTransform(4);
+			const glm::dmat4 node6 = hierarchy.GetAbsoluteTransform(6);
+			locals[3] = glm::translate(glm::dmat4(1), glm::dvec3(10, 0, 0));
+			locals[1] = glm::scale(glm::dmat4(1), glm::dvec3(3));
+			hierarchy.SetLocalTransform(3, locals[3]);
+			hierarchy.SetLocalTransform(1, locals[1]);
+			hierarchy.SetLocalTransform(3, locals[3]);
+			if (!hierarchy.IsDirty()) {
+				LOG_ERROR("v4d::tests::TransformHierarchy ERROR 3.1 (not dirty)")
+				return 3;
+			}
+			hierarchy.Update();
+			if (hierarchy.IsDirty() || !matches(hierarchy, parents, locals) || !(hierarchy.GetAbsoluteTransform(4) == node4) || !(hierarchy.GetAbsoluteTransform(6) == node6)) {
+				LOG_ERROR("v4d::tests::TransformHierarchy ERROR 3.2 (dirty subtree update)")
+				return 3;
+			}
+			locals[2] = glm::translate(glm::dmat4(1), glm::dvec3(0, 5, 0));
+			hierarchy.SetLocalTransform(2, locals[2]);
+			hierarchy.Update();
+			if (!matches(hierarchy, parents, locals)) {
+				LOG_ERROR("v4d::tests::TransformHierarchy ERROR 3.3 (root update)")
+				return 3;
+			}
+		}
+
+		{// Test 4 (invalid hierarchies)
+			if (hierarchy.Build({1, 2, 0}, std::vector<glm::dmat4>(3, glm::dmat4(1))) || hierarchy.GetNodeCount() != 0) {
+				LOG_ERROR("v4d::tests::TransformHierarchy ERROR 4.1 (cycle)")
+				return 4;
+			}
+			if (hierarchy.Build({NO_PARENT, 7}, std::vector<glm::dmat4>(2, glm::dmat4(1)))) {
+				LOG_ERROR("v4d::tests::TransformHierarchy ERROR 4.2 (invalid parent)")
+				return 4;
+			}
+		}
+
+		return 0;
+	}
+}
@@ -0,0 +1,69 @@
+/*
+ * Flattened node transform hierarchy
+ * Part of the Vulkan4D open-source game engine under the LGPL license - https://github.com/Vulkan4D
+ *
+ * Nodes are identified by their index (ie: glTF node index) and all arrays are indexed by node id.
+ * Nodes are also kept in depth-first order so that each subtree is a contiguous range, absolute transforms are computed in a single pass over that order,
+ * and modifying the local transform of an animated node only recomputes its own subtree on the next Update().
+ */
+#pragma once
+
+#include <v4d.h>
+#include <vector>
+
+namespace v4d::graphics {
+	class V4DLIB TransformHierarchy {
+	public:
+		static constexpr uint32_t NO_PARENT = ~0u;
+
+	private:
+		// Indexed by node id
+		std::vector<uint32_t> parents {};
+		std::vector<glm::dmat4> localTransforms {};
+		std::vector<glm::dmat4> absoluteTransforms {};
+		std::vector<uint32_t> orderIndex {}; // index of the node in order
+
+		// Depth-first order, parents before their children
+		std::vector<uint32_t> order {};
+		std::vector<uint32_t> subtreeEnd {}; // index in order after the last node of the subtree
+
+		std::vector<uint32_t> dirtyNodes {};
+
+		void UpdateSubtree(uint32_t begin, uint32_t end);
+
+	public:
+		TransformHierarchy() = default;
+
+		/**
+		 * parents[i] is the id of the parent of node i, or NO_PARENT for root nodes
+		 * Returns false if a parent id is invalid or the hierarchy has a cycle, in which case it is left empty
+		 */
+		bool Build(const std::vector<uint32_t>& parents, const std::vector<glm::dmat4>& localTransforms);
+
+		void Clear();
+
+		size_t GetNodeCount() const {return parents.size();}
+		uint32_t GetParent(uint32_t node) const {return parents[node];}
+		const glm::dmat4& GetLocalTransform(uint32_t node) const {return localTransforms[node];}
+
+		// Valid after Build() and Update()
+		const glm::dmat4& GetAbsoluteTransform(uint32_t node) const {return absoluteTransforms[node];}
+		const std::vector<glm::dmat4>& GetAbsoluteTransforms() const {return absoluteTransforms;}
+
+		// Depth-first order of the nodes, the subtree of a node is [OrderIndex(node), GetSubtreeEnd(node))
+		const std::vector<uint32_t>& GetOrder() const {return order;}
+		uint32_t GetOrderIndex(uint32_t node) const {return orderIndex[node];}
+		uint32_t GetSubtreeEnd(uint32_t node) const {return subtreeEnd[orderIndex[node]];}
+
+		// Marks the subtree of this node to be updated
+		void SetLocalTransform(uint32_t node, const glm::dmat4& transform);
+
+		bool IsDirty() const {return dirtyNodes.size() > 0;}
+
+		// Recomputes absolute transforms of modified subtrees only
+		void Update();
+
+		// Recomputes all absolute transforms
+		void UpdateAll();
+	};
+}
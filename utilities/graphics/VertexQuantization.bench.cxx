@@ -0,0 +1,72 @@
+#include <v4d.h>
+#include "helpers/Benchmark.hpp"
+#include "utilities/graphics/VertexQuantization.h"
+
+namespace v4d::benchmarks {
+	void VertexQuantization() {
+		using v4d::Benchmark;
+		using namespace v4d::graphics::mesh;
+
+		// 1M vertices with all attributes
+		const size_t count = 1 << 20;
+		std::vector<float> positions(count * 3), normals(count * 3), tangents(count * 4), uvs(count * 2), colors(count * 4);
+		for (size_t i = 0; i < count; ++i) {
+			float a = float(i) * 0.001f, b = float(i) * 0.0007f;
+			glm::vec3 n(std::cos(a) * std::sin(b), std::sin(a) * std::sin(b), std::cos(b));
+			positions[i*3] = n.x * 10; positions[i*3+1] = n.y * 10; positions[i*3+2] = n.z * 10 + float(i % 7);
+			normals[i*3] = n.x; normals[i*3+1] = n.y; normals[i*3+2] = n.z;
+			tangents[i*4] = -n.y; tangents[i*4+1] = n.x; tangents[i*4+2] = 0; tangents[i*4+3] = (i & 1)? 1.0f : -1.0f;
+			if (tangents[i*4] == 0 && tangents[i*4+1] == 0) tangents[i*4] = 1;
+			float l = std::sqrt(tangents[i*4]*tangents[i*4] + tangents[i*4+1]*tangents[i*4+1]);
+			tangents[i*4] /= l; tangents[i*4+1] /= l;
+			uvs[i*2] = float(i % 1024) / 1024; uvs[i*2+1] = float(i / 1024) / 1024;
+			colors[i*4] = uvs[i*2]; colors[i*4+1] = uvs[i*2+1]; colors[i*4+2] = 0.5f; colors[i*4+3] = 1;
+		}
+
+		const size_t floatSize = sizeof(float) * (3 + 3 + 4 + 2 + 4);
+		const size_t quantizedSize = sizeof(VertexPositionU16Vec4) + sizeof(VertexNormalOctI16Vec2) + sizeof(VertexTangentOctI8Vec4) + sizeof(VertexUvF16Vec2) + sizeof(VertexColorU8Vec4);
+		LOG("    VertexQuantization vertex size: " << floatSize << " bytes as floats, " << quantizedSize << " bytes quantized")
+
+		std::vector<VertexPositionU16Vec4> quantizedPositions(count);
+		std::vector<VertexNormalOctI16Vec2> quantizedNormals(count);
+		std::vector<VertexTangentOctI8Vec4> quantizedTangents(count);
+		std::vector<VertexUvF16Vec2> halfUvs(count);
+		std::vector<VertexUvU16Vec2> unormUvs(count);
+		std::vector<VertexColorU8Vec4> quantizedColors(count);
+		std::vector<float> decoded(count * 4);
+		PositionQuantization quantization {};
+
+		Benchmark::Run("VertexQuantization QuantizePositions 1M", [&]{
+			quantization = QuantizePositions(positions.data(), count, quantizedPositions.data());
+			Benchmark::DoNotOptimize(quantizedPositions[0]);
+		}, double(count * 12));
+		Benchmark::Run("VertexQuantization DequantizePositions 1M", [&]{
+			DequantizePositions(quantizedPositions.data(), count, quantization, decoded.data());
+			Benchmark::DoNotOptimize(decoded[0]);
+		}, double(count * 12));
+		Benchmark::Run("VertexQuantization EncodeNormals 1M", [&]{
+			EncodeNormals(normals.data(), count, quantizedNormals.data());
+			Benchmark::DoNotOptimize(quantizedNormals[0]);
+		}, double(count * 12));
+		Benchmark::Run("VertexQuantization DecodeNormals 1M", [&]{
+			DecodeNormals(quantizedNormals.data(), count, decoded.data());
+			Benchmark::DoNotOptimize(decoded[0]);
+		}, double(count * 12));
+		Benchmark::Run("VertexQuantization EncodeTangents 1M", [&]{
+			EncodeTangents(tangents.data(), count, quantizedTangents.data());
+			Benchmark::DoNotOptimize(quantizedTangents[0]);
+		}, double(count * 16));
+		Benchmark::Run("VertexQuantization EncodeUvs half 1M", [&]{
+			EncodeUvs(uvs.data(), count, halfUvs.data());
+			Benchmark::DoNotOptimize(halfUvs[0]);
+		}, double(count * 8));
+		Benchmark::Run("VertexQuantization EncodeUvs unorm16 1M", [&]{
+			EncodeUvs(uvs.data(), count, unormUvs.data());
+			Benchmark::DoNotOptimize(unormUvs[0]);
+		}, double(count * 8));
+		Benchmark::Run("VertexQuantization EncodeColors 1M", [&]{
+			EncodeColors(colors.data(), count, quantizedColors.data());
+			Benchmark::DoNotOptimize(quantizedColors[0]);
+		}, double(count * 16));
+	}
+}
@@ -0,0 +1,345 @@
+#include "VertexQuantization.h"
+#include <algorithm>
+#ifdef __SSE4_1__
+	#include <immintrin.h>
+#endif
+
+namespace v4d::graphics::mesh {
+
+// Single element conversions, also used for the remaining elements of SIMD loops
+
+template<int MAX>
+static inline int32_t QuantizeUnorm(float v) {
+	return int32_t(std::nearbyint(std::clamp(v, 0.0f, 1.0f) * float(MAX)));
+}
+
+template<int MAX>
+static inline int32_t QuantizeSnorm(float v) {
+	return std::clamp(int32_t(std::nearbyint(v * float(MAX))), -MAX, MAX);
+}
+
+template<int MAX>
+static inline float DequantizeSnorm(int32_t v) {
+	return std::max(float(v) / float(MAX), -1.0f);
+}
+
+template<int MAX>
+static inline void EncodeOctahedral(const float* n, int32_t& x, int32_t& y) {
+	glm::vec2 e = OctahedralEncode(glm::vec3(n[0], n[1], n[2]));
+	x = QuantizeSnorm<MAX>(e.x);
+	y = QuantizeSnorm<MAX>(e.y);
+}
+
+template<int MAX>
+static inline void DecodeOctahedral(int32_t x, int32_t y, float* n) {
+	float ex = DequantizeSnorm<MAX>(x), ey = DequantizeSnorm<MAX>(y);
+	float nx = ex, ny = ey, nz = 1 - std::abs(ex) - std::abs(ey);
+	float t = std::max(-nz, 0.0f);
+	nx += nx >= 0? -t : t;
+	ny += ny >= 0? -t : t;
+	float length = std::sqrt(nx*nx + ny*ny + nz*nz);
+	n[0] = nx / length;
+	n[1] = ny / length;
+	n[2] = nz / length;
+}
+
+#ifdef __SSE4_1__
+	// Transposes 4 consecutive vec3 to/from one register per component
+	static inline void LoadVec3x4(const float* p, __m128& x, __m128& y, __m128& z) {
+		__m128 a = _mm_loadu_ps(p), b = _mm_loadu_ps(p + 4), c = _mm_loadu_ps(p + 8); // x0 y0 z0 x1, y1 z1 x2 y2, z2 x3 y3 z3
+		x = _mm_shuffle_ps(a, _mm_shuffle_ps(b, c, _MM_SHUFFLE(0,1,0,2)), _MM_SHUFFLE(2,0,3,0));
+		y = _mm_shuffle_ps(_mm_shuffle_ps(a, b, _MM_SHUFFLE(0,0,0,1)), _mm_shuffle_ps(b, c, _MM_SHUFFLE(0,2,0,3)), _MM_SHUFFLE(2,0,2,0));
+		z = _mm_shuffle_ps(_mm_shuffle_ps(a, b, _MM_SHUFFLE(0,1,0,2)), _mm_shuffle_ps(c, c, _MM_SHUFFLE(0,3,0,0)), _MM_SHUFFLE(2,0,2,0));
+	}
+	static inline void StoreVec3x4(float* p, __m128 x, __m128 y, __m128 z) {
+		__m128 xyLow = _mm_unpacklo_ps(x, y), xyHigh = _mm_unpackhi_ps(x, y); // x0 y0 x1 y1, x2 y2 x3 y3
+		_mm_storeu_ps(p, _mm_shuffle_ps(xyLow, _mm_shuffle_ps(z, xyLow, _MM_SHUFFLE(0,2,0,0)), _MM_SHUFFLE(2,0,1,0)));
+		_mm_storeu_ps(p + 4, _mm_shuffle_ps(_mm_shuffle_ps(xyLow, z, _MM_SHUFFLE(0,1,0,3)), xyHigh, _MM_SHUFFLE(1,0,2,0)));
+		_mm_storeu_ps(p + 8, _mm_shuffle_ps(_mm_shuffle_ps(z, xyHigh, _MM_SHUFFLE(0,2,0,2)), _mm_shuffle_ps(xyHigh, z, _MM_SHUFFLE(0,3,0,3)), _MM_SHUFFLE(2,0,2,0)));
+	}
+
+	static inline __m128 Abs(__m128 v) {return _mm_andnot_ps(_mm_set1_ps(-0.0f), v);}
+	// +1 where v >= 0 (including -0), -1 elsewhere
+	static inline __m128 SignNotZero(__m128 v) {return _mm_blendv_ps(_mm_set1_ps(-1.0f), _mm_set1_ps(1.0f), _mm_cmpge_ps(v, _mm_setzero_ps()));}
+
+	static inline void EncodeOctahedral(__m128 x, __m128 y, __m128 z, __m128& ex, __m128& ey) {
+		__m128 l1 = _mm_add_ps(_mm_add_ps(Abs(x), Abs(y)), Abs(z));
+		__m128 zero = _mm_cmpeq_ps(l1, _mm_setzero_ps());
+		x = _mm_div_ps(x, l1);
+		y = _mm_div_ps(y, l1);
+		__m128 negative = _mm_cmplt_ps(z, _mm_setzero_ps());
+		__m128 one = _mm_set1_ps(1.0f);
+		__m128 fx = _mm_mul_ps(_mm_sub_ps(one, Abs(y)), SignNotZero(x));
+		__m128 fy = _mm_mul_ps(_mm_sub_ps(one, Abs(x)), SignNotZero(y));
+		ex = _mm_andnot_ps(zero, _mm_blendv_ps(x, fx, negative));
+		ey = _mm_andnot_ps(zero, _mm_blendv_ps(y, fy, negative));
+	}
+
+	static inline void DecodeOctahedral(__m128 ex, __m128 ey, __m128& x, __m128& y, __m128& z) {
+		z = _mm_sub_ps(_mm_sub_ps(_mm_set1_ps(1.0f), Abs(ex)), Abs(ey));
+		__m128 t = _mm_max_ps(_mm_sub_ps(_mm_setzero_ps(), z), _mm_setzero_ps());
+		x = _mm_sub_ps(ex, _mm_mul_ps(t, SignNotZero(ex)));
+		y = _mm_sub_ps(ey, _mm_mul_ps(t, SignNotZero(ey)));
+		__m128 length = _mm_sqrt_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(x, x), _mm_mul_ps(y, y)), _mm_mul_ps(z, z)));
+		x = _mm_div_ps(x, length);
+		y = _mm_div_ps(y, length);
+		z = _mm_div_ps(z, length);
+	}
+
+	template<int MAX>
+	static inline __m128i QuantizeSnorm(__m128 v) {
+		__m128i q = _mm_cvtps_epi32(_mm_mul_ps(v, _mm_set1_ps(float(MAX))));
+		return _mm_max_epi32(_mm_min_epi32(q, _mm_set1_epi32(MAX)), _mm_set1_epi32(-MAX));
+	}
+	template<int MAX>
+	static inline __m128 DequantizeSnorm(__m128i v) {
+		return _mm_max_ps(_mm_div_ps(_mm_cvtepi32_ps(v), _mm_set1_ps(float(MAX))), _mm_set1_ps(-1.0f));
+	}
+	template<int MAX>
+	static inline __m128i QuantizeUnorm(__m128 v) {
+		v = _mm_min_ps(_mm_max_ps(v, _mm_setzero_ps()), _mm_set1_ps(1.0f));
+		return _mm_cvtps_epi32(_mm_mul_ps(v, _mm_set1_ps(float(MAX))));
+	}
+#endif
+
+PositionQuantization QuantizePositions(const float* positions, size_t count, VertexPositionU16Vec4* dst) {
+	PositionQuantization quantization {};
+	if (count == 0) return quantization;
+	glm::vec3 min(positions[0], positions[1], positions[2]), max = min;
+	size_t i = 1;
+	#ifdef __SSE4_1__
+		if (count > 1) {
+			__m128 vmin = _mm_loadu_ps(positions), vmax = vmin;
+			for (; i + 1 < count; ++i) {
+				__m128 p = _mm_loadu_ps(positions + i*3);
+				vmin = _mm_min_ps(vmin, p);
+				vmax = _mm_max_ps(vmax, p);
+			}
+			float m[4];
+			_mm_storeu_ps(m, vmin);
+			min = glm::vec3(m[0], m[1], m[2]);
+			_mm_storeu_ps(m, vmax);
+			max = glm::vec3(m[0], m[1], m[2]);
+		}
+	#endif
+	for (; i < count; ++i) {
+		glm::vec3 p(positions[i*3], positions[i*3+1], positions[i*3+2]);
+		min = glm::min(min, p);
+		max = glm::max(max, p);
+	}
+	quantization.offset = min;
+	quantization.scale = (max - min) / 65535.0f;
+	glm::vec3 inverseScale;
+	for (int k = 0; k < 3; ++k) inverseScale[k] = quantization.scale[k] > 0? 1.0f / quantization.scale[k] : 0;
+
+	i = 0;
+	#ifdef __SSE4_1__
+		// Loads 4 floats per position, so the last one is done separately
+		const __m128 offset = _mm_setr_ps(min.x, min.y, min.z, 0), inverse = _mm_setr_ps(inverseScale.x, inverseScale.y, inverseScale.z, 0);
+		for (; i + 1 < count; ++i) {
+			__m128i q = _mm_cvtps_epi32(_mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(positions + i*3), offset), inverse));
+			_mm_storel_epi64(reinterpret_cast<__m128i*>(dst + i), _mm_packus_epi32(q, q));
+		}
+	#endif
+	for (; i < count; ++i) {
+		uint16_t q[3];
+		for (int k = 0; k < 3; ++k) q[k] = uint16_t(std::clamp(int32_t(std::nearbyint((positions[i*3+k] - min[k]) * inverseScale[k])), 0, 65535));
+		dst[i].x = q[0];
+		dst[i].y = q[1];
+		dst[i].z = q[2];
+		dst[i].w = 0;
+	}
+	return quantization;
+}
+
+void DequantizePositions(const VertexPositionU16Vec4* positions, size_t count, const PositionQuantization& quantization, float* dst) {
+	size_t i = 0;
+	#ifdef __SSE4_1__
+		// Stores 4 floats per position, the 4th being overwritten by the next one, so the last one is done separately
+		const __m128 offset = _mm_setr_ps(quantization.offset.x, quantization.offset.y, quantization.offset.z, 0), scale = _mm_setr_ps(quantization.scale.x, quantization.scale.y, quantization.scale.z, 0);
+		for (; i + 1 < count; ++i) {
+			__m128 q = _mm_cvtepi32_ps(_mm_cvtepu16_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(positions + i))));
+			_mm_storeu_ps(dst + i*3, _mm_add_ps(offset, _mm_mul_ps(q, scale)));
+		}
+	#endif
+	for (; i < count; ++i) {
+		dst[i*3+0] = quantization.offset.x + float(positions[i].x) * quantization.scale.x;
+		dst[i*3+1] = quantization.offset.y + float(positions[i].y) * quantization.scale.y;
+		dst[i*3+2] = quantization.offset.z + float(positions[i].z) * quantization.scale.z;
+	}
+}
+
+void EncodeNormals(const float* normals, size_t count, VertexNormalOctI16Vec2* dst) {
+	size_t i = 0;
+	#ifdef __SSE4_1__
+		for (; i + 4 <= count; i += 4) {
+			__m128 x, y, z, ex, ey;
+			LoadVec3x4(normals + i*3, x, y, z);
+			EncodeOctahedral(x, y, z, ex, ey);
+			__m128i qx = QuantizeSnorm<32767>(ex), qy = QuantizeSnorm<32767>(ey);
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_packs_epi32(_mm_unpacklo_epi32(qx, qy), _mm_unpackhi_epi32(qx, qy)));
+		}
+	#endif
+	for (; i < count; ++i) {
+		int32_t x, y;
+		EncodeOctahedral<32767>(normals + i*3, x, y);
+		dst[i].x = int16_t(x);
+		dst[i].y = int16_t(y);
+	}
+}
+
+void DecodeNormals(const VertexNormalOctI16Vec2* normals, size_t count, float* dst) {
+	size_t i = 0;
+	#ifdef __SSE4_1__
+		for (; i + 4 <= count; i += 4) {
+			__m128i packed = _mm_loadu_si128(reinterpret_cast<const __m128i*>(normals + i));
+			__m128 low = DequantizeSnorm<32767>(_mm_cvtepi16_epi32(packed)), high = DequantizeSnorm<32767>(_mm_cvtepi16_epi32(_mm_srli_si128(packed, 8)));
+			__m128 x, y, z;
+			DecodeOctahedral(_mm_shuffle_ps(low, high, _MM_SHUFFLE(2,0,2,0)), _mm_shuffle_ps(low, high, _MM_SHUFFLE(3,1,3,1)), x, y, z);
+			StoreVec3x4(dst + i*3, x, y, z);
+		}
+	#endif
+	for (; i < count; ++i) DecodeOctahedral<32767>(normals[i].x, normals[i].y, dst + i*3);
+}
+
+void EncodeTangents(const float* tangents, size_t count, VertexTangentOctI8Vec4* dst) {
+	size_t i = 0;
+	#ifdef __SSE4_1__
+		for (; i + 4 <= count; i += 4) {
+			__m128 x = _mm_loadu_ps(tangents + i*4), y = _mm_loadu_ps(tangents + i*4 + 4), z = _mm_loadu_ps(tangents + i*4 + 8), w = _mm_loadu_ps(tangents + i*4 + 12);
+			_MM_TRANSPOSE4_PS(x, y, z, w);
+			__m128 ex, ey;
+			EncodeOctahedral(x, y, z, ex, ey);
+			__m128i qx = QuantizeSnorm<127>(ex), qy = QuantizeSnorm<127>(ey), qw = _mm_cvtps_epi32(_mm_mul_ps(SignNotZero(w), _mm_set1_ps(127.0f)));
+			// x0 y0 w0 0 x1 y1 w1 0 ...
+			__m128i xy01 = _mm_unpacklo_epi32(qx, qy), xy23 = _mm_unpackhi_epi32(qx, qy), w01 = _mm_unpacklo_epi32(qw, _mm_setzero_si128()), w23 = _mm_unpackhi_epi32(qw, _mm_setzero_si128());
+			__m128i v01 = _mm_packs_epi32(_mm_unpacklo_epi64(xy01, w01), _mm_unpackhi_epi64(xy01, w01));
+			__m128i v23 = _mm_packs_epi32(_mm_unpacklo_epi64(xy23, w23), _mm_unpackhi_epi64(xy23, w23));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_packs_epi16(v01, v23));
+		}
+	#endif
+	for (; i < count; ++i) {
+		int32_t x, y;
+		EncodeOctahedral<127>(tangents + i*4, x, y);
+		dst[i].x = int8_t(x);
+		dst[i].y = int8_t(y);
+		dst[i].z = tangents[i*4+3] >= 0? 127 : -127;
+		dst[i].w = 0;
+	}
+}
+
+void DecodeTangents(const VertexTangentOctI8Vec4* tangents, size_t count, float* dst) {
+	size_t i = 0;
+	#ifdef __SSE4_1__
+		for (; i + 4 <= count; i += 4) {
+			__m128i packed = _mm_loadu_si128(reinterpret_cast<const __m128i*>(tangents + i));
+			// Deinterleave the bytes into x0-3 y0-3 w0-3
+			__m128i components = _mm_shuffle_epi8(packed, _mm_setr_epi8(0,4,8,12, 1,5,9,13, 2,6,10,14, 3,7,11,15));
+			__m128 ex = DequantizeSnorm<127>(_mm_cvtepi8_epi32(components));
+			__m128 ey = DequantizeSnorm<127>(_mm_cvtepi8_epi32(_mm_srli_si128(components, 4)));
+			__m128 w = DequantizeSnorm<127>(_mm_cvtepi8_epi32(_mm_srli_si128(components, 8)));
+			__m128 x, y, z;
+			DecodeOctahedral(ex, ey, x, y, z);
+			_MM_TRANSPOSE4_PS(x, y, z, w);
+			_mm_storeu_ps(dst + i*4, x);
+			_mm_storeu_ps(dst + i*4 + 4, y);
+			_mm_storeu_ps(dst + i*4 + 8, z);
+			_mm_storeu_ps(dst + i*4 + 12, w);
+		}
+	#endif
+	for (; i < count; ++i) {
+		DecodeOctahedral<127>(tangents[i].x, tangents[i].y, dst + i*4);
+		dst[i*4+3] = DequantizeSnorm<127>(tangents[i].z);
+	}
+}
+
+void EncodeUvs(const float* uvs, size_t count, VertexUvF16Vec2* dst) {
+	size_t i = 0;
+	#ifdef __F16C__
+		for (; i + 2 <= count; i += 2) {
+			_mm_storel_epi64(reinterpret_cast<__m128i*>(dst + i), _mm_cvtps_ph(_mm_loadu_ps(uvs + i*2), _MM_FROUND_TO_NEAREST_INT));
+		}
+	#endif
+	for (; i < count; ++i) {
+		dst[i].s = FloatToHalf(uvs[i*2]);
+		dst[i].t = FloatToHalf(uvs[i*2+1]);
+	}
+}
+
+void DecodeUvs(const VertexUvF16Vec2* uvs, size_t count, float* dst) {
+	size_t i = 0;
+	#ifdef __F16C__
+		for (; i + 2 <= count; i += 2) {
+			_mm_storeu_ps(dst + i*2, _mm_cvtph_ps(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(uvs + i))));
+		}
+	#endif
+	for (; i < count; ++i) {
+		dst[i*2] = HalfToFloat(uvs[i].s);
+		dst[i*2+1] = HalfToFloat(uvs[i].t);
+	}
+}
+
+void EncodeUvs(const float* uvs, size_t count, VertexUvU16Vec2* dst) {
+	size_t i = 0;
+	#ifdef __SSE4_1__
+		for (; i + 4 <= count; i += 4) {
+			__m128i low = QuantizeUnorm<65535>(_mm_loadu_ps(uvs + i*2)), high = QuantizeUnorm<65535>(_mm_loadu_ps(uvs + i*2 + 4));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_packus_epi32(low, high));
+		}
+	#endif
+	for (; i < count; ++i) {
+		dst[i].s = uint16_t(QuantizeUnorm<65535>(uvs[i*2]));
+		dst[i].t = uint16_t(QuantizeUnorm<65535>(uvs[i*2+1]));
+	}
+}
+
+void DecodeUvs(const VertexUvU16Vec2* uvs, size_t count, float* dst) {
+	size_t i = 0;
+	#ifdef __SSE4_1__
+		for (; i + 2 <= count; i += 2) {
+			__m128i q = _mm_cvtepu16_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(uvs + i)));
+			_mm_storeu_ps(dst + i*2, _mm_div_ps(_mm_cvtepi32_ps(q), _mm_set1_ps(65535.0f)));
+		}
+	#endif
+	for (; i < count; ++i) {
+		dst[i*2] = float(uvs[i].s) / 65535.0f;
+		dst[i*2+1] = float(uvs[i].t) / 65535.0f;
+	}
+}
+
+void EncodeColors(const float* colors, size_t count, VertexColorU8Vec4* dst) {
+	size_t i = 0;
+	#ifdef __SSE4_1__
+		for (; i + 4 <= count; i += 4) {
+			__m128i c0 = QuantizeUnorm<255>(_mm_loadu_ps(colors + i*4)), c1 = QuantizeUnorm<255>(_mm_loadu_ps(colors + i*4 + 4));
+			__m128i c2 = QuantizeUnorm<255>(_mm_loadu_ps(colors + i*4 + 8)), c3 = QuantizeUnorm<255>(_mm_loadu_ps(colors + i*4 + 12));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_packus_epi16(_mm_packus_epi32(c0, c1), _mm_packus_epi32(c2, c3)));
+		}
+	#endif
+	for (; i < count; ++i) {
+		dst[i].r = uint8_t(QuantizeUnorm<255>(colors[i*4]));
+		dst[i].g = uint8_t(QuantizeUnorm<255>(colors[i*4+1]));
+		dst[i].b = uint8_t(QuantizeUnorm<255>(colors[i*4+2]));
+		dst[i].a = uint8_t(QuantizeUnorm<255>(colors[i*4+3]));
+	}
+}
+
+void DecodeColors(const VertexColorU8Vec4* colors, size_t count, float* dst) {
+	size_t i = 0;
+	#ifdef __SSE4_1__
+		for (; i < count; ++i) {
+			int32_t packed;
+			memcpy(&packed, colors + i, 4);
+			__m128i q = _mm_cvtepu8_epi32(_mm_cvtsi32_si128(packed));
+			_mm_storeu_ps(dst + i*4, _mm_div_ps(_mm_cvtepi32_ps(q), _mm_set1_ps(255.0f)));
+		}
+	#endif
+	for (; i < count; ++i) {
+		dst[i*4] = float(colors[i].r) / 255.0f;
+		dst[i*4+1] = float(colors[i].g) / 255.0f;
+		dst[i*4+2] = float(colors[i].b) / 255.0f;
+		dst[i*4+3] = float(colors[i].a) / 255.0f;
+	}
+}
+
+}
@@ -0,0 +1,187 @@
+#include <v4d.h>
+#include <cmath>
+#include <cstring>
+#include "utilities/graphics/VertexQuantization.h"
+
+namespace v4d::tests {
+	int VertexQuantization() {
+		using namespace v4d::graphics::mesh;
+
+		uint64_t seed = 1;
+		auto random = [&seed](float min, float max){
+			seed = seed * 6364136223846793005ull + 1442695040888963407ull;
+			return min + float(seed >> 40) / float(1 << 24) * (max - min);
+		};
+		auto randomUnitVectors = [&](size_t count){
+			std::vector<float> vectors {0,0,1, 0,0,-1, 1,0,0, -1,0,0, 0,1,0, 0,-1,0, 0.6f,-0.8f,0, -0.6f,0,-0.8f};
+			while (vectors.size() < count * 3) {
+				glm::vec3 v(random(-1,1), random(-1,1), random(-1,1));
+				if (glm::length(v) < 0.01f) continue;
+				v = glm::normalize(v);
+				vectors.insert(vectors.end(), {v.x, v.y, v.z});
+			}
+			return vectors;
+		};
+		// Odd counts so that the remaining elements after the SIMD loops are also converted
+		const size_t count = 1003;
+
+		{// Test 1 (half floats)
+			for (uint32_t h = 0; h < 0x10000; ++h) {
+				if ((h & 0x7c00) == 0x7c00 && (h & 0x3ff)) continue; // NaN
+				if (FloatToHalf(HalfToFloat(uint16_t(h))) != h) {
+					LOG_ERROR("v4d::tests::VertexQuantization ERROR 1.1 (" << h << ")")
+					return 1;
+				}
+			}
+			struct {float value; uint16_t half;} expected[] {
+				{1.0f, 0x3c00}, {-2.0f, 0xc000}, {65504.0f, 0x7bff}, {65520.0f, 0x7c00}, {1e10f, 0x7c00},
+				{1.0f + 1.0f/2048, 0x3c00}, {1.0f + 3.0f/2048, 0x3c02}, // ties to even
+				{5.9604645e-8f, 0x0001}, {2.9802322e-8f, 0x0000}, {4.4703484e-8f, 0x0001}, {6.0975552e-5f, 0x03ff}, {-0.0f, 0x8000},
+			};
+			for (auto[value, half] : expected) {
+				if (FloatToHalf(value) != half) {
+					LOG_ERROR("v4d::tests::VertexQuantization ERROR 1.2 (" << value << " -> " << FloatToHalf(value) << ")")
+					return 1;
+				}
+			}
+		}
+
+		{// Test 2 (positions within half a step of the bounding box quantization)
+			std::vector<float> positions {};
+			for (size_t i = 0; i < count; ++i) positions.insert(positions.end(), {random(-10, 30), random(5, 6), random(-1000, 1000)});
+			std::vector<VertexPositionU16Vec4> quantized(count);
+			auto quantization = QuantizePositions(positions.data(), count, quantized.data());
+			std::vector<float> decoded(count * 3);
+			DequantizePositions(quantized.data(), count, quantization, decoded.data());
+			for (size_t i = 0; i < count; ++i) {
+				for (int k = 0; k < 3; ++k) {
+					float step = quantization.scale[k];
+					if (std::abs(decoded[i*3+k] - positions[i*3+k]) > step * 0.5f + std::abs(positions[i*3+k]) * 1e-6f || quantized[i].w != 0) {
+						LOG_ERROR("v4d::tests::VertexQuantization ERROR 2.1 (position " << i << ")")
+						return 2;
+					}
+				}
+				if (glm::length(quantization.Decode(quantized[i]) - glm::vec3(decoded[i*3], decoded[i*3+1], decoded[i*3+2])) > 1e-3f) {
+					LOG_ERROR("v4d::tests::VertexQuantization ERROR 2.2 (position " << i << ")")
+					return 2;
+				}
+			}
+			// Flat mesh, one axis has no extent
+			const float flat[] {0,1,2, 4,1,3};
+			VertexPositionU16Vec4 flatQuantized[2];
+			float flatDecoded[6];
+			DequantizePositions(flatQuantized, 2, QuantizePositions(flat, 2, flatQuantized), flatDecoded);
+			if (flatDecoded[1] != 1 || flatDecoded[4] != 1 || flatQuantized[0].y != 0 || flatQuantized[1].y != 0 || std::abs(flatDecoded[3] - 4) > 1e-5f) {
+				LOG_ERROR("v4d::tests::VertexQuantization ERROR 2.3 (flat)")
+				return 2;
+			}
+		}
+
+		{// Test 3 (octahedral normals)
+			auto normals = randomUnitVectors(count);
+			std::vector<VertexNormalOctI16Vec2> encoded(count);
+			EncodeNormals(normals.data(), count, encoded.data());
+			std::vector<float> decoded(count * 3);
+			DecodeNormals(encoded.data(), count, decoded.data());
+			for (size_t i = 0; i < count; ++i) {
+				glm::vec3 n(normals[i*3], normals[i*3+1], normals[i*3+2]), d(decoded[i*3], decoded[i*3+1], decoded[i*3+2]);
+				if (glm::dot(n, d) < 0.99999f || std::abs(glm::length(d) - 1) > 1e-5f) {
+					LOG_ERROR("v4d::tests::VertexQuantization ERROR 3.1 (normal " << i << ": " << glm::dot(n, d) << ")")
+					return 3;
+				}
+				// Same result one at a time (without SIMD)
+				VertexNormalOctI16Vec2 single;
+				float singleDecoded[3];
+				EncodeNormals(&normals[i*3], 1, &single);
+				DecodeNormals(&single, 1, singleDecoded);
+				if (single.x != encoded[i].x || single.y != encoded[i].y || memcmp(singleDecoded, &decoded[i*3], sizeof(singleDecoded)) != 0) {
+					LOG_ERROR("v4d::tests::VertexQuantization ERROR 3.2 (normal " << i << ")")
+					return 3;
+				}
+			}
+		}
+
+		{// Test 4 (octahedral tangents with bitangent sign)
+			auto directions = randomUnitVectors(count);
+			std::vector<float> tangents {};
+			for (size_t i = 0; i < count; ++i) tangents.insert(tangents.end(), {directions[i*3], directions[i*3+1], directions[i*3+2], (i % 3)? 1.0f : -1.0f});
+			std::vector<VertexTangentOctI8Vec4> encoded(count);
+			EncodeTangents(tangents.data(), count, encoded.data());
+			std::vector<float> decoded(count * 4);
+			DecodeTangents(encoded.data(), count, decoded.data());
+			for (size_t i = 0; i < count; ++i) {
+				glm::vec3 t(tangents[i*4], tangents[i*4+1], tangents[i*4+2]), d(decoded[i*4], decoded[i*4+1], decoded[i*4+2]);
+				if (glm::dot(t, d) < 0.999f || decoded[i*4+3] != tangents[i*4+3] || encoded[i].w != 0) {
+					LOG_ERROR("v4d::tests::VertexQuantization ERROR 4.1 (tangent " << i << ": " << glm::dot(t, d) << ")")
+					return 4;
+				}
+				VertexTangentOctI8Vec4 single;
+				float singleDecoded[4];
+				EncodeTangents(&tangents[i*4], 1, &single);
+				DecodeTangents(&single, 1, singleDecoded);
+				if (memcmp(&single, &encoded[i], sizeof(single)) != 0 || memcmp(singleDecoded, &decoded[i*4], sizeof(singleDecoded)) != 0) {
+					LOG_ERROR("v4d::tests::VertexQuantization ERROR 4.2 (tangent " << i << ")")
+					return 4;
+				}
+			}
+		}
+
+		{// Test 5 (UVs)
+			std::vector<float> uvs {};
+			for (size_t i = 0; i < count; ++i) uvs.insert(uvs.end(), {random(-4, 4), random(0, 1)});
+			std::vector<VertexUvF16Vec2> halfs(count);
+			std::vector<float> decoded(count * 2);
+			EncodeUvs(uvs.data(), count, halfs.data());
+			DecodeUvs(halfs.data(), count, decoded.data());
+			for (size_t i = 0; i < count * 2; ++i) {
+				if (std::abs(decoded[i] - uvs[i]) > std::max(std::abs(uvs[i]) / 2048, 3e-8f) || FloatToHalf(uvs[i]) != (i%2? halfs[i/2].t : halfs[i/2].s)) {
+					LOG_ERROR("v4d::tests::VertexQuantization ERROR 5.1 (half " << i << ": " << uvs[i] << " -> " << decoded[i] << ")")
+					return 5;
+				}
+			}
+			for (size_t i = 0; i < count; ++i) uvs[i*2] = random(0, 1);
+			uvs[0] = -0.2f;
+			uvs[1] = 1.5f;
+			std::vector<VertexUvU16Vec2> unorms(count);
+			EncodeUvs(uvs.data(), count, unorms.data());
+			DecodeUvs(unorms.data(), count, decoded.data());
+			if (decoded[0] != 0 || decoded[1] != 1) {
+				LOG_ERROR("v4d::tests::VertexQuantization ERROR 5.2 (unorm clamping)")
+				return 5;
+			}
+			for (size_t i = 2; i < count * 2; ++i) {
+				VertexUvU16Vec2 single;
+				EncodeUvs(&uvs[i & ~1], 1, &single);
+				if (std::abs(decoded[i] - uvs[i]) > 0.5f / 65535 + 1e-7f || memcmp(&single, &unorms[i/2], sizeof(single)) != 0) {
+					LOG_ERROR("v4d::tests::VertexQuantization ERROR 5.3 (unorm " << i << ": " << uvs[i] << " -> " << decoded[i] << ")")
+					return 5;
+				}
+			}
+		}
+
+		{// Test 6 (colors)
+			std::vector<float> colors {-1, 0.5f, 2, 1};
+			for (size_t i = 1; i < count; ++i) colors.insert(colors.end(), {random(0, 1), random(0, 1), random(0, 1), random(0, 1)});
+			std::vector<VertexColorU8Vec4> encoded(count);
+			std::vector<float> decoded(count * 4);
+			EncodeColors(colors.data(), count, encoded.data());
+			DecodeColors(encoded.data(), count, decoded.data());
+			if (encoded[0].r != 0 || encoded[0].g != 128 || encoded[0].b != 255 || encoded[0].a != 255) {
+				LOG_ERROR("v4d::tests::VertexQuantization ERROR 6.1 (clamping)")
+				return 6;
+			}
+			for (size_t i = 1; i < count; ++i) {
+				VertexColorU8Vec4 single;
+				EncodeColors(&colors[i*4], 1, &single);
+				for (int k = 0; k < 4; ++k) {
+					if (std::abs(decoded[i*4+k] - colors[i*4+k]) > 0.5f / 255 + 1e-6f || memcmp(&single, &encoded[i], sizeof(single)) != 0) {
+						LOG_ERROR("v4d::tests::VertexQuantization ERROR 6.2 (color " << i << ")")
+						return 6;
+					}
+				}
+			}
+		}
+
+		return 0;
+	}
+}
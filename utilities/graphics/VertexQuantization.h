@@ -0,0 +1,153 @@
+/*
+ * Quantized vertex formats and conversions from/to the full float vertex attributes
+ * Part of the Vulkan4D open-source game engine under the LGPL license - https://github.com/Vulkan4D
+ *
+ * Positions are 16-bit unsigned integers relative to the mesh bounding box, read as floats (0 to 65535) by a vec4 shader input and decoded with offset + position.xyz * scale (in the shader or folded into the model matrix).
+ * Normals and tangents are octahedral encoded, UVs are half floats or unorm16 and colors are unorm8.
+ * All formats map directly to Vulkan vertex formats (noted for each struct) so that they are decoded by the vertex input.
+ * Array conversions use SSE4.1 when available (half floats use F16C), with a scalar fallback.
+ */
+#pragma once
+
+#include <v4d.h>
+#include <cmath>
+#include <cstring>
+
+namespace v4d::graphics::mesh {
+
+	struct VertexPositionU16Vec4 { // VK_FORMAT_R16G16B16A16_USCALED (w is always 0, the shader uses vec4(position.xyz, 1))
+		uint16_t x;
+		uint16_t y;
+		uint16_t z;
+		uint16_t w;
+		VertexPositionU16Vec4() {static_assert(sizeof(VertexPositionU16Vec4) == 8);}
+	};
+
+	struct VertexNormalOctI16Vec2 { // VK_FORMAT_R16G16_SNORM
+		int16_t x;
+		int16_t y;
+		VertexNormalOctI16Vec2() {static_assert(sizeof(VertexNormalOctI16Vec2) == 4);}
+	};
+
+	struct VertexTangentOctI8Vec4 { // VK_FORMAT_R8G8B8A8_SNORM, z is the bitangent sign (w of the float tangent)
+		int8_t x;
+		int8_t y;
+		int8_t z;
+		int8_t w;
+		VertexTangentOctI8Vec4() {static_assert(sizeof(VertexTangentOctI8Vec4) == 4);}
+	};
+
+	struct VertexUvF16Vec2 { // VK_FORMAT_R16G16_SFLOAT
+		uint16_t s;
+		uint16_t t;
+		VertexUvF16Vec2() {static_assert(sizeof(VertexUvF16Vec2) == 4);}
+	};
+
+	struct VertexUvU16Vec2 { // VK_FORMAT_R16G16_UNORM, for UVs within [0,1]
+		uint16_t s;
+		uint16_t t;
+		VertexUvU16Vec2() {static_assert(sizeof(VertexUvU16Vec2) == 4);}
+	};
+
+	struct VertexColorU8Vec4 { // VK_FORMAT_R8G8B8A8_UNORM
+		uint8_t r;
+		uint8_t g;
+		uint8_t b;
+		uint8_t a;
+		VertexColorU8Vec4() {static_assert(sizeof(VertexColorU8Vec4) == 4);}
+	};
+
+	struct PositionQuantization {
+		glm::vec3 offset {0};
+		glm::vec3 scale {1};
+		glm::vec3 Decode(const VertexPositionU16Vec4& position) const {
+			return offset + glm::vec3(position.x, position.y, position.z) * scale;
+		}
+	};
+
+	// Round to nearest even, overflows to infinity
+	inline uint16_t FloatToHalf(float f) {
+		uint32_t x;
+		memcpy(&x, &f, 4);
+		const uint16_t sign = uint16_t((x >> 16) & 0x8000);
+		x &= 0x7fffffff;
+		if (x > 0x7f800000) return sign | 0x7e00; // NaN
+		if (x >= 0x47800000) return sign | 0x7c00; // infinity
+		if (x < 0x33000000) return sign; // zero
+		uint32_t mantissa, remainder, halfway;
+		if (x < 0x38800000) {// subnormal
+			uint32_t shift = 126 - (x >> 23);
+			uint32_t m = (x & 0x7fffff) | 0x800000;
+			mantissa = m >> shift;
+			remainder = m & ((1u << shift) - 1);
+			halfway = 1u << (shift - 1);
+		} else {
+			mantissa = (((x >> 23) - 112) << 10) | ((x >> 13) & 0x3ff);
+			remainder = x & 0x1fff;
+			halfway = 0x1000;
+		}
+		if (remainder > halfway || (remainder == halfway && (mantissa & 1))) ++mantissa; // may carry into the exponent, up to infinity
+		return sign | uint16_t(mantissa);
+	}
+
+	inline float HalfToFloat(uint16_t h) {
+		const uint32_t sign = uint32_t(h & 0x8000) << 16, exponent = (h >> 10) & 0x1f, mantissa = h & 0x3ff;
+		uint32_t x;
+		if (exponent == 0) {
+			float f = float(mantissa) * 5.9604645e-8f; // 2^-24
+			return sign? -f : f;
+		}
+		if (exponent == 31) x = sign | 0x7f800000 | (mantissa << 13);
+		else x = sign | ((exponent + 112) << 23) | (mantissa << 13);
+		float f;
+		memcpy(&f, &x, 4);
+		return f;
+	}
+
+	// Maps a unit vector onto the [-1,1] square
+	inline glm::vec2 OctahedralEncode(const glm::vec3& n) {
+		float l1 = std::abs(n.x) + std::abs(n.y) + std::abs(n.z);
+		if (l1 == 0) return glm::vec2(0);
+		float x = n.x / l1, y = n.y / l1;
+		if (n.z < 0) {
+			float fx = (1 - std::abs(y)) * (x >= 0? 1 : -1);
+			float fy = (1 - std::abs(x)) * (y >= 0? 1 : -1);
+			x = fx;
+			y = fy;
+		}
+		return glm::vec2(x, y);
+	}
+
+	inline glm::vec3 OctahedralDecode(const glm::vec2& e) {
+		glm::vec3 n(e.x, e.y, 1 - std::abs(e.x) - std::abs(e.y));
+		float t = std::max(-n.z, 0.0f);
+		n.x += n.x >= 0? -t : t;
+		n.y += n.y >= 0? -t : t;
+		return glm::normalize(n);
+	}
+
+	/**
+	 * Quantizes count positions (3 floats each) relative to their bounding box
+	 * Returns the offset and scale to decode them
+	 */
+	V4DLIB PositionQuantization QuantizePositions(const float* positions, size_t count, VertexPositionU16Vec4* dst);
+	V4DLIB void DequantizePositions(const VertexPositionU16Vec4* positions, size_t count, const PositionQuantization& quantization, float* dst);
+
+	// Normals are 3 floats, they must be normalized
+	V4DLIB void EncodeNormals(const float* normals, size_t count, VertexNormalOctI16Vec2* dst);
+	V4DLIB void DecodeNormals(const VertexNormalOctI16Vec2* normals, size_t count, float* dst);
+
+	// Tangents are 4 floats, xyz normalized and w the bitangent sign
+	V4DLIB void EncodeTangents(const float* tangents, size_t count, VertexTangentOctI8Vec4* dst);
+	V4DLIB void DecodeTangents(const VertexTangentOctI8Vec4* tangents, size_t count, float* dst);
+
+	// UVs are 2 floats, unorm16 clamps them to [0,1]
+	V4DLIB void EncodeUvs(const float* uvs, size_t count, VertexUvF16Vec2* dst);
+	V4DLIB void DecodeUvs(const VertexUvF16Vec2* uvs, size_t count, float* dst);
+	V4DLIB void EncodeUvs(const float* uvs, size_t count, VertexUvU16Vec2* dst);
+	V4DLIB void DecodeUvs(const VertexUvU16Vec2* uvs, size_t count, float* dst);
+
+	// Colors are 4 floats, clamped to [0,1]
+	V4DLIB void EncodeColors(const float* colors, size_t count, VertexColorU8Vec4* dst);
+	V4DLIB void DecodeColors(const VertexColorU8Vec4* colors, size_t count, float* dst);
+}
@@ -0,0 +1,64 @@
+#include <v4d.h>
+#include "helpers/Benchmark.hpp"
+#include "utilities/graphics/VertexRepacking.h"
+
+namespace v4d::benchmarks {
+	void VertexRepacking() {
+		using v4d::Benchmark;
+		using namespace v4d::graphics::mesh;
+
+		// 64k vertices interleaved like most DCC exporters do (position, normal, uv)
+		const size_t count = 65536;
+		struct Vertex {float position[3]; float normal[3]; float uv[2];};
+		std::vector<Vertex> vertices(count);
+		for (size_t i = 0; i < count; ++i) vertices[i] = {{float(i), 1, 2}, {0, 1, 0}, {0.5f, 0.25f}};
+		std::vector<float> dst(count * 4);
+
+		StridedAccessor packed {(const byte*)dst.data(), count, 12, ComponentType::FLOAT, 3};
+		std::vector<float> packedPositions(count * 3);
+		Benchmark::Run("VertexRepacking RepackFloats 64k tightly packed vec3 (memcpy)", [&]{
+			RepackFloats(packed, packedPositions.data(), 3);
+			Benchmark::DoNotOptimize(packedPositions[0]);
+		}, count * 12);
+
+		StridedAccessor positions {(const byte*)&vertices[0].position, count, sizeof(Vertex), ComponentType::FLOAT, 3};
+		Benchmark::Run("VertexRepacking RepackFloats 64k interleaved vec3", [&]{
+			RepackFloats(positions, dst.data(), 3);
+			Benchmark::DoNotOptimize(dst[0]);
+		}, count * 12);
+
+		StridedAccessor uvs {(const byte*)&vertices[0].uv, count, sizeof(Vertex), ComponentType::FLOAT, 2};
+		Benchmark::Run("VertexRepacking RepackFloats 64k interleaved vec2", [&]{
+			RepackFloats(uvs, dst.data(), 2);
+			Benchmark::DoNotOptimize(dst[0]);
+		}, count * 8);
+
+		Benchmark::Run("VertexRepacking RepackFloats 64k interleaved vec3 to vec4", [&]{
+			RepackFloats(positions, dst.data(), 4);
+			Benchmark::DoNotOptimize(dst[0]);
+		}, count * 16);
+
+		// Most files use 16-bit indices, converted to 32-bit ones for geometries that share a 32-bit index buffer
+		std::vector<uint16_t> indices16(count * 3);
+		for (size_t i = 0; i < indices16.size(); ++i) indices16[i] = uint16_t(i * 7);
+		std::vector<uint32_t> indices32(indices16.size());
+		StridedAccessor indices {(const byte*)indices16.data(), indices16.size(), 2, ComponentType::UNSIGNED_SHORT, 1};
+		Benchmark::Run("VertexRepacking RepackIndices 192k u16 to u32", [&]{
+			RepackIndices(indices, indices32.data());
+			Benchmark::DoNotOptimize(indices32[0]);
+		}, indices32.size() * 4);
+
+		std::vector<uint8_t> colors(count * 4, 128);
+		StridedAccessor rgb {colors.data(), count, 4, ComponentType::UNSIGNED_BYTE, 3, true};
+		Benchmark::Run("VertexRepacking RepackFloats 64k normalized u8 rgb to vec4", [&]{
+			RepackFloats(rgb, dst.data(), 4);
+			Benchmark::DoNotOptimize(dst[0]);
+		}, count * 16);
+
+		std::vector<uint32_t> triangles(TriangleListIndexCount(PrimitiveMode::TRIANGLE_STRIP, count));
+		Benchmark::Run("VertexRepacking Triangulate 64k non-indexed strip", [&]{
+			Triangulate(PrimitiveMode::TRIANGLE_STRIP, (const uint32_t*)nullptr, count, triangles.data());
+			Benchmark::DoNotOptimize(triangles[0]);
+		}, triangles.size() * 4);
+	}
+}
@@ -0,0 +1,213 @@
+#include "VertexRepacking.h"
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <type_traits>
+#ifdef __SSE4_1__
+	#include <immintrin.h>
+#endif
+
+namespace v4d::graphics::mesh {
+
+size_t StridedAccessor::ComponentSize() const {
+	switch (componentType) {
+		case ComponentType::BYTE:
+		case ComponentType::UNSIGNED_BYTE: return 1;
+		case ComponentType::SHORT:
+		case ComponentType::UNSIGNED_SHORT: return 2;
+		case ComponentType::UNSIGNED_INT:
+		case ComponentType::FLOAT: return 4;
+	}
+	return 0;
+}
+
+static bool IsValid(const StridedAccessor& src) {
+	if (src.ComponentSize() == 0 || src.componentCount < 1 || src.componentCount > 4) return false;
+	if (src.count == 0) return true;
+	return src.data && (src.count == 1 || src.stride >= src.ElementSize());
+}
+
+// glTF conversion of normalized integers, signed values are clamped so that both -max and min are -1
+template<typename T>
+static inline float Normalize(T c) {
+	if constexpr (std::is_signed_v<T>) return std::max(float(c) / float(std::numeric_limits<T>::max()), -1.0f);
+	else return float(c) / float(std::numeric_limits<T>::max());
+}
+
+// Component type and count are known at compile time so that the inner loops are unrolled
+template<typename T, int N, int DST_N, bool NORMALIZED>
+static void RepackFloats(const byte* src, size_t count, size_t stride, float* dst, int dstN, float fill) {
+	if constexpr (DST_N > 0) dstN = DST_N;
+	size_t i = 0;
+	#ifdef __SSE4_1__
+		// Float elements are loaded and stored 4 components at a time, the extra components being overwritten by the next element, so the last one is done separately
+		if constexpr (std::is_same_v<T, float> && N >= 2 && DST_N >= N && DST_N <= 4) {
+			const __m128 fillValue = _mm_set1_ps(fill);
+			for (; i + 1 < count; ++i, src += stride, dst += DST_N) {
+				__m128 element = _mm_loadu_ps(reinterpret_cast<const float*>(src));
+				if constexpr (DST_N > N) element = _mm_blend_ps(element, fillValue, (0xF << N) & 0xF);
+				_mm_storeu_ps(dst, element);
+			}
+		}
+	#endif
+	for (; i < count; ++i, src += stride, dst += dstN) {
+		T element[N];
+		memcpy(element, src, sizeof(element));
+		for (int c = 0; c < N; ++c) if (c < dstN) {
+			if constexpr (NORMALIZED) dst[c] = Normalize(element[c]);
+			else dst[c] = float(element[c]);
+		}
+		for (int c = N; c < dstN; ++c) dst[c] = fill;
+	}
+}
+
+// Same number of components or one more (ie: RGB to RGBA) are the common cases
+template<typename T, int N, bool NORMALIZED>
+static void RepackFloats(const byte* src, size_t count, size_t stride, float* dst, int dstN, float fill) {
+	if (dstN == N) RepackFloats<T, N, N, NORMALIZED>(src, count, stride, dst, dstN, fill);
+	else if (dstN == N + 1) RepackFloats<T, N, N + 1, NORMALIZED>(src, count, stride, dst, dstN, fill);
+	else RepackFloats<T, N, 0, NORMALIZED>(src, count, stride, dst, dstN, fill);
+}
+
+template<typename T, bool NORMALIZED>
+static void RepackFloats(const StridedAccessor& src, float* dst, int dstN, float fill) {
+	switch (src.componentCount) {
+		case 1: RepackFloats<T, 1, NORMALIZED>(src.data, src.count, src.stride, dst, dstN, fill); break;
+		case 2: RepackFloats<T, 2, NORMALIZED>(src.data, src.count, src.stride, dst, dstN, fill); break;
+		case 3: RepackFloats<T, 3, NORMALIZED>(src.data, src.count, src.stride, dst, dstN, fill); break;
+		case 4: RepackFloats<T, 4, NORMALIZED>(src.data, src.count, src.stride, dst, dstN, fill); break;
+	}
+}
+
+bool RepackFloats(const StridedAccessor& src, float* dst, int dstComponentCount, float fill) {
+	if (!IsValid(src) || dstComponentCount < 1) return false;
+	if (src.count == 0) return true;
+	switch (src.componentType) {
+		case ComponentType::FLOAT:
+			if (dstComponentCount == src.componentCount && src.IsTightlyPacked()) {
+				memcpy(dst, src.data, src.count * src.ElementSize());
+			} else {
+				RepackFloats<float, false>(src, dst, dstComponentCount, fill);
+			}
+		break;
+		case ComponentType::BYTE:
+			if (src.normalized) RepackFloats<int8_t, true>(src, dst, dstComponentCount, fill);
+			else RepackFloats<int8_t, false>(src, dst, dstComponentCount, fill);
+		break;
+		case ComponentType::UNSIGNED_BYTE:
+			if (src.normalized) RepackFloats<uint8_t, true>(src, dst, dstComponentCount, fill);
+			else RepackFloats<uint8_t, false>(src, dst, dstComponentCount, fill);
+		break;
+		case ComponentType::SHORT:
+			if (src.normalized) RepackFloats<int16_t, true>(src, dst, dstComponentCount, fill);
+			else RepackFloats<int16_t, false>(src, dst, dstComponentCount, fill);
+		break;
+		case ComponentType::UNSIGNED_SHORT:
+			if (src.normalized) RepackFloats<uint16_t, true>(src, dst, dstComponentCount, fill);
+			else RepackFloats<uint16_t, false>(src, dst, dstComponentCount, fill);
+		break;
+		case ComponentType::UNSIGNED_INT:
+			if (src.normalized) return false; // not allowed by glTF
+			RepackFloats<uint32_t, false>(src, dst, dstComponentCount, fill);
+		break;
+	}
+	return true;
+}
+
+template<typename T, typename D>
+static void RepackIndices(const byte* src, size_t count, size_t stride, D* dst) {
+	if (stride == sizeof(T) && sizeof(T) == sizeof(D)) {
+		memcpy(dst, src, count * sizeof(D));
+		return;
+	}
+	size_t i = 0;
+	#ifdef __SSE4_1__
+		// Tightly packed indices are widened 8 at a time
+		if constexpr (sizeof(D) > sizeof(T)) if (stride == sizeof(T)) {
+			for (; i + 8 <= count; i += 8) {
+				if constexpr (sizeof(T) == 1 && sizeof(D) == 2) {
+					_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_cvtepu8_epi16(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(src + i))));
+				} else if constexpr (sizeof(T) == 1) {
+					__m128i bytes = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(src + i));
+					_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_cvtepu8_epi32(bytes));
+					_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i + 4), _mm_cvtepu8_epi32(_mm_srli_si128(bytes, 4)));
+				} else {
+					__m128i shorts = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i * 2));
+					_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_cvtepu16_epi32(shorts));
+					_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i + 4), _mm_cvtepu16_epi32(_mm_srli_si128(shorts, 8)));
+				}
+			}
+		}
+	#endif
+	for (src += i * stride; i < count; ++i, src += stride) {
+		T index;
+		memcpy(&index, src, sizeof(T));
+		dst[i] = D(index);
+	}
+}
+
+bool RepackIndices(const StridedAccessor& src, uint32_t* dst) {
+	if (!IsValid(src) || src.componentCount != 1) return false;
+	switch (src.componentType) {
+		case ComponentType::UNSIGNED_BYTE: RepackIndices<uint8_t>(src.data, src.count, src.stride, dst); return true;
+		case ComponentType::UNSIGNED_SHORT: RepackIndices<uint16_t>(src.data, src.count, src.stride, dst); return true;
+		case ComponentType::UNSIGNED_INT: RepackIndices<uint32_t>(src.data, src.count, src.stride, dst); return true;
+		default: return false;
+	}
+}
+
+bool RepackIndices(const StridedAccessor& src, uint16_t* dst) {
+	if (!IsValid(src) || src.componentCount != 1) return false;
+	switch (src.componentType) {
+		case ComponentType::UNSIGNED_BYTE: RepackIndices<uint8_t>(src.data, src.count, src.stride, dst); return true;
+		case ComponentType::UNSIGNED_SHORT: RepackIndices<uint16_t>(src.data, src.count, src.stride, dst); return true;
+		default: return false;
+	}
+}
+
+size_t TriangleListIndexCount(PrimitiveMode mode, size_t indexCount) {
+	switch (mode) {
+		case PrimitiveMode::TRIANGLES: return indexCount - indexCount % 3;
+		case PrimitiveMode::TRIANGLE_STRIP:
+		case PrimitiveMode::TRIANGLE_FAN: return indexCount < 3? 0 : (indexCount - 2) * 3;
+		default: return 0;
+	}
+}
+
+template<typename T>
+static void Triangulate(PrimitiveMode mode, const T* indices, size_t indexCount, T* dst) {
+	auto index = [indices](size_t i){return indices? indices[i] : T(i);};
+	const size_t count = TriangleListIndexCount(mode, indexCount);
+	switch (mode) {
+		case PrimitiveMode::TRIANGLES:
+			if (indices) memcpy(dst, indices, count * sizeof(T));
+			else for (size_t i = 0; i < count; ++i) dst[i] = T(i);
+		break;
+		case PrimitiveMode::TRIANGLE_STRIP:
+			// every other triangle is flipped to keep the same winding
+			for (size_t i = 0; i < count / 3; ++i, dst += 3) {
+				dst[0] = index(i);
+				dst[1] = index(i + 1 + i % 2);
+				dst[2] = index(i + 2 - i % 2);
+			}
+		break;
+		case PrimitiveMode::TRIANGLE_FAN:
+			for (size_t i = 0; i < count / 3; ++i, dst += 3) {
+				dst[0] = index(i + 1);
+				dst[1] = index(i + 2);
+				dst[2] = index(0);
+			}
+		break;
+		default: break;
+	}
+}
+
+void Triangulate(PrimitiveMode mode, const uint32_t* indices, size_t indexCount, uint32_t* dst) {
+	Triangulate<uint32_t>(mode, indices, indexCount, dst);
+}
+
+void Triangulate(PrimitiveMode mode, const uint16_t* indices, size_t indexCount, uint16_t* dst) {
+	Triangulate<uint16_t>(mode, indices, indexCount, dst);
+}
+
+}
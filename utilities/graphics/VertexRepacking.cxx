@@ -0,0 +1,148 @@
+#include <v4d.h>
+#include <cstring>
+#include "utilities/graphics/VertexRepacking.h"
+
+namespace v4d::tests {
+	int VertexRepacking() {
+		using namespace v4d::graphics::mesh;
+
+		{// Test 1 (interleaved float attributes)
+			struct Vertex {float position[3]; float normal[3]; float uv[2];};
+			std::vector<Vertex> vertices(5);
+			for (int i = 0; i < 5; ++i) vertices[i] = {{i*1.0f, i*2.0f, i*3.0f}, {0, 1, float(i)}, {0.5f, i*0.25f}};
+			std::vector<float> positions(15), uvs(10);
+			StridedAccessor position {(const byte*)&vertices[0].position, 5, sizeof(Vertex), ComponentType::FLOAT, 3};
+			StridedAccessor uv {(const byte*)&vertices[0].uv, 5, sizeof(Vertex), ComponentType::FLOAT, 2};
+			if (!RepackFloats(position, positions.data(), 3) || !RepackFloats(uv, uvs.data(), 2)) {
+				LOG_ERROR("v4d::tests::VertexRepacking ERROR 1.1")
+				return 1;
+			}
+			for (int i = 0; i < 5; ++i) {
+				if (memcmp(&positions[i*3], vertices[i].position, 12) != 0 || memcmp(&uvs[i*2], vertices[i].uv, 8) != 0) {
+					LOG_ERROR("v4d::tests::VertexRepacking ERROR 1.2 (vertex " << i << ")")
+					return 1;
+				}
+			}
+		}
+
+		{// Test 2 (normalized integers, missing components filled)
+			const uint8_t colors[] {255, 0, 51, 0 /*padding*/, 0, 255, 102, 0};
+			std::vector<float> rgba(8);
+			if (!RepackFloats({colors, 2, 4, ComponentType::UNSIGNED_BYTE, 3, true}, rgba.data(), 4) || rgba != std::vector<float>{1, 0, 0.2f, 1, 0, 1, 0.4f, 1}) {
+				LOG_ERROR("v4d::tests::VertexRepacking ERROR 2.1 (u8 colors)")
+				return 2;
+			}
+			const int16_t normals[] {32767, -32767, -32768};
+			std::vector<float> xyz(3);
+			if (!RepackFloats({(const byte*)normals, 1, 6, ComponentType::SHORT, 3, true}, xyz.data(), 3) || xyz != std::vector<float>{1, -1, -1}) {
+				LOG_ERROR("v4d::tests::VertexRepacking ERROR 2.2 (i16 normals)")
+				return 2;
+			}
+			const uint16_t positions[] {1, 2, 3};
+			if (!RepackFloats({(const byte*)positions, 1, 6, ComponentType::UNSIGNED_SHORT, 3, false}, xyz.data(), 3) || xyz != std::vector<float>{1, 2, 3}) {
+				LOG_ERROR("v4d::tests::VertexRepacking ERROR 2.3 (u16 positions)")
+				return 2;
+			}
+		}
+
+		{// Test 3 (invalid accessors)
+			float dst[8];
+			const float src[8] {};
+			if (RepackFloats({(const byte*)src, 2, 8, ComponentType::FLOAT, 3}, dst, 3) // stride smaller than an element
+				|| RepackFloats({(const byte*)src, 2, 12, ComponentType(0), 3}, dst, 3)
+				|| RepackFloats({(const byte*)src, 2, 16, ComponentType::UNSIGNED_INT, 3, true}, dst, 3)
+			) {
+				LOG_ERROR("v4d::tests::VertexRepacking ERROR 3")
+				return 3;
+			}
+		}
+
+		{// Test 4 (indices)
+			const uint8_t interleaved[] {0, 9, 1, 9, 2, 9, 3, 9};
+			uint16_t indices16[4];
+			uint32_t indices32[4];
+			if (!RepackIndices({interleaved, 4, 2, ComponentType::UNSIGNED_BYTE}, indices16) || indices16[3] != 3 || !RepackIndices({interleaved, 4, 2, ComponentType::UNSIGNED_BYTE}, indices32) || indices32[2] != 2) {
+				LOG_ERROR("v4d::tests::VertexRepacking ERROR 4.1 (u8 indices)")
+				return 4;
+			}
+			const uint32_t wide[] {1, 70000};
+			if (RepackIndices({(const byte*)wide, 2, 4, ComponentType::UNSIGNED_INT}, indices16) || !RepackIndices({(const byte*)wide, 2, 4, ComponentType::UNSIGNED_INT}, indices32) || indices32[1] != 70000) {
+				LOG_ERROR("v4d::tests::VertexRepacking ERROR 4.2 (u32 indices)")
+				return 4;
+			}
+		}
+
+		{// Test 5 (triangulation)
+			// strip 0-1-2-3-4 gives triangles 012, 132, 234 (glTF order), all with the same winding
+			const uint32_t strip[] {10, 11, 12, 13, 14};
+			std::vector<uint32_t> triangles(TriangleListIndexCount(PrimitiveMode::TRIANGLE_STRIP, 5));
+			Triangulate(PrimitiveMode::TRIANGLE_STRIP, strip, 5, triangles.data());
+			if (triangles != std::vector<uint32_t>{10, 11, 12, 11, 13, 12, 12, 13, 14}) {
+				LOG_ERROR("v4d::tests::VertexRepacking ERROR 5.1 (strip)")
+				return 5;
+			}
+			std::vector<uint16_t> fan(TriangleListIndexCount(PrimitiveMode::TRIANGLE_FAN, 4));
+			Triangulate(PrimitiveMode::TRIANGLE_FAN, (const uint16_t*)nullptr, 4, fan.data());
+			if (fan != std::vector<uint16_t>{1, 2, 0, 2, 3, 0}) {
+				LOG_ERROR("v4d::tests::VertexRepacking ERROR 5.2 (non-indexed fan)")
+				return 5;
+			}
+			std::vector<uint16_t> list(TriangleListIndexCount(PrimitiveMode::TRIANGLES, 7));
+			Triangulate(PrimitiveMode::TRIANGLES, (const uint16_t*)nullptr, 7, list.data());
+			if (list != std::vector<uint16_t>{0, 1, 2, 3, 4, 5}) {
+				LOG_ERROR("v4d::tests::VertexRepacking ERROR 5.3 (non-indexed list)")
+				return 5;
+			}
+			if (TriangleListIndexCount(PrimitiveMode::LINES, 6) != 0 || TriangleListIndexCount(PrimitiveMode::TRIANGLE_STRIP, 2) != 0) {
+				LOG_ERROR("v4d::tests::VertexRepacking ERROR 5.4 (not triangles)")
+				return 5;
+			}
+		}
+
+		{// Test 6 (vectorized paths and their remaining elements, sources end with the last element so that reading past it is caught by sanitizers)
+			for (size_t count : {1, 2, 3, 9, 17}) {
+				for (int n = 1; n <= 4; ++n) for (size_t stride : {size_t(n*4), size_t(n*4 + 4), size_t(20)}) for (int dstN = n; dstN <= n + 1; ++dstN) {
+					std::vector<byte> src((count - 1) * stride + n*4);
+					for (size_t i = 0; i < count; ++i) for (int c = 0; c < n; ++c) {
+						float value = float(i * 10 + c);
+						memcpy(&src[i * stride + c*4], &value, 4);
+					}
+					std::vector<float> dst(count * dstN, -1);
+					if (!RepackFloats({src.data(), count, stride, ComponentType::FLOAT, n}, dst.data(), dstN, 7)) {
+						LOG_ERROR("v4d::tests::VertexRepacking ERROR 6.1")
+						return 6;
+					}
+					for (size_t i = 0; i < count; ++i) for (int c = 0; c < dstN; ++c) {
+						if (dst[i * dstN + c] != (c < n? float(i * 10 + c) : 7.0f)) {
+							LOG_ERROR("v4d::tests::VertexRepacking ERROR 6.2 (" << count << " vec" << n << " with stride " << stride << " to vec" << dstN << ", element " << i << ")")
+							return 6;
+						}
+					}
+				}
+				std::vector<uint8_t> bytes(count);
+				std::vector<uint16_t> shorts(count);
+				for (size_t i = 0; i < count; ++i) {
+					bytes[i] = uint8_t(255 - i);
+					shorts[i] = uint16_t(65535 - i * 1000);
+				}
+				std::vector<uint16_t> indices16(count);
+				std::vector<uint32_t> indices32(count), shorts32(count);
+				if (!RepackIndices({bytes.data(), count, 1, ComponentType::UNSIGNED_BYTE}, indices16.data())
+					|| !RepackIndices({bytes.data(), count, 1, ComponentType::UNSIGNED_BYTE}, indices32.data())
+					|| !RepackIndices({(const byte*)shorts.data(), count, 2, ComponentType::UNSIGNED_SHORT}, shorts32.data())
+				) {
+					LOG_ERROR("v4d::tests::VertexRepacking ERROR 6.3")
+					return 6;
+				}
+				for (size_t i = 0; i < count; ++i) {
+					if (indices16[i] != bytes[i] || indices32[i] != bytes[i] || shorts32[i] != shorts[i]) {
+						LOG_ERROR("v4d::tests::VertexRepacking ERROR 6.4 (" << count << " indices, index " << i << ")")
+						return 6;
+					}
+				}
+			}
+		}
+
+		return 0;
+	}
+}
@@ -0,0 +1,68 @@
+/*
+ * Repacking of interleaved or strided vertex attributes and indices into tightly packed arrays
+ * Part of the Vulkan4D open-source game engine under the LGPL license - https://github.com/Vulkan4D
+ *
+ * Enum values are the same as in glTF (and OpenGL), so they can be cast directly from tinygltf accessors and primitives.
+ */
+#pragma once
+
+#include <v4d.h>
+
+namespace v4d::graphics::mesh {
+	enum class ComponentType : int {
+		BYTE = 5120,
+		UNSIGNED_BYTE = 5121,
+		SHORT = 5122,
+		UNSIGNED_SHORT = 5123,
+		UNSIGNED_INT = 5125,
+		FLOAT = 5126,
+	};
+
+	enum class PrimitiveMode : int {
+		POINTS = 0,
+		LINES = 1,
+		LINE_LOOP = 2,
+		LINE_STRIP = 3,
+		TRIANGLES = 4,
+		TRIANGLE_STRIP = 5,
+		TRIANGLE_FAN = 6,
+	};
+
+	// count elements of componentCount components each, one element every stride bytes (the source does not need to be aligned)
+	struct V4DLIB StridedAccessor {
+		const byte* data = nullptr;
+		size_t count = 0;
+		size_t stride = 0;
+		ComponentType componentType = ComponentType::FLOAT;
+		int componentCount = 1;
+		bool normalized = false;
+
+		size_t ComponentSize() const;
+		size_t ElementSize() const {return ComponentSize() * componentCount;}
+		bool IsTightlyPacked() const {return stride == ElementSize();}
+	};
+
+	/**
+	 * Writes count * dstComponentCount floats, integer components are converted as per glTF (normalized or not)
+	 * Missing components are set to fill (ie: alpha of RGB colors) and extra components are dropped
+	 * Returns false if the accessor is not valid
+	 */
+	V4DLIB bool RepackFloats(const StridedAccessor& src, float* dst, int dstComponentCount, float fill = 1);
+
+	/**
+	 * Writes count indices
+	 * Returns false if the indices are not unsigned integers that fit in the destination type
+	 */
+	V4DLIB bool RepackIndices(const StridedAccessor& src, uint32_t* dst);
+	V4DLIB bool RepackIndices(const StridedAccessor& src, uint16_t* dst);
+
+	// Number of indices of the triangle list for a primitive of indexCount indices (or vertices), 0 for points and lines
+	V4DLIB size_t TriangleListIndexCount(PrimitiveMode mode, size_t indexCount);
+
+	/**
+	 * Writes TriangleListIndexCount(mode, indexCount) indices of a triangle list, keeping the winding order of strips and fans
+	 * indices may be nullptr for non-indexed primitives, it cannot be the same array as dst
+	 */
+	V4DLIB void Triangulate(PrimitiveMode mode, const uint32_t* indices, size_t indexCount, uint32_t* dst);
+	V4DLIB void Triangulate(PrimitiveMode mode, const uint16_t* indices, size_t indexCount, uint16_t* dst);
+}
@@ -20,7 +20,7 @@ namespace v4d::graphics::vulkan {
 				if (device->GetPhysicalDevice()->deviceFeatures.vulkan12DeviceFeatures.bufferDeviceAddress)
 					bufferInfo.usage |= VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT;
 				
-				device->CreateAndAllocateBuffer(bufferInfo, memoryUsage, obj, &allocation);
+				device->CreateAndAllocateBuffer(bufferInfo, memoryUsage, obj, &allocation, false, allocationTag);
 				if (device->GetPhysicalDevice()->deviceFeatures.vulkan12DeviceFeatures.bufferDeviceAddress) {
 					address = device->GetBufferDeviceOrHostAddressConst(obj);
 					if (alignment > 0 && address.deviceAddress % alignment != 0) {
@@ -46,8 +46,180 @@ namespace v4d::graphics::vulkan {
 		}
 	}
 
+	bool BufferObject::Resize(size_t newSize, VkCommandBuffer cmdBuffer, DeferredReleaseQueue& releaseQueue, double growthFactor) {
+		if (!CanGrow()) {
+			assert(!"Mapped buffers cannot grow while keeping their contents");
+			return false;
+		}
+		if (newSize <= size) return false;
+		const VkDeviceSize oldSize = size;
+		size = std::max(VkDeviceSize(newSize), VkDeviceSize(double(oldSize) * growthFactor));
+		if (device == nullptr) return false;
+		
+		Device* dev = device;
+		if ((VkBuffer)obj == VK_NULL_HANDLE) {// nothing to keep
+			device = nullptr;
+			BufferObject::Allocate(dev);
+			return true;
+		}
+		
+		assert((bufferUsage & VK_BUFFER_USAGE_TRANSFER_SRC_BIT) && (bufferUsage & VK_BUFFER_USAGE_TRANSFER_DST_BIT));
+		VkBuffer oldBuffer = obj;
+		MemoryAllocation oldAllocation = allocation;
+		VkBufferCopy region {};{
+			region.srcOffset = alignedOffset;
+			region.size = oldSize;
+		}
+		{
+			std::lock_guard lock(UnderlyingCommonObjectContainer::mu);
+			obj = VK_NULL_HANDLE;
+		}
+		allocation = VK_NULL_HANDLE;
+		address = {};
+		device = nullptr;
+		BufferObject::Allocate(dev);
+		region.dstOffset = alignedOffset;
+		
+		VkMemoryBarrier barrier {};{
+			barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+			barrier.srcAccessMask = VK_ACCESS_MEMORY_WRITE_BIT;
+			barrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+		}
+		dev->CmdPipelineBarrier(cmdBuffer, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 1, &barrier, 0, nullptr, 0, nullptr);
+		dev->CmdCopyBuffer(cmdBuffer, oldBuffer, obj, 1, &region);
+		barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+		barrier.dstAccessMask = VK_ACCESS_MEMORY_READ_BIT | VK_ACCESS_MEMORY_WRITE_BIT;
+		dev->CmdPipelineBarrier(cmdBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, 0, 1, &barrier, 0, nullptr, 0, nullptr);
+		
+		// The frames in flight and the copy above still read the old buffer
+		releaseQueue.Defer([dev, oldBuffer, oldAllocation]() mutable {
+			dev->FreeAndDestroyBuffer(oldBuffer, oldAllocation);
+		});
+		return true;
+	}
+	
 	BufferObject::~BufferObject() {
 		Free();
 	}
 	
+	bool DeviceBufferPoolBackend::CreateBlock(BufferPoolBlock& block) {
+		VkBufferCreateInfo bufferInfo {};{
+			bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+			bufferInfo.size = block.size;
+			bufferInfo.usage = bufferUsage;
+			bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+		}
+		const bool hasDeviceAddress = device->GetPhysicalDevice()->deviceFeatures.vulkan12DeviceFeatures.bufferDeviceAddress;
+		if (hasDeviceAddress)
+			bufferInfo.usage |= VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT;
+		
+		MemoryAllocation allocation = VK_NULL_HANDLE;
+		if (device->CreateAndAllocateBuffer(bufferInfo, memoryUsage, block.buffer, &allocation, false, "BufferPool") != VK_SUCCESS) {
+			block.buffer = VK_NULL_HANDLE;
+			return false;
+		}
+		allocations[block.buffer] = allocation;
+		block.deviceAddress = hasDeviceAddress? device->GetBufferDeviceAddress(block.buffer) : 0;
+		return true;
+	}
+	
+	void DeviceBufferPoolBackend::DestroyBlock(BufferPoolBlock& block) {
+		auto it = allocations.find(block.buffer);
+		if (it != allocations.end()) {
+			device->FreeAndDestroyBuffer(block.buffer, it->second);
+			allocations.erase(it);
+		}
+		block = {};
+	}
+	
+	void RingStagingBuffer::Allocate(Device* device) {
+		if (this->device == nullptr) {
+			BufferObject::Allocate(device);
+			device->MapMemoryAllocation(allocation, (void**)&data, 0, size);
+		}
+	}
+	
+	void RingStagingBuffer::Free() {
+		std::lock_guard lock(mu);
+		if (device && data) {
+			device->UnmapMemoryAllocation(allocation);
+			data = nullptr;
+		}
+		ring.Reset();
+		imageUploads.clear();
+		BufferObject::Free();
+	}
+	
+	RingStagingBuffer::~RingStagingBuffer() {
+		Free();
+	}
+	
+	void RingStagingBuffer::BeginFrame(uint32_t frameIndex) {
+		std::lock_guard lock(mu);
+		ring.BeginFrame(frameIndex);
+	}
+	
+	bool RingStagingBuffer::Upload(VkBuffer dst, VkDeviceSize dstOffset, const void* src, VkDeviceSize size) {
+		std::lock_guard lock(mu);
+		assert(data);
+		VkDeviceSize offset = ring.Allocate(size);
+		if (offset == StagingRing::INVALID_OFFSET) return false;
+		memcpy(data + offset, src, size);
+		ring.Copy(obj, offset, dst, dstOffset, size);
+		return true;
+	}
+	
+	bool RingStagingBuffer::UploadToImage(VkImage dst, const VkBufferImageCopy& region, const void* src, VkDeviceSize size, std::function<void(VkCommandBuffer)>&& before, std::function<void(VkCommandBuffer)>&& after) {
+		std::lock_guard lock(mu);
+		assert(data);
+		VkDeviceSize offset = ring.Allocate(size);
+		if (offset == StagingRing::INVALID_OFFSET) return false;
+		memcpy(data + offset, src, size);
+		imageUploads.push_back({dst, region, std::move(before), std::move(after)});
+		imageUploads.back().region.bufferOffset = offset;
+		return true;
+	}
+	
+	void RingStagingBuffer::Copy(VkBuffer src, VkDeviceSize srcOffset, VkBuffer dst, VkDeviceSize dstOffset, VkDeviceSize size) {
+		std::lock_guard lock(mu);
+		ring.Copy(src, srcOffset, dst, dstOffset, size);
+	}
+	
+	StagingRing::Range RingStagingBuffer::Record(VkCommandBuffer cmdBuffer) {
+		if (!device || (ring.GetQueuedCopyCount() == 0 && imageUploads.empty())) return ring.MarkRecorded();
+		for (auto& upload : imageUploads) if (upload.before) upload.before(cmdBuffer);
+		ring.FlushCopies([this, cmdBuffer](VkBuffer src, VkBuffer dst, const VkBufferCopy* regions, uint32_t regionCount){
+			device->CmdCopyBuffer(cmdBuffer, src, dst, regionCount, regions);
+		});
+		for (auto& upload : imageUploads) {
+			device->CmdCopyBufferToImage(cmdBuffer, obj, upload.image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &upload.region);
+		}
+		for (auto& upload : imageUploads) if (upload.after) upload.after(cmdBuffer);
+		imageUploads.clear();
+		VkMemoryBarrier barrier {};{
+			barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+			barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+			barrier.dstAccessMask = VK_ACCESS_MEMORY_READ_BIT | VK_ACCESS_MEMORY_WRITE_BIT;
+		}
+		device->CmdPipelineBarrier(cmdBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, 0, 1, &barrier, 0, nullptr, 0, nullptr);
+		return ring.MarkRecorded();
+	}
+	
+	void RingStagingBuffer::Flush(VkCommandBuffer cmdBuffer) {
+		std::lock_guard lock(mu);
+		Record(cmdBuffer);
+	}
+	
+	bool RingStagingBuffer::FlushAndWait(Queue queue) {
+		if (!device) return false;
+		StagingRing::Range recorded {};
+		device->RunSingleTimeCommands(queue, [this, &recorded](VkCommandBuffer cmdBuffer){
+			std::lock_guard lock(mu);
+			recorded = Record(cmdBuffer);
+		});
+		std::lock_guard lock(mu);
+		// Not released yet if older uploads, possibly recorded into frames still in flight, are holding space before it
+		return ring.Release(recorded);
+	}
+	
 }
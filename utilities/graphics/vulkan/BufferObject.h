@@ -2,6 +2,17 @@
 
 #include <v4d.h>
 #include "utilities/graphics/vulkan/Device.h"
+#include "utilities/graphics/vulkan/BufferPool.h"
+#include "utilities/graphics/vulkan/StagingRing.h"
+#include "utilities/graphics/vulkan/DeferredReleaseQueue.h"
+
+#ifndef V4D_BUFFER_GROWTH_FACTOR
+	#define V4D_BUFFER_GROWTH_FACTOR 1.5 // minimum growth of a buffer resized while keeping its contents
+#endif
+
+#ifndef V4D_RING_STAGING_BUFFER_SIZE
+	#define V4D_RING_STAGING_BUFFER_SIZE (64 * 1024 * 1024) // shared by all the frames in flight
+#endif
 
 namespace v4d::graphics::vulkan {
 
@@ -18,6 +29,7 @@ class V4DLIB BufferObject {
 	MemoryAllocation allocation = VK_NULL_HANDLE;
 	VkDeviceOrHostAddressConstKHR address {};
 	VkDeviceSize alignedOffset = 0;
+	const char* allocationTag = "BufferObject"; // owner shown in memory allocation stats, copied when allocating so it only needs to live until Allocate() returns
 	
 	BufferObject(MemoryUsage memoryUsage, VkBufferUsageFlags bufferUsage, VkDeviceSize size, uint32_t alignment = 0)
 	 : obj(), memoryUsage(memoryUsage), bufferUsage(bufferUsage), size(size), alignment(alignment) {}
@@ -37,6 +49,17 @@ class V4DLIB BufferObject {
 		}
 	}
 	
+	/**
+	 * Grows the buffer to at least newSize while keeping its contents, never shrinks it
+	 * The size grows geometrically so that growing a little at a time does not reallocate every time
+	 * The copy to the new buffer is recorded in cmdBuffer and the old buffer is freed once releaseQueue gets to the current frame again
+	 * Returns true if the buffer was reallocated, its handle and address have changed then
+	 * The buffer must have both TRANSFER_SRC and TRANSFER_DST usage, it cannot be a mapped one (returns false without changing anything then)
+	 */
+	bool Resize(size_t newSize, VkCommandBuffer cmdBuffer, DeferredReleaseQueue& releaseQueue, double growthFactor = V4D_BUFFER_GROWTH_FACTOR);
+	// False for subclasses that keep a mapping of the buffer, which Resize(newSize, cmdBuffer, ...) would not redo
+	virtual bool CanGrow() const {return true;}
+	
 	virtual ~BufferObject();
 	
 	// operator FramebufferedBuffer() const {
@@ -62,6 +85,67 @@ class V4DLIB BufferObject {
 	operator VkDeviceAddress() const {return address.deviceAddress;}
 };
 
+// Creates the blocks of a BufferPool as actual buffers on a device
+class V4DLIB DeviceBufferPoolBackend : public BufferPoolBackend {
+	Device* device;
+	MemoryUsage memoryUsage;
+	VkBufferUsageFlags bufferUsage;
+	std::unordered_map<VkBuffer, MemoryAllocation> allocations {};
+public:
+	DeviceBufferPoolBackend(Device* device, MemoryUsage memoryUsage, VkBufferUsageFlags bufferUsage)
+	 : device(device), memoryUsage(memoryUsage), bufferUsage(bufferUsage) {}
+	virtual bool CreateBlock(BufferPoolBlock& block) override;
+	virtual void DestroyBlock(BufferPoolBlock& block) override;
+	Device* GetDevice() const {return device;}
+};
+
+// Persistently mapped staging buffer that uploads are sub-allocated from (StagingRing.h), all of them are recorded together by Flush() with one CmdCopyBuffer per destination buffer
+class V4DLIB RingStagingBuffer : public BufferObject {
+	struct ImageUpload {
+		VkImage image;
+		VkBufferImageCopy region;
+		std::function<void(VkCommandBuffer)> before;
+		std::function<void(VkCommandBuffer)> after;
+	};
+	StagingRing ring;
+	byte* data = nullptr;
+	std::vector<ImageUpload> imageUploads {};
+	std::mutex mu;
+	StagingRing::Range Record(VkCommandBuffer cmdBuffer); // mu must be locked
+public:
+	RingStagingBuffer(VkDeviceSize size = V4D_RING_STAGING_BUFFER_SIZE, uint32_t frameCount = V4D_RENDERER_FRAMEBUFFERS_MAX_FRAMES)
+	 : BufferObject(MEMORY_USAGE_CPU_ONLY, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, size), ring(size, frameCount) {
+		allocationTag = "RingStagingBuffer";
+	}
+	
+	virtual void Allocate(Device* device) override;
+	virtual void Free() override;
+	virtual void Resize(size_t, bool) override {assert(!"RingStagingBuffer cannot be resized");}
+	virtual bool CanGrow() const override {return false;}
+	virtual ~RingStagingBuffer();
+	
+	// Must be called once the fence of the previous use of this frame index has been waited for, Renderer::BeginFrame() does it for its uploadRing
+	void BeginFrame(uint32_t frameIndex);
+	
+	// These return false when the ring has no space left for this frame, nothing is queued then
+	bool Upload(VkBuffer dst, VkDeviceSize dstOffset, const void* src, VkDeviceSize size);
+	// before() is recorded before all the copies of a flush and after() after all of them, for layout transitions and mipmaps, whatever they capture must live until then
+	bool UploadToImage(VkImage dst, const VkBufferImageCopy& region, const void* src, VkDeviceSize size, std::function<void(VkCommandBuffer)>&& before = nullptr, std::function<void(VkCommandBuffer)>&& after = nullptr);
+	
+	// Queues a copy between two other buffers to be recorded with the next flush, src must not be modified until then
+	void Copy(VkBuffer src, VkDeviceSize srcOffset, VkBuffer dst, VkDeviceSize dstOffset, VkDeviceSize size);
+	
+	// Records all queued copies followed by a barrier that makes them visible to any later command
+	void Flush(VkCommandBuffer cmdBuffer);
+	/**
+	 * Submits all queued copies and waits for them, then releases the space they used
+	 * Returns false if that space could not be released yet because uploads recorded before it with Flush() may still be in flight, it is then released when its frame index begins again
+	 */
+	bool FlushAndWait(Queue queue);
+	
+	VkDeviceSize GetCapacity() const {return ring.GetCapacity();}
+};
+
 template<typename T>
 class MappedBufferObject : public BufferObject {
 protected:
@@ -139,6 +223,7 @@ public:
 		}
 		BufferObject::Resize(newCount * sizeof(T), allowReallocation);
 	}
+	virtual bool CanGrow() const override {return false;}
 	
 	T& operator[](size_t index) {
 		assert(index * sizeof(T) < size);
@@ -250,6 +335,16 @@ public:
 		}
 	}
 	
+	// Same as above, but batched with the other copies of the ring instead of being recorded right away
+	void Push(RingStagingBuffer& uploadRing, int32_t count = -1, VkDeviceSize offset = 0) {
+		if (count == 0) return;
+		if (hostBuffer.size > 0) {
+			assert(hostBuffer.device);
+			assert(count * int32_t(sizeof(T)) <= int32_t(hostBuffer.size));
+			uploadRing.Copy(hostBuffer, offset, deviceBuffer, offset + deviceBuffer.alignedOffset, count > 0? (uint32_t(count) * sizeof(T)) : hostBuffer.size);
+		}
+	}
+	
 	void Pull(VkCommandBuffer cmdBuffer, uint32_t count = -1, VkDeviceSize offset = 0) {
 		if (count == 0) return;
 		if (hostBuffer.size > 0) {
@@ -0,0 +1,146 @@
+#include "BufferPool.h"
+#include <algorithm>
+
+namespace v4d::graphics::vulkan {
+
+	BufferPool::~BufferPool() {
+		Clear();
+	}
+
+	uint32_t BufferPool::CreateBlock(VkDeviceSize size, bool dedicated) {
+		Block block {};
+		block.block.size = size;
+		block.dedicated = dedicated;
+		if (!backend->CreateBlock(block.block)) return ~0u;
+		block.freeRanges[0] = size;
+		// Reuse the slot of a destroyed block
+		for (uint32_t i = 0; i < blocks.size(); ++i) {
+			if (!blocks[i].IsAlive()) {
+				blocks[i] = std::move(block);
+				return i;
+			}
+		}
+		blocks.push_back(std::move(block));
+		return uint32_t(blocks.size() - 1);
+	}
+
+	void BufferPool::DestroyBlock(uint32_t index) {
+		backend->DestroyBlock(blocks[index].block);
+		blocks[index] = {};
+	}
+
+	bool BufferPool::AllocateFromBlock(uint32_t index, VkDeviceSize size, VkDeviceSize alignment, BufferPoolAllocation& allocation) {
+		Block& block = blocks[index];
+		// Aligning the offset only aligns the device address too when the block's address is aligned
+		if (block.block.deviceAddress % alignment != 0) return false;
+		// Smallest free range that fits once aligned
+		auto best = block.freeRanges.end();
+		VkDeviceSize bestOffset = 0;
+		for (auto it = block.freeRanges.begin(); it != block.freeRanges.end(); ++it) {
+			const auto [rangeOffset, rangeSize] = *it;
+			if (rangeSize < size) continue;
+			const VkDeviceSize offset = (rangeOffset + alignment - 1) & ~(alignment - 1);
+			if (offset + size > rangeOffset + rangeSize) continue;
+			if (best == block.freeRanges.end() || rangeSize < best->second) {
+				best = it;
+				bestOffset = offset;
+				if (rangeSize == size) break;
+			}
+		}
+		if (best == block.freeRanges.end()) return false;
+
+		const auto [rangeOffset, rangeSize] = *best;
+		block.freeRanges.erase(best);
+		// Keep the alignment padding and the remaining end of the range free
+		if (bestOffset > rangeOffset) block.freeRanges[rangeOffset] = bestOffset - rangeOffset;
+		if (bestOffset + size < rangeOffset + rangeSize) block.freeRanges[bestOffset + size] = rangeOffset + rangeSize - (bestOffset + size);
+
+		block.usedBytes += size;
+		block.allocationCount++;
+		allocation.buffer = block.block.buffer;
+		allocation.offset = bestOffset;
+		allocation.size = size;
+		allocation.deviceAddress = block.block.deviceAddress? block.block.deviceAddress + bestOffset : 0;
+		allocation.block = index;
+		return true;
+	}
+
+	BufferPoolAllocation BufferPool::Allocate(VkDeviceSize size, VkDeviceSize alignment) {
+		assert(alignment > 0 && (alignment & (alignment - 1)) == 0);
+		BufferPoolAllocation allocation {};
+		if (size == 0) return allocation;
+		std::lock_guard lock(mu);
+
+		const bool dedicated = size + alignment - 1 > blockSize;
+		if (!dedicated) {
+			for (uint32_t i = 0; i < blocks.size(); ++i) {
+				if (blocks[i].IsAlive() && !blocks[i].dedicated && AllocateFromBlock(i, size, alignment, allocation)) return allocation;
+			}
+		}
+		uint32_t index = CreateBlock(dedicated? size : blockSize, dedicated);
+		if (index != ~0u && !AllocateFromBlock(index, size, alignment, allocation)) {
+			LOG_ERROR("BufferPool block device address " << blocks[index].block.deviceAddress << " is not aligned to " << alignment)
+			DestroyBlock(index);
+		}
+		return allocation;
+	}
+
+	void BufferPool::Free(BufferPoolAllocation& allocation) {
+		if (!allocation.IsValid()) return;
+		std::lock_guard lock(mu);
+		assert(allocation.block < blocks.size() && blocks[allocation.block].block.buffer == allocation.buffer);
+		Block& block = blocks[allocation.block];
+		block.usedBytes -= allocation.size;
+		block.allocationCount--;
+
+		// Merge with the adjacent free ranges
+		VkDeviceSize offset = allocation.offset, size = allocation.size;
+		auto next = block.freeRanges.lower_bound(offset);
+		if (next != block.freeRanges.end() && next->first == offset + size) {
+			size += next->second;
+			next = block.freeRanges.erase(next);
+		}
+		if (next != block.freeRanges.begin()) {
+			auto previous = std::prev(next);
+			if (previous->first + previous->second == offset) {
+				offset = previous->first;
+				size += previous->second;
+				block.freeRanges.erase(previous);
+			}
+		}
+		block.freeRanges[offset] = size;
+
+		if (block.allocationCount == 0) {
+			const uint32_t index = allocation.block;
+			bool destroy = block.dedicated;
+			for (uint32_t i = 0; !destroy && i < blocks.size(); ++i) {
+				destroy = i != index && blocks[i].IsAlive() && !blocks[i].dedicated && blocks[i].allocationCount == 0;
+			}
+			if (destroy) DestroyBlock(index);
+		}
+		allocation = {};
+	}
+
+	void BufferPool::Clear() {
+		std::lock_guard lock(mu);
+		for (uint32_t i = 0; i < blocks.size(); ++i) {
+			if (blocks[i].IsAlive()) DestroyBlock(i);
+		}
+		blocks.clear();
+	}
+
+	BufferPool::Stats BufferPool::GetStats() const {
+		std::lock_guard lock(mu);
+		Stats stats {};
+		for (const auto& block : blocks) {
+			if (!block.IsAlive()) continue;
+			stats.blockCount++;
+			if (block.dedicated) stats.dedicatedBlockCount++;
+			stats.allocationCount += block.allocationCount;
+			stats.reservedBytes += block.block.size;
+			stats.usedBytes += block.usedBytes;
+			for (const auto& [offset, size] : block.freeRanges) stats.largestFreeRange = std::max(stats.largestFreeRange, size);
+		}
+		return stats;
+	}
+}
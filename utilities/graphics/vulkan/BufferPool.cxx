@@ -0,0 +1,175 @@
+#include <v4d.h>
+#include <algorithm>
+#include "utilities/graphics/vulkan/BufferPool.h"
+
+namespace v4d::tests {
+	int BufferPool() {
+		using namespace v4d::graphics::vulkan;
+
+		// Fake buffers without a GPU, with device addresses that are not aligned to more than addressAlignment bytes
+		struct MockBackend : BufferPoolBackend {
+			uint64_t nextId = 1;
+			int liveBlocks = 0;
+			int createdBlocks = 0;
+			VkDeviceSize maxBlockSize = ~VkDeviceSize(0);
+			VkDeviceSize addressAlignment = 256;
+			bool CreateBlock(BufferPoolBlock& block) override {
+				if (block.size > maxBlockSize) return false;
+				block.buffer = reinterpret_cast<VkBuffer>(uintptr_t(nextId));
+				block.deviceAddress = (nextId << 32) + addressAlignment;
+				++nextId;
+				++liveBlocks;
+				++createdBlocks;
+				return true;
+			}
+			void DestroyBlock(BufferPoolBlock& block) override {
+				--liveBlocks;
+				block = {};
+			}
+		};
+
+		uint64_t seed = 1;
+		auto random = [&seed](uint64_t max){
+			seed = seed * 6364136223846793005ull + 1442695040888963407ull;
+			return (seed >> 33) % max;
+		};
+		const VkDeviceSize blockSize = 1 << 20;
+
+		{// Test 1 (alignment, no overlaps and block reuse with thousands of small allocations)
+			MockBackend backend {};
+			v4d::graphics::vulkan::BufferPool pool(&backend, blockSize);
+			std::vector<BufferPoolAllocation> allocations {};
+			VkDeviceSize total = 0;
+			for (int i = 0; i < 4000; ++i) {
+				VkDeviceSize size = 1 + random(4096), alignment = VkDeviceSize(1) << random(9);
+				auto allocation = pool.Allocate(size, alignment);
+				if (!allocation.IsValid() || allocation.size != size || allocation.deviceAddress % alignment != 0 || allocation.offset % alignment != 0 || allocation.offset + size > blockSize) {
+					LOG_ERROR("v4d::tests::BufferPool ERROR 1.1 (allocation " << i << ")")
+					return 1;
+				}
+				allocations.push_back(allocation);
+				total += size;
+			}
+			std::sort(allocations.begin(), allocations.end(), [](auto& a, auto& b){return a.deviceAddress < b.deviceAddress;});
+			for (size_t i = 1; i < allocations.size(); ++i) {
+				if (allocations[i-1].deviceAddress + allocations[i-1].size > allocations[i].deviceAddress) {
+					LOG_ERROR("v4d::tests::BufferPool ERROR 1.2 (overlap)")
+					return 1;
+				}
+			}
+			auto stats = pool.GetStats();
+			// At most a block worth of alignment padding and unused block ends
+			if (stats.allocationCount != 4000 || stats.usedBytes != total || stats.blockCount > total / blockSize + 2 || backend.liveBlocks != (int)stats.blockCount) {
+				LOG_ERROR("v4d::tests::BufferPool ERROR 1.3 (" << stats.blockCount << " blocks for " << total << " bytes)")
+				return 1;
+			}
+			// Free half of them and allocate again, the freed ranges must be reused without new blocks
+			for (size_t i = 0; i < allocations.size(); i += 2) pool.Free(allocations[i]);
+			int created = backend.createdBlocks;
+			for (size_t i = 0; i < allocations.size(); i += 2) {
+				allocations[i] = pool.Allocate(1 + random(2048), 256);
+			}
+			if (backend.createdBlocks != created) {
+				LOG_ERROR("v4d::tests::BufferPool ERROR 1.4 (" << (backend.createdBlocks - created) << " new blocks)")
+				return 1;
+			}
+			// Freeing everything merges all ranges and keeps a single empty block
+			for (auto& allocation : allocations) pool.Free(allocation);
+			stats = pool.GetStats();
+			if (stats.blockCount != 1 || stats.usedBytes != 0 || stats.allocationCount != 0 || stats.largestFreeRange != blockSize || backend.liveBlocks != 1 || allocations[0].IsValid()) {
+				LOG_ERROR("v4d::tests::BufferPool ERROR 1.5 (" << stats.blockCount << " blocks, largest free range " << stats.largestFreeRange << ")")
+				return 1;
+			}
+			pool.Clear();
+			if (backend.liveBlocks != 0) {
+				LOG_ERROR("v4d::tests::BufferPool ERROR 1.6 (" << backend.liveBlocks << " blocks not destroyed)")
+				return 1;
+			}
+		}
+
+		{// Test 2 (freed ranges are merged with their neighbours)
+			MockBackend backend {};
+			v4d::graphics::vulkan::BufferPool pool(&backend, blockSize);
+			auto a = pool.Allocate(1000, 64);
+			auto b = pool.Allocate(3000, 64);
+			auto c = pool.Allocate(2000, 64);
+			auto d = pool.Allocate(5000, 64);
+			const VkDeviceSize bOffset = b.offset;
+			pool.Free(b);
+			pool.Free(c);
+			// b and c merged, so this fits where b was
+			auto e = pool.Allocate(4500, 64);
+			if (e.offset != bOffset || e.buffer != a.buffer) {
+				LOG_ERROR("v4d::tests::BufferPool ERROR 2.1 (offset " << e.offset << " instead of " << bOffset << ")")
+				return 2;
+			}
+			// Best fit, a smaller hole left after e is preferred over the end of the block
+			auto f = pool.Allocate(100, 1);
+			if (f.offset != e.offset + 4500) {
+				LOG_ERROR("v4d::tests::BufferPool ERROR 2.2 (offset " << f.offset << ")")
+				return 2;
+			}
+			pool.Free(a);
+			pool.Free(d);
+			pool.Free(e);
+			pool.Free(f);
+			if (pool.GetStats().largestFreeRange != blockSize) {
+				LOG_ERROR("v4d::tests::BufferPool ERROR 2.3")
+				return 2;
+			}
+		}
+
+		{// Test 3 (dedicated blocks and backend failures)
+			MockBackend backend {};
+			v4d::graphics::vulkan::BufferPool pool(&backend, blockSize);
+			auto small = pool.Allocate(100, 256);
+			auto large = pool.Allocate(blockSize * 3, 256);
+			auto stats = pool.GetStats();
+			if (!large.IsValid() || large.deviceAddress % 256 != 0 || stats.blockCount != 2 || stats.dedicatedBlockCount != 1 || large.buffer == small.buffer) {
+				LOG_ERROR("v4d::tests::BufferPool ERROR 3.1 (dedicated)")
+				return 3;
+			}
+			// Small allocations never go in the remaining space of a dedicated block
+			auto other = pool.Allocate(100, 1);
+			if (other.buffer != small.buffer) {
+				LOG_ERROR("v4d::tests::BufferPool ERROR 3.2")
+				return 3;
+			}
+			pool.Free(large);
+			if (pool.GetStats().blockCount != 1 || backend.liveBlocks != 1) {
+				LOG_ERROR("v4d::tests::BufferPool ERROR 3.3 (dedicated block not destroyed)")
+				return 3;
+			}
+			backend.maxBlockSize = blockSize;
+			auto failed = pool.Allocate(blockSize * 2, 1);
+			if (failed.IsValid() || pool.Allocate(0).IsValid()) {
+				LOG_ERROR("v4d::tests::BufferPool ERROR 3.4 (failed allocation)")
+				return 3;
+			}
+			pool.Free(failed); // no-op
+			pool.Free(small);
+			pool.Free(other);
+		}
+
+		{// Test 4 (blocks whose device address is not aligned enough are not used for that alignment, as aligning the offset would misalign the address)
+			MockBackend backend {};
+			backend.addressAlignment = 64;
+			v4d::graphics::vulkan::BufferPool pool(&backend, blockSize);
+			auto a = pool.Allocate(100, 64);
+			auto b = pool.Allocate(100, 64);
+			if (!a.IsValid() || b.buffer != a.buffer || b.offset % 64 != 0 || b.deviceAddress % 64 != 0) {
+				LOG_ERROR("v4d::tests::BufferPool ERROR 4.1")
+				return 4;
+			}
+			auto misaligned = pool.Allocate(100, 256);
+			if (misaligned.IsValid() || pool.GetStats().blockCount != 1 || backend.liveBlocks != 1) {
+				LOG_ERROR("v4d::tests::BufferPool ERROR 4.2 (allocated from a misaligned block)")
+				return 4;
+			}
+			pool.Free(a);
+			pool.Free(b);
+		}
+
+		return 0;
+	}
+}
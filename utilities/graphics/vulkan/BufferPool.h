@@ -0,0 +1,94 @@
+/*
+ * Sub-allocation of many small buffer ranges from a few large pooled buffers
+ * Part of the Vulkan4D open-source game engine under the LGPL license - https://github.com/Vulkan4D
+ *
+ * Large blocks are created and destroyed through a BufferPoolBackend, DeviceBufferPoolBackend (BufferObject.h) creates actual VkBuffers while tests use a mock backend without a GPU.
+ * Each block keeps its free ranges sorted by offset and merges them back on free, an allocation takes the smallest free range that fits in the first block that has one.
+ * Requests larger than the block size get a dedicated block. Empty blocks are destroyed, except for one that is kept to avoid reallocating a block when usage goes up and down around a block boundary.
+ */
+#pragma once
+
+#include <v4d.h>
+#include <map>
+#include <mutex>
+#include <vector>
+
+#ifndef V4D_BUFFER_POOL_BLOCK_SIZE
+	#define V4D_BUFFER_POOL_BLOCK_SIZE (64 * 1024 * 1024)
+#endif
+
+namespace v4d::graphics::vulkan {
+
+	struct BufferPoolBlock {
+		VkBuffer buffer = VK_NULL_HANDLE;
+		VkDeviceAddress deviceAddress = 0;
+		VkDeviceSize size = 0;
+	};
+
+	class V4DLIB BufferPoolBackend {
+	public:
+		virtual ~BufferPoolBackend() = default;
+		// Fills block.buffer and block.deviceAddress for a buffer of block.size bytes, returns false if it could not be allocated
+		virtual bool CreateBlock(BufferPoolBlock& block) = 0;
+		virtual void DestroyBlock(BufferPoolBlock& block) = 0;
+	};
+
+	struct BufferPoolAllocation {
+		VkBuffer buffer = VK_NULL_HANDLE;
+		VkDeviceSize offset = 0;
+		VkDeviceSize size = 0;
+		VkDeviceAddress deviceAddress = 0; // address of the allocation itself, not of the buffer
+		uint32_t block = ~0u;
+		bool IsValid() const {return block != ~0u;}
+	};
+
+	class V4DLIB BufferPool {
+		struct Block {
+			BufferPoolBlock block {};
+			std::map<VkDeviceSize, VkDeviceSize> freeRanges {}; // offset -> size
+			VkDeviceSize usedBytes = 0;
+			uint32_t allocationCount = 0;
+			bool dedicated = false;
+			bool IsAlive() const {return block.size > 0;}
+		};
+
+		BufferPoolBackend* backend;
+		VkDeviceSize blockSize;
+		std::vector<Block> blocks {}; // destroyed blocks leave an empty slot so that the block index of allocations stays valid
+		mutable std::mutex mu;
+
+		uint32_t CreateBlock(VkDeviceSize size, bool dedicated);
+		void DestroyBlock(uint32_t index);
+		bool AllocateFromBlock(uint32_t index, VkDeviceSize size, VkDeviceSize alignment, BufferPoolAllocation& allocation);
+
+	public:
+		BufferPool(BufferPoolBackend* backend, VkDeviceSize blockSize = V4D_BUFFER_POOL_BLOCK_SIZE) : backend(backend), blockSize(blockSize) {}
+		~BufferPool();
+
+		BufferPool(const BufferPool&) = delete;
+		BufferPool& operator=(const BufferPool&) = delete;
+
+		/**
+		 * Returns a range of size bytes whose offset and device address are both multiples of alignment (a power of two)
+		 * Block device addresses must be multiples of the largest alignment requested, as those of buffers whose memory requirements have that alignment
+		 * The returned allocation is invalid if the backend could not create a block
+		 */
+		BufferPoolAllocation Allocate(VkDeviceSize size, VkDeviceSize alignment = 1);
+
+		// Returns the range to its block and resets the allocation
+		void Free(BufferPoolAllocation& allocation);
+
+		// Destroys all blocks, all allocations must have been freed or not be used anymore
+		void Clear();
+
+		struct Stats {
+			uint32_t blockCount = 0;
+			uint32_t dedicatedBlockCount = 0;
+			uint32_t allocationCount = 0;
+			VkDeviceSize reservedBytes = 0; // total size of all blocks
+			VkDeviceSize usedBytes = 0; // total size of all allocations
+			VkDeviceSize largestFreeRange = 0;
+		};
+		Stats GetStats() const;
+	};
+}
@@ -0,0 +1,50 @@
+#include "DeferredReleaseQueue.h"
+
+namespace v4d::graphics::vulkan {
+
+	DeferredReleaseQueue::DeferredReleaseQueue(uint32_t frameCount) : pending(frameCount) {
+		assert(frameCount > 0);
+	}
+
+	DeferredReleaseQueue::~DeferredReleaseQueue() {
+		ReleaseAll();
+	}
+
+	void DeferredReleaseQueue::Defer(std::function<void()>&& release) {
+		std::lock_guard lock(mu);
+		pending[currentFrame].push_back(std::move(release));
+	}
+
+	void DeferredReleaseQueue::BeginFrame(uint32_t frameIndex) {
+		assert(frameIndex < pending.size());
+		std::vector<std::function<void()>> releases;
+		{
+			std::lock_guard lock(mu);
+			currentFrame = frameIndex;
+			releases.swap(pending[frameIndex]);
+		}
+		// Without the lock, a release may queue another one
+		for (auto& release : releases) release();
+	}
+
+	void DeferredReleaseQueue::ReleaseAll() {
+		std::vector<std::function<void()>> releases;
+		{
+			std::lock_guard lock(mu);
+			// Oldest frames first, starting after the current one
+			for (size_t i = 1; i <= pending.size(); ++i) {
+				auto& frame = pending[(currentFrame + i) % pending.size()];
+				releases.insert(releases.end(), std::make_move_iterator(frame.begin()), std::make_move_iterator(frame.end()));
+				frame.clear();
+			}
+		}
+		for (auto& release : releases) release();
+	}
+
+	size_t DeferredReleaseQueue::GetPendingCount() const {
+		std::lock_guard lock(mu);
+		size_t count = 0;
+		for (auto& frame : pending) count += frame.size();
+		return count;
+	}
+}
@@ -0,0 +1,63 @@
+#include <v4d.h>
+#include "utilities/graphics/vulkan/DeferredReleaseQueue.h"
+
+namespace v4d::tests {
+	int DeferredReleaseQueue() {
+		using namespace v4d::graphics::vulkan;
+
+		{// Test 1 (releases run when their frame index begins again, not before)
+			std::vector<int> released;
+			v4d::graphics::vulkan::DeferredReleaseQueue queue(2);
+			queue.BeginFrame(0);
+			queue.Defer([&]{released.push_back(1);});
+			queue.Defer([&]{released.push_back(2);});
+			queue.BeginFrame(1);
+			queue.Defer([&]{released.push_back(3);});
+			if (released.size() != 0 || queue.GetPendingCount() != 3) {
+				LOG_ERROR("v4d::tests::DeferredReleaseQueue ERROR 1.1 (" << released.size() << " released too early)")
+				return 1;
+			}
+			queue.BeginFrame(0);
+			if (released != std::vector<int>{1, 2} || queue.GetPendingCount() != 1) {
+				LOG_ERROR("v4d::tests::DeferredReleaseQueue ERROR 1.2 (" << released.size() << " released)")
+				return 1;
+			}
+			queue.BeginFrame(1);
+			if (released != std::vector<int>{1, 2, 3} || queue.GetPendingCount() != 0) {
+				LOG_ERROR("v4d::tests::DeferredReleaseQueue ERROR 1.3 (" << released.size() << " released)")
+				return 1;
+			}
+		}
+
+		{// Test 2 (a release may defer another one, ReleaseAll runs the oldest frames first, destruction releases the rest)
+			std::vector<int> released;
+			{
+				v4d::graphics::vulkan::DeferredReleaseQueue queue(3);
+				queue.BeginFrame(0);
+				queue.Defer([&]{released.push_back(1); queue.Defer([&]{released.push_back(4);});});
+				queue.BeginFrame(1);
+				queue.Defer([&]{released.push_back(2);});
+				queue.BeginFrame(2);
+				queue.Defer([&]{released.push_back(3);});
+				queue.BeginFrame(0);
+				// The release deferred from within frame 0 belongs to frame 0 again
+				if (released != std::vector<int>{1} || queue.GetPendingCount() != 3) {
+					LOG_ERROR("v4d::tests::DeferredReleaseQueue ERROR 2.1 (" << released.size() << " released, " << queue.GetPendingCount() << " pending)")
+					return 2;
+				}
+				queue.ReleaseAll();
+				if (released != std::vector<int>{1, 2, 3, 4} || queue.GetPendingCount() != 0) {
+					LOG_ERROR("v4d::tests::DeferredReleaseQueue ERROR 2.2 (order)")
+					return 2;
+				}
+				queue.Defer([&]{released.push_back(5);});
+			}
+			if (released.size() != 5) {
+				LOG_ERROR("v4d::tests::DeferredReleaseQueue ERROR 2.3 (not released on destruction)")
+				return 2;
+			}
+		}
+
+		return 0;
+	}
+}
@@ -0,0 +1,37 @@
+/*
+ * Release of device objects that may still be in use by frames in flight
+ * Part of the Vulkan4D open-source game engine under the LGPL license - https://github.com/Vulkan4D
+ *
+ * A release queued during a frame runs when that frame index begins again, the caller must have waited for the fence of its previous use before that.
+ * BufferObject::Resize uses it to free the old buffer after the copy that preserves its contents, tests use it with plain callbacks without a GPU.
+ */
+#pragma once
+
+#include <v4d.h>
+#include <functional>
+#include <mutex>
+#include <vector>
+
+namespace v4d::graphics::vulkan {
+
+	class V4DLIB DeferredReleaseQueue {
+		std::vector<std::vector<std::function<void()>>> pending; // per frame index
+		uint32_t currentFrame = 0;
+		mutable std::mutex mu;
+
+	public:
+		DeferredReleaseQueue(uint32_t frameCount);
+		~DeferredReleaseQueue(); // releases everything still pending
+
+		// Queues a release for after the GPU work of the current frame has completed
+		void Defer(std::function<void()>&& release);
+
+		// Runs the releases that were queued the last time this frame index was used
+		void BeginFrame(uint32_t frameIndex);
+
+		// Runs all pending releases, the device must be idle
+		void ReleaseAll();
+
+		size_t GetPendingCount() const;
+	};
+}
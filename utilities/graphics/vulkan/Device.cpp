@@ -263,17 +263,146 @@ bool Device::TryRunSingleTimeCommands(Queue queue, std::function<bool(VkCommandB
 	return result;
 }
 
-#ifdef V4D_VULKAN_USE_VMA
-	void Device::DumpMemoryAllocationStats() {
+#ifndef V4D_VULKAN_USE_VMA
+	static std::ostream& operator<<(std::ostream& out, const MemoryAllocationTracker::Counters& counters) {
+		return out << "{\"Count\": " << counters.count << ", \"Bytes\": " << counters.bytes << ", \"PeakCount\": " << counters.peakCount << ", \"PeakBytes\": " << counters.peakBytes << ", \"TotalCount\": " << counters.totalCount << "}";
+	}
+#endif
+void Device::DumpMemoryAllocationStats() {
+	std::ofstream file("vramdump.json");
+	#ifdef V4D_VULKAN_USE_VMA
 		char* str;
 		vmaBuildStatsString(allocator, &str, true);
-		std::ofstream file("vramdump.json");
 		file << str << std::endl;
 		vmaFreeStatsString(allocator, str);
-	}
-#endif
+	#else
+		static const char* usageNames[] {"UNKNOWN", "GPU_ONLY", "CPU_ONLY", "CPU_TO_GPU", "GPU_TO_CPU", "CPU_COPY", "GPU_LAZILY_ALLOCATED"};
+		auto snapshot = memoryAllocationTracker.GetSnapshot();
+		file << "{\n\t\"Total\": " << snapshot.allocations << ",\n\t\"Blocks\": " << snapshot.blocks << ",\n";
+		// Reserved bytes above a heap size show overcommitment before the driver runs out of memory
+		file << "\t\"Heaps\": [";
+		for (uint32_t h = 0; h < memoryProperties.memoryHeapCount; ++h) {
+			VkDeviceSize reservedBytes = 0, peakReservedBytes = 0;
+			for (auto& [type, counters] : snapshot.blocksPerMemoryType) if (memoryProperties.memoryTypes[type].heapIndex == h) {
+				reservedBytes += counters.bytes;
+				peakReservedBytes += counters.peakBytes;
+			}
+			file << (h? ",":"") << "\n\t\t{\"Size\": " << memoryProperties.memoryHeaps[h].size << ", \"Flags\": " << memoryProperties.memoryHeaps[h].flags << ", \"ReservedBytes\": " << reservedBytes << ", \"PeakReservedBytes\": " << peakReservedBytes << "}";
+		}
+		file << "\n\t],\n\t\"MemoryTypes\": {";
+		for (uint32_t t = 0; t < memoryProperties.memoryTypeCount; ++t) {
+			file << (t? ",":"") << "\n\t\t\"" << t << "\": {\"Heap\": " << memoryProperties.memoryTypes[t].heapIndex << ", \"Flags\": " << memoryProperties.memoryTypes[t].propertyFlags
+				<< ", \"Allocations\": " << snapshot.allocationsPerMemoryType[t] << ", \"Blocks\": " << snapshot.blocksPerMemoryType[t] << "}";
+		}
+		file << "\n\t},\n\t\"Usages\": {";
+		bool first = true;
+		for (auto& [usage, counters] : snapshot.allocationsPerUsage) {
+			file << (first? "":",") << "\n\t\t\"" << (usage < std::size(usageNames)? usageNames[usage] : "MAX_ENUM") << "\": " << counters;
+			first = false;
+		}
+		file << "\n\t},\n\t\"Tags\": {";
+		first = true;
+		for (auto& [tag, counters] : snapshot.allocationsPerTag) {
+			file << (first? "":",") << "\n\t\t\"" << tag << "\": " << counters;
+			first = false;
+		}
+		file << "\n\t}\n}" << std::endl;
+	#endif
+}
 
 // Allocator
+#ifndef V4D_VULKAN_USE_VMA
+	static VkMemoryPropertyFlags GetMemoryPropertyFlags(MemoryUsage memoryUsage) {
+		switch (memoryUsage) {
+			case MEMORY_USAGE_UNKNOWN: return VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
+			case MEMORY_USAGE_GPU_ONLY: return VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT;
+			case MEMORY_USAGE_CPU_ONLY: return VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
+			case MEMORY_USAGE_CPU_TO_GPU: return VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT;
+			case MEMORY_USAGE_GPU_TO_CPU: return VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_CACHED_BIT;
+			case MEMORY_USAGE_CPU_COPY: return VK_MEMORY_PROPERTY_HOST_CACHED_BIT;
+			case MEMORY_USAGE_GPU_LAZILY_ALLOCATED: return VK_MEMORY_PROPERTY_LAZILY_ALLOCATED_BIT;
+			case MEMORY_USAGE_MAX_ENUM: return VK_MEMORY_PROPERTY_FLAG_BITS_MAX_ENUM;
+		}
+		return 0;
+	}
+	
+	VkResult Device::AllocateDeviceMemory(const VkMemoryRequirements& memRequirements, MemoryUsage memoryUsage, DeviceMemoryBlockKind kind, MemoryAllocation* pAllocation) {
+		const uint32_t memoryTypeIndex = GetPhysicalDevice()->FindMemoryType(memRequirements.memoryTypeBits, GetMemoryPropertyFlags(memoryUsage));
+		const VkDeviceSize heapSize = memoryProperties.memoryHeaps[memoryProperties.memoryTypes[memoryTypeIndex].heapIndex].size;
+		const VkDeviceSize blockSize = std::min<VkDeviceSize>(V4D_DEVICE_MEMORY_BLOCK_SIZE, heapSize / 8);
+		const bool dedicated = memoryUsage == MEMORY_USAGE_GPU_LAZILY_ALLOCATED || memRequirements.size > blockSize / 2;
+		
+		std::lock_guard lock(memoryBlocksMutex);
+		DeviceMemoryBlock* block = nullptr;
+		TlsfAllocator::Allocation range {};
+		if (!dedicated) for (auto& b : memoryBlocks) {
+			if (b->dedicated || b->memoryTypeIndex != memoryTypeIndex || b->kind != kind) continue;
+			range = b->allocator.Allocate(memRequirements.size, memRequirements.alignment);
+			if (range.IsValid()) {
+				block = b.get();
+				break;
+			}
+		}
+		
+		if (!block) {
+			VkMemoryAllocateFlagsInfo memoryAllocateFlagsInfo {};
+				memoryAllocateFlagsInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_FLAGS_INFO;
+				if (kind == DEVICE_MEMORY_BLOCK_LINEAR_DEVICE_ADDRESS) {
+					memoryAllocateFlagsInfo.flags = VK_MEMORY_ALLOCATE_DEVICE_ADDRESS_BIT_KHR;
+				}
+			VkMemoryAllocateInfo allocInfo {};
+				allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+				allocInfo.pNext = memoryAllocateFlagsInfo.flags > 0 ? &memoryAllocateFlagsInfo : nullptr;
+				allocInfo.allocationSize = dedicated? memRequirements.size : blockSize;
+				allocInfo.memoryTypeIndex = memoryTypeIndex;
+			VkDeviceMemory memory;
+			VkResult result = AllocateMemory(&allocInfo, nullptr, &memory);
+			if (result != VK_SUCCESS) {
+				auto snapshot = memoryAllocationTracker.GetSnapshot();
+				LOG_ERROR("Failed to allocate " << allocInfo.allocationSize << " bytes of device memory type " << memoryTypeIndex << " (heap of " << heapSize << " bytes, " << snapshot.blocksPerMemoryType[memoryTypeIndex].bytes << " bytes already reserved for this memory type)")
+				return result;
+			}
+			memoryAllocationTracker.TrackBlock(memoryTypeIndex, allocInfo.allocationSize);
+			block = memoryBlocks.emplace_back(std::make_unique<DeviceMemoryBlock>(memory, memoryTypeIndex, kind, dedicated, allocInfo.allocationSize)).get();
+			range = block->allocator.Allocate(memRequirements.size, memRequirements.alignment);
+			if (!range.IsValid()) {
+				LOG_ERROR("Failed to sub-allocate " << memRequirements.size << " bytes aligned to " << memRequirements.alignment << " in a new device memory block of " << allocInfo.allocationSize << " bytes")
+				memoryAllocationTracker.UntrackBlock(memoryTypeIndex, allocInfo.allocationSize);
+				FreeMemory(memory, nullptr);
+				memoryBlocks.pop_back();
+				return VK_ERROR_OUT_OF_DEVICE_MEMORY;
+			}
+		}
+		
+		*pAllocation = new DeviceMemoryAllocation {block->memory, range.offset, range.size, block, range};
+		return VK_SUCCESS;
+	}
+	
+	void Device::FreeDeviceMemory(MemoryAllocation& allocation) {
+		std::lock_guard lock(memoryBlocksMutex);
+		if (!allocatorCreated) {
+			// Its block was already freed by DestroyAllocator()
+			delete allocation;
+			return;
+		}
+		DeviceMemoryBlock* block = allocation->block;
+		block->allocator.Free(allocation->range);
+		delete allocation;
+		if (block->allocator.IsEmpty()) {
+			// Keep one empty block per memory type and kind, to avoid reallocating a block when usage goes up and down around a block boundary
+			bool release = block->dedicated;
+			for (size_t i = 0; !release && i < memoryBlocks.size(); ++i) {
+				const auto& b = memoryBlocks[i];
+				release = b.get() != block && !b->dedicated && b->memoryTypeIndex == block->memoryTypeIndex && b->kind == block->kind && b->allocator.IsEmpty();
+			}
+			if (release) {
+				memoryAllocationTracker.UntrackBlock(block->memoryTypeIndex, block->allocator.GetSize());
+				FreeMemory(block->memory, nullptr);
+				std::erase_if(memoryBlocks, [block](auto& b){return b.get() == block;});
+			}
+		}
+	}
+#endif
 void Device::CreateAllocator() {
 	#ifdef V4D_VULKAN_USE_VMA
 		VmaVulkanFunctions vulkanFunctions {};{
@@ -318,16 +447,36 @@ void Device::CreateAllocator() {
 			}
 		}
 		vmaCreateAllocator(&allocatorInfo, &allocator);
+	#else
+		instance->GetPhysicalDeviceMemoryProperties(GetPhysicalDeviceHandle(), &memoryProperties);
+		nonCoherentAtomSize = std::max<VkDeviceSize>(1, GetPhysicalDevice()->GetProperties().limits.nonCoherentAtomSize);
+		std::lock_guard lock(memoryBlocksMutex);
+		allocatorCreated = true;
 	#endif
 }
 void Device::DestroyAllocator() {
+	auto snapshot = memoryAllocationTracker.GetSnapshot();
+	if (snapshot.allocations.count > 0) {
+		LOG_WARN("Destroying the memory allocator with " << snapshot.allocations.count << " allocations (" << snapshot.allocations.bytes << " bytes) not freed")
+		for (auto& [tag, counters] : snapshot.allocationsPerTag) if (counters.count > 0) {
+			LOG_WARN("    " << tag << ": " << counters.count << " allocations, " << counters.bytes << " bytes")
+		}
+	}
+	memoryAllocationTracker.Reset();
 	#ifdef V4D_VULKAN_USE_VMA
 		std::lock_guard lock(allocatorDeleteMutex);
 		vmaDestroyAllocator(allocator);
 		allocator = VK_NULL_HANDLE;
+	#else
+		std::lock_guard lock(memoryBlocksMutex);
+		for (auto& block : memoryBlocks) {
+			FreeMemory(block->memory, nullptr);
+		}
+		memoryBlocks.clear();
+		allocatorCreated = false;
 	#endif
 }
-VkResult Device::CreateAndAllocateBuffer(const VkBufferCreateInfo& bufferCreateInfo, MemoryUsage memoryUsage, VkBuffer& buffer, MemoryAllocation* pAllocation, bool weakAllocation) {
+VkResult Device::CreateAndAllocateBuffer(const VkBufferCreateInfo& bufferCreateInfo, MemoryUsage memoryUsage, VkBuffer& buffer, MemoryAllocation* pAllocation, bool weakAllocation, const char* allocationTag) {
 	#ifdef V4D_VULKAN_USE_VMA
 		VmaAllocationCreateInfo allocInfo {};
 			allocInfo.usage = (VmaMemoryUsage)memoryUsage;
@@ -337,7 +486,13 @@ VkResult Device::CreateAndAllocateBuffer(const VkBufferCreateInfo& bufferCreateI
 			// if (Loader::VULKAN_API_VERSION >= VK_API_VERSION_1_2 && (bufferCreateInfo.usage & VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT)) {
 			// 	allocInfo.flags |= VMA_ALLOCATOR_CREATE_BUFFER_DEVICE_ADDRESS_BIT;
 			// }
-		return vmaCreateBuffer(allocator, &bufferCreateInfo, &allocInfo, &buffer, pAllocation, nullptr);
+		VkResult result = vmaCreateBuffer(allocator, &bufferCreateInfo, &allocInfo, &buffer, pAllocation, nullptr);
+		if (result == VK_SUCCESS) {
+			VmaAllocationInfo allocationInfo;
+			vmaGetAllocationInfo(allocator, *pAllocation, &allocationInfo);
+			memoryAllocationTracker.TrackAllocation(*pAllocation, allocationInfo.memoryType, memoryUsage, allocationInfo.size, allocationTag);
+		}
+		return result;
 	#else
 		if (CreateBuffer(&bufferCreateInfo, nullptr, &buffer) != VK_SUCCESS) {
 			throw std::runtime_error("Failed to create buffer");
@@ -346,58 +501,19 @@ VkResult Device::CreateAndAllocateBuffer(const VkBufferCreateInfo& bufferCreateI
 		VkMemoryRequirements memRequirements;
 		GetBufferMemoryRequirements(buffer, &memRequirements);
 		
-		VkDeviceSize allocSize = memRequirements.size;
-		if ((allocSize % memRequirements.alignment) > 0) {
-			allocSize += memRequirements.alignment - (allocSize % memRequirements.alignment);
+		DeviceMemoryBlockKind kind = DEVICE_MEMORY_BLOCK_LINEAR;
+		if (Loader::VULKAN_API_VERSION >= VK_API_VERSION_1_2 && (bufferCreateInfo.usage & VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT)) {
+			kind = DEVICE_MEMORY_BLOCK_LINEAR_DEVICE_ADDRESS;
 		}
-		
-		VkMemoryAllocateFlagsInfo memoryAllocateFlagsInfo {};
-			memoryAllocateFlagsInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_FLAGS_INFO;
-			if (Loader::VULKAN_API_VERSION >= VK_API_VERSION_1_2 && (bufferCreateInfo.usage & VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT)) {
-				memoryAllocateFlagsInfo.flags = VK_MEMORY_ALLOCATE_DEVICE_ADDRESS_BIT_KHR;
-			}
-
-		VkMemoryAllocateInfo allocInfo = {};
-			allocInfo.pNext = memoryAllocateFlagsInfo.flags > 0 ? &memoryAllocateFlagsInfo : nullptr;
-			allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-			allocInfo.allocationSize = allocSize;
-			VkMemoryPropertyFlags properties = 0;
-			switch (memoryUsage) {
-				case MEMORY_USAGE_UNKNOWN: 
-					properties = VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
-					break;
-				case MEMORY_USAGE_GPU_ONLY: 
-					properties = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT;
-					break;
-				case MEMORY_USAGE_CPU_ONLY: 
-					properties = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
-					break;
-				case MEMORY_USAGE_CPU_TO_GPU: 
-					properties = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT;
-					break;
-				case MEMORY_USAGE_GPU_TO_CPU: 
-					properties = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_CACHED_BIT;
-					break;
-				case MEMORY_USAGE_CPU_COPY: 
-					properties = VK_MEMORY_PROPERTY_HOST_CACHED_BIT;
-					break;
-				case MEMORY_USAGE_GPU_LAZILY_ALLOCATED: 
-					properties = VK_MEMORY_PROPERTY_LAZILY_ALLOCATED_BIT;
-					break;
-				case MEMORY_USAGE_MAX_ENUM: 
-					properties = VK_MEMORY_PROPERTY_FLAG_BITS_MAX_ENUM;
-					break;
-			}
-			allocInfo.memoryTypeIndex = GetPhysicalDevice()->FindMemoryType(memRequirements.memoryTypeBits, properties);
-
-		if (AllocateMemory(&allocInfo, nullptr, pAllocation) != VK_SUCCESS) {
+		if (AllocateDeviceMemory(memRequirements, memoryUsage, kind, pAllocation) != VK_SUCCESS) {
 			throw std::runtime_error("Failed to allocate buffer memory");
 		}
+		memoryAllocationTracker.TrackAllocation(*pAllocation, (*pAllocation)->block->memoryTypeIndex, memoryUsage, (*pAllocation)->size, allocationTag);
 		
-		return BindBufferMemory(buffer, *pAllocation, 0);
+		return BindBufferMemory(buffer, (*pAllocation)->memory, (*pAllocation)->offset);
 	#endif
 }
-VkResult Device::CreateAndAllocateImage(const VkImageCreateInfo& imageCreateInfo, MemoryUsage memoryUsage, VkImage& image, MemoryAllocation* pAllocation, bool weakAllocation) {
+VkResult Device::CreateAndAllocateImage(const VkImageCreateInfo& imageCreateInfo, MemoryUsage memoryUsage, VkImage& image, MemoryAllocation* pAllocation, bool weakAllocation, const char* allocationTag) {
 	#ifdef V4D_VULKAN_USE_VMA
 		VmaAllocationCreateInfo allocInfo {};
 			allocInfo.usage = (VmaMemoryUsage)memoryUsage;
@@ -407,7 +523,13 @@ VkResult Device::CreateAndAllocateImage(const VkImageCreateInfo& imageCreateInfo
 			if (Loader::VULKAN_API_VERSION >= VK_API_VERSION_1_2 && (imageCreateInfo.usage & VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT)) {
 				allocInfo.flags |= VMA_ALLOCATOR_CREATE_BUFFER_DEVICE_ADDRESS_BIT;
 			}
-		return vmaCreateImage(allocator, &imageCreateInfo, &allocInfo, &image, pAllocation, nullptr);
+		VkResult result = vmaCreateImage(allocator, &imageCreateInfo, &allocInfo, &image, pAllocation, nullptr);
+		if (result == VK_SUCCESS) {
+			VmaAllocationInfo allocationInfo;
+			vmaGetAllocationInfo(allocator, *pAllocation, &allocationInfo);
+			memoryAllocationTracker.TrackAllocation(*pAllocation, allocationInfo.memoryType, memoryUsage, allocationInfo.size, allocationTag);
+		}
+		return result;
 	#else
 		if ((CreateImage(&imageCreateInfo, nullptr, &image)) != VK_SUCCESS) {
 			throw std::runtime_error("Failed to create image");
@@ -416,18 +538,17 @@ VkResult Device::CreateAndAllocateImage(const VkImageCreateInfo& imageCreateInfo
 		VkMemoryRequirements memRequirements;
 		GetImageMemoryRequirements(image, &memRequirements);
 
-		VkMemoryAllocateInfo allocInfo = {};
-		allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-		allocInfo.allocationSize = memRequirements.size;
-		allocInfo.memoryTypeIndex = GetPhysicalDevice()->FindMemoryType(memRequirements.memoryTypeBits, memoryUsage);
-		if ((AllocateMemory(&allocInfo, nullptr, pAllocation)) != VK_SUCCESS) {
+		DeviceMemoryBlockKind kind = imageCreateInfo.tiling == VK_IMAGE_TILING_OPTIMAL ? DEVICE_MEMORY_BLOCK_OPTIMAL : DEVICE_MEMORY_BLOCK_LINEAR;
+		if (AllocateDeviceMemory(memRequirements, memoryUsage, kind, pAllocation) != VK_SUCCESS) {
 			throw std::runtime_error("Failed to allocate image memory");
 		}
+		memoryAllocationTracker.TrackAllocation(*pAllocation, (*pAllocation)->block->memoryTypeIndex, memoryUsage, (*pAllocation)->size, allocationTag);
 
-		return BindImageMemory(image, *pAllocation, 0);
+		return BindImageMemory(image, (*pAllocation)->memory, (*pAllocation)->offset);
 	#endif
 }
 void Device::FreeAndDestroyBuffer(VkBuffer& buffer, MemoryAllocation& allocation) {
+	if (allocation) memoryAllocationTracker.UntrackAllocation(allocation);
 	#ifdef V4D_VULKAN_USE_VMA
 		std::lock_guard lock(allocatorDeleteMutex);
 		if (allocator) {
@@ -437,12 +558,13 @@ void Device::FreeAndDestroyBuffer(VkBuffer& buffer, MemoryAllocation& allocation
 		}
 	#else
 		DestroyBuffer(buffer, nullptr);
-		if (allocation) FreeMemory(allocation, nullptr);
+		if (allocation) FreeDeviceMemory(allocation);
 	#endif
 	buffer = VK_NULL_HANDLE;
 	allocation = VK_NULL_HANDLE;
 }
 void Device::FreeAndDestroyImage(VkImage& image, MemoryAllocation& allocation) {
+	if (allocation) memoryAllocationTracker.UntrackAllocation(allocation);
 	#ifdef V4D_VULKAN_USE_VMA
 		std::lock_guard lock(allocatorDeleteMutex);
 		if (allocator) {
@@ -452,7 +574,7 @@ void Device::FreeAndDestroyImage(VkImage& image, MemoryAllocation& allocation) {
 		}
 	#else
 		DestroyImage(image, nullptr);
-		if (allocation) FreeMemory(allocation, nullptr);
+		if (allocation) FreeDeviceMemory(allocation);
 	#endif
 	image = VK_NULL_HANDLE;
 	allocation = VK_NULL_HANDLE;
@@ -465,7 +587,15 @@ VkResult Device::MapMemoryAllocation(MemoryAllocation& allocation, void** data,
 		}
 		return result;
 	#else
-		return MapMemory(allocation, offset, size, 0, data);
+		std::lock_guard lock(memoryBlocksMutex);
+		DeviceMemoryBlock* block = allocation->block;
+		if (block->mapCount == 0) {
+			VkResult result = MapMemory(block->memory, 0, VK_WHOLE_SIZE, 0, &block->mapped);
+			if (result != VK_SUCCESS) return result;
+		}
+		block->mapCount++;
+		*data = (uint8_t*)block->mapped + allocation->offset + offset;
+		return VK_SUCCESS;
 	#endif
 }
 void Device::UnmapMemoryAllocation(MemoryAllocation& allocation) {
@@ -475,18 +605,29 @@ void Device::UnmapMemoryAllocation(MemoryAllocation& allocation) {
 			vmaUnmapMemory(allocator, allocation);
 		}
 	#else
-		UnmapMemory(allocation);
+		std::lock_guard lock(memoryBlocksMutex);
+		if (!allocatorCreated) return;
+		DeviceMemoryBlock* block = allocation->block;
+		if (block->mapCount > 0 && --block->mapCount == 0) {
+			UnmapMemory(block->memory);
+			block->mapped = nullptr;
+		}
 	#endif
 }
 VkResult Device::FlushMemoryAllocation(MemoryAllocation& allocation, VkDeviceSize offset, VkDeviceSize size) {
 	#ifdef V4D_VULKAN_USE_VMA
 		return vmaFlushAllocation(allocator, allocation, offset, size);
 	#else
+		// The range within the block must be aligned to nonCoherentAtomSize, flushing a few bytes of the neighbouring allocations is harmless
+		VkDeviceSize begin = allocation->offset + offset;
+		VkDeviceSize end = (size == VK_WHOLE_SIZE)? allocation->offset + allocation->size : begin + size;
+		begin -= begin % nonCoherentAtomSize;
+		end = std::min((end + nonCoherentAtomSize - 1) / nonCoherentAtomSize * nonCoherentAtomSize, allocation->block->allocator.GetSize());
 		VkMappedMemoryRange mappedRange {};{
 			mappedRange.sType = VK_STRUCTURE_TYPE_MAPPED_MEMORY_RANGE;
-			mappedRange.memory = allocation;
-			mappedRange.offset = offset;
-			mappedRange.size = size;
+			mappedRange.memory = allocation->memory;
+			mappedRange.offset = begin;
+			mappedRange.size = end - begin;
 		}
 		return FlushMappedMemoryRanges(1, &mappedRange);
 	#endif
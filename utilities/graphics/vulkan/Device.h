@@ -8,12 +8,15 @@
 
 #include <v4d.h>
 #include <map>
+#include <memory>
 #include <unordered_map>
 #include <mutex>
 #include <vector>
 #include "utilities/graphics/vulkan/Loader.h"
 #include "utilities/graphics/vulkan/PhysicalDevice.h"
 #include "utilities/graphics/vulkan/Queue.hpp"
+#include "utilities/graphics/vulkan/TlsfAllocator.h"
+#include "utilities/graphics/vulkan/MemoryAllocationTracker.h"
 
 namespace v4d::graphics::vulkan {
 
@@ -103,7 +106,38 @@ namespace v4d::graphics::vulkan {
 	#ifdef V4D_VULKAN_USE_VMA
 		typedef VmaAllocation MemoryAllocation;
 	#else
-		typedef VkDeviceMemory MemoryAllocation;
+		#ifndef V4D_DEVICE_MEMORY_BLOCK_SIZE
+			#define V4D_DEVICE_MEMORY_BLOCK_SIZE (64 * 1024 * 1024) // at most 1/8 of the memory heap, allocations larger than half a block get their own VkDeviceMemory
+		#endif
+
+		// Buffers, linear images and optimal images live in separate blocks so that bufferImageGranularity never applies, buffers with a device address need a block allocated with VK_MEMORY_ALLOCATE_DEVICE_ADDRESS_BIT
+		enum DeviceMemoryBlockKind : uint8_t {
+			DEVICE_MEMORY_BLOCK_LINEAR = 0,
+			DEVICE_MEMORY_BLOCK_LINEAR_DEVICE_ADDRESS = 1,
+			DEVICE_MEMORY_BLOCK_OPTIMAL = 2,
+		};
+
+		struct DeviceMemoryBlock {
+			VkDeviceMemory memory;
+			uint32_t memoryTypeIndex;
+			DeviceMemoryBlockKind kind;
+			bool dedicated;
+			TlsfAllocator allocator;
+			void* mapped = nullptr; // the whole block is mapped once while any of its allocations is mapped, Vulkan does not allow mapping a VkDeviceMemory twice
+			uint32_t mapCount = 0;
+			DeviceMemoryBlock(VkDeviceMemory memory, uint32_t memoryTypeIndex, DeviceMemoryBlockKind kind, bool dedicated, VkDeviceSize size)
+			: memory(memory), memoryTypeIndex(memoryTypeIndex), kind(kind), dedicated(dedicated), allocator(size) {}
+		};
+
+		struct DeviceMemoryAllocation {
+			VkDeviceMemory memory; // same as block->memory, for binding
+			VkDeviceSize offset;
+			VkDeviceSize size;
+			DeviceMemoryBlock* block;
+			TlsfAllocator::Allocation range;
+		};
+
+		typedef DeviceMemoryAllocation* MemoryAllocation;
 	#endif
 
 	class V4DLIB Device : public xvk::Interface::DeviceInterface {
@@ -114,7 +148,17 @@ namespace v4d::graphics::vulkan {
 		#ifdef V4D_VULKAN_USE_VMA
 			VmaAllocator allocator;
 			std::mutex allocatorDeleteMutex;
+		#else
+			// Sub-allocated VkDeviceMemory blocks, so that we do not hit maxMemoryAllocationCount nor pay for a driver allocation per buffer and image
+			std::vector<std::unique_ptr<DeviceMemoryBlock>> memoryBlocks {};
+			std::mutex memoryBlocksMutex;
+			bool allocatorCreated = false; // memory blocks are all freed by DestroyAllocator(), later frees and unmaps are ignored like with VMA
+			VkPhysicalDeviceMemoryProperties memoryProperties {};
+			VkDeviceSize nonCoherentAtomSize = 1;
+			VkResult AllocateDeviceMemory(const VkMemoryRequirements&, MemoryUsage, DeviceMemoryBlockKind, MemoryAllocation*);
+			void FreeDeviceMemory(MemoryAllocation&);
 		#endif
+		MemoryAllocationTracker memoryAllocationTracker {};
 
 	public:
 		Device(
@@ -126,9 +170,9 @@ namespace v4d::graphics::vulkan {
 		);
 		~Device();
 		
-		#ifdef V4D_VULKAN_USE_VMA
-			void DumpMemoryAllocationStats();
-		#endif
+		// Writes vramdump.json in the working directory
+		void DumpMemoryAllocationStats();
+		MemoryAllocationTracker::Snapshot GetMemoryAllocationSnapshot() const {return memoryAllocationTracker.GetSnapshot();}
 
 		VkDevice GetHandle() const;
 		VkPhysicalDevice GetPhysicalDeviceHandle() const;
@@ -170,8 +214,9 @@ namespace v4d::graphics::vulkan {
 		// Allocator
 		void CreateAllocator();
 		void DestroyAllocator();
-		VkResult CreateAndAllocateBuffer(const VkBufferCreateInfo&, MemoryUsage, VkBuffer&, MemoryAllocation*, bool weakAllocation = false);
-		VkResult CreateAndAllocateImage(const VkImageCreateInfo&, MemoryUsage, VkImage&, MemoryAllocation*, bool weakAllocation = true);
+		// allocationTag identifies the owner in memory allocation stats
+		VkResult CreateAndAllocateBuffer(const VkBufferCreateInfo&, MemoryUsage, VkBuffer&, MemoryAllocation*, bool weakAllocation = false, const char* allocationTag = nullptr);
+		VkResult CreateAndAllocateImage(const VkImageCreateInfo&, MemoryUsage, VkImage&, MemoryAllocation*, bool weakAllocation = true, const char* allocationTag = nullptr);
 		void FreeAndDestroyBuffer(VkBuffer&, MemoryAllocation&);
 		void FreeAndDestroyImage(VkImage&, MemoryAllocation&);
 		VkResult MapMemoryAllocation(MemoryAllocation&, void** data, VkDeviceSize offset = 0, VkDeviceSize size = 0);
@@ -48,7 +48,7 @@ void ImageObject::Create(Device* device) {
 			imageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
 		}
 		
-		device->CreateAndAllocateImage(imageInfo, memoryUsage, obj, &allocation);
+		device->CreateAndAllocateImage(imageInfo, memoryUsage, obj, &allocation, true, allocationTag);
 		
 		if (format == VK_FORMAT_D32_SFLOAT) {
 			viewInfo.subresourceRange.aspectMask = VK_IMAGE_ASPECT_DEPTH_BIT;
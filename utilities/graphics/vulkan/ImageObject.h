@@ -29,6 +29,7 @@ namespace v4d::graphics::vulkan {
 		VkImageView view = VK_NULL_HANDLE;
 		VkSampler sampler = VK_NULL_HANDLE;
 		MemoryAllocation allocation = VK_NULL_HANDLE;
+		const char* allocationTag = "ImageObject"; // owner shown in memory allocation stats, copied when allocating so it only needs to live until Create() returns
 		
 		int formatFeatures = 0;
 		uint32_t squareSize = 0;
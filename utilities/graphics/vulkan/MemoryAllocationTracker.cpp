@@ -0,0 +1,53 @@
+#include "MemoryAllocationTracker.h"
+
+namespace v4d::graphics::vulkan {
+
+	void MemoryAllocationTracker::TrackAllocation(const void* handle, uint32_t memoryTypeIndex, uint32_t usage, VkDeviceSize size, const char* tag) {
+		std::lock_guard lock(mu);
+		auto [it, inserted] = entries.try_emplace(handle, Entry{memoryTypeIndex, usage, size, (tag && tag[0])? tag : "untagged"});
+		if (!inserted) {
+			LOG_WARN("MemoryAllocationTracker: allocation " << handle << " tracked twice, it was probably freed without FreeAndDestroy")
+			return;
+		}
+		const Entry& entry = it->second;
+		current.allocations.Add(size);
+		current.allocationsPerMemoryType[memoryTypeIndex].Add(size);
+		current.allocationsPerUsage[usage].Add(size);
+		current.allocationsPerTag[entry.tag].Add(size);
+	}
+
+	void MemoryAllocationTracker::UntrackAllocation(const void* handle) {
+		std::lock_guard lock(mu);
+		auto it = entries.find(handle);
+		if (it == entries.end()) return;
+		const Entry& entry = it->second;
+		current.allocations.Remove(entry.size);
+		current.allocationsPerMemoryType[entry.memoryTypeIndex].Remove(entry.size);
+		current.allocationsPerUsage[entry.usage].Remove(entry.size);
+		current.allocationsPerTag[entry.tag].Remove(entry.size);
+		entries.erase(it);
+	}
+
+	void MemoryAllocationTracker::TrackBlock(uint32_t memoryTypeIndex, VkDeviceSize size) {
+		std::lock_guard lock(mu);
+		current.blocks.Add(size);
+		current.blocksPerMemoryType[memoryTypeIndex].Add(size);
+	}
+
+	void MemoryAllocationTracker::UntrackBlock(uint32_t memoryTypeIndex, VkDeviceSize size) {
+		std::lock_guard lock(mu);
+		current.blocks.Remove(size);
+		current.blocksPerMemoryType[memoryTypeIndex].Remove(size);
+	}
+
+	MemoryAllocationTracker::Snapshot MemoryAllocationTracker::GetSnapshot() const {
+		std::lock_guard lock(mu);
+		return current;
+	}
+
+	void MemoryAllocationTracker::Reset() {
+		std::lock_guard lock(mu);
+		entries.clear();
+		current = {};
+	}
+}
@@ -0,0 +1,105 @@
+#include <v4d.h>
+#include <memory>
+#include "utilities/graphics/vulkan/MemoryAllocationTracker.h"
+#include "utilities/graphics/vulkan/TlsfAllocator.h"
+
+namespace v4d::tests {
+	int MemoryAllocationTracker() {
+		using namespace v4d::graphics::vulkan;
+
+		// Sub-allocates fake memory blocks of 1 MB per memory type like Device does without VMA, reporting to a tracker
+		struct MockDevice {
+			v4d::graphics::vulkan::MemoryAllocationTracker tracker {};
+			struct Block {uint32_t memoryTypeIndex; std::unique_ptr<TlsfAllocator> allocator;};
+			struct Allocation {size_t block; TlsfAllocator::Allocation range;};
+			std::vector<Block> blocks {};
+			Allocation* Allocate(uint32_t memoryTypeIndex, uint32_t usage, VkDeviceSize size, const char* tag) {
+				auto allocation = new Allocation {};
+				for (allocation->block = 0; allocation->block < blocks.size(); ++allocation->block) {
+					if (blocks[allocation->block].memoryTypeIndex != memoryTypeIndex) continue;
+					allocation->range = blocks[allocation->block].allocator->Allocate(size, 256);
+					if (allocation->range.IsValid()) break;
+				}
+				if (!allocation->range.IsValid()) {
+					blocks.push_back({memoryTypeIndex, std::make_unique<TlsfAllocator>(1 << 20)});
+					tracker.TrackBlock(memoryTypeIndex, 1 << 20);
+					allocation->range = blocks.back().allocator->Allocate(size, 256);
+				}
+				tracker.TrackAllocation(allocation, memoryTypeIndex, usage, size, tag);
+				return allocation;
+			}
+			void Free(Allocation* allocation) {
+				tracker.UntrackAllocation(allocation);
+				blocks[allocation->block].allocator->Free(allocation->range);
+				delete allocation;
+			}
+		};
+
+		{// Test 1 (counts and bytes per memory type, usage and tag, with high-water marks)
+			MockDevice device {};
+			std::vector<MockDevice::Allocation*> buffers {}, images {};
+			for (int i = 0; i < 10; ++i) buffers.push_back(device.Allocate(0, 1, 100000, "BufferObject"));
+			for (int i = 0; i < 4; ++i) images.push_back(device.Allocate(2, 1, 300000, "ImageObject"));
+			auto staging = device.Allocate(1, 3, 5000, nullptr);
+
+			auto snapshot = device.tracker.GetSnapshot();
+			if (snapshot.allocations.count != 15 || snapshot.allocations.bytes != 10*100000 + 4*300000 + 5000
+			 || snapshot.allocationsPerMemoryType[0].count != 10 || snapshot.allocationsPerMemoryType[2].bytes != 1200000
+			 || snapshot.allocationsPerUsage[1].count != 14 || snapshot.allocationsPerUsage[3].bytes != 5000
+			 || snapshot.allocationsPerTag["BufferObject"].bytes != 1000000 || snapshot.allocationsPerTag["untagged"].count != 1) {
+				LOG_ERROR("v4d::tests::MemoryAllocationTracker ERROR 1.1 (" << snapshot.allocations.count << " allocations, " << snapshot.allocations.bytes << " bytes)")
+				return 1;
+			}
+			// 10 x 100k fit in one block, 4 x 300k need two blocks, plus one for the staging memory type
+			if (snapshot.blocks.count != 4 || snapshot.blocksPerMemoryType[2].count != 2 || snapshot.blocks.bytes != 4 << 20) {
+				LOG_ERROR("v4d::tests::MemoryAllocationTracker ERROR 1.2 (" << snapshot.blocks.count << " blocks)")
+				return 1;
+			}
+
+			for (auto image : images) device.Free(image);
+			device.Free(staging);
+			snapshot = device.tracker.GetSnapshot();
+			const auto& imageCounters = snapshot.allocationsPerTag["ImageObject"];
+			if (imageCounters.count != 0 || imageCounters.bytes != 0 || imageCounters.peakCount != 4 || imageCounters.peakBytes != 1200000 || imageCounters.totalCount != 4
+			 || snapshot.allocations.count != 10 || snapshot.allocations.peakCount != 15 || snapshot.allocations.peakBytes != 2205000) {
+				LOG_ERROR("v4d::tests::MemoryAllocationTracker ERROR 1.3 (peak " << snapshot.allocations.peakBytes << " bytes)")
+				return 1;
+			}
+
+			// Whatever is left is a leak
+			auto leaked = buffers.back();
+			buffers.pop_back();
+			for (auto buffer : buffers) device.Free(buffer);
+			snapshot = device.tracker.GetSnapshot();
+			if (snapshot.allocations.count != 1 || snapshot.allocationsPerTag["BufferObject"].bytes != 100000) {
+				LOG_ERROR("v4d::tests::MemoryAllocationTracker ERROR 1.4 (" << snapshot.allocations.count << " leaked allocations)")
+				return 1;
+			}
+			device.Free(leaked);
+		}
+
+		{// Test 2 (unknown handles are ignored, reset)
+			v4d::graphics::vulkan::MemoryAllocationTracker tracker {};
+			int a, b;
+			tracker.TrackAllocation(&a, 0, 0, 64);
+			tracker.UntrackAllocation(&b);
+			tracker.UntrackAllocation(nullptr);
+			tracker.TrackBlock(0, 1024);
+			tracker.UntrackBlock(0, 1024);
+			auto snapshot = tracker.GetSnapshot();
+			if (snapshot.allocations.count != 1 || snapshot.allocations.bytes != 64 || snapshot.blocks.count != 0 || snapshot.blocks.peakBytes != 1024) {
+				LOG_ERROR("v4d::tests::MemoryAllocationTracker ERROR 2.1")
+				return 2;
+			}
+			tracker.Reset();
+			tracker.UntrackAllocation(&a);
+			snapshot = tracker.GetSnapshot();
+			if (snapshot.allocations.count != 0 || snapshot.allocations.peakCount != 0 || snapshot.allocationsPerTag.size() != 0) {
+				LOG_ERROR("v4d::tests::MemoryAllocationTracker ERROR 2.2 (reset)")
+				return 2;
+			}
+		}
+
+		return 0;
+	}
+}
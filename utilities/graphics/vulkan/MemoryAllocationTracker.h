@@ -0,0 +1,73 @@
+/*
+ * Tracking of device memory allocations for statistics and leak detection
+ * Part of the Vulkan4D open-source game engine under the LGPL license - https://github.com/Vulkan4D
+ *
+ * Device reports every allocation made through CreateAndAllocateBuffer/CreateAndAllocateImage here, with or without VMA, as well as the VkDeviceMemory blocks it sub-allocates from when VMA is not used.
+ * Counters are kept per memory type, per MemoryUsage and per owner tag (BufferObject::allocationTag, ImageObject::allocationTag, "BufferPool"...), each with its high-water marks.
+ * Allocations are identified by their opaque handle only, tests use fake handles without a GPU.
+ */
+#pragma once
+
+#include <v4d.h>
+#include <algorithm>
+#include <map>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+namespace v4d::graphics::vulkan {
+
+	class V4DLIB MemoryAllocationTracker {
+	public:
+		struct Counters {
+			uint64_t count = 0;
+			VkDeviceSize bytes = 0;
+			uint64_t peakCount = 0;
+			VkDeviceSize peakBytes = 0;
+			uint64_t totalCount = 0; // including those that were freed since
+			void Add(VkDeviceSize size) {
+				count++;
+				totalCount++;
+				bytes += size;
+				peakCount = std::max(peakCount, count);
+				peakBytes = std::max(peakBytes, bytes);
+			}
+			void Remove(VkDeviceSize size) {
+				count--;
+				bytes -= size;
+			}
+		};
+
+		struct Snapshot {
+			Counters allocations {};
+			Counters blocks {}; // VkDeviceMemory blocks that allocations are sub-allocated from, only without VMA
+			std::map<uint32_t, Counters> allocationsPerMemoryType {};
+			std::map<uint32_t, Counters> blocksPerMemoryType {};
+			std::map<uint32_t, Counters> allocationsPerUsage {}; // MemoryUsage
+			std::map<std::string, Counters> allocationsPerTag {};
+		};
+
+	private:
+		struct Entry {
+			uint32_t memoryTypeIndex;
+			uint32_t usage;
+			VkDeviceSize size;
+			std::string tag;
+		};
+		std::unordered_map<const void*, Entry> entries {};
+		Snapshot current {};
+		mutable std::mutex mu;
+
+	public:
+		// Allocations without a tag are counted under "untagged"
+		void TrackAllocation(const void* handle, uint32_t memoryTypeIndex, uint32_t usage, VkDeviceSize size, const char* tag = nullptr);
+		// Ignores handles that are not tracked
+		void UntrackAllocation(const void* handle);
+		void TrackBlock(uint32_t memoryTypeIndex, VkDeviceSize size);
+		void UntrackBlock(uint32_t memoryTypeIndex, VkDeviceSize size);
+
+		// Counters at the time of the call, peaks are since construction or the last Reset()
+		Snapshot GetSnapshot() const;
+		void Reset();
+	};
+}
@@ -38,14 +38,13 @@ namespace v4d::graphics::vulkan {
 		v4d::io::FilePath file;
 		std::vector<ShaderPipelineObject*> shaders;
 		RayTracingPipeline* sbt;
-		double mtime;
 		
 		ShaderPipelineMetaFile(v4d::io::FilePath metaFile, std::vector<ShaderPipelineObject*>&& shaders)
-		: file(metaFile), shaders(shaders), sbt(nullptr), mtime(0) {}
+		: file(metaFile), shaders(shaders), sbt(nullptr) {}
 		ShaderPipelineMetaFile(const std::string& shaderProgram, ShaderPipelineObject* shaderPipeline)
-		: file(shaderProgram+".meta"), shaders({shaderPipeline}), sbt(nullptr), mtime(0) {}
+		: file(shaderProgram+".meta"), shaders({shaderPipeline}), sbt(nullptr) {}
 		ShaderPipelineMetaFile(const std::string& shaderProgram, RayTracingPipeline* sbt)
-		: file(shaderProgram+".meta"), shaders(), sbt(sbt), mtime(0) {}
+		: file(shaderProgram+".meta"), shaders(), sbt(sbt) {}
 		
 		operator const std::vector<ShaderInfo> () const {
 			DEBUG_ASSERT_ERROR(file.Exists(), "Shader file does not exist: " << std::string(file));
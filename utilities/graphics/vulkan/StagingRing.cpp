@@ -0,0 +1,81 @@
+#include "StagingRing.h"
+
+namespace v4d::graphics::vulkan {
+
+	StagingRing::StagingRing(VkDeviceSize capacity, uint32_t frameCount) : capacity(capacity), frameEnds(frameCount, 0) {
+		assert(capacity > 0 && frameCount > 0);
+	}
+
+	void StagingRing::BeginFrame(uint32_t frameIndex) {
+		assert(frameIndex < frameEnds.size());
+		frameEnds[currentFrame] = head;
+		currentFrame = frameIndex;
+		// Frames complete in order, so everything allocated before the end of this frame slot is free too
+		if (frameEnds[frameIndex] > tail) tail = frameEnds[frameIndex];
+	}
+
+	void StagingRing::Reset() {
+		tail = recordedHead = head;
+		for (auto& end : frameEnds) end = head;
+		for (uint32_t i = 0; i < batchCount; ++i) batches[i].regions.clear();
+		batchCount = 0;
+	}
+
+	StagingRing::Range StagingRing::MarkRecorded() {
+		Range range {recordedHead, head};
+		recordedHead = head;
+		return range;
+	}
+
+	bool StagingRing::Release(const Range& range) {
+		if (tail < range.begin) return false;
+		if (range.end > tail) tail = range.end;
+		return true;
+	}
+
+	VkDeviceSize StagingRing::Allocate(VkDeviceSize size, VkDeviceSize alignment) {
+		assert(alignment > 0 && (alignment & (alignment - 1)) == 0);
+		if (size == 0 || size > capacity) return INVALID_OFFSET;
+		// Nothing in use, start back at the beginning of the ring so that nothing is skipped
+		if (head == tail) head = tail = (head + capacity - 1) / capacity * capacity;
+		const VkDeviceSize physical = head % capacity;
+		const VkDeviceSize aligned = (physical + alignment - 1) & ~(alignment - 1);
+		// Wrap around instead of splitting an allocation at the end of the ring
+		const uint64_t start = (aligned + size <= capacity)? head + (aligned - physical) : head + (capacity - physical);
+		if (start + size - tail > capacity) return INVALID_OFFSET;
+		head = start + size;
+		return start % capacity;
+	}
+
+	void StagingRing::Copy(VkBuffer src, VkDeviceSize srcOffset, VkBuffer dst, VkDeviceSize dstOffset, VkDeviceSize size) {
+		if (size == 0) return;
+		CopyBatch* batch = nullptr;
+		for (uint32_t i = 0; i < batchCount; ++i) {
+			if (batches[i].src == src && batches[i].dst == dst) {
+				batch = &batches[i];
+				break;
+			}
+		}
+		if (!batch) {
+			if (batchCount == batches.size()) batches.emplace_back();
+			batch = &batches[batchCount++];
+			batch->src = src;
+			batch->dst = dst;
+		}
+		// Uploads of consecutive ranges are usually staged consecutively too
+		if (batch->regions.size() > 0) {
+			VkBufferCopy& last = batch->regions.back();
+			if (last.srcOffset + last.size == srcOffset && last.dstOffset + last.size == dstOffset) {
+				last.size += size;
+				return;
+			}
+		}
+		batch->regions.push_back({srcOffset, dstOffset, size});
+	}
+
+	uint32_t StagingRing::GetQueuedCopyCount() const {
+		uint32_t count = 0;
+		for (uint32_t i = 0; i < batchCount; ++i) count += uint32_t(batches[i].regions.size());
+		return count;
+	}
+}
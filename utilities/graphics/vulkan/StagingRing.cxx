@@ -0,0 +1,149 @@
+#include <v4d.h>
+#include "utilities/graphics/vulkan/StagingRing.h"
+
+namespace v4d::tests {
+	int StagingRing() {
+		using namespace v4d::graphics::vulkan;
+		const VkDeviceSize INVALID = v4d::graphics::vulkan::StagingRing::INVALID_OFFSET;
+
+		{// Test 1 (alignment, wrapping and release of the space of completed frames)
+			v4d::graphics::vulkan::StagingRing ring(1000, 2);
+			ring.BeginFrame(0);
+			VkDeviceSize a = ring.Allocate(100, 1);
+			VkDeviceSize b = ring.Allocate(100, 64);
+			if (a != 0 || b != 128 || ring.GetUsedBytes() != 228) {
+				LOG_ERROR("v4d::tests::StagingRing ERROR 1.1 (offsets " << a << " " << b << ")")
+				return 1;
+			}
+			ring.BeginFrame(1);
+			VkDeviceSize c = ring.Allocate(700, 4);
+			// Frame 0 is still in flight, its space cannot be reused yet
+			if (c != 228 || ring.Allocate(100, 1) != INVALID) {
+				LOG_ERROR("v4d::tests::StagingRing ERROR 1.2 (offset " << c << ")")
+				return 1;
+			}
+			// Frame 0 completed, the next allocation does not fit at the end and wraps to offset 0
+			ring.BeginFrame(0);
+			VkDeviceSize d = ring.Allocate(200, 16);
+			if (d != 0 || ring.GetUsedBytes() != 772 + 200) {
+				LOG_ERROR("v4d::tests::StagingRing ERROR 1.3 (offset " << d << ", " << ring.GetUsedBytes() << " used)")
+				return 1;
+			}
+			// Frame 1 is still in flight and ends at 928, between 200 and 228 is free but not enough for 100
+			if (ring.Allocate(100, 1) != INVALID || ring.Allocate(1001) != INVALID || ring.Allocate(0) != INVALID) {
+				LOG_ERROR("v4d::tests::StagingRing ERROR 1.4")
+				return 1;
+			}
+			ring.BeginFrame(1);
+			VkDeviceSize e = ring.Allocate(700, 1);
+			if (e != 200) {
+				LOG_ERROR("v4d::tests::StagingRing ERROR 1.5 (offset " << e << ")")
+				return 1;
+			}
+			ring.Reset();
+			if (ring.GetUsedBytes() != 0 || ring.Allocate(1000, 1) == INVALID) {
+				LOG_ERROR("v4d::tests::StagingRing ERROR 1.6 (reset)")
+				return 1;
+			}
+		}
+
+		{// Test 2 (a long run of frames never overlaps allocations of frames in flight)
+			const uint32_t frames = 3;
+			v4d::graphics::vulkan::StagingRing ring(1 << 16, frames);
+			struct Range {VkDeviceSize offset, size;};
+			std::vector<Range> inFlight[frames];
+			uint64_t seed = 1;
+			auto random = [&seed](uint64_t max){
+				seed = seed * 6364136223846793005ull + 1442695040888963407ull;
+				return (seed >> 33) % max;
+			};
+			for (uint32_t frame = 0; frame < 3000; ++frame) {
+				const uint32_t index = frame % frames;
+				ring.BeginFrame(index);
+				inFlight[index].clear();
+				for (int i = 0, n = int(random(20)); i < n; ++i) {
+					VkDeviceSize size = 1 + random(2000), offset = ring.Allocate(size, VkDeviceSize(1) << random(8));
+					if (offset == INVALID) continue;
+					if (offset + size > ring.GetCapacity()) {
+						LOG_ERROR("v4d::tests::StagingRing ERROR 2.1 (frame " << frame << ")")
+						return 2;
+					}
+					for (auto& ranges : inFlight) for (auto& r : ranges) {
+						if (offset < r.offset + r.size && r.offset < offset + size) {
+							LOG_ERROR("v4d::tests::StagingRing ERROR 2.2 (frame " << frame << ", overlap at offset " << offset << ")")
+							return 2;
+						}
+					}
+					inFlight[index].push_back({offset, size});
+				}
+			}
+		}
+
+		{// Test 3 (copies are batched per source and destination buffer, contiguous regions are merged)
+			v4d::graphics::vulkan::StagingRing ring(1 << 20, 2);
+			VkBuffer staging = reinterpret_cast<VkBuffer>(uintptr_t(1)), vertices = reinterpret_cast<VkBuffer>(uintptr_t(2)), indices = reinterpret_cast<VkBuffer>(uintptr_t(3));
+			ring.Copy(staging, 0, vertices, 1000, 100);
+			ring.Copy(staging, 100, vertices, 1100, 50); // merged
+			ring.Copy(staging, 256, indices, 0, 64);
+			ring.Copy(staging, 512, vertices, 0, 16);
+			ring.Copy(staging, 600, vertices, 16, 0); // empty
+			if (ring.GetQueuedCopyCount() != 3) {
+				LOG_ERROR("v4d::tests::StagingRing ERROR 3.1 (" << ring.GetQueuedCopyCount() << " regions)")
+				return 3;
+			}
+			int calls = 0;
+			bool ok = true;
+			ring.FlushCopies([&](VkBuffer src, VkBuffer dst, const VkBufferCopy* regions, uint32_t count){
+				calls++;
+				if (src != staging) ok = false;
+				if (dst == vertices) ok = ok && count == 2 && regions[0].srcOffset == 0 && regions[0].dstOffset == 1000 && regions[0].size == 150 && regions[1].dstOffset == 0;
+				else ok = ok && dst == indices && count == 1 && regions[0].size == 64;
+			});
+			if (calls != 2 || !ok || ring.GetQueuedCopyCount() != 0) {
+				LOG_ERROR("v4d::tests::StagingRing ERROR 3.2 (" << calls << " flushed batches)")
+				return 3;
+			}
+			calls = 0;
+			ring.FlushCopies([&](VkBuffer, VkBuffer, const VkBufferCopy*, uint32_t){calls++;});
+			if (calls != 0) {
+				LOG_ERROR("v4d::tests::StagingRing ERROR 3.3 (flushed twice)")
+				return 3;
+			}
+		}
+
+		{// Test 4 (space recorded and waited for on its own is only released when nothing older is still in use)
+			v4d::graphics::vulkan::StagingRing ring(1000, 2);
+			ring.BeginFrame(0);
+			// Uploads recorded into frame 0 with Flush(), still in flight
+			ring.Allocate(300, 1);
+			ring.MarkRecorded();
+			// Uploads submitted with FlushAndWait() during the same frame
+			ring.Allocate(400, 1);
+			auto waited = ring.MarkRecorded();
+			if (waited.begin != 300 || waited.end != 700 || ring.Release(waited) || ring.GetUsedBytes() != 700) {
+				LOG_ERROR("v4d::tests::StagingRing ERROR 4.1 (released space in front of a frame in flight, " << ring.GetUsedBytes() << " used)")
+				return 4;
+			}
+			// Once frame 0 completed, a FlushAndWait() releases its own space right away, not what was allocated after it
+			ring.BeginFrame(1);
+			ring.BeginFrame(0);
+			ring.Allocate(200, 1);
+			auto loading = ring.MarkRecorded();
+			ring.Allocate(50, 1); // queued by another thread while waiting
+			if (!ring.Release(loading) || ring.GetUsedBytes() != 50) {
+				LOG_ERROR("v4d::tests::StagingRing ERROR 4.2 (" << ring.GetUsedBytes() << " used)")
+				return 4;
+			}
+			// With nothing else in use, successive loads never run out of space
+			v4d::graphics::vulkan::StagingRing loads(1000, 2);
+			for (int i = 0; i < 100; ++i) {
+				if (loads.Allocate(600, 16) == INVALID || !loads.Release(loads.MarkRecorded())) {
+					LOG_ERROR("v4d::tests::StagingRing ERROR 4.3 (load " << i << ")")
+					return 4;
+				}
+			}
+		}
+
+		return 0;
+	}
+}
@@ -0,0 +1,86 @@
+/*
+ * Ring allocation of staging memory partitioned per frame in flight, and batching of buffer copies
+ * Part of the Vulkan4D open-source game engine under the LGPL license - https://github.com/Vulkan4D
+ *
+ * Only offsets are managed here, RingStagingBuffer (BufferObject.h) owns the actual persistently mapped buffer and records the copies, tests use it without a GPU.
+ * Each frame allocates from where the previous one stopped, an allocation that does not fit before the end of the ring starts back at offset 0.
+ * The space used by a frame is released when that frame index begins again, the caller must have waited for its fence before that.
+ * Space recorded into a command buffer that was waited for on its own (ie: at load time) may be released earlier with Release(), as long as nothing older is still in use.
+ * Copies are grouped per source and destination buffer so that a flush records a single CmdCopyBuffer with many regions for each pair, contiguous regions are merged.
+ */
+#pragma once
+
+#include <v4d.h>
+#include <vector>
+
+namespace v4d::graphics::vulkan {
+
+	class V4DLIB StagingRing {
+	public:
+		static constexpr VkDeviceSize INVALID_OFFSET = ~VkDeviceSize(0);
+
+		// Virtual offsets of the space allocated between two calls to MarkRecorded()
+		struct Range {
+			uint64_t begin = 0;
+			uint64_t end = 0;
+		};
+
+	private:
+		VkDeviceSize capacity;
+		uint64_t head = 0; // virtual offsets that only grow, the physical offset is modulo capacity
+		uint64_t tail = 0; // oldest byte that may still be in use by the GPU
+		std::vector<uint64_t> frameEnds; // head when each frame slot ended
+		uint32_t currentFrame = 0;
+		uint64_t recordedHead = 0; // head at the last MarkRecorded()
+
+		struct CopyBatch {
+			VkBuffer src;
+			VkBuffer dst;
+			std::vector<VkBufferCopy> regions;
+		};
+		std::vector<CopyBatch> batches {}; // there are usually only a few destination buffers per frame, a linear search is faster than a map
+		uint32_t batchCount = 0; // batches beyond this are empty but keep their capacity
+
+	public:
+		StagingRing(VkDeviceSize capacity, uint32_t frameCount);
+
+		// Releases the space that was used the last time this frame index was used, its GPU work must have completed
+		void BeginFrame(uint32_t frameIndex);
+
+		// Releases everything and drops the queued copies, the device must be idle
+		void Reset();
+
+		// Returns the space allocated since the previous call, to be called when the uploads using it are recorded into a command buffer
+		Range MarkRecorded();
+
+		/**
+		 * Releases the space of a recorded range once its command buffer completed, if everything allocated before it was already released
+		 * Otherwise it stays in use until its frame index begins again, since the ring can only be released in order
+		 * Returns true if the space was released
+		 */
+		bool Release(const Range& range);
+
+		/**
+		 * Returns the offset in the ring of size bytes aligned to alignment (a power of two) for the current frame
+		 * Returns INVALID_OFFSET if there is not enough free space, without changing anything
+		 */
+		VkDeviceSize Allocate(VkDeviceSize size, VkDeviceSize alignment = 16);
+
+		// Queues a copy to be recorded at the next flush
+		void Copy(VkBuffer src, VkDeviceSize srcOffset, VkBuffer dst, VkDeviceSize dstOffset, VkDeviceSize size);
+
+		// Calls record(src, dst, regions, regionCount) once per source and destination pair, then clears the queued copies
+		template<typename F>
+		void FlushCopies(F&& record) {
+			for (uint32_t i = 0; i < batchCount; ++i) {
+				record(batches[i].src, batches[i].dst, batches[i].regions.data(), uint32_t(batches[i].regions.size()));
+				batches[i].regions.clear();
+			}
+			batchCount = 0;
+		}
+
+		VkDeviceSize GetCapacity() const {return capacity;}
+		VkDeviceSize GetUsedBytes() const {return head - tail;} // including space skipped at the end of the ring when wrapping
+		uint32_t GetQueuedCopyCount() const;
+	};
+}
@@ -0,0 +1,34 @@
+#include <v4d.h>
+#include "helpers/Benchmark.hpp"
+#include "utilities/graphics/vulkan/TlsfAllocator.h"
+
+namespace v4d::benchmarks {
+	void TlsfAllocator() {
+		using v4d::Benchmark;
+		using namespace v4d::graphics::vulkan;
+
+		uint64_t seed = 1;
+		auto random = [&seed](uint64_t max){
+			seed = seed * 6364136223846793005ull + 1442695040888963407ull;
+			return (seed >> 33) % max;
+		};
+
+		// 256 MB block half full of 4k live allocations of 256 bytes to 256 KB, then one allocation and one free of a random one per operation
+		v4d::graphics::vulkan::TlsfAllocator allocator(256 << 20);
+		std::vector<TlsfAllocator::Allocation> allocations {};
+		auto randomSize = [&]{return VkDeviceSize(256) << random(11);};
+		while (allocator.GetStats().usedBytes < (128 << 20)) allocations.push_back(allocator.Allocate(randomSize(), 256));
+
+		Benchmark::Run("TlsfAllocator Allocate+Free 1000 random", [&]{
+			for (int i = 0; i < 1000; ++i) {
+				auto& allocation = allocations[random(allocations.size())];
+				allocator.Free(allocation);
+				allocation = allocator.Allocate(randomSize(), 256);
+			}
+			Benchmark::DoNotOptimize(allocations.data());
+		});
+
+		auto stats = allocator.GetStats();
+		LOG("    TlsfAllocator after churn: " << stats.allocationCount << " allocations, " << stats.freeRangeCount << " free ranges, fragmentation " << stats.Fragmentation())
+	}
+}
@@ -0,0 +1,227 @@
+#include "TlsfAllocator.h"
+#include <algorithm>
+#include <bit>
+
+namespace v4d::graphics::vulkan {
+
+	TlsfAllocator::TlsfAllocator(VkDeviceSize size) : size(size) {
+		assert(size > 0);
+		Clear();
+	}
+
+	void TlsfAllocator::Mapping(VkDeviceSize size, uint32_t& fl, uint32_t& sl) {
+		fl = 63 - std::countl_zero(uint64_t(size));
+		// Second level is the SL_BITS bits after the most significant one, sizes smaller than SL_COUNT get one exact list each
+		if (fl >= SL_BITS) sl = uint32_t(size >> (fl - SL_BITS)) ^ SL_COUNT;
+		else sl = uint32_t(size << (SL_BITS - fl)) ^ SL_COUNT;
+	}
+
+	uint32_t TlsfAllocator::NewNode() {
+		if (unusedNodes.size() > 0) {
+			uint32_t node = unusedNodes.back();
+			unusedNodes.pop_back();
+			nodes[node] = {};
+			return node;
+		}
+		nodes.emplace_back();
+		return uint32_t(nodes.size() - 1);
+	}
+
+	void TlsfAllocator::InsertFree(uint32_t node) {
+		uint32_t fl, sl;
+		Mapping(nodes[node].size, fl, sl);
+		uint32_t& head = freeLists[fl][sl];
+		nodes[node].free = true;
+		nodes[node].prevFree = ~0u;
+		nodes[node].nextFree = head;
+		if (head != ~0u) nodes[head].prevFree = node;
+		head = node;
+		flBitmap |= uint64_t(1) << fl;
+		slBitmaps[fl] |= 1u << sl;
+		freeRangeCount++;
+	}
+
+	void TlsfAllocator::RemoveFree(uint32_t node) {
+		uint32_t fl, sl;
+		Mapping(nodes[node].size, fl, sl);
+		Node& n = nodes[node];
+		if (n.prevFree != ~0u) nodes[n.prevFree].nextFree = n.nextFree;
+		else freeLists[fl][sl] = n.nextFree;
+		if (n.nextFree != ~0u) nodes[n.nextFree].prevFree = n.prevFree;
+		if (freeLists[fl][sl] == ~0u) {
+			slBitmaps[fl] &= ~(1u << sl);
+			if (slBitmaps[fl] == 0) flBitmap &= ~(uint64_t(1) << fl);
+		}
+		n.free = false;
+		n.prevFree = n.nextFree = ~0u;
+		freeRangeCount--;
+	}
+
+	uint32_t TlsfAllocator::FindFree(VkDeviceSize size) const {
+		// Round up to the next list boundary so that any range in the lists found is large enough
+		uint32_t fl = 63 - std::countl_zero(uint64_t(size)), sl;
+		if (fl >= SL_BITS) size += (VkDeviceSize(1) << (fl - SL_BITS)) - 1;
+		Mapping(size, fl, sl);
+		uint32_t slMap = slBitmaps[fl] & (~0u << sl);
+		if (slMap == 0) {
+			const uint64_t flMap = fl + 1 < FL_COUNT ? flBitmap & (~uint64_t(0) << (fl + 1)) : 0;
+			if (flMap == 0) return ~0u;
+			fl = std::countr_zero(flMap);
+			slMap = slBitmaps[fl];
+		}
+		return freeLists[fl][std::countr_zero(slMap)];
+	}
+
+	TlsfAllocator::Allocation TlsfAllocator::Allocate(VkDeviceSize size, VkDeviceSize alignment) {
+		assert(alignment > 0 && (alignment & (alignment - 1)) == 0);
+		Allocation allocation {};
+		if (size == 0 || size > this->size) return allocation;
+
+		auto alignUp = [alignment](VkDeviceSize offset){return (offset + alignment - 1) & ~(alignment - 1);};
+		auto fits = [&](uint32_t node){return node != ~0u && alignUp(nodes[node].offset) + size <= nodes[node].offset + nodes[node].size;};
+
+		uint32_t node = FindFree(size);
+		if (!fits(node)) {
+			// Large enough for any alignment padding
+			node = (size + alignment - 1 <= this->size)? FindFree(size + alignment - 1) : ~0u;
+			if (!fits(node)) {
+				// Ranges in the list of the size itself may still fit (rounding up skips it), this is what makes a single allocation of the whole range possible
+				uint32_t fl, sl;
+				Mapping(size, fl, sl);
+				for (node = freeLists[fl][sl]; node != ~0u && !fits(node); node = nodes[node].nextFree);
+				if (node == ~0u) return allocation;
+			}
+		}
+		RemoveFree(node);
+
+		// Split off the alignment padding at the beginning, it stays free in the node with the lowest offset
+		const VkDeviceSize offset = alignUp(nodes[node].offset);
+		if (offset > nodes[node].offset) {
+			const uint32_t rest = NewNode();
+			Node& padding = nodes[node];
+			nodes[rest].offset = offset;
+			nodes[rest].size = padding.offset + padding.size - offset;
+			nodes[rest].prevPhysical = node;
+			nodes[rest].nextPhysical = padding.nextPhysical;
+			if (padding.nextPhysical != ~0u) nodes[padding.nextPhysical].prevPhysical = rest;
+			padding.nextPhysical = rest;
+			padding.size = offset - padding.offset;
+			InsertFree(node);
+			node = rest;
+		}
+
+		// Split off the remaining end
+		if (nodes[node].size > size) {
+			const uint32_t tail = NewNode();
+			Node& n = nodes[node];
+			nodes[tail].offset = n.offset + size;
+			nodes[tail].size = n.size - size;
+			nodes[tail].prevPhysical = node;
+			nodes[tail].nextPhysical = n.nextPhysical;
+			if (n.nextPhysical != ~0u) nodes[n.nextPhysical].prevPhysical = tail;
+			n.nextPhysical = tail;
+			n.size = size;
+			InsertFree(tail);
+		}
+
+		usedBytes += size;
+		allocationCount++;
+		allocation.offset = offset;
+		allocation.size = size;
+		allocation.node = node;
+		return allocation;
+	}
+
+	void TlsfAllocator::Free(Allocation& allocation) {
+		if (!allocation.IsValid()) return;
+		uint32_t node = allocation.node;
+		assert(node < nodes.size() && !nodes[node].free && nodes[node].offset == allocation.offset && nodes[node].size == allocation.size);
+		usedBytes -= nodes[node].size;
+		allocationCount--;
+
+		// Merge with the free physical neighbours
+		const uint32_t next = nodes[node].nextPhysical;
+		if (next != ~0u && nodes[next].free) {
+			RemoveFree(next);
+			nodes[node].size += nodes[next].size;
+			nodes[node].nextPhysical = nodes[next].nextPhysical;
+			if (nodes[next].nextPhysical != ~0u) nodes[nodes[next].nextPhysical].prevPhysical = node;
+			unusedNodes.push_back(next);
+		}
+		const uint32_t prev = nodes[node].prevPhysical;
+		if (prev != ~0u && nodes[prev].free) {
+			RemoveFree(prev);
+			nodes[prev].size += nodes[node].size;
+			nodes[prev].nextPhysical = nodes[node].nextPhysical;
+			if (nodes[node].nextPhysical != ~0u) nodes[nodes[node].nextPhysical].prevPhysical = prev;
+			unusedNodes.push_back(node);
+			node = prev;
+		}
+		InsertFree(node);
+		allocation = {};
+	}
+
+	void TlsfAllocator::Clear() {
+		nodes.clear();
+		unusedNodes.clear();
+		flBitmap = 0;
+		for (uint32_t fl = 0; fl < FL_COUNT; ++fl) {
+			slBitmaps[fl] = 0;
+			for (uint32_t sl = 0; sl < SL_COUNT; ++sl) freeLists[fl][sl] = ~0u;
+		}
+		usedBytes = 0;
+		allocationCount = 0;
+		freeRangeCount = 0;
+		nodes.push_back({0, size});
+		InsertFree(0);
+	}
+
+	TlsfAllocator::Stats TlsfAllocator::GetStats() const {
+		Stats stats {};
+		stats.size = size;
+		stats.usedBytes = usedBytes;
+		stats.allocationCount = allocationCount;
+		stats.freeRangeCount = freeRangeCount;
+		if (flBitmap) {
+			// The largest range is in the highest non-empty list
+			const uint32_t fl = 63 - std::countl_zero(flBitmap);
+			const uint32_t sl = 31 - std::countl_zero(slBitmaps[fl]);
+			for (uint32_t node = freeLists[fl][sl]; node != ~0u; node = nodes[node].nextFree) {
+				stats.largestFreeRange = std::max(stats.largestFreeRange, nodes[node].size);
+			}
+		}
+		return stats;
+	}
+
+	bool TlsfAllocator::Validate() const {
+		// Physical chain covers the whole range without gaps, with no two adjacent free ranges
+		VkDeviceSize offset = 0, used = 0;
+		uint32_t freeCount = 0, usedCount = 0, previous = ~0u;
+		for (uint32_t node = 0; node != ~0u; previous = node, node = nodes[node].nextPhysical) {
+			const Node& n = nodes[node];
+			if (n.offset != offset || n.size == 0 || n.prevPhysical != previous) return false;
+			if (n.free && previous != ~0u && nodes[previous].free) return false;
+			if (n.free) freeCount++;
+			else {usedCount++; used += n.size;}
+			offset += n.size;
+		}
+		if (offset != size || used != usedBytes || usedCount != allocationCount || freeCount != freeRangeCount) return false;
+
+		// Every free range is in the list of its size and bitmaps match non-empty lists
+		uint32_t listed = 0;
+		for (uint32_t fl = 0; fl < FL_COUNT; ++fl) {
+			if (bool(flBitmap & (uint64_t(1) << fl)) != (slBitmaps[fl] != 0)) return false;
+			for (uint32_t sl = 0; sl < SL_COUNT; ++sl) {
+				if (bool(slBitmaps[fl] & (1u << sl)) != (freeLists[fl][sl] != ~0u)) return false;
+				uint32_t prev = ~0u;
+				for (uint32_t node = freeLists[fl][sl]; node != ~0u; prev = node, node = nodes[node].nextFree) {
+					uint32_t f, s;
+					Mapping(nodes[node].size, f, s);
+					if (!nodes[node].free || nodes[node].prevFree != prev || f != fl || s != sl) return false;
+					if (++listed > freeRangeCount) return false;
+				}
+			}
+		}
+		return listed == freeRangeCount;
+	}
+}
@@ -0,0 +1,134 @@
+#include <v4d.h>
+#include <map>
+#include "utilities/graphics/vulkan/TlsfAllocator.h"
+
+namespace v4d::tests {
+	int TlsfAllocator() {
+		using namespace v4d::graphics::vulkan;
+
+		uint64_t seed = 1;
+		auto random = [&seed](uint64_t max){
+			seed = seed * 6364136223846793005ull + 1442695040888963407ull;
+			return (seed >> 33) % max;
+		};
+
+		{// Test 1 (fuzz, random sizes and alignments allocated and freed in random order, checked against a reference map of live ranges)
+			const VkDeviceSize size = 10'000'019;
+			v4d::graphics::vulkan::TlsfAllocator allocator(size);
+			std::vector<TlsfAllocator::Allocation> allocations {};
+			std::map<VkDeviceSize, VkDeviceSize> live {}; // offset -> size
+			VkDeviceSize used = 0;
+			uint32_t failures = 0;
+			for (int i = 0; i < 100000; ++i) {
+				if (allocations.size() > 0 && random(100) < 45) {
+					size_t index = random(allocations.size());
+					live.erase(allocations[index].offset);
+					used -= allocations[index].size;
+					allocator.Free(allocations[index]);
+					allocations[index] = allocations.back();
+					allocations.pop_back();
+				} else {
+					// Sizes spread over several orders of magnitude, mostly small
+					VkDeviceSize s = 1 + random(VkDeviceSize(1) << (4 + random(14)));
+					VkDeviceSize alignment = VkDeviceSize(1) << random(13);
+					auto allocation = allocator.Allocate(s, alignment);
+					if (!allocation.IsValid()) {
+						failures++;
+						continue;
+					}
+					if (allocation.size != s || allocation.offset % alignment != 0 || allocation.offset + s > size) {
+						LOG_ERROR("v4d::tests::TlsfAllocator ERROR 1.1 (operation " << i << ", offset " << allocation.offset << ")")
+						return 1;
+					}
+					auto next = live.lower_bound(allocation.offset);
+					if ((next != live.end() && next->first < allocation.offset + s) || (next != live.begin() && std::prev(next)->first + std::prev(next)->second > allocation.offset)) {
+						LOG_ERROR("v4d::tests::TlsfAllocator ERROR 1.2 (operation " << i << ", overlap at offset " << allocation.offset << ")")
+						return 1;
+					}
+					live[allocation.offset] = s;
+					used += s;
+					allocations.push_back(allocation);
+				}
+				if (i % 1000 == 0) {
+					auto stats = allocator.GetStats();
+					if (!allocator.Validate() || stats.usedBytes != used || stats.allocationCount != allocations.size()) {
+						LOG_ERROR("v4d::tests::TlsfAllocator ERROR 1.3 (operation " << i << ", invalid state)")
+						return 1;
+					}
+				}
+			}
+			// The range must have been full at some point for the fuzzing to cover failures
+			if (failures == 0) {
+				LOG_ERROR("v4d::tests::TlsfAllocator ERROR 1.4 (never full)")
+				return 1;
+			}
+			for (auto& allocation : allocations) allocator.Free(allocation);
+			auto stats = allocator.GetStats();
+			if (!allocator.Validate() || stats.usedBytes != 0 || stats.freeRangeCount != 1 || stats.largestFreeRange != size || stats.Fragmentation() != 0.0) {
+				LOG_ERROR("v4d::tests::TlsfAllocator ERROR 1.5 (" << stats.freeRangeCount << " free ranges after freeing everything)")
+				return 1;
+			}
+		}
+
+		{// Test 2 (the whole range can be allocated at once, even with a size that is not a list boundary)
+			for (VkDeviceSize size : {VkDeviceSize(1), VkDeviceSize(31), VkDeviceSize(101), VkDeviceSize(10'000'019), VkDeviceSize(1) << 40}) {
+				v4d::graphics::vulkan::TlsfAllocator allocator(size);
+				auto all = allocator.Allocate(size, 1);
+				if (!all.IsValid() || all.offset != 0 || allocator.Allocate(1).IsValid() || !allocator.Validate()) {
+					LOG_ERROR("v4d::tests::TlsfAllocator ERROR 2.1 (size " << size << ")")
+					return 2;
+				}
+				allocator.Free(all);
+				if (allocator.Allocate(size + 1).IsValid() || allocator.Allocate(0).IsValid() || !allocator.IsEmpty()) {
+					LOG_ERROR("v4d::tests::TlsfAllocator ERROR 2.2 (size " << size << ")")
+					return 2;
+				}
+			}
+		}
+
+		{// Test 3 (merging and fragmentation statistics)
+			v4d::graphics::vulkan::TlsfAllocator allocator(1024);
+			auto a = allocator.Allocate(100);
+			auto b = allocator.Allocate(100);
+			auto c = allocator.Allocate(100);
+			allocator.Free(a);
+			auto stats = allocator.GetStats();
+			if (stats.freeRangeCount != 2 || stats.largestFreeRange != 724 || std::abs(stats.Fragmentation() - (1.0 - 724.0 / 824.0)) > 1e-9) {
+				LOG_ERROR("v4d::tests::TlsfAllocator ERROR 3.1 (" << stats.freeRangeCount << " free ranges, fragmentation " << stats.Fragmentation() << ")")
+				return 3;
+			}
+			// c merges with the free end of the range
+			allocator.Free(c);
+			stats = allocator.GetStats();
+			if (stats.freeRangeCount != 2 || stats.largestFreeRange != 824) {
+				LOG_ERROR("v4d::tests::TlsfAllocator ERROR 3.2 (" << stats.freeRangeCount << " free ranges)")
+				return 3;
+			}
+			// b merges with both neighbours
+			allocator.Free(b);
+			stats = allocator.GetStats();
+			if (stats.freeRangeCount != 1 || stats.largestFreeRange != 1024 || !allocator.Validate()) {
+				LOG_ERROR("v4d::tests::TlsfAllocator ERROR 3.3 (" << stats.freeRangeCount << " free ranges)")
+				return 3;
+			}
+		}
+
+		{// Test 4 (alignment padding stays free and is reused by a later allocation that fits in it)
+			v4d::graphics::vulkan::TlsfAllocator allocator(1 << 20);
+			auto a = allocator.Allocate(1);
+			auto b = allocator.Allocate(16, 256);
+			auto c = allocator.Allocate(200);
+			if (b.offset != 256 || c.offset != 1 || allocator.GetStats().usedBytes != 217 || !allocator.Validate()) {
+				LOG_ERROR("v4d::tests::TlsfAllocator ERROR 4.1 (offsets " << b.offset << " " << c.offset << ")")
+				return 4;
+			}
+			allocator.Clear();
+			if (!allocator.IsEmpty() || allocator.GetStats().largestFreeRange != (1 << 20) || !allocator.Validate()) {
+				LOG_ERROR("v4d::tests::TlsfAllocator ERROR 4.2 (clear)")
+				return 4;
+			}
+		}
+
+		return 0;
+	}
+}
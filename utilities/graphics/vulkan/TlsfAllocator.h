@@ -0,0 +1,97 @@
+/*
+ * Two-level segregated fit allocator of offsets within a single range
+ * Part of the Vulkan4D open-source game engine under the LGPL license - https://github.com/Vulkan4D
+ *
+ * Only offsets and sizes are managed here, Device sub-allocates VkDeviceMemory blocks with it when V4D_VULKAN_USE_VMA is not defined and tests use it without a GPU.
+ * Free ranges are kept in segregated lists indexed by the most significant bit of their size (first level) and the next TLSF_SL_BITS bits (second level), with one bitmap per level, so that allocating and freeing are constant time.
+ * Freed ranges are merged with their free physical neighbours immediately, there are never two adjacent free ranges.
+ * Not thread safe, the owner must lock.
+ */
+#pragma once
+
+#include <v4d.h>
+#include <vector>
+
+#ifndef V4D_TLSF_SL_BITS
+	#define V4D_TLSF_SL_BITS 5 // 32 second level lists per power of two, the worst case waste of a good fit is 1/32 of the size
+#endif
+
+namespace v4d::graphics::vulkan {
+
+	class V4DLIB TlsfAllocator {
+	public:
+		static constexpr uint32_t SL_BITS = V4D_TLSF_SL_BITS;
+		static constexpr uint32_t SL_COUNT = 1u << SL_BITS;
+		static constexpr uint32_t FL_COUNT = 64;
+		static_assert(SL_COUNT <= 32, "second level bitmaps are 32 bits");
+
+		struct Allocation {
+			VkDeviceSize offset = 0;
+			VkDeviceSize size = 0;
+			uint32_t node = ~0u;
+			bool IsValid() const {return node != ~0u;}
+		};
+
+		struct Stats {
+			VkDeviceSize size = 0;
+			VkDeviceSize usedBytes = 0; // alignment padding is split off and stays free
+			uint32_t allocationCount = 0;
+			uint32_t freeRangeCount = 0;
+			VkDeviceSize largestFreeRange = 0;
+			// 0 when all free space is contiguous, close to 1 when it is scattered in many small ranges
+			double Fragmentation() const {
+				VkDeviceSize freeBytes = size - usedBytes;
+				return freeBytes > 0 ? 1.0 - double(largestFreeRange) / double(freeBytes) : 0.0;
+			}
+		};
+
+	private:
+		struct Node {
+			VkDeviceSize offset = 0;
+			VkDeviceSize size = 0;
+			uint32_t prevPhysical = ~0u;
+			uint32_t nextPhysical = ~0u;
+			uint32_t prevFree = ~0u;
+			uint32_t nextFree = ~0u;
+			bool free = false;
+		};
+
+		VkDeviceSize size;
+		std::vector<Node> nodes {}; // node 0 always starts at offset 0, merges keep the node with the lowest offset
+		std::vector<uint32_t> unusedNodes {};
+		uint64_t flBitmap = 0;
+		uint32_t slBitmaps[FL_COUNT] {};
+		uint32_t freeLists[FL_COUNT][SL_COUNT];
+		VkDeviceSize usedBytes = 0;
+		uint32_t allocationCount = 0;
+		uint32_t freeRangeCount = 0;
+
+		static void Mapping(VkDeviceSize size, uint32_t& fl, uint32_t& sl);
+		uint32_t NewNode();
+		void InsertFree(uint32_t node);
+		void RemoveFree(uint32_t node);
+		uint32_t FindFree(VkDeviceSize size) const;
+
+	public:
+		TlsfAllocator(VkDeviceSize size);
+
+		/**
+		 * Returns a range of size bytes whose offset is a multiple of alignment (a power of two)
+		 * The returned allocation is invalid if there is no free range large enough
+		 */
+		Allocation Allocate(VkDeviceSize size, VkDeviceSize alignment = 1);
+
+		// Returns the range to the free lists and resets the allocation
+		void Free(Allocation& allocation);
+
+		// Frees all allocations at once
+		void Clear();
+
+		VkDeviceSize GetSize() const {return size;}
+		bool IsEmpty() const {return allocationCount == 0;}
+		Stats GetStats() const;
+
+		// Checks all internal invariants (physical chain, merged neighbours, free lists and bitmaps), for tests
+		bool Validate() const;
+	};
+}
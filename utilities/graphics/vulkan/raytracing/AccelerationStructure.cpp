@@ -2,6 +2,58 @@
 
 namespace v4d::graphics::vulkan::raytracing {
 	
+	struct AccelerationStructure::Pools {
+		Device* device;
+		DeviceBufferPoolBackend storageBackend;
+		DeviceBufferPoolBackend scratchBackend;
+		BufferPool storage;
+		BufferPool scratch;
+		Pools(Device* device)
+		 : device(device)
+		 , storageBackend(device, MEMORY_USAGE_GPU_ONLY, VK_BUFFER_USAGE_ACCELERATION_STRUCTURE_STORAGE_BIT_KHR)
+		 , scratchBackend(device, MEMORY_USAGE_GPU_ONLY, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT)
+		 , storage(&storageBackend, RAY_TRACING_STORAGE_POOL_BLOCK_SIZE)
+		 , scratch(&scratchBackend, RAY_TRACING_SCRATCH_POOL_BLOCK_SIZE)
+		{}
+	};
+	
+	std::unordered_map<Device*, std::unique_ptr<AccelerationStructure::Pools>> AccelerationStructure::pools {};
+	std::mutex AccelerationStructure::poolsMutex;
+	
+	BufferPoolAllocation AccelerationStructure::AllocateFromPools(Device* device, bool scratch, VkDeviceSize size) {
+		std::lock_guard lock(poolsMutex);
+		auto& devicePools = pools[device];
+		if (!devicePools) devicePools = std::make_unique<Pools>(device);
+		return (scratch? devicePools->scratch : devicePools->storage).Allocate(size, RAY_TRACING_ACCELERATION_STRUCTURE_ALIGNMENT);
+	}
+	
+	void AccelerationStructure::FreeFromPools(Device* device, bool scratch, BufferPoolAllocation& allocation) {
+		std::lock_guard lock(poolsMutex);
+		auto it = pools.find(device);
+		if (it == pools.end()) {
+			allocation = {}; // the pools were destroyed with their buffers already
+			return;
+		}
+		(scratch? it->second->scratch : it->second->storage).Free(allocation);
+	}
+	
+	BufferPool::Stats AccelerationStructure::GetStoragePoolStats(Device* device) {
+		std::lock_guard lock(poolsMutex);
+		auto it = pools.find(device);
+		return it == pools.end()? BufferPool::Stats{} : it->second->storage.GetStats();
+	}
+	
+	BufferPool::Stats AccelerationStructure::GetScratchPoolStats(Device* device) {
+		std::lock_guard lock(poolsMutex);
+		auto it = pools.find(device);
+		return it == pools.end()? BufferPool::Stats{} : it->second->scratch.GetStats();
+	}
+	
+	void AccelerationStructure::DestroyPools(Device* device) {
+		std::lock_guard lock(poolsMutex);
+		pools.erase(device);
+	}
+	
 	void AccelerationStructure::AssignBottomLevelGeometry(const std::vector<GeometryAccelerationStructureInfo>& geometries) {
 		isTopLevel = false;
 		
@@ -175,13 +227,12 @@ namespace v4d::graphics::vulkan::raytracing {
 		if (update) {
 			built = false;
 		} else {
-			{// Create and Allocate Buffer
-				VkBufferCreateInfo bufferCreateInfo{};{
-					bufferCreateInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
-					bufferCreateInfo.size = accelerationStructureSize;
-					bufferCreateInfo.usage = VK_BUFFER_USAGE_ACCELERATION_STRUCTURE_STORAGE_BIT_KHR | VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT;
-				}
-				device->CreateAndAllocateBuffer(bufferCreateInfo, MEMORY_USAGE_GPU_ONLY, accelerationStructureBuffer, &accelerationStructureAllocation, true);
+			{// Sub-allocate storage from the shared pool
+				accelerationStructureAllocation = AllocateFromPools(device, false, accelerationStructureSize);
+				if (!accelerationStructureAllocation.IsValid())
+					throw std::runtime_error("Failed to allocate acceleration structure storage");
+				accelerationStructureBuffer = accelerationStructureAllocation.buffer;
+				accelerationStructureOffset = accelerationStructureAllocation.offset;
 			}
 			
 			{// Create acceleration structure
@@ -210,17 +261,10 @@ namespace v4d::graphics::vulkan::raytracing {
 		}
 		
 		// LOG_VERBOSE("Created Acceleration Structure " << accelerationStructure)
-		
-		if (!device->TouchAllocation(accelerationStructureAllocation)) {
-			// LOG_DEBUG("Acceleration Structure CreateAndAllocate ALLOCATION LOST")
-		}
 	}
 	
 	void AccelerationStructure::FreeAndDestroy() {
 		if (device) {
-			if (accelerationStructureAllocation) {
-				device->FreeAndDestroyBuffer(accelerationStructureBuffer, accelerationStructureAllocation);
-			}
 			FreeScratchBuffer();
 			if (accelerationStructure) {
 				// LOG_VERBOSE("Destroyed Acceleration Structure " << accelerationStructure << "; handle " << std::hex << handle)
@@ -228,6 +272,11 @@ namespace v4d::graphics::vulkan::raytracing {
 				// LOG_VERBOSE("Destroyed Acceleration Structure " << accelerationStructure)
 				accelerationStructure = VK_NULL_HANDLE;
 			}
+			if (accelerationStructureAllocation.IsValid()) {
+				FreeFromPools(device, false, accelerationStructureAllocation);
+				accelerationStructureBuffer = VK_NULL_HANDLE;
+				accelerationStructureOffset = 0;
+			}
 			deviceAddress = 0;
 			built = false;
 			device = nullptr;
@@ -239,23 +288,17 @@ namespace v4d::graphics::vulkan::raytracing {
 	}
 	
 	void AccelerationStructure::AllocateScratchBuffer() {
-		if (!scratchBuffer && buildGeometryInfo.scratchData.deviceAddress == 0) {
-			scratchBuffer = std::make_unique<BufferObject>(MEMORY_USAGE_CPU_ONLY, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT
-			
-				// This seems to fix a validation error with the alignment of the device address... But it may not be the correct solution.
-				|VK_BUFFER_USAGE_ACCELERATION_STRUCTURE_STORAGE_BIT_KHR
-				// If we are getting issues with this in the future, try to align the address by adding the alignment to it and then aligning the address when assigning it.
-				// The alignment can be found in VkPhysicalDeviceAccelerationStructurePropertiesKHR::minAccelerationStructureScratchOffsetAlignment
-				
-			, accelerationStructureBuildSizesInfo.buildScratchSize);
-			scratchBuffer->Allocate(device);
-			AssignScratchBuffer(VkDeviceOrHostAddressKHR(*scratchBuffer));
+		if (!scratchAllocation.IsValid() && buildGeometryInfo.scratchData.deviceAddress == 0) {
+			scratchAllocation = AllocateFromPools(device, true, accelerationStructureBuildSizesInfo.buildScratchSize);
+			if (!scratchAllocation.IsValid())
+				throw std::runtime_error("Failed to allocate acceleration structure scratch memory");
+			buildGeometryInfo.scratchData.deviceAddress = scratchAllocation.deviceAddress;
 		}
 	}
 	
 	void AccelerationStructure::FreeScratchBuffer() {
-		if (scratchBuffer) {
-			scratchBuffer = nullptr;
+		if (scratchAllocation.IsValid()) {
+			FreeFromPools(device, true, scratchAllocation);
 			buildGeometryInfo.scratchData.deviceAddress = 0;
 		}
 	}
@@ -9,6 +9,14 @@
 #ifndef RAY_TRACING_TLAS_MAX_INSTANCES
 	#define RAY_TRACING_TLAS_MAX_INSTANCES 1'048'576
 #endif
+#ifndef RAY_TRACING_STORAGE_POOL_BLOCK_SIZE
+	#define RAY_TRACING_STORAGE_POOL_BLOCK_SIZE (64 * 1024 * 1024)
+#endif
+#ifndef RAY_TRACING_SCRATCH_POOL_BLOCK_SIZE
+	#define RAY_TRACING_SCRATCH_POOL_BLOCK_SIZE (32 * 1024 * 1024)
+#endif
+// Acceleration structure offsets must be multiples of 256, which is also the largest possible minAccelerationStructureScratchOffsetAlignment
+#define RAY_TRACING_ACCELERATION_STRUCTURE_ALIGNMENT 256
 
 #define VK_SHADER_STAGE_ALL_RAY_TRACING VK_SHADER_STAGE_RAYGEN_BIT_KHR | VK_SHADER_STAGE_MISS_BIT_KHR | VK_SHADER_STAGE_CLOSEST_HIT_BIT_KHR | VK_SHADER_STAGE_ANY_HIT_BIT_KHR | VK_SHADER_STAGE_INTERSECTION_BIT_KHR | VK_SHADER_STAGE_CALLABLE_BIT_KHR
 
@@ -30,8 +38,8 @@ namespace v4d::graphics::vulkan::raytracing {
 		
 		// Handles
 		VkAccelerationStructureKHR accelerationStructure = VK_NULL_HANDLE;
-		MemoryAllocation accelerationStructureAllocation = VK_NULL_HANDLE;
-		VkBuffer accelerationStructureBuffer = VK_NULL_HANDLE; //TODO use a global buffer
+		BufferPoolAllocation accelerationStructureAllocation {}; // sub-allocated from the storage pool shared by all acceleration structures
+		VkBuffer accelerationStructureBuffer = VK_NULL_HANDLE;
 		VkDeviceSize accelerationStructureSize = 0;
 		VkDeviceSize accelerationStructureOffset = 0;
 		VkDeviceAddress deviceAddress = 0;
@@ -52,7 +60,7 @@ namespace v4d::graphics::vulkan::raytracing {
 		Device* device = nullptr;
 		
 		// Scratch Buffer
-		std::unique_ptr<BufferObject> scratchBuffer = nullptr;
+		BufferPoolAllocation scratchAllocation {}; // sub-allocated from the shared scratch pool, unless assigned with AssignScratchBuffer()
 		
 		struct GeometryAccelerationStructureInfo {
 			VkGeometryFlagsKHR flags = 0; // VK_GEOMETRY_NO_DUPLICATE_ANY_HIT_INVOCATION_BIT_KHR
@@ -91,5 +99,20 @@ namespace v4d::graphics::vulkan::raytracing {
 		}
 		
 		bool IsAllocated() const {return device != nullptr;}
+		
+		// Shared pools, one set per device, created on its first allocation
+		struct Pools;
+		// Both hold poolsMutex while using the pool, so that DestroyPools cannot destroy it meanwhile
+		static BufferPoolAllocation AllocateFromPools(Device* device, bool scratch, VkDeviceSize size);
+		// Drops the allocation without creating pools if the device has none anymore
+		static void FreeFromPools(Device* device, bool scratch, BufferPoolAllocation& allocation);
+		static BufferPool::Stats GetStoragePoolStats(Device* device);
+		static BufferPool::Stats GetScratchPoolStats(Device* device);
+		// Should be called after all acceleration structures of the device were freed, before destroying the device (allocations freed later are simply dropped)
+		static void DestroyPools(Device* device);
+		
+	private:
+		static std::unordered_map<Device*, std::unique_ptr<Pools>> pools;
+		static std::mutex poolsMutex;
 	};
 }
@@ -172,6 +172,7 @@ uint32_t RayTracingPipeline::GetOrAddHitGroup(const char* filePath) {
 	if (!sharedHitGroups.contains(filePath)) {
 		sharedHitGroups.emplace(filePath, AddHitShader(filePath));
 		hitGroupsDirty = true;
+		if (sharedHitGroupAddedCallback) sharedHitGroupAddedCallback(filePath);
 	}
 	return sharedHitGroups.at(filePath).index;
 }
@@ -162,13 +162,13 @@ namespace v4d::graphics::vulkan::raytracing {
 		uint32_t GetOrAddHitGroup(const char* filePath);
 		struct SharedHitGroup {
 			uint32_t index;
-			double modifiedTime;
 			SharedHitGroup(uint32_t index)
-			 : index(index), modifiedTime(0)
+			 : index(index)
 			{}
 		};
 		std::mutex sharedHitGroupsMutex;
 		std::unordered_map<std::string, SharedHitGroup> sharedHitGroups {};
+		std::function<void(const std::string& filePath)> sharedHitGroupAddedCallback = nullptr; // called with sharedHitGroupsMutex locked
 		bool hitGroupsDirty = false;
 		
 		void Configure(v4d::graphics::Renderer*, Device*);
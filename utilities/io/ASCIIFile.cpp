@@ -6,20 +6,13 @@ int ASCIIFile::globalAutoReloadInterval = DEFAULT_AUTORELOAD_INTERVAL;
 
 ASCIIFile::ASCIIFile(const std::string& filePath, std::optional<int> autoReloadInterval) : FilePath(filePath), autoReloadInterval(autoReloadInterval.value_or(globalAutoReloadInterval)) {
 	AutoCreateFile();
-	if (autoReloadInterval > 0) {
-		StartAutoReloadThread();
+	if (this->autoReloadInterval > 0) {
+		StartWatching();
 	}
 }
 
 ASCIIFile::~ASCIIFile() {
-	autoReloadInterval = 0;
-	{
-		std::lock_guard lock(mu);
-	}
-	if (autoReloadThread && autoReloadThread->joinable()) {
-		autoReloadThread->join();
-		delete autoReloadThread;
-	}
+	StopWatching();
 }
 
 void ASCIIFile::Load(ReloadCallbackFunc&& callback) {
@@ -36,14 +29,12 @@ void ASCIIFile::Load(ReloadCallbackFunc&& callback) {
 }
 
 void ASCIIFile::SetAutoReloadInterval(int interval) {
+	// Not holding the lock while unwatching, since the watcher waits for a running reload which needs it
+	StopWatching();
 	std::lock_guard lock(mu);
 	autoReloadInterval = interval;
-	if (autoReloadInterval <= 0 && autoReloadThread && autoReloadThread->joinable()) {
-		autoReloadThread->detach();
-		delete autoReloadThread;
-		autoReloadThread = nullptr;
-	} else if (autoReloadInterval > 0 && !autoReloadThread) {
-		StartAutoReloadThread();
+	if (autoReloadInterval > 0) {
+		StartWatching();
 	}
 }
 
@@ -52,30 +43,39 @@ bool ASCIIFile::FileHasChanged() const {
 	return lastWriteTimeCache != GetLastWriteTime();
 }
 
-void ASCIIFile::StartAutoReloadThread() {
-	autoReloadThread = new std::thread([this]{
-		int interval;
-		{
-			std::lock_guard lock(mu);
-			interval = autoReloadInterval;
-		}
-		for (;;) {
-			if (interval <= 0) return;
-			SLEEP(std::chrono::milliseconds{interval})
-			std::lock_guard lock(mu);
-			if (autoReloadInterval > 0) {
-				auto lastWriteTime = GetLastWriteTime();
-				if (lastWriteTime == 0) {
-					AutoCreateFile();
-					lastWriteTime = GetLastWriteTime();
-				}
-				if (lastWriteTimeCache != lastWriteTime) {
-					ReadFromFile();
-					lastWriteTimeCache = GetLastWriteTime();
-					reloadCallback(this);
-				}
-			}
-			interval = autoReloadInterval;
-		}
-	});
+void ASCIIFile::StartWatching() {
+	std::lock_guard lock(mu);
+	if (watcher) return;
+	watcher = FileWatcher::Instance();
+	watchId = watcher->Watch(filePath.string(), [this](const std::string&){
+		ReloadIfChanged();
+	}, autoReloadInterval);
+}
+
+void ASCIIFile::StopWatching() {
+	std::shared_ptr<FileWatcher> w;
+	FileWatcher::WatchId id;
+	{
+		std::lock_guard lock(mu);
+		w = std::move(watcher);
+		id = watchId;
+		watcher = nullptr;
+		watchId = 0;
+	}
+	if (w) w->Unwatch(id);
+}
+
+void ASCIIFile::ReloadIfChanged() {
+	std::lock_guard lock(mu);
+	if (autoReloadInterval <= 0) return;
+	auto lastWriteTime = GetLastWriteTime();
+	if (lastWriteTime == 0) {
+		AutoCreateFile();
+		lastWriteTime = GetLastWriteTime();
+	}
+	if (lastWriteTimeCache != lastWriteTime) {
+		ReadFromFile();
+		lastWriteTimeCache = GetLastWriteTime();
+		reloadCallback(this);
+	}
 }
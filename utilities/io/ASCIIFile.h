@@ -2,11 +2,12 @@
 
 #include <v4d.h>
 #include <functional>
-#include <thread>
+#include <memory>
 #include <mutex>
 #include <string>
 #include <optional>
 #include "utilities/io/FilePath.h"
+#include "utilities/io/FileWatcher.h"
 
 namespace v4d::io {
 	
@@ -22,10 +23,13 @@ namespace v4d::io {
 		static int globalAutoReloadInterval;
 
 		mutable std::recursive_mutex mu;
-		std::thread* autoReloadThread = nullptr;
+		std::shared_ptr<FileWatcher> watcher = nullptr;
+		FileWatcher::WatchId watchId = 0;
 		double lastWriteTimeCache = 0;
 
-		void StartAutoReloadThread();
+		void StartWatching();
+		void StopWatching();
+		void ReloadIfChanged();
 
 		virtual void ReadFromFile() = 0;
 		virtual void WriteToFile() = 0;
@@ -35,6 +39,7 @@ namespace v4d::io {
 		ASCIIFile(const std::string& filePath, std::optional<int> autoReloadInterval = std::nullopt);
 		virtual ~ASCIIFile();
 
+		// Reloads the file when it changed and then did not change for this long (in milliseconds), 0 = disabled
 		void SetAutoReloadInterval(int interval);
 
 		bool FileHasChanged() const;
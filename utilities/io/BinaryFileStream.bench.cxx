@@ -0,0 +1,54 @@
+#include <v4d.h>
+#include <random>
+#include "helpers/Benchmark.hpp"
+#include "utilities/io/BinaryFileStream.h"
+
+namespace v4d::benchmarks {
+	void BinaryFileStream() {
+		using v4d::Benchmark;
+		using MODE = v4d::io::BinaryFileStream::MODE;
+
+		const size_t count = 65536; // uint32 values per sequential pass (256 KB)
+		const size_t randomReads = 1024; // 64-byte records per random pass
+
+		std::vector<size_t> randomOffsets(randomReads);
+		{
+			std::mt19937 rng(1);
+			for (auto& offset : randomOffsets) offset = (rng() % (count * 4 / 64)) * 64;
+		}
+
+		for (MODE mode : {MODE::FSTREAM, MODE::MMAP}) {
+			const std::string modeName = mode == MODE::MMAP? "MMAP" : "FSTREAM";
+			// FSTREAM rewinds after each flush, so its write buffer must hold a whole pass
+			v4d::io::BinaryFileStream file(v4d::io::FilePath("benchfiles_/BinaryFileStream.bin"), count * sizeof(uint32_t) + 1, mode);
+
+			file.Truncate();
+			Benchmark::Run("BinaryFileStream " + modeName + " Sequential Write 64K uint32", [&]{
+				file.SetWritePos(0);
+				for (uint32_t i = 0; i < count; ++i) file << i;
+				file.Flush();
+			}, count * sizeof(uint32_t));
+
+			Benchmark::Run("BinaryFileStream " + modeName + " Sequential Read 64K uint32", [&]{
+				file.SetReadPos(0);
+				uint32_t sum = 0;
+				for (size_t i = 0; i < count; ++i) sum += file.Read<uint32_t>();
+				Benchmark::DoNotOptimize(sum);
+			}, count * sizeof(uint32_t));
+
+			file.SetAccessPattern(v4d::io::BinaryFileStream::ACCESS_PATTERN::RANDOM);
+			Benchmark::Run("BinaryFileStream " + modeName + " Random Read 1024x64 bytes", [&]{
+				byte record[64];
+				for (size_t offset : randomOffsets) {
+					file.SetReadPos((long)offset);
+					file.ReadBytes(record, sizeof(record));
+				}
+				Benchmark::DoNotOptimize(record);
+			}, randomReads * 64);
+
+			file.Delete();
+		}
+
+		v4d::io::FilePath::DeleteDirectory("benchfiles_", true);
+	}
+}
@@ -1,10 +1,32 @@
 #include "BinaryFileStream.h"
 #include "utilities/io/Logger.h"
+#include <cstring>
+#include <algorithm>
+
+#ifndef _WINDOWS
+	#include <fcntl.h>
+	#include <unistd.h>
+	#include <sys/mman.h>
+	#include <sys/stat.h>
+#endif
 
 using namespace v4d::io;
 
-BinaryFileStream::BinaryFileStream(const std::string& filePath, size_t bufferSize) : Stream(bufferSize), FilePath(filePath) {
+// In MMAP mode, the file and its mapping grow by at least this much (or by doubling) when writing past the end
+static constexpr size_t MMAP_MIN_GROWTH = 65536;
+
+BinaryFileStream::BinaryFileStream(const std::string& filePath, size_t bufferSize, MODE mode) : Stream(mode == MODE::MMAP? 0 : bufferSize), FilePath(filePath), mode(mode) {
 	AutoCreateFile();
+	#ifdef _WINDOWS
+		if (this->mode == MODE::MMAP) {
+			LOG_WARN("BinaryFileStream MMAP mode is not supported on this platform, using FSTREAM for '" << filePath << "'")
+			this->mode = MODE::FSTREAM;
+		}
+	#endif
+	if (this->mode == MODE::MMAP) {
+		OpenMapping();
+		return;
+	}
 	file.open(this->filePath, OPENMODE);
 	if (!file.is_open()) {
 		LOG_ERROR("Cannot open file '" << filePath << "'")
@@ -12,12 +34,172 @@ BinaryFileStream::BinaryFileStream(const std::string& filePath, size_t bufferSiz
 }
 
 BinaryFileStream::~BinaryFileStream() {
+	CloseMapping();
 	if (!file.is_open()) {
 		file.close();
 	}
 }
 
+bool BinaryFileStream::OpenMapping(bool truncate) {
+	#ifndef _WINDOWS
+		fd = open(filePath.c_str(), O_RDWR | O_CREAT | (truncate? O_TRUNC : 0), 0644);
+		if (fd == -1) {
+			LOG_ERROR("Cannot open file '" << filePath.string() << "': " << strerror(errno))
+			return false;
+		}
+		struct stat st;
+		if (fstat(fd, &st) == -1) {
+			LOG_ERROR("Cannot stat file '" << filePath.string() << "': " << strerror(errno))
+			CloseMapping();
+			return false;
+		}
+		fileSize = dataSize = (size_t)st.st_size;
+		readPos = writePos = 0;
+		if (fileSize > 0) {
+			void* ptr = mmap(nullptr, fileSize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+			if (ptr == MAP_FAILED) {
+				LOG_ERROR("Cannot map file '" << filePath.string() << "': " << strerror(errno))
+				CloseMapping();
+				return false;
+			}
+			mapping = (byte*)ptr;
+			mappingSize = fileSize;
+			SetAccessPattern(accessPattern);
+		}
+		return true;
+	#else
+		return false;
+	#endif
+}
+
+void BinaryFileStream::CloseMapping() {
+	#ifndef _WINDOWS
+		if (fd == -1) return;
+		TrimMapping();
+		if (mapping) munmap(mapping, mappingSize);
+		close(fd);
+		mapping = nullptr;
+		mappingSize = fileSize = dataSize = readPos = writePos = 0;
+		fd = -1;
+	#endif
+}
+
+// Makes sure that at least `size` bytes of the file are mapped, growing the file if needed
+bool BinaryFileStream::ReserveMapping(size_t size) {
+	#ifndef _WINDOWS
+		if (size <= fileSize) return true;
+		if (fd == -1) {
+			LOG_ERROR("File '" << filePath.string() << "' not opened")
+			return false;
+		}
+		size_t newSize = std::max(size, std::max(fileSize * 2, MMAP_MIN_GROWTH));
+		if (ftruncate(fd, (off_t)newSize) == -1) {
+			LOG_ERROR("Cannot grow file '" << filePath.string() << "': " << strerror(errno))
+			return false;
+		}
+		fileSize = newSize;
+		if (newSize > mappingSize) {
+			void* ptr = mapping? mremap(mapping, mappingSize, newSize, MREMAP_MAYMOVE) : mmap(nullptr, newSize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+			if (ptr == MAP_FAILED) {
+				LOG_ERROR("Cannot map file '" << filePath.string() << "': " << strerror(errno))
+				return false;
+			}
+			mapping = (byte*)ptr;
+			mappingSize = newSize;
+			SetAccessPattern(accessPattern);
+		}
+		return true;
+	#else
+		return false;
+	#endif
+}
+
+// Shrinks the file on disk to the size of the data written (the mapping itself is kept, only the pages past the end of the file become inaccessible)
+void BinaryFileStream::TrimMapping() {
+	#ifndef _WINDOWS
+		if (fd != -1 && fileSize > dataSize) {
+			if (ftruncate(fd, (off_t)dataSize) == -1) {
+				LOG_ERROR("Cannot truncate file '" << filePath.string() << "': " << strerror(errno))
+				return;
+			}
+			fileSize = dataSize;
+		}
+	#endif
+}
+
+void BinaryFileStream::SetAccessPattern(ACCESS_PATTERN pattern) {
+	accessPattern = pattern;
+	#ifndef _WINDOWS
+		if (mapping) {
+			int advice = MADV_NORMAL;
+			switch (pattern) {
+				case ACCESS_PATTERN::NORMAL: advice = MADV_NORMAL; break;
+				case ACCESS_PATTERN::SEQUENTIAL: advice = MADV_SEQUENTIAL; break;
+				case ACCESS_PATTERN::RANDOM: advice = MADV_RANDOM; break;
+			}
+			madvise(mapping, mappingSize, advice);
+		}
+	#endif
+}
+
+v4d::data::Stream& BinaryFileStream::Flush() {
+	if (mode != MODE::MMAP) return Stream::Flush();
+	LockReadWrite();
+		TrimMapping();
+	UnlockReadWrite();
+	return *this;
+}
+
+v4d::data::Stream& BinaryFileStream::WriteBytes(const byte* data, size_t n) {
+	if (mode != MODE::MMAP) return Stream::WriteBytes(data, n);
+	if (n == 0) return *this;
+	LockWrite();
+		bool ok = true;
+		if (writePos + n > fileSize) {
+			// Readers must not access the mapping while it is being moved
+			LockRead();
+				ok = ReserveMapping(writePos + n);
+			UnlockRead();
+		}
+		if (ok) {
+			memcpy(mapping + writePos, data, n);
+			writePos += n;
+			if (writePos > dataSize) dataSize = writePos;
+		}
+	UnlockWrite();
+	return *this;
+}
+
+v4d::data::Stream& BinaryFileStream::ReadBytes(byte* data, size_t n) {
+	if (mode != MODE::MMAP) return Stream::ReadBytes(data, n);
+	if (n == 0) return *this;
+	LockRead();
+		if (readPos > dataSize || n > dataSize - readPos) {
+			ReadBytes_OnError("BinaryFileStream read past the end of the file");
+			memset(data, 0, n);
+		} else {
+			memcpy(data, mapping + readPos, n);
+			readPos += n;
+		}
+	UnlockRead();
+	return *this;
+}
+
+size_t BinaryFileStream::GetReadableSize() {
+	if (mode != MODE::MMAP) return Stream::GetReadableSize();
+	LockRead();
+		size_t readable = readPos < dataSize? dataSize - readPos : 0;
+	UnlockRead();
+	return readable;
+}
+
 std::vector<byte> BinaryFileStream::GetData() {
+	if (mode == MODE::MMAP) {
+		LockRead();
+			std::vector<byte> data(mapping, mapping + dataSize);
+		UnlockRead();
+		return data;
+	}
 	LockReadWrite();
 		long pos = (long)file.tellg();
 		file.seekg(0, std::ios::end);
@@ -31,6 +213,9 @@ std::vector<byte> BinaryFileStream::GetData() {
 };
 
 long BinaryFileStream::GetSize() {
+	if (mode == MODE::MMAP) {
+		return (long)dataSize;
+	}
 	LockReadWrite();
 		long pos = (long)file.tellg();
 		file.seekg(0, std::ios::end);
@@ -42,6 +227,12 @@ long BinaryFileStream::GetSize() {
 
 void BinaryFileStream::Truncate() {
 	LockReadWrite();
+		if (mode == MODE::MMAP) {
+			CloseMapping();
+			OpenMapping(true);
+			UnlockReadWrite();
+			return;
+		}
 		if (file.is_open()) {
 			file.close();
 		}
@@ -54,6 +245,14 @@ void BinaryFileStream::Truncate() {
 
 void BinaryFileStream::Reopen(bool seekEnd) {
 	LockReadWrite();
+		if (mode == MODE::MMAP) {
+			CloseMapping();
+			if (OpenMapping() && seekEnd) {
+				readPos = writePos = dataSize;
+			}
+			UnlockReadWrite();
+			return;
+		}
 		if (file.is_open()) {
 			file.close();
 		}
@@ -65,12 +264,50 @@ void BinaryFileStream::Reopen(bool seekEnd) {
 }
 
 bool BinaryFileStream::Delete() {
+	CloseMapping();
 	if (file.is_open()) {
 		file.close();
 	}
 	return FilePath::Delete();
 }
 
+bool BinaryFileStream::IsEOF() const {
+	if (mode == MODE::MMAP) {
+		return readPos >= dataSize;
+	}
+	return file.eof();
+}
+
+long BinaryFileStream::GetReadPos() {
+	if (mode == MODE::MMAP) {
+		return (long)readPos;
+	}
+	return file.tellg();
+}
+
+long BinaryFileStream::GetWritePos() {
+	if (mode == MODE::MMAP) {
+		return (long)writePos;
+	}
+	return file.tellp();
+}
+
+void BinaryFileStream::SetReadPos(long pos) {
+	if (mode == MODE::MMAP) {
+		readPos = (size_t)pos;
+		return;
+	}
+	file.seekg(pos);
+}
+
+void BinaryFileStream::SetWritePos(long pos) {
+	if (mode == MODE::MMAP) {
+		writePos = (size_t)pos;
+		return;
+	}
+	file.seekp(pos);
+}
+
 void BinaryFileStream::Send() {
 	LockReadWrite();
 		if (!file.is_open()) {
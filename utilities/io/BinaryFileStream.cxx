@@ -1,4 +1,5 @@
 #include "BinaryFileStream.h"
+#include "utilities/io/Logger.h"
 
 namespace v4d::tests {
 	int BinaryFileStream() {
@@ -72,6 +73,78 @@ namespace v4d::tests {
 			fileStream.Delete();
 		}
 
+		{// Test 3 (MMAP mode)
+			result = 300;
+			{
+				v4d::io::BinaryFileStream fileStream(v4d::io::FilePath("testfiles_/test_BinaryFileStream_mmap.bin"), 1024, v4d::io::BinaryFileStream::MODE::MMAP);
+				fileStream.Truncate();
+				std::vector<std::string> strListWrite = {"000", "111", "", LONG_ASS_STRING};
+				std::vector<uint32_t> numbers(100000);
+				for (uint32_t i = 0; i < numbers.size(); ++i) numbers[i] = i;
+				fileStream << (int)54 << strListWrite << numbers; // grows the mapping several times
+				fileStream.Flush();
+				if (fileStream.GetSize() != fileStream.GetWritePos()) {
+					LOG_ERROR("v4d::tests::BinaryFileStream ERROR 3.1 (size " << fileStream.GetSize() << " != write position " << fileStream.GetWritePos() << ")")
+					return result + 1;
+				}
+				int a = fileStream.Read<int>();
+				auto strListRead = fileStream.Read<std::vector, std::string>();
+				long numbersPos = fileStream.GetReadPos();
+				auto numbersRead = fileStream.Read<std::vector, uint32_t>();
+				if (a != 54 || strListRead != strListWrite || numbersRead != numbers || !fileStream.IsEOF()) {
+					LOG_ERROR("v4d::tests::BinaryFileStream ERROR 3.2 (sequential read)")
+					return result + 2;
+				}
+				// Random access
+				fileStream.SetAccessPattern(v4d::io::BinaryFileStream::ACCESS_PATTERN::RANDOM);
+				fileStream.SetReadPos(numbersPos + 9 + 4 * 777); // skip the size (9 bytes with LEGACY encoding)
+				if (fileStream.Read<uint32_t>() != 777) {
+					LOG_ERROR("v4d::tests::BinaryFileStream ERROR 3.3 (random read)")
+					return result + 3;
+				}
+				fileStream.SetWritePos(0);
+				fileStream << (int)55;
+				fileStream.SetReadPos(0);
+				if (fileStream.Read<int>() != 55) {
+					LOG_ERROR("v4d::tests::BinaryFileStream ERROR 3.4 (overwrite)")
+					return result + 4;
+				}
+				// Reading past the end gives zeros
+				fileStream.SetReadPos(fileStream.GetSize() - 2);
+				if (fileStream.Read<int>() != 0 || fileStream.GetReadableSize() != 2) {
+					LOG_ERROR("v4d::tests::BinaryFileStream ERROR 3.5 (read past the end)")
+					return result + 5;
+				}
+			}
+			{// Same file read back in FSTREAM mode, then appended to in MMAP mode
+				v4d::io::BinaryFileStream fileStream(v4d::io::FilePath("testfiles_/test_BinaryFileStream_mmap.bin"));
+				int a = fileStream.Read<int>();
+				auto strListRead = fileStream.Read<std::vector, std::string>();
+				if (a != 55 || strListRead.size() != 4 || strListRead[3] != LONG_ASS_STRING) {
+					LOG_ERROR("v4d::tests::BinaryFileStream ERROR 3.6 (read MMAP file with FSTREAM)")
+					return result + 6;
+				}
+			}
+			{
+				v4d::io::BinaryFileStream fileStream(v4d::io::FilePath("testfiles_/test_BinaryFileStream_mmap.bin"), 1024, v4d::io::BinaryFileStream::MODE::MMAP);
+				long size = fileStream.GetSize();
+				fileStream.Reopen(true);
+				fileStream << (double)5.5;
+				fileStream.SetReadPos(size);
+				if (fileStream.GetSize() != size + 8 || fileStream.Read<double>() != 5.5) {
+					LOG_ERROR("v4d::tests::BinaryFileStream ERROR 3.7 (append)")
+					return result + 7;
+				}
+				fileStream.Truncate();
+				if (fileStream.GetSize() != 0 || !fileStream) {
+					LOG_ERROR("v4d::tests::BinaryFileStream ERROR 3.8 (truncate)")
+					return result + 8;
+				}
+				fileStream.Delete();
+			}
+			result = 0;
+		}
+
 		if (!v4d::io::FilePath::DeleteDirectory("testfiles_", true)) {
 			// LOG_ERROR("Failed to delete directory after running tests")
 			return 3;
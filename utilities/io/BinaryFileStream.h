@@ -4,18 +4,51 @@
 #include <string>
 #include <fstream>
 #include <vector>
+#include <atomic>
 #include "utilities/io/FilePath.h"
 #include "utilities/data/Stream.h"
 
 namespace v4d::io {
 	class V4DLIB BinaryFileStream : public v4d::data::Stream, public v4d::io::FilePath {
+	public:
+
+		enum class MODE : uint8_t {
+			FSTREAM, // buffered std::fstream
+			MMAP, // reads and writes go directly to a memory-mapped region of the file (falls back to FSTREAM on Windows)
+		};
+
+		// madvise hints for MMAP mode
+		enum class ACCESS_PATTERN : uint8_t {
+			NORMAL,
+			SEQUENTIAL,
+			RANDOM,
+		};
+
+	private:
 		std::fstream file;
 
 		const std::ios_base::openmode OPENMODE = std::fstream::in | std::fstream::out | std::fstream::binary;
 
+		MODE mode;
+
+		// MMAP mode
+		int fd = -1;
+		byte* mapping = nullptr;
+		size_t mappingSize = 0; // length of the mapped region
+		size_t fileSize = 0; // size of the file on disk, grown ahead of the data while writing and trimmed on Flush() and close
+		std::atomic<size_t> dataSize = 0; // read without the write lock
+		size_t readPos = 0;
+		size_t writePos = 0;
+		ACCESS_PATTERN accessPattern = ACCESS_PATTERN::SEQUENTIAL;
+
+		bool OpenMapping(bool truncate = false);
+		void CloseMapping();
+		bool ReserveMapping(size_t size);
+		void TrimMapping();
+
 	public:
 
-		BinaryFileStream(const std::string& filePath, size_t bufferSize = 1024);
+		BinaryFileStream(const std::string& filePath, size_t bufferSize = 1024, MODE mode = MODE::FSTREAM);
 
 		virtual ~BinaryFileStream() override;
 
@@ -25,34 +58,31 @@ namespace v4d::io {
 		void Truncate();
 		void Reopen(bool seekEnd = false);
 
+		inline MODE GetMode() const {
+			return mode;
+		}
+
+		// Only has an effect in MMAP mode
+		void SetAccessPattern(ACCESS_PATTERN pattern);
+
 		// Stream Overrides
 		std::vector<byte> GetData() override;
+		Stream& Flush() override;
+		Stream& WriteBytes(const byte* data, size_t n) override;
+		Stream& ReadBytes(byte* data, size_t n) override;
+		size_t GetReadableSize() override;
 
 		// FilePath Overrides
 		virtual bool Delete() override;
 		
-		inline bool IsEOF() const {
-			return file.eof();
-		}
-
-		inline long GetReadPos() {
-			return file.tellg();
-		}
-
-		inline long GetWritePos() {
-			return file.tellp();
-		}
-
-		inline void SetReadPos(long pos) {
-			file.seekg(pos);
-		}
-
-		inline void SetWritePos(long pos) {
-			file.seekp(pos);
-		}
+		bool IsEOF() const;
+		long GetReadPos();
+		long GetWritePos();
+		void SetReadPos(long pos);
+		void SetWritePos(long pos);
 		
 		inline operator bool() const {
-			return file.good();
+			return mode == MODE::MMAP? (fd != -1) : file.good();
 		}
 
 	protected:
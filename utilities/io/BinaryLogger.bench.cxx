@@ -0,0 +1,42 @@
+#include <v4d.h>
+#include "helpers/Benchmark.hpp"
+#include "utilities/io/BinaryLogger.h"
+#include "utilities/io/Logger.h"
+
+namespace v4d::benchmarks {
+	void BinaryLogger() {
+		using v4d::Benchmark;
+		using v4d::io::BinaryLogger;
+		v4d::io::FilePath::CreateDirectory("benchfiles_");
+
+		const std::string address = "192.168.0.10:8080";
+		uint32_t size = 0;
+
+		// Same message as text, the way the LOG macros write into a log file
+		{
+			v4d::io::Logger textLogger("benchfiles_/BinaryLogger.log");
+			Benchmark::Run("BinaryLogger text Logger file (for comparison)", [&]{
+				++size;
+				textLogger.Log(std::ostringstream() << "Received " << size << " bytes from " << address << " in " << 0.25 << " ms");
+			});
+		}
+
+		{
+			const uint32_t formatId = BinaryLogger::RegisterFormat(BinaryLogger::LEVEL::INFO, "Received {} bytes from {} in {} ms", __FILE__, __LINE__, BinaryLogger::ArgTypesOf<std::tuple<uint32_t, std::string, double>>::value);
+			BinaryLogger binaryLogger("benchfiles_/BinaryLogger.blog");
+			Benchmark::Run("BinaryLogger Write", [&]{
+				++size;
+				binaryLogger.Write(formatId, size, address, 0.25);
+			});
+		}
+
+		{
+			Benchmark::Run("BinaryLogger FormatText (no binary sink)", [&]{
+				++size;
+				Benchmark::DoNotOptimize(BinaryLogger::FormatText("Received {} bytes from {} in {} ms", size, address, 0.25));
+			});
+		}
+
+		v4d::io::FilePath::DeleteDirectory("benchfiles_", true);
+	}
+}
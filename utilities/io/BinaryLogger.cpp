@@ -0,0 +1,181 @@
+#include "BinaryLogger.h"
+#include "utilities/io/BinaryFileStream.h"
+#include <ctime>
+#include <fstream>
+#include <iomanip>
+#include <unordered_map>
+
+using namespace v4d::io;
+
+std::mutex BinaryLogger::formatsMutex {};
+std::vector<BinaryLogger::Format> BinaryLogger::formats {};
+
+BinaryLogger::BinaryLogger(const std::string& filePath) : file(std::make_unique<BinaryFileStream>(filePath, 0, BinaryFileStream::MODE::MMAP)) {
+	file->Truncate();
+	file->WriteBytes((const byte*)MAGIC, sizeof(MAGIC));
+}
+
+BinaryLogger::~BinaryLogger() {
+	file->Flush();
+}
+
+uint32_t BinaryLogger::RegisterFormat(LEVEL level, const char* format, const char* file, int line, const char* argTypes) {
+	std::string filePath = file;
+	#ifdef _V4D_PROJECT_PATH
+		if (filePath.find(_V4D_PROJECT_PATH) == 0) filePath = filePath.substr(std::string(_V4D_PROJECT_PATH).length());
+	#endif
+	std::lock_guard lock(formatsMutex);
+	formats.push_back({level, format, filePath, (uint32_t)line, argTypes});
+	return (uint32_t)formats.size();
+}
+
+BinaryLogger::Format BinaryLogger::GetFormat(uint32_t id) {
+	std::lock_guard lock(formatsMutex);
+	if (id == 0 || id > formats.size()) return {LEVEL::INFO, "", "", 0, ""};
+	return formats[id - 1];
+}
+
+uint32_t BinaryLogger::GetThreadNumber() {
+	static std::atomic<uint32_t> nextThreadNumber = 1;
+	thread_local uint32_t threadNumber = nextThreadNumber++;
+	return threadNumber;
+}
+
+void BinaryLogger::WriteRecord(uint32_t formatId, const byte* data, size_t size) {
+	std::lock_guard lock(mu);
+	if (formatId >= definedFormats.size()) definedFormats.resize(formatId + 1, false);
+	if (!definedFormats[formatId]) {
+		// First use of this format in this file, define it just before
+		Format format = GetFormat(formatId);
+		std::vector<byte> definition {};
+		auto append = [&definition](const void* value, size_t n){
+			definition.insert(definition.end(), (const byte*)value, (const byte*)value + n);
+		};
+		auto appendString = [&append](const std::string& str){
+			uint32_t size = (uint32_t)str.size();
+			append(&size, sizeof(size));
+			append(str.data(), size);
+		};
+		append(&FORMAT_DEFINITION, sizeof(FORMAT_DEFINITION));
+		append(&formatId, sizeof(formatId));
+		append(&format.level, sizeof(format.level));
+		append(&format.line, sizeof(format.line));
+		appendString(format.file);
+		appendString(format.format);
+		appendString(format.argTypes);
+		file->WriteBytes(definition.data(), definition.size());
+		definedFormats[formatId] = true;
+	}
+	file->WriteBytes(data, size);
+}
+
+void BinaryLogger::Flush() {
+	std::lock_guard lock(mu);
+	file->Flush();
+}
+
+bool BinaryLogger::Decode(const std::string& filePath, std::ostream& out, bool withTimestamps) {
+	std::vector<byte> data {};
+	{
+		std::ifstream file(filePath, std::ios::binary);
+		if (!file.is_open()) return false;
+		data.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+	}
+	if (data.size() < sizeof(MAGIC) || memcmp(data.data(), MAGIC, sizeof(MAGIC)) != 0) return false;
+
+	size_t pos = sizeof(MAGIC);
+	auto read = [&data, &pos](void* value, size_t n){
+		if (n > data.size() - pos) return false;
+		memcpy(value, data.data() + pos, n);
+		pos += n;
+		return true;
+	};
+	auto readString = [&data, &pos, &read](std::string& str){
+		uint32_t size;
+		if (!read(&size, sizeof(size)) || size > data.size() - pos) return false;
+		str.assign((const char*)data.data() + pos, size);
+		pos += size;
+		return true;
+	};
+
+	std::unordered_map<uint32_t, Format> definitions {};
+	for (;;) {
+		uint32_t id;
+		if (!read(&id, sizeof(id)) || id == 0) break; // end of the data
+
+		if (id == FORMAT_DEFINITION) {
+			uint32_t formatId;
+			Format format {};
+			if (!read(&formatId, sizeof(formatId)) || !read(&format.level, sizeof(format.level)) || !read(&format.line, sizeof(format.line))
+				|| !readString(format.file) || !readString(format.format) || !readString(format.argTypes)
+			) break; // incomplete
+			definitions[formatId] = std::move(format);
+			continue;
+		}
+
+		auto definition = definitions.find(id);
+		if (definition == definitions.end()) return false; // corrupted
+		const Format& format = definition->second;
+		uint64_t timestamp;
+		uint32_t thread;
+		if (!read(&timestamp, sizeof(timestamp)) || !read(&thread, sizeof(thread))) break;
+
+		// Same rendering as FormatText()
+		std::ostringstream line;
+		if (withTimestamps) {
+			time_t seconds = (time_t)(timestamp / 1000000000);
+			std::tm time = *std::gmtime(&seconds);
+			line << std::put_time(&time, "%Y-%m-%d %H:%M:%S") << '.' << std::setw(6) << std::setfill('0') << (timestamp % 1000000000) / 1000 << std::setfill(' ') << ' ';
+		}
+		line << "[thread " << thread << "] ";
+		switch (format.level) {
+			case LEVEL::WARN: line << "WARNING: "; break;
+			case LEVEL::ERR: line << "ERROR: "; break;
+			default: break;
+		}
+		std::string_view remaining = format.format;
+		bool complete = true;
+		for (char type : format.argTypes) {
+			size_t placeholder = remaining.find("{}");
+			line << remaining.substr(0, placeholder);
+			remaining = placeholder == std::string_view::npos? std::string_view() : remaining.substr(placeholder + 2);
+			auto readValue = [&read, &line, &complete](auto value, auto display){
+				if (read(&value, sizeof(value))) line << (decltype(display))value;
+				else complete = false;
+			};
+			switch (type) {
+				case 'b': readValue(bool{}, bool{}); break;
+				case 'c': readValue(char{}, char{}); break;
+				case 'a': readValue(int8_t{}, int{}); break;
+				case 's': readValue(int16_t{}, int16_t{}); break;
+				case 'i': readValue(int32_t{}, int32_t{}); break;
+				case 'l': readValue(int64_t{}, int64_t{}); break;
+				case 'A': readValue(uint8_t{}, int{}); break;
+				case 'S': readValue(uint16_t{}, uint16_t{}); break;
+				case 'I': readValue(uint32_t{}, uint32_t{}); break;
+				case 'L': readValue(uint64_t{}, uint64_t{}); break;
+				case 'f': readValue(float{}, float{}); break;
+				case 'd': readValue(double{}, double{}); break;
+				case 'p': {
+					uint64_t ptr;
+					if (read(&ptr, sizeof(ptr))) line << (const void*)(uintptr_t)ptr;
+					else complete = false;
+				}break;
+				case 'z': {
+					std::string str;
+					if (readString(str)) line << str;
+					else complete = false;
+				}break;
+				default: return false; // unknown type, cannot know its size
+			}
+			if (!complete) break;
+		}
+		if (!complete) break; // the application stopped while writing this record
+		line << remaining;
+		if (format.level == LEVEL::WARN || format.level == LEVEL::ERR) {
+			line << " [" << format.file << ":" << format.line << "]";
+		}
+		out << line.str() << '\n';
+	}
+	return true;
+}
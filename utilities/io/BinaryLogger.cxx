@@ -0,0 +1,147 @@
+#include <v4d.h>
+#include <fstream>
+#include <sstream>
+#include <filesystem>
+#include "utilities/io/FilePath.h"
+#include "utilities/io/BinaryLogger.h"
+#include "utilities/io/Logger.h"
+
+namespace v4d::tests {
+	int BinaryLogger() {
+		using v4d::io::BinaryLogger;
+		const std::string dir = "testfiles_blog_";
+		v4d::io::FilePath::CreateDirectory(dir);
+
+		auto decode = [](const std::string& path, std::vector<std::string>& lines, bool withTimestamps = false){
+			std::ostringstream out;
+			lines.clear();
+			if (!BinaryLogger::Decode(path, out, withTimestamps)) return false;
+			std::istringstream in(out.str());
+			for (std::string line; std::getline(in, line);) lines.push_back(line);
+			return true;
+		};
+		auto endsWith = [](const std::string& str, const std::string& end){
+			return str.length() >= end.length() && str.compare(str.length() - end.length(), end.length(), end) == 0;
+		};
+
+		const std::string longString(300, 'x');
+		const uint32_t infoId = BinaryLogger::RegisterFormat(BinaryLogger::LEVEL::INFO, "int {} uint {} string '{}' float {} int8 {} bool {} char {}", __FILE__, __LINE__, BinaryLogger::ArgTypesOf<std::tuple<int, uint64_t, const char*, float, int8_t, bool, char>>::value);
+		const uint32_t warnId = BinaryLogger::RegisterFormat(BinaryLogger::LEVEL::WARN, "long {} end", "some/file.cpp", 42, BinaryLogger::ArgTypesOf<std::tuple<std::string>>::value);
+		const uint32_t emptyId = BinaryLogger::RegisterFormat(BinaryLogger::LEVEL::ERR, "no arguments", "some/file.cpp", 43, "");
+
+		{// Test 1 (records are decoded like the text formatting)
+			{
+				BinaryLogger logger(dir + "/test1.blog");
+				logger.Write(infoId, -5, uint64_t(1ull << 40), "hello", 1.5f, int8_t(-3), true, 'z');
+				logger.Write(warnId, longString);
+				logger.Write(emptyId);
+				logger.Write(infoId, 7, uint64_t(0), "", 0.25f, int8_t(100), false, 'a');
+			}
+			const std::string expected[] = {
+				BinaryLogger::FormatText("int {} uint {} string '{}' float {} int8 {} bool {} char {}", -5, uint64_t(1ull << 40), "hello", 1.5f, int8_t(-3), true, 'z'),
+				"WARNING: long " + longString + " end [some/file.cpp:42]",
+				"ERROR: no arguments [some/file.cpp:43]",
+				"int 7 uint 0 string '' float 0.25 int8 100 bool 0 char a",
+			};
+			if (expected[0] != "int -5 uint 1099511627776 string 'hello' float 1.5 int8 -3 bool 1 char z") {
+				LOG_ERROR("v4d::tests::BinaryLogger ERROR 1.1 (FormatText) " << expected[0])
+				return 1;
+			}
+			std::vector<std::string> lines;
+			if (!decode(dir + "/test1.blog", lines) || lines.size() != 4) {
+				LOG_ERROR("v4d::tests::BinaryLogger ERROR 1.2 (decoded " << lines.size() << " lines)")
+				return 1;
+			}
+			for (int i = 0; i < 4; ++i) {
+				if (lines[i].find("[thread ") != 0 || !endsWith(lines[i], "] " + expected[i])) {
+					LOG_ERROR("v4d::tests::BinaryLogger ERROR 1.3 (line " << i << ") " << lines[i])
+					return 1;
+				}
+			}
+			if (!decode(dir + "/test1.blog", lines, true) || lines.size() != 4 || lines[0].length() < 27 || lines[0][4] != '-' || lines[0][19] != '.' || lines[0].find("[thread ") != 27) {
+				LOG_ERROR("v4d::tests::BinaryLogger ERROR 1.4 (timestamps) " << (lines.size()? lines[0] : ""))
+				return 1;
+			}
+		}
+
+		{// Test 2 (a file that was not closed properly is decoded up to its last complete record)
+			std::string content;
+			{
+				std::ifstream file(dir + "/test1.blog", std::ios::binary);
+				std::stringstream stream;
+				stream << file.rdbuf();
+				content = stream.str();
+				content.erase(content.find_last_not_of('\0') + 1); // the memory-mapped file may be larger than its data
+			}
+			const size_t lastRecordSize = BinaryLogger::RECORD_HEADER_SIZE + 4 + 8 + 4 + 4 + 1 + 1 + 1;
+			{
+				std::ofstream file(dir + "/test2.blog", std::ios::binary | std::ios::trunc);
+				file << content << std::string(4096, '\0');
+			}
+			std::vector<std::string> lines;
+			if (!decode(dir + "/test2.blog", lines) || lines.size() != 4) {
+				LOG_ERROR("v4d::tests::BinaryLogger ERROR 2.1 (decoded " << lines.size() << " lines from a zero-padded file)")
+				return 2;
+			}
+			{
+				std::ofstream file(dir + "/test2.blog", std::ios::binary | std::ios::trunc);
+				file << content.substr(0, content.length() - 3);
+			}
+			if (!decode(dir + "/test2.blog", lines) || lines.size() != 3) {
+				LOG_ERROR("v4d::tests::BinaryLogger ERROR 2.2 (decoded " << lines.size() << " lines from a truncated file)")
+				return 2;
+			}
+			{
+				std::ofstream file(dir + "/test2.blog", std::ios::binary | std::ios::trunc);
+				file << content.substr(0, content.length() - lastRecordSize - 2);
+			}
+			if (!decode(dir + "/test2.blog", lines) || lines.size() != 2) {
+				LOG_ERROR("v4d::tests::BinaryLogger ERROR 2.3 (decoded " << lines.size() << " lines from a truncated file)")
+				return 2;
+			}
+			{
+				std::ofstream file(dir + "/test2.blog", std::ios::binary | std::ios::trunc);
+				file << "not a log file";
+			}
+			if (decode(dir + "/test2.blog", lines)) {
+				LOG_ERROR("v4d::tests::BinaryLogger ERROR 2.4 (invalid file decoded)")
+				return 2;
+			}
+		}
+
+		{// Test 3 (LOG_FMT macros write into the binary sink of the logger)
+			auto testLogger = std::make_shared<v4d::io::Logger>();
+			testLogger->SetVerbose(false);
+			#pragma push_macro("V4D_LOGGER_INSTANCE")
+			#undef V4D_LOGGER_INSTANCE
+			#define V4D_LOGGER_INSTANCE testLogger
+				testLogger->SetBinarySink(std::make_shared<BinaryLogger>(dir + "/test3.blog"));
+				for (int i = 0; i < 3; ++i) {
+					LOG_FMT("loop {} of {}", i, std::string("three"))
+					LOG_FMT_VERBOSE("not logged {}", i)
+				}
+				const int line = __LINE__ + 1;
+				LOG_FMT_WARN("warning {}", 1.25)
+				LOG_FMT_ERROR("error")
+				testLogger->GetBinarySink()->Flush();
+			#pragma pop_macro("V4D_LOGGER_INSTANCE")
+			std::vector<std::string> lines;
+			if (!decode(dir + "/test3.blog", lines) || lines.size() != 5) {
+				LOG_ERROR("v4d::tests::BinaryLogger ERROR 3.1 (decoded " << lines.size() << " lines)")
+				return 3;
+			}
+			if (!endsWith(lines[2], "] loop 2 of three") || lines[3].find("] WARNING: warning 1.25 [") == std::string::npos || !endsWith(lines[3], "utilities/io/BinaryLogger.cxx:" + std::to_string(line) + "]")
+				|| lines[4].find("] ERROR: error [") == std::string::npos || !endsWith(lines[4], "utilities/io/BinaryLogger.cxx:" + std::to_string(line + 1) + "]")
+			) {
+				LOG_ERROR("v4d::tests::BinaryLogger ERROR 3.2 (macros)\n" << lines[2] << "\n" << lines[3] << "\n" << lines[4])
+				return 3;
+			}
+		}
+
+		if (!v4d::io::FilePath::DeleteDirectory(dir, true)) {
+			return 4;
+		}
+
+		return 0;
+	}
+}
@@ -0,0 +1,221 @@
+/*
+ * Binary structured log sink
+ * Part of the Vulkan4D open-source game engine under the LGPL license - https://github.com/Vulkan4D
+ *
+ * Each log call site registers its format string once and gets an id. A log record is then only that id, a timestamp, a thread number and the raw bytes of the arguments,
+ * there is no text formatting when logging. The file is memory-mapped so that what was logged survives a crash of the application.
+ * Format definitions are written in the file the first time they are used, so that it can be decoded by itself, later, with the v4d_logdecode tool (or BinaryLogger::Decode).
+ *
+ * 		// at init
+ * 		V4D_LOGGER_INSTANCE->SetBinarySink(std::make_shared<v4d::io::BinaryLogger>("logs/network.blog"));
+ * 		// hot path, {} is replaced by the next argument when decoding
+ * 		LOG_FMT_VERBOSE("Received {} bytes from {}", size, address)
+ *
+ * The LOG_FMT macros are defined at the end of this file, it is not included by Logger.h so that files which only use the other LOG macros do not depend on it.
+ */
+#pragma once
+
+#include <v4d.h>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <mutex>
+#include <memory>
+#include <ostream>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <vector>
+
+namespace v4d::io {
+	class BinaryFileStream;
+
+	class V4DLIB BinaryLogger {
+	public:
+
+		enum class LEVEL : uint8_t {
+			INFO,
+			VERBOSE,
+			SUCCESS,
+			WARN,
+			ERR, // not ERROR, which is a macro on Windows
+		};
+
+		struct Format {
+			LEVEL level;
+			std::string format;
+			std::string file;
+			uint32_t line;
+			std::string argTypes; // one char per argument, see ArgType()
+		};
+
+		// File layout: MAGIC, then records that start with a uint32 format id (0 = end of the data, the rest of a memory-mapped file is zeros)
+		static constexpr char MAGIC[8] = {'V','4','D','B','L','O','G','1'};
+		static constexpr uint32_t FORMAT_DEFINITION = 0xFFFFFFFF; // followed by id, level, line, file, format and argument types
+		static constexpr size_t RECORD_HEADER_SIZE = sizeof(uint32_t) + sizeof(uint64_t) + sizeof(uint32_t); // format id, timestamp (nanoseconds since epoch), thread number
+
+	private:
+		std::unique_ptr<BinaryFileStream> file; // not included here, since this header is included by Logger.h
+		std::mutex mu;
+		std::vector<bool> definedFormats {}; // format ids already defined in this file
+
+		static std::mutex formatsMutex;
+		static std::vector<Format> formats; // index = id - 1
+
+		static uint32_t GetThreadNumber();
+
+		void WriteRecord(uint32_t formatId, const byte* data, size_t size);
+
+		template<typename T>
+		static constexpr bool IsString = std::is_same_v<std::decay_t<T>, const char*> || std::is_same_v<std::decay_t<T>, char*>
+									|| std::is_same_v<std::decay_t<T>, std::string> || std::is_same_v<std::decay_t<T>, std::string_view>;
+
+		template<typename T>
+		static std::string_view StringView(const T& str) {
+			if constexpr (std::is_pointer_v<std::decay_t<T>>) {
+				return str? std::string_view(str) : std::string_view();
+			} else {
+				return std::string_view(str);
+			}
+		}
+
+		template<typename T>
+		static size_t ArgSize(const T& arg) {
+			if constexpr (IsString<T>) {
+				return sizeof(uint32_t) + StringView(arg).size();
+			} else if constexpr (std::is_pointer_v<std::decay_t<T>>) {
+				return sizeof(uint64_t);
+			} else {
+				return sizeof(T);
+			}
+		}
+
+		template<typename T>
+		static byte* EncodeArg(byte* out, const T& arg) {
+			if constexpr (IsString<T>) {
+				std::string_view str = StringView(arg);
+				uint32_t size = (uint32_t)str.size();
+				memcpy(out, &size, sizeof(size));
+				memcpy(out + sizeof(size), str.data(), size);
+				return out + sizeof(size) + size;
+			} else if constexpr (std::is_pointer_v<std::decay_t<T>>) {
+				std::decay_t<T> pointer = arg;
+				uint64_t ptr = (uint64_t)(uintptr_t)pointer;
+				memcpy(out, &ptr, sizeof(ptr));
+				return out + sizeof(ptr);
+			} else {
+				memcpy(out, &arg, sizeof(T));
+				return out + sizeof(T);
+			}
+		}
+
+		template<typename T>
+		static void StreamArg(std::ostream& stream, const T& arg) {
+			using U = std::decay_t<T>;
+			if constexpr (IsString<T>) {
+				stream << StringView(arg);
+			} else if constexpr (std::is_pointer_v<U>) {
+				stream << (const void*)arg;
+			} else if constexpr (std::is_enum_v<U>) {
+				StreamArg(stream, (std::underlying_type_t<U>)arg);
+			} else if constexpr (std::is_integral_v<U> && sizeof(U) == 1 && !std::is_same_v<U, char> && !std::is_same_v<U, bool>) {
+				stream << (int)arg; // int8_t and uint8_t are numbers, not characters
+			} else {
+				stream << arg;
+			}
+		}
+
+	public:
+
+		BinaryLogger(const std::string& filePath);
+		~BinaryLogger();
+
+		DELETE_COPY_MOVE_CONSTRUCTORS(BinaryLogger)
+
+		// Type of an argument in a format definition
+		template<typename T>
+		static constexpr char ArgType() {
+			using U = std::decay_t<T>;
+			if constexpr (IsString<U>) return 'z';
+			else if constexpr (std::is_same_v<U, bool>) return 'b';
+			else if constexpr (std::is_same_v<U, char>) return 'c';
+			else if constexpr (std::is_enum_v<U>) return ArgType<std::underlying_type_t<U>>();
+			else if constexpr (std::is_integral_v<U> && std::is_signed_v<U>) return "as i   l"[sizeof(U) - 1];
+			else if constexpr (std::is_integral_v<U>) return "AS I   L"[sizeof(U) - 1];
+			else if constexpr (std::is_same_v<U, float>) return 'f';
+			else if constexpr (std::is_same_v<U, double>) return 'd';
+			else if constexpr (std::is_pointer_v<U>) return 'p';
+			else static_assert(std::is_void_v<U>, "BinaryLogger only supports arithmetic, enum, pointer and string arguments");
+		}
+
+		// Argument types of a std::tuple, as a null-terminated string
+		template<typename Tuple> struct ArgTypesOf;
+		template<typename... T> struct ArgTypesOf<std::tuple<T...>> {
+			static constexpr char value[] = {ArgType<T>()..., '\0'};
+		};
+
+		// Called once per log call site (see LOG_FMT), returns the format id
+		static uint32_t RegisterFormat(LEVEL level, const char* format, const char* file, int line, const char* argTypes);
+		static Format GetFormat(uint32_t id);
+
+		// Text formatting of a message, used when there is no binary sink, each {} is replaced by the next argument
+		template<typename... Args>
+		static std::string FormatText(std::string_view format, const Args&... args) {
+			std::ostringstream stream;
+			auto next = [&stream, &format](){
+				size_t pos = format.find("{}");
+				stream << format.substr(0, pos);
+				format = pos == std::string_view::npos? std::string_view() : format.substr(pos + 2);
+			};
+			((next(), StreamArg(stream, args)), ...);
+			stream << format;
+			return stream.str();
+		}
+
+		// Hot path, encodes the arguments without formatting them
+		template<typename... Args>
+		void Write(uint32_t formatId, const Args&... args) {
+			size_t size = (ArgSize(args) + ... + RECORD_HEADER_SIZE);
+			byte stackBuffer[256];
+			std::vector<byte> heapBuffer {};
+			byte* data = stackBuffer;
+			if (size > sizeof(stackBuffer)) {
+				heapBuffer.resize(size);
+				data = heapBuffer.data();
+			}
+			uint64_t timestamp = (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+			uint32_t thread = GetThreadNumber();
+			memcpy(data, &formatId, sizeof(formatId));
+			memcpy(data + 4, &timestamp, sizeof(timestamp));
+			memcpy(data + 12, &thread, sizeof(thread));
+			byte* out = data + RECORD_HEADER_SIZE;
+			((out = EncodeArg(out, args)), ...);
+			WriteRecord(formatId, data, size);
+		}
+
+		void Flush();
+
+		/**
+		 * Renders a binary log file as text, one line per record: [time] [thread n] message, followed by [file:line] for warnings and errors.
+		 * Stops at the end of the data, or at the first incomplete record of a file that was not closed properly.
+		 * Returns false if the file is not a binary log file or is corrupted.
+		 */
+		static bool Decode(const std::string& filePath, std::ostream& out, bool withTimestamps = true);
+
+	};
+}
+
+// Structured logging for hot paths, {} in the format string is replaced by the next argument
+// With a binary sink, only the format id and the raw argument bytes are written (decode the file with v4d_logdecode), otherwise the message is formatted as text like the LOG macros
+#define __V4D_LOG_FMT(level, textLog, format, ...) {\
+	static const uint32_t __v4dLogFormatId = v4d::io::BinaryLogger::RegisterFormat(v4d::io::BinaryLogger::LEVEL::level, format, __FILE__, __LINE__, v4d::io::BinaryLogger::ArgTypesOf<decltype(std::make_tuple(__VA_ARGS__))>::value);\
+	if (auto* __v4dBinarySink = V4D_LOGGER_INSTANCE->GetBinarySink()) __v4dBinarySink->Write(__v4dLogFormatId __VA_OPT__(,) __VA_ARGS__);\
+	else textLog(v4d::io::BinaryLogger::FormatText(format __VA_OPT__(,) __VA_ARGS__))\
+}
+#define LOG_FMT(format, ...) __V4D_LOG_FMT(INFO, LOG, format __VA_OPT__(,) __VA_ARGS__)
+#define LOG_FMT_VERBOSE(format, ...) {if (V4D_LOGGER_INSTANCE->IsVerbose()) __V4D_LOG_FMT(VERBOSE, LOG_VERBOSE, format __VA_OPT__(,) __VA_ARGS__)}
+#define LOG_FMT_SUCCESS(format, ...) __V4D_LOG_FMT(SUCCESS, LOG_SUCCESS, format __VA_OPT__(,) __VA_ARGS__)
+#define LOG_FMT_WARN(format, ...) __V4D_LOG_FMT(WARN, LOG_WARN, format __VA_OPT__(,) __VA_ARGS__)
+#define LOG_FMT_ERROR(format, ...) __V4D_LOG_FMT(ERR, LOG_ERROR, format __VA_OPT__(,) __VA_ARGS__)
@@ -0,0 +1,89 @@
+#include <v4d.h>
+#include <fstream>
+#include <sstream>
+#include <regex>
+#include <filesystem>
+#include "helpers/Benchmark.hpp"
+#include "utilities/io/ConfigFile.h"
+
+namespace v4d::benchmarks::ConfigFile_Structs {
+	struct BenchConfig : v4d::io::ConfigFile {
+		CONFIGFILE_STRUCT(BenchConfig)
+		int first = 0, middle = 0, last = 0;
+		std::string name = "";
+		double ratio = 0;
+		void Save() {
+			WriteConfig();
+		}
+	private:
+		void ReadConfig() override {
+			CONFIGFILE_READ_FROM_INI("section0", first, name)
+			CONFIGFILE_READ_FROM_INI("section50", middle, ratio)
+			CONFIGFILE_READ_FROM_INI("section99", last)
+		}
+		void WriteConfig() override {
+			CONFIGFILE_WRITE_TO_INI("section99", last)
+		}
+	};
+}
+
+namespace v4d::benchmarks {
+	void ConfigFile() {
+		using v4d::Benchmark;
+		using namespace ConfigFile_Structs;
+		const std::string path = "benchfiles_/ConfigFile.ini";
+
+		// 100 sections of 99 confs, with a comment line in each (10k lines)
+		v4d::io::FilePath::CreateDirectory("benchfiles_");
+		{
+			std::ofstream file(path, std::ios::trunc);
+			for (int s = 0; s < 100; ++s) {
+				file << "[section" << s << "]\n";
+				file << "; comment for section " << s << "\n";
+				file << "first = " << s << "\nmiddle = " << s << "\nlast = " << s << "\nname = \"section " << s << "\"\nratio: 0." << s << "\n";
+				for (int c = 5; c < 98; ++c) file << "conf" << c << " = some value " << c << "\n";
+			}
+		}
+		const double fileSize = (double)std::filesystem::file_size(path);
+
+		BenchConfig config(path, 0);
+
+		// The file changes before every load, so that it is parsed again
+		Benchmark::Run("ConfigFile Load 10k-line INI", [&]{
+			std::filesystem::last_write_time(path, std::filesystem::file_time_type::clock::now());
+			config.Load();
+			Benchmark::DoNotOptimize(config.last);
+		}, fileSize);
+
+		Benchmark::Run("ConfigFile Load 10k-line INI unchanged", [&]{
+			config.Load();
+			Benchmark::DoNotOptimize(config.last);
+		}, fileSize);
+
+		// Same work as the previous std::regex parser, for comparison
+		const std::regex INI_REGEX_COMMENT	{R"(^(;|#|//).*$)"};
+		const std::regex INI_REGEX_SECTION	{R"(^\[([\w\s]+)\]$)"};
+		const std::regex INI_REGEX_CONF		{R"(^([\w\s]+)\s*[=:]\s*(.*)$)"};
+		Benchmark::Run("ConfigFile std::regex scan 10k-line INI (previous parser)", [&]{
+			std::ifstream file(path);
+			std::string line;
+			std::cmatch match;
+			size_t confs = 0;
+			while (std::getline(file, line)) {
+				v4d::String::Trim(line);
+				if (line.length() == 0) continue;
+				if (std::regex_match(line.c_str(), match, INI_REGEX_COMMENT)) continue;
+				if (std::regex_match(line.c_str(), match, INI_REGEX_SECTION)) continue;
+				if (std::regex_match(line.c_str(), match, INI_REGEX_CONF)) ++confs;
+			}
+			Benchmark::DoNotOptimize(confs);
+		}, fileSize);
+
+		Benchmark::Run("ConfigFile Write 1 value in 10k-line INI", [&]{
+			++config.last;
+			config.Save();
+		});
+
+		v4d::io::FilePath::DeleteDirectory("benchfiles_", true);
+	}
+}
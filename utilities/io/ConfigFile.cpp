@@ -1,5 +1,7 @@
 #include "ConfigFile.h"
 #include <fstream>
+#include <filesystem>
+#include <algorithm>
 #include "utilities/io/Logger.h"
 
 using namespace v4d::io;
@@ -9,17 +11,14 @@ int ConfigFile::globalAutoReloadInterval = DEFAULT_AUTORELOAD_INTERVAL;
 
 ConfigFile::ConfigFile(const std::string& filePath, std::optional<int> autoReloadInterval) : FilePath(filePath), autoReloadInterval(autoReloadInterval.value_or(globalAutoReloadInterval)) {
 	AutoCreateFile();
-	if (autoReloadInterval > 0) {
-		StartAutoReloadThread();
+	if (this->autoReloadInterval > 0) {
+		StartWatching();
 	}
 }
 
 ConfigFile::~ConfigFile() {
 	autoReloadInterval = 0;
-	if (autoReloadThread && autoReloadThread->joinable()) {
-		autoReloadThread->join();
-		delete autoReloadThread;
-	}
+	StopWatching();
 }
 
 ConfigFile* ConfigFile::Load() {
@@ -35,13 +34,12 @@ ConfigFile* ConfigFile::Load() {
 }
 
 void ConfigFile::SetAutoReloadInterval(int interval) {
+	// Not holding the lock while unwatching, since the watcher waits for a running reload which needs it
+	StopWatching();
+	std::lock_guard lock(mu);
 	autoReloadInterval = interval;
-	if (autoReloadInterval <= 0 && autoReloadThread && autoReloadThread->joinable()) {
-		autoReloadThread->join();
-		delete autoReloadThread;
-		autoReloadThread = nullptr;
-	} else if (autoReloadInterval > 0 && !autoReloadThread) {
-		StartAutoReloadThread();
+	if (autoReloadInterval > 0) {
+		StartWatching();
 	}
 }
 
@@ -50,159 +48,253 @@ bool ConfigFile::FileHasChanged() const {
 	return lastWriteTimeCache != GetLastWriteTime();
 }
 
-void ConfigFile::StartAutoReloadThread() {
-	autoReloadThread = new std::thread([this]{
-		int interval = autoReloadInterval;
-		for (;;) {
-			if (interval <= 0) return;
-			SLEEP(std::chrono::milliseconds{interval})
-			std::lock_guard lock(mu);
-			if (autoReloadInterval <= 0) return;
-			auto lastWriteTime = GetLastWriteTime();
-			if (lastWriteTime == 0) {
-				AutoCreateFile();
-				lastWriteTime = GetLastWriteTime();
-			}
-			if (lastWriteTimeCache != lastWriteTime) {
-				ReadConfig();
-				lastWriteTimeCache = GetLastWriteTime();
-			}
-			interval = autoReloadInterval;
+void ConfigFile::StartWatching() {
+	std::lock_guard lock(mu);
+	if (watcher) return;
+	watcher = FileWatcher::Instance();
+	watchId = watcher->Watch(filePath.string(), [this](const std::string&){
+		ReloadIfChanged();
+	}, autoReloadInterval);
+}
+
+void ConfigFile::StopWatching() {
+	std::shared_ptr<FileWatcher> w;
+	FileWatcher::WatchId id;
+	{
+		std::lock_guard lock(mu);
+		w = std::move(watcher);
+		id = watchId;
+		watcher = nullptr;
+		watchId = 0;
+	}
+	if (w) w->Unwatch(id);
+}
+
+void ConfigFile::ReloadIfChanged() {
+	std::lock_guard lock(mu);
+	if (autoReloadInterval <= 0) return;
+	auto lastWriteTime = GetLastWriteTime();
+	if (lastWriteTime == 0) {
+		AutoCreateFile();
+		lastWriteTime = GetLastWriteTime();
+	}
+	if (lastWriteTimeCache != lastWriteTime) {
+		ReadConfig();
+		lastWriteTimeCache = GetLastWriteTime();
+	}
+}
+
+ConfigFile::IniLine ConfigFile::ScanIniLine(std::string_view line) {
+	// Same grammar as the regexes used before: ^(;|#|//).*$  ^\[([\w\s]+)\]$  ^([\w\s]+)\s*[=:]\s*(.*)$
+	auto isSpace = [](char c){return c == ' ' || c == '\t' || c == '\r' || c == '\n' || c == '\f' || c == '\v';};
+	auto isNameChar = [&isSpace](char c){return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '_' || isSpace(c);};
+	auto trim = [&isSpace](std::string_view str){
+		while (!str.empty() && isSpace(str.front())) str.remove_prefix(1);
+		while (!str.empty() && isSpace(str.back())) str.remove_suffix(1);
+		return str;
+	};
+	IniLine result {};
+	line = trim(line);
+	if (line.empty()) return result;
+	if (line[0] == ';' || line[0] == '#' || line.starts_with("//")) {
+		result.type = IniLine::COMMENT;
+		return result;
+	}
+	if (line[0] == '[') {
+		if (line.size() > 2 && line.back() == ']' && std::all_of(line.begin() + 1, line.end() - 1, isNameChar)) {
+			result.type = IniLine::SECTION;
+			result.name = trim(line.substr(1, line.size() - 2));
+		} else {
+			result.type = IniLine::INVALID;
 		}
-	});
+		return result;
+	}
+	size_t i = 0;
+	while (i < line.size() && isNameChar(line[i])) ++i;
+	if (i == 0 || i == line.size() || (line[i] != '=' && line[i] != ':')) {
+		result.type = IniLine::INVALID;
+		return result;
+	}
+	result.type = IniLine::CONF;
+	result.name = trim(line.substr(0, i));
+	result.value = trim(line.substr(i + 1));
+	return result;
+}
+
+void ConfigFile::LoadIniDocument() {
+	std::error_code err;
+	double lastWriteTime = GetLastWriteTime();
+	uintmax_t fileSize = std::filesystem::file_size(filePath, err);
+	if (err) fileSize = 0;
+	if (ini.loaded && ini.lastWriteTime == lastWriteTime && ini.fileSize == fileSize) return;
+
+	// Read the whole file at once, then split it in lines
+	std::string text(fileSize, '\0');
+	{
+		std::ifstream file(filePath, std::ios::binary);
+		file.read(text.data(), (std::streamsize)fileSize);
+		text.resize((size_t)file.gcount());
+	}
+	ini.lines.clear();
+	for (size_t begin = 0; begin < text.size(); ) {
+		size_t end = text.find('\n', begin);
+		if (end == std::string::npos) end = text.size();
+		ini.lines.push_back({text.substr(begin, end - begin), IniLine::BLANK, 0, 0, 0, begin, end < text.size()});
+		begin = end + 1;
+	}
+	IndexIniDocument();
+	ini.loaded = true;
+	ini.lastWriteTime = lastWriteTime;
+	ini.fileSize = fileSize;
+}
+
+void ConfigFile::IndexIniDocument() {
+	ini.sections.assign(1, "");
+	ini.sectionLastLine.assign(1, -1);
+	ini.sectionIndex.clear();
+	ini.sectionIndex.emplace("", 0);
+	ini.confLines.clear();
+	ini.confLines.reserve(ini.lines.size());
+	size_t currentSection = 0;
+	for (size_t n = 0; n < ini.lines.size(); ++n) {
+		auto& line = ini.lines[n];
+		IniLine scanned = ScanIniLine(line.text);
+		line.type = scanned.type;
+		switch (scanned.type) {
+			case IniLine::BLANK: break;
+			case IniLine::SECTION: {
+				auto [it, inserted] = ini.sectionIndex.try_emplace(std::string(scanned.name), ini.sections.size());
+				if (inserted) {
+					ini.sections.emplace_back(scanned.name);
+					ini.sectionLastLine.push_back(-1);
+				}
+				currentSection = it->second;
+			}break;
+			case IniLine::CONF:
+				line.valueBegin = size_t(scanned.value.data() - line.text.data());
+				line.valueLength = scanned.value.size();
+				ini.confLines.try_emplace(IniKey(ini.sections[currentSection], scanned.name), n); // the first one wins
+			break;
+			case IniLine::INVALID:
+				LOG_WARN_VERBOSE("Line " << (n+1) << " is invalid in config file " << filePath)
+			break;
+			case IniLine::COMMENT: break;
+		}
+		line.section = currentSection;
+		if (scanned.type != IniLine::BLANK) ini.sectionLastLine[currentSection] = (long)n;
+	}
+}
+
+void ConfigFile::WriteIniDocument(size_t firstModifiedLine) {
+	// Only rewrite the file from the first modified line, the lines before it are still where they were when scanned
+	size_t offset = 0;
+	std::string tail;
+	if (firstModifiedLine > 0) {
+		auto& previous = ini.lines[firstModifiedLine - 1];
+		offset = previous.offset + previous.text.size();
+		if (previous.terminated) ++offset;
+		else tail.append(1, '\n'); // the file did not end with a line break
+		previous.terminated = true;
+	}
+	for (size_t n = firstModifiedLine; n < ini.lines.size(); ++n) {
+		ini.lines[n].offset = offset + tail.size();
+		ini.lines[n].terminated = true;
+		tail.append(ini.lines[n].text).append(1, '\n');
+	}
+	{
+		std::fstream file(filePath, std::ios::in | std::ios::out | std::ios::binary);
+		if (!file.is_open()) file.open(filePath, std::ios::out | std::ios::binary);
+		file.seekp((std::streamoff)offset);
+		file.write(tail.data(), (std::streamsize)tail.size());
+	}
+	std::error_code err;
+	std::filesystem::resize_file(filePath, offset + tail.size(), err);
+	ini.lastWriteTime = GetLastWriteTime();
+	ini.fileSize = offset + tail.size();
 }
 
 void ConfigFile::ReadFromINI(const std::string& section, std::vector<Conf> configs, bool writeIfNotExists) {
 	LOG_VERBOSE("Config File Read: " << filePath.string())
-	std::ifstream file(filePath);
-	std::string curSection = "";
-	std::string line;
-	std::cmatch match;
-	int n = 0;
-	while (!configs.empty() && std::getline(file, line)) {
-		n++;
-		v4d::String::Trim(line);
-		if (line.length() == 0) continue;
-		if (std::regex_match(line.c_str(), match, INI_REGEX_COMMENT)) continue;
-		if (std::regex_match(line.c_str(), match, INI_REGEX_SECTION)) {
-			curSection = match[1];
-			v4d::String::Trim(curSection);
-			continue;
-		}
-		if (std::regex_match(line.c_str(), match, INI_REGEX_CONF)) {
-			for (auto it = configs.begin(); it != configs.end(); it++) {
-				auto conf = *it;
-				std::string confName = match[1];
-				v4d::String::Trim(confName);
-				if (conf.name == confName) {
-					std::string value = match[2];
-					v4d::String::Trim(value);
-					conf.ReadValue(value);
-					configs.erase(it);
-					break;
-				}
-			}
+	std::lock_guard lock(mu);
+	LoadIniDocument();
+	std::vector<Conf> missingConfigs {};
+	for (auto& conf : configs) {
+		auto it = ini.confLines.find(IniKey(section, conf.name));
+		if (it == ini.confLines.end()) {
+			missingConfigs.push_back(conf);
 			continue;
 		}
-		LOG_WARN_VERBOSE("Line " << n << " is invalid in config file " << filePath)
+		const auto& line = ini.lines[it->second];
+		conf.ReadValue(line.text.substr(line.valueBegin, line.valueLength));
 	}
-	file.close();
-	if (writeIfNotExists && !configs.empty()) {
-		WriteToINI(section, configs);
+	if (writeIfNotExists && !missingConfigs.empty()) {
+		WriteToINI(section, missingConfigs);
 	}
 }
 
 void ConfigFile::WriteToINI(const std::string& section, std::vector<Conf> configs) {
 	LOG_VERBOSE("Config File Write: " << filePath.string())
+	std::lock_guard lock(mu);
+	LoadIniDocument();
+	size_t firstModifiedLine = ini.lines.size();
 
-	// Read all lines
-	std::vector<std::string> lines;
-	{
-		std::ifstream file(filePath);
-		std::string line;
-		while (std::getline(file, line)) {
-			v4d::String::Trim(line);
-			lines.push_back(line);
+	// Replace the values of existing lines in place
+	std::vector<std::string> newLines {};
+	for (auto& conf : configs) {
+		std::string value = conf.WriteValue();
+		auto it = ini.confLines.find(IniKey(section, conf.name));
+		if (it == ini.confLines.end()) {
+			newLines.push_back(conf.name + " = " + value);
+			continue;
 		}
-		file.close();
-	}
-
-	// Add/Set configurations to lines (at the correct positions)
-	for (auto conf : configs) {
-		std::string confLine = conf.name + " = " + conf.WriteValue();
-		std::string curSection = "";
-		std::cmatch match;
-		for (auto line = lines.begin(); line != lines.end(); line++) {
-			if (section == curSection && std::regex_match(line->c_str(), match, INI_REGEX_SECTION)) {
-				// We're at the end of the correct section, Insert conf just before the current line (the next section line)
-				auto insertedLine = lines.insert(line, confLine);
-				lines.insert(insertedLine+1, ""); // Add an empty line before the next section
-				goto NextConf;
-			} else {
-				if (line->length() == 0) continue;
-				if (std::regex_match(line->c_str(), match, INI_REGEX_COMMENT)) continue;
-				if (std::regex_match(line->c_str(), match, INI_REGEX_SECTION)) {
-					curSection = match[1];
-					v4d::String::Trim(curSection);
-					continue;
-				}
-			}
-			if (std::regex_match(line->c_str(), match, INI_REGEX_CONF)) {
-				std::string confName = match[1];
-				v4d::String::Trim(confName);
-				if (conf.name == confName) {
-					// Edit existing line in file
-					*line = confLine;
-					goto NextConf;
-				}
-				continue;
+		auto& line = ini.lines[it->second];
+		if (line.text.compare(line.valueBegin, line.valueLength, value) == 0) continue;
+		line.text.replace(line.valueBegin, line.valueLength, value);
+		line.valueLength = value.size();
+		firstModifiedLine = std::min(firstModifiedLine, it->second);
+	}
+
+	// Insert the missing ones at the end of their section, or in a new section at the end of the file
+	if (!newLines.empty()) {
+		size_t insertAt;
+		auto sectionIt = ini.sectionIndex.find(section);
+		if (sectionIt != ini.sectionIndex.end()) {
+			insertAt = size_t(ini.sectionLastLine[sectionIt->second] + 1);
+		} else {
+			insertAt = ini.lines.size();
+			newLines.insert(newLines.begin(), "[" + section + "]");
+			if (insertAt > 0 && ini.lines.back().type != IniLine::BLANK) {
+				newLines.insert(newLines.begin(), ""); // empty line before the new section
 			}
 		}
-		// Conf not found in file, append it
-		if (section != curSection) {
-			// Section not found, append it
-			lines.push_back("");
-			lines.push_back(std::string("[") + section + "]");
-		}
-		lines.push_back(confLine);
-		NextConf: continue;
+		std::vector<IniDocument::Line> inserted {};
+		for (auto& text : newLines) inserted.push_back({std::move(text), IniLine::BLANK, 0, 0, 0, 0, true});
+		ini.lines.insert(ini.lines.begin() + insertAt, std::make_move_iterator(inserted.begin()), std::make_move_iterator(inserted.end()));
+		firstModifiedLine = std::min(firstModifiedLine, insertAt);
+		IndexIniDocument();
 	}
 
-	// Write all lines to file
-	std::ofstream file(filePath);
-	for (auto line : lines) {
-		file << line << "\n";
+	if (firstModifiedLine < ini.lines.size()) {
+		WriteIniDocument(firstModifiedLine);
 	}
-	file.close();
 }
 
 void ConfigFile::ReadFromINI(std::function<void(std::stringstream section, std::vector<ConfLineStream>& configs)>&& callbackPerSection) {
 	LOG_VERBOSE("Config File Read: " << filePath.string())
-	std::ifstream file(filePath);
+	std::lock_guard lock(mu);
+	LoadIniDocument();
 	std::string curSection = "";
 	std::vector<ConfLineStream> curConfigs {};
-	std::string line;
-	std::cmatch match;
-	int n = 0;
-	while (std::getline(file, line)) {
-		n++;
-		v4d::String::Trim(line);
-		if (line.length() == 0) continue;
-		if (std::regex_match(line.c_str(), match, INI_REGEX_COMMENT)) continue;
-		if (std::regex_match(line.c_str(), match, INI_REGEX_SECTION)) {
+	for (auto& line : ini.lines) {
+		if (line.type == IniLine::SECTION) {
 			callbackPerSection(std::move(std::stringstream{curSection}), curConfigs);
 			curConfigs.clear();
-			curSection = match[1].str();
-			continue;
-		}
-		if (std::regex_match(line.c_str(), match, INI_REGEX_CONF)) {
+			curSection = ini.sections[line.section];
+		} else if (line.type == IniLine::CONF) {
 			auto& confLineStream = curConfigs.emplace_back();
-			confLineStream.name << match[1].str();
-			confLineStream.value << match[2].str();
-			continue;
+			confLineStream.name << ScanIniLine(line.text).name;
+			confLineStream.value << line.text.substr(line.valueBegin, line.valueLength);
 		}
-		LOG_WARN_VERBOSE("Line " << n << " is invalid in config file " << filePath)
 	}
-	file.close();
 	callbackPerSection(std::move(std::stringstream{curSection}), curConfigs);
 }
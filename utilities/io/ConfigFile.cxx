@@ -0,0 +1,132 @@
+#include <v4d.h>
+#include <fstream>
+#include <sstream>
+#include "utilities/io/ConfigFile.h"
+
+namespace v4d::tests::ConfigFile_Structs {
+	struct TestConfig : v4d::io::ConfigFile {
+		CONFIGFILE_STRUCT(TestConfig)
+		int width = 800;
+		float scale = 1.5f;
+		bool fullscreen = false;
+		int volume = 50;
+		std::string name = "default";
+		void Save() {
+			WriteConfig();
+		}
+	private:
+		void ReadConfig() override {
+			CONFIGFILE_READ_FROM_INI_WRITE("graphics", width, scale, fullscreen)
+			CONFIGFILE_READ_FROM_INI_WRITE("audio", volume)
+			CONFIGFILE_READ_FROM_INI("general", name)
+		}
+		void WriteConfig() override {
+			CONFIGFILE_WRITE_TO_INI("graphics", width, scale, fullscreen)
+			CONFIGFILE_WRITE_TO_INI("audio", volume)
+			CONFIGFILE_WRITE_TO_INI("general", name)
+		}
+	};
+}
+
+namespace v4d::tests {
+	int ConfigFile() {
+		using namespace ConfigFile_Structs;
+		const std::string path = "testfiles_config_/test.ini";
+
+		auto readFile = [&path]{
+			std::ifstream file(path, std::ios::binary);
+			std::stringstream content;
+			content << file.rdbuf();
+			return content.str();
+		};
+		auto writeFile = [&path](const std::string& content){
+			std::ofstream file(path, std::ios::binary | std::ios::trunc);
+			file << content;
+		};
+
+		const std::string original =
+			"; comment\n"
+			"# other comment\n"
+			"// another comment\n"
+			"title: hello world\n"
+			"\n"
+			"[graphics]\n"
+			"width = 1920   \n"
+			"  scale=2.5\n"
+			"fullscreen: yes\n"
+			"volume = 10\n"
+			"this line is invalid!\n"
+			"\n"
+			"[audio]\n"
+		;
+		v4d::io::FilePath::CreateDirectory("testfiles_config_");
+		writeFile(original);
+
+		{
+			TestConfig config(path, 0);
+			config.Load();
+
+			{// Test 1 (values are read from their own section only)
+				if (config.width != 1920 || config.scale != 2.5f || !config.fullscreen || config.volume != 50 || config.name != "default") {
+					LOG_ERROR("v4d::tests::ConfigFile ERROR 1 (read values)")
+					return 1;
+				}
+			}
+
+			{// Test 2 (missing values are written at the end of their section, leaving the other lines untouched)
+				if (readFile() != original + "volume = 50\n") {
+					LOG_ERROR("v4d::tests::ConfigFile ERROR 2 (missing value not written in place)\n" << readFile())
+					return 2;
+				}
+			}
+
+			{// Test 3 (only modified values are rewritten, missing sections are appended)
+				config.width = 1280;
+				config.Save();
+				std::string expected = original + "volume = 50\n\n[general]\nname = default\n";
+				expected.replace(expected.find("1920"), 4, "1280");
+				expected.replace(expected.find("scale=2.5") + 6, 3, std::to_string(2.5f));
+				if (readFile() != expected) {
+					LOG_ERROR("v4d::tests::ConfigFile ERROR 3 (minimal rewrite)\n" << readFile())
+					return 3;
+				}
+				config.Save();
+				if (readFile() != expected) {
+					LOG_ERROR("v4d::tests::ConfigFile ERROR 3.1 (rewrite without changes)\n" << readFile())
+					return 3;
+				}
+			}
+
+			{// Test 4 (external modifications are seen when loading again)
+				std::string content = readFile();
+				content.replace(content.find("width = 1280"), 12, "width=640");
+				content.replace(content.find("name = default"), 14, "name = 'quoted value'");
+				writeFile(content);
+				config.Load();
+				if (config.width != 640 || config.name != "'quoted value'" || config.volume != 50) {
+					LOG_ERROR("v4d::tests::ConfigFile ERROR 4 (reload)")
+					return 4;
+				}
+			}
+		}
+
+		{// Test 5 (a file without a line break at the end gets one before the appended lines)
+			const std::string content = "[graphics]\nwidth = 1920\nscale = " + std::to_string(2.5f) + "\nfullscreen = no\n\n[audio]\nvolume = 10";
+			writeFile(content);
+			TestConfig config(path, 0);
+			config.Load();
+			config.Save();
+			const std::string expected = content + "\n\n[general]\nname = default\n";
+			if (config.width != 1920 || config.volume != 10 || readFile() != expected) {
+				LOG_ERROR("v4d::tests::ConfigFile ERROR 5 (no trailing line break)\n" << readFile())
+				return 5;
+			}
+		}
+
+		if (!v4d::io::FilePath::DeleteDirectory("testfiles_config_", true)) {
+			return 6;
+		}
+
+		return 0;
+	}
+}
@@ -3,13 +3,15 @@
 #include <v4d.h>
 #include <string>
 #include <sstream>
-#include <regex>
+#include <string_view>
+#include <unordered_map>
 #include <mutex>
 #include <functional>
 #include <vector>
 #include <optional>
-#include <thread>
+#include <memory>
 #include "utilities/io/FilePath.h"
+#include "utilities/io/FileWatcher.h"
 #include "utilities/io/Logger.h"
 
 namespace v4d::io {
@@ -161,6 +163,7 @@ namespace v4d::io {
 
 		ConfigFile* Load();
 
+		// Reloads the file when it changed and then did not change for this long (in milliseconds), 0 = disabled
 		void SetAutoReloadInterval(int interval);
 
 		bool FileHasChanged() const;
@@ -170,23 +173,70 @@ namespace v4d::io {
 		static const int DEFAULT_AUTORELOAD_INTERVAL = 0; // in milliseconds, 0 = disabled
 		static int globalAutoReloadInterval;
 
-		std::thread* autoReloadThread = nullptr;
+		std::shared_ptr<FileWatcher> watcher = nullptr;
+		FileWatcher::WatchId watchId = 0;
 		double lastWriteTimeCache = 0;
 
+		void StopWatching();
+		void ReloadIfChanged();
+
 	protected: // methods
 
 		ConfigFile(const std::string& filePath, std::optional<int> autoReloadInterval);
 
-		void StartAutoReloadThread();
+		void StartWatching();
 
-		const std::regex INI_REGEX_COMMENT	{R"(^(;|#|//).*$)"};
-		const std::regex INI_REGEX_SECTION	{R"(^\[([\w\s]+)\]$)"};
-		const std::regex INI_REGEX_CONF		{R"(^([\w\s]+)\s*[=:]\s*(.*)$)"};
+		// One line of an INI file, as seen by the scanner
+		struct IniLine {
+			enum TYPE {
+				BLANK,
+				COMMENT, // ; # or //
+				SECTION, // [name]
+				CONF, // name = value, or name: value
+				INVALID,
+			} type = BLANK;
+			std::string_view name {}; // section or conf name, trimmed
+			std::string_view value {}; // conf value, trimmed
+		};
+		static IniLine ScanIniLine(std::string_view line);
 
 		void ReadFromINI(const std::string& section, std::vector<Conf> configs, bool writeIfNotExists = false);
 		void WriteToINI(const std::string& section, std::vector<Conf> configs);
 		void ReadFromINI(std::function<void(std::stringstream section, std::vector<ConfLineStream>& configs)>&& callbackPerSection); // runs the callback for each section, with a vector containing all configs as ConfLineStream
 
+	private: // INI
+
+		// INI file parsed once and shared by all ReadFromINI/WriteToINI calls until the file changes on disk
+		struct IniDocument {
+			struct Line {
+				std::string text; // as in the file, without the line break
+				IniLine::TYPE type;
+				size_t section; // index in sections
+				size_t valueBegin, valueLength; // position of the conf value in text
+				size_t offset; // byte offset of the line in the file, only valid up to the first modified line
+				bool terminated; // false for a last line without a line break
+			};
+			std::vector<Line> lines {};
+			std::vector<std::string> sections {""}; // lines before the first section header are in section ""
+			std::vector<long> sectionLastLine {-1}; // last non-blank line of each section, new confs are inserted after it
+			std::unordered_map<std::string, size_t> sectionIndex {{"", 0}};
+			std::unordered_map<std::string, size_t> confLines {}; // IniKey(section, name) -> index in lines
+			bool loaded = false;
+			double lastWriteTime = 0;
+			uintmax_t fileSize = 0;
+		} ini;
+
+		static std::string IniKey(std::string_view section, std::string_view name) {
+			std::string key;
+			key.reserve(section.size() + name.size() + 1);
+			key.append(section).append(1, '\n').append(name);
+			return key;
+		}
+
+		void LoadIniDocument();
+		void IndexIniDocument();
+		void WriteIniDocument(size_t firstModifiedLine);
+
 	};
 }
 
@@ -0,0 +1,255 @@
+#include "FileWatcher.h"
+#include "utilities/io/Logger.h"
+#include <filesystem>
+#include <cstring>
+
+#ifndef _WINDOWS
+	#include <poll.h>
+	#include <unistd.h>
+	#include <sys/eventfd.h>
+	#include <sys/inotify.h>
+#endif
+
+using namespace v4d::io;
+
+#ifndef _WINDOWS
+	// Events on the parent directory that may change the content of a watched file, plus the ones telling that the directory itself is gone
+	static constexpr uint32_t INOTIFY_MASK = IN_CLOSE_WRITE | IN_MODIFY | IN_CREATE | IN_DELETE | IN_MOVED_TO | IN_MOVED_FROM | IN_DELETE_SELF | IN_MOVE_SELF | IN_ONLYDIR;
+#endif
+
+// Same as FilePath::GetLastWriteTime, without throwing when the file is deleted in between
+static double LastWriteTime(const std::string& filePath) {
+	std::error_code err;
+	auto time = std::filesystem::last_write_time(filePath, err);
+	if (err) return 0;
+	return ((std::chrono::duration<double, std::milli>)time.time_since_epoch()).count();
+}
+
+FileWatcher::FileWatcher(MODE mode) : mode(mode) {
+	#ifndef _WINDOWS
+		if (mode == MODE::AUTO) {
+			inotifyFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+			if (inotifyFd == -1) {
+				LOG_WARN("FileWatcher: inotify is not available (" << strerror(errno) << "), watched files will be polled")
+			}
+		}
+		wakeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+	#endif
+	thread = std::thread(&FileWatcher::Run, this);
+}
+
+FileWatcher::~FileWatcher() {
+	{
+		std::lock_guard lock(mu);
+		running = false;
+		Wake();
+	}
+	if (thread.joinable()) thread.join();
+	#ifndef _WINDOWS
+		if (inotifyFd != -1) close(inotifyFd);
+		if (wakeFd != -1) close(wakeFd);
+	#endif
+}
+
+std::shared_ptr<FileWatcher> FileWatcher::Instance() {
+	static std::shared_ptr<FileWatcher> instance = std::make_shared<FileWatcher>();
+	return instance;
+}
+
+FileWatcher::WatchId FileWatcher::Watch(const std::string& filePath, Callback&& callback, int debounceMilliseconds) {
+	auto watch = std::make_shared<WatchedFile>();
+	std::filesystem::path path = std::filesystem::absolute(filePath).lexically_normal();
+	watch->filePath = filePath;
+	watch->directory = path.parent_path().string();
+	watch->fileName = path.filename().string();
+	watch->callback = std::forward<Callback>(callback);
+	watch->debounce = std::chrono::milliseconds{std::max(0, debounceMilliseconds)};
+	std::lock_guard lock(mu);
+	if (mode == MODE::AUTO) StartWatching(*watch);
+	watch->lastWriteTime = LastWriteTime(filePath);
+	WatchId id = nextId++;
+	watches.emplace(id, watch);
+	Wake();
+	return id;
+}
+
+void FileWatcher::Unwatch(WatchId id) {
+	std::unique_lock lock(mu);
+	auto it = watches.find(id);
+	if (it == watches.end()) return;
+	StopWatching(*it->second);
+	watches.erase(it);
+	if (std::this_thread::get_id() != thread.get_id()) {
+		callbackDone.wait(lock, [this, id]{return runningCallback != id;});
+	}
+}
+
+size_t FileWatcher::GetPolledCount() {
+	std::lock_guard lock(mu);
+	size_t count = 0;
+	for (auto& [id, watch] : watches) {
+		if (watch->directoryWatch == -1) ++count;
+	}
+	return count;
+}
+
+void FileWatcher::SetPollingInterval(int milliseconds) {
+	std::lock_guard lock(mu);
+	pollingInterval = std::max(1, milliseconds);
+	nextPoll = Clock::now();
+	Wake();
+}
+
+void FileWatcher::StartWatching(WatchedFile& watch) {
+	#ifndef _WINDOWS
+		if (inotifyFd == -1 || watch.directoryWatch != -1) return;
+		int wd = inotify_add_watch(inotifyFd, watch.directory.c_str(), INOTIFY_MASK);
+		if (wd == -1) return; // keep polling
+		watch.directoryWatch = wd;
+		++directoryWatchRefCount[wd];
+	#endif
+}
+
+void FileWatcher::StopWatching(WatchedFile& watch) {
+	#ifndef _WINDOWS
+		if (watch.directoryWatch == -1) return;
+		auto it = directoryWatchRefCount.find(watch.directoryWatch);
+		if (it != directoryWatchRefCount.end() && --it->second == 0) {
+			inotify_rm_watch(inotifyFd, watch.directoryWatch);
+			directoryWatchRefCount.erase(it);
+		}
+		watch.directoryWatch = -1;
+		watch.lastWriteTime = LastWriteTime(watch.filePath);
+	#endif
+}
+
+void FileWatcher::Wake() {
+	#ifndef _WINDOWS
+		if (wakeFd != -1) {
+			uint64_t one = 1;
+			[[maybe_unused]] auto n = write(wakeFd, &one, sizeof(one));
+			return;
+		}
+	#endif
+	wakeRequested = true;
+	wakeCondition.notify_one();
+}
+
+void FileWatcher::WaitForEvents(std::unique_lock<std::mutex>& lock, int timeoutMilliseconds) {
+	#ifndef _WINDOWS
+		if (wakeFd != -1) {
+			pollfd fds[2] {{wakeFd, POLLIN, 0}, {inotifyFd, POLLIN, 0}}; // a negative fd is ignored by poll
+			lock.unlock();
+				::poll(fds, 2, timeoutMilliseconds);
+				if (fds[0].revents & POLLIN) {
+					uint64_t count;
+					[[maybe_unused]] auto n = read(wakeFd, &count, sizeof(count));
+				}
+			lock.lock();
+			if (fds[1].revents & POLLIN) ReadEvents();
+			return;
+		}
+	#endif
+	if (timeoutMilliseconds < 0) {
+		wakeCondition.wait(lock, [this]{return wakeRequested;});
+	} else {
+		wakeCondition.wait_for(lock, std::chrono::milliseconds{timeoutMilliseconds}, [this]{return wakeRequested;});
+	}
+	wakeRequested = false;
+}
+
+void FileWatcher::ReadEvents() {
+	#ifndef _WINDOWS
+		alignas(inotify_event) char buffer[4096];
+		auto now = Clock::now();
+		auto setPending = [now](WatchedFile& watch){
+			watch.pending = true;
+			watch.deadline = now + watch.debounce;
+		};
+		for (;;) {
+			ssize_t length = read(inotifyFd, buffer, sizeof(buffer));
+			if (length <= 0) break;
+			for (char* ptr = buffer; ptr < buffer + length; ) {
+				const inotify_event* event = (const inotify_event*)ptr;
+				ptr += sizeof(inotify_event) + event->len;
+				if (event->mask & IN_Q_OVERFLOW) {
+					// Some events were lost, consider that all files may have changed
+					for (auto& [id, watch] : watches) {
+						if (watch->directoryWatch != -1) setPending(*watch);
+					}
+				} else if (event->mask & (IN_DELETE_SELF | IN_MOVE_SELF | IN_IGNORED)) {
+					// The directory is gone (or its filesystem was unmounted), poll its files until it comes back
+					for (auto& [id, watch] : watches) {
+						if (watch->directoryWatch == event->wd) {
+							StopWatching(*watch);
+							setPending(*watch);
+						}
+					}
+				} else if (event->len > 0) {
+					for (auto& [id, watch] : watches) {
+						if (watch->directoryWatch == event->wd && watch->fileName == event->name) setPending(*watch);
+					}
+				}
+			}
+		}
+	#endif
+}
+
+void FileWatcher::PollFiles() {
+	auto now = Clock::now();
+	for (auto& [id, watch] : watches) {
+		if (watch->directoryWatch != -1) continue;
+		if (mode == MODE::AUTO) StartWatching(*watch); // the directory may exist now, any later change will be seen by inotify
+		double lastWriteTime = LastWriteTime(watch->filePath);
+		if (lastWriteTime != watch->lastWriteTime) {
+			watch->lastWriteTime = lastWriteTime;
+			watch->pending = true;
+			watch->deadline = now + watch->debounce;
+		}
+	}
+}
+
+void FileWatcher::Run() {
+	std::unique_lock lock(mu);
+	std::vector<std::pair<WatchId, std::shared_ptr<WatchedFile>>> dueWatches {};
+	while (running) {
+		auto now = Clock::now();
+		if (now >= nextPoll) {
+			PollFiles();
+			nextPoll = now + std::chrono::milliseconds{pollingInterval};
+		}
+
+		// Run the callbacks of the files that did not change for their debounce delay
+		for (auto& [id, watch] : watches) {
+			if (watch->pending && watch->deadline <= now) {
+				watch->pending = false;
+				dueWatches.emplace_back(id, watch);
+			}
+		}
+		for (auto& [id, watch] : dueWatches) {
+			if (!watches.contains(id)) continue; // unwatched by a previous callback
+			runningCallback = id;
+			lock.unlock();
+				try {
+					watch->callback(watch->filePath);
+				} catch (std::exception& e) {
+					LOG_ERROR("FileWatcher: callback for '" << watch->filePath << "' failed: " << e.what())
+				}
+			lock.lock();
+			runningCallback = 0;
+			callbackDone.notify_all();
+		}
+		dueWatches.clear();
+
+		// Sleep until the next debounce deadline, the next poll or a new inotify event
+		now = Clock::now();
+		std::optional<Clock::time_point> wakeAt {};
+		for (auto& [id, watch] : watches) {
+			if (watch->pending && (!wakeAt || watch->deadline < *wakeAt)) wakeAt = watch->deadline;
+			if (watch->directoryWatch == -1 && (!wakeAt || nextPoll < *wakeAt)) wakeAt = nextPoll;
+		}
+		int timeout = -1;
+		if (wakeAt) timeout = (int)std::max<int64_t>(0, std::chrono::ceil<std::chrono::milliseconds>(*wakeAt - now).count());
+		if (running) WaitForEvents(lock, timeout);
+	}
+}
@@ -0,0 +1,144 @@
+#include <v4d.h>
+#include <fstream>
+#include <filesystem>
+#include "utilities/io/FilePath.h"
+#include "utilities/io/FileWatcher.h"
+#include "utilities/io/Logger.h"
+
+namespace v4d::tests {
+	int FileWatcher() {
+		using MODE = v4d::io::FileWatcher::MODE;
+
+		auto writeFile = [](const std::string& path, const std::string& content){
+			std::ofstream file(path, std::ios::trunc);
+			file << content;
+		};
+		// Waits up to 3 seconds for a condition
+		auto waitFor = [](auto&& condition){
+			for (int i = 0; i < 300 && !condition(); ++i) SLEEP(10ms)
+			return condition();
+		};
+
+		for (MODE mode : {MODE::AUTO, MODE::POLLING}) {
+			const std::string dir = "testfiles_watch_";
+			const int errorOffset = mode == MODE::AUTO? 0 : 100;
+			const char* modeName = mode == MODE::AUTO? "AUTO" : "POLLING";
+			v4d::io::FilePath::DeleteDirectory(dir, true);
+			v4d::io::FilePath::CreateDirectory(dir);
+			writeFile(dir + "/a.txt", "0");
+
+			v4d::io::FileWatcher watcher(mode);
+			watcher.SetPollingInterval(10);
+			if (mode == MODE::POLLING && watcher.IsUsingInotify()) {
+				LOG_ERROR("v4d::tests::FileWatcher ERROR 1 (POLLING mode uses inotify)")
+				return 1;
+			}
+
+			std::atomic<int> countA = 0;
+			std::atomic<bool> pathMatches = true;
+			auto idA = watcher.Watch(dir + "/a.txt", [&](const std::string& path){
+				if (path != dir + "/a.txt") pathMatches = false;
+				++countA;
+			}, 50);
+			if (mode == MODE::AUTO && watcher.IsUsingInotify() && watcher.GetPolledCount() != 0) {
+				LOG_ERROR("v4d::tests::FileWatcher ERROR 2 (" << modeName << " existing directory is polled)")
+				return errorOffset + 2;
+			}
+
+			{// Test 3 (a burst of writes runs the callback once, after the debounce delay)
+				for (int i = 0; i < 5; ++i) writeFile(dir + "/a.txt", std::to_string(i));
+				if (!waitFor([&]{return countA > 0;})) {
+					LOG_ERROR("v4d::tests::FileWatcher ERROR 3.1 (" << modeName << " modification not seen)")
+					return errorOffset + 3;
+				}
+				SLEEP(200ms)
+				if (countA != 1 || !pathMatches) {
+					LOG_ERROR("v4d::tests::FileWatcher ERROR 3.2 (" << modeName << " callback ran " << countA << " times for a burst of writes)")
+					return errorOffset + 3;
+				}
+			}
+
+			{// Test 4 (other files in the same directory are ignored)
+				writeFile(dir + "/b.txt", "b");
+				SLEEP(200ms)
+				if (countA != 1) {
+					LOG_ERROR("v4d::tests::FileWatcher ERROR 4 (" << modeName << " callback ran for another file)")
+					return errorOffset + 4;
+				}
+			}
+
+			{// Test 5 (atomic save, writing a temporary file then renaming it over the watched one)
+				SLEEP(20ms) // make sure the modification time differs when polling
+				writeFile(dir + "/a.txt.tmp", "atomic");
+				std::filesystem::rename(dir + "/a.txt.tmp", dir + "/a.txt");
+				if (!waitFor([&]{return countA == 2;})) {
+					LOG_ERROR("v4d::tests::FileWatcher ERROR 5 (" << modeName << " atomic save not seen)")
+					return errorOffset + 5;
+				}
+			}
+
+			{// Test 6 (file in a directory that does not exist yet)
+				std::atomic<int> countC = 0;
+				auto idC = watcher.Watch(dir + "/sub/c.txt", [&](const std::string&){++countC;}, 20);
+				if (watcher.GetPolledCount() != (mode == MODE::AUTO && watcher.IsUsingInotify()? 1 : 2)) {
+					LOG_ERROR("v4d::tests::FileWatcher ERROR 6.1 (" << modeName << " missing directory should be polled)")
+					return errorOffset + 6;
+				}
+				v4d::io::FilePath::CreateDirectory(dir + "/sub");
+				writeFile(dir + "/sub/c.txt", "c");
+				if (!waitFor([&]{return countC > 0;})) {
+					LOG_ERROR("v4d::tests::FileWatcher ERROR 6.2 (" << modeName << " file created in a new directory not seen)")
+					return errorOffset + 6;
+				}
+				if (mode == MODE::AUTO && watcher.IsUsingInotify()) {
+					// Now watched with inotify
+					if (!waitFor([&]{return watcher.GetPolledCount() == 0;})) {
+						LOG_ERROR("v4d::tests::FileWatcher ERROR 6.3 (" << modeName << " new directory still polled)")
+						return errorOffset + 6;
+					}
+					int count = countC;
+					writeFile(dir + "/sub/c.txt", "cc");
+					if (!waitFor([&]{return countC > count;})) {
+						LOG_ERROR("v4d::tests::FileWatcher ERROR 6.4 (" << modeName << " modification in the new directory not seen)")
+						return errorOffset + 6;
+					}
+				}
+				watcher.Unwatch(idC);
+			}
+
+			{// Test 7 (no callback after Unwatch, which waits for a running callback)
+				std::atomic<bool> inCallback = false;
+				std::atomic<int> countD = 0;
+				auto idD = watcher.Watch(dir + "/a.txt", [&](const std::string&){
+					inCallback = true;
+					SLEEP(100ms)
+					++countD;
+					inCallback = false;
+				}, 0);
+				SLEEP(20ms)
+				writeFile(dir + "/a.txt", "d");
+				if (!waitFor([&]{return inCallback.load();})) {
+					LOG_ERROR("v4d::tests::FileWatcher ERROR 7.1 (" << modeName << " second watch of the same file not seen)")
+					return errorOffset + 7;
+				}
+				watcher.Unwatch(idD);
+				if (inCallback || countD != 1) {
+					LOG_ERROR("v4d::tests::FileWatcher ERROR 7.2 (" << modeName << " Unwatch returned while the callback was running)")
+					return errorOffset + 7;
+				}
+				watcher.Unwatch(idA);
+				int count = countA;
+				writeFile(dir + "/a.txt", "e");
+				SLEEP(200ms)
+				if (countA != count || countD != 1) {
+					LOG_ERROR("v4d::tests::FileWatcher ERROR 7.3 (" << modeName << " callback ran after Unwatch)")
+					return errorOffset + 7;
+				}
+			}
+
+			v4d::io::FilePath::DeleteDirectory(dir, true);
+		}
+
+		return 0;
+	}
+}
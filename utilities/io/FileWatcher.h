@@ -0,0 +1,118 @@
+/*
+ * Process-wide file watcher
+ * Part of the Vulkan4D open-source game engine under the LGPL license - https://github.com/Vulkan4D
+ *
+ * A single background thread watches all registered files and runs their callbacks (on that thread) once a file has stopped changing for the debounce delay.
+ * On Linux, it uses inotify on the parent directories, so that atomic saves (write to a temp file then rename) are seen too.
+ * Files that cannot be watched with inotify (unsupported filesystem, missing directory, watch limit reached, other platforms) are polled with GetLastWriteTime instead.
+ *
+ * 		auto watcher = v4d::io::FileWatcher::Instance();
+ * 		auto id = watcher->Watch("config/settings.ini", [](const std::string& path){ ... });
+ * 		...
+ * 		watcher->Unwatch(id);
+ */
+#pragma once
+
+#include <v4d.h>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#ifndef V4D_FILEWATCHER_DEFAULT_DEBOUNCE
+	#define V4D_FILEWATCHER_DEFAULT_DEBOUNCE 100 // milliseconds without changes before running a callback
+#endif
+#ifndef V4D_FILEWATCHER_POLLING_INTERVAL
+	#define V4D_FILEWATCHER_POLLING_INTERVAL 500 // milliseconds between checks of the files that are not watched with inotify
+#endif
+
+namespace v4d::io {
+	class V4DLIB FileWatcher {
+	public:
+		using WatchId = uint64_t;
+		using Callback = std::function<void(const std::string& filePath)>;
+
+		enum class MODE {
+			AUTO, // inotify when available, polling otherwise
+			POLLING, // always poll
+		};
+
+	private:
+		using Clock = std::chrono::steady_clock;
+
+		struct WatchedFile {
+			std::string filePath; // as given to Watch()
+			std::string directory;
+			std::string fileName; // compared with inotify event names
+			Callback callback;
+			std::chrono::milliseconds debounce;
+			int directoryWatch = -1; // inotify watch descriptor of the parent directory, -1 when polling
+			double lastWriteTime = 0; // when polling
+			bool pending = false;
+			Clock::time_point deadline {};
+		};
+
+		const MODE mode;
+		int pollingInterval = V4D_FILEWATCHER_POLLING_INTERVAL;
+
+		std::mutex mu;
+		std::condition_variable callbackDone;
+		std::map<WatchId, std::shared_ptr<WatchedFile>> watches {};
+		std::unordered_map<int, int> directoryWatchRefCount {};
+		WatchId nextId = 1;
+		WatchId runningCallback = 0;
+		Clock::time_point nextPoll {};
+		bool running = true;
+
+		int inotifyFd = -1;
+		int wakeFd = -1;
+		std::condition_variable wakeCondition; // used instead of wakeFd when there is no inotify support
+		bool wakeRequested = false;
+
+		std::thread thread;
+
+		void Run();
+		void Wake();
+		void WaitForEvents(std::unique_lock<std::mutex>& lock, int timeoutMilliseconds);
+		void ReadEvents();
+		void PollFiles();
+		void StartWatching(WatchedFile& watch);
+		void StopWatching(WatchedFile& watch);
+
+	public:
+
+		FileWatcher(MODE mode = MODE::AUTO);
+		~FileWatcher();
+
+		DELETE_COPY_MOVE_CONSTRUCTORS(FileWatcher)
+
+		// Shared by the whole process, hold on to the returned pointer for as long as there are watches
+		static std::shared_ptr<FileWatcher> Instance();
+
+		/**
+		 * Runs the callback (on the watcher thread) when the file is created, modified, replaced or deleted, and then did not change for the debounce delay.
+		 * The file and its directory do not need to exist yet.
+		 */
+		WatchId Watch(const std::string& filePath, Callback&& callback, int debounceMilliseconds = V4D_FILEWATCHER_DEFAULT_DEBOUNCE);
+
+		// Once this returns, the callback is not running anymore and will not run again (unless called from within the callback itself)
+		void Unwatch(WatchId id);
+
+		bool IsUsingInotify() const {
+			return inotifyFd != -1;
+		}
+
+		// Number of watched files that are polled rather than watched with inotify
+		size_t GetPolledCount();
+
+		void SetPollingInterval(int milliseconds);
+
+	};
+}
@@ -0,0 +1,35 @@
+#include <v4d.h>
+#include "helpers/Benchmark.hpp"
+#include "utilities/io/Logger.h"
+
+namespace v4d::benchmarks {
+	void Logger() {
+		using v4d::Benchmark;
+		v4d::io::FilePath::CreateDirectory("benchfiles_");
+		{
+			auto testLogger = std::make_shared<v4d::io::Logger>("benchfiles_/Logger.log", false);
+			#pragma push_macro("V4D_LOGGER_INSTANCE")
+			#undef V4D_LOGGER_INSTANCE
+			#define V4D_LOGGER_INSTANCE testLogger
+				int i = 0;
+				Benchmark::Run("Logger LOG_WARN file", [&]{
+					LOG_WARN("warning " << ++i)
+				});
+				// Flooding a single call site, nearly all messages are suppressed
+				Benchmark::Run("Logger LOG_WARN_LIMITED file flood", [&]{
+					LOG_WARN_LIMITED("warning " << ++i)
+				});
+				Benchmark::Run("Logger LOG_WARN_SAMPLED(1000) file flood", [&]{
+					LOG_WARN_SAMPLED(1000, "warning " << ++i)
+				});
+			#pragma pop_macro("V4D_LOGGER_INSTANCE")
+
+			// Cost of the limiter itself when a message is not throttled
+			v4d::io::LogRateLimiter limiter(__FILE__, __LINE__, 1e12, 1);
+			Benchmark::Run("Logger LogRateLimiter Allow", [&]{
+				Benchmark::DoNotOptimize(limiter.Allow(testLogger.get()));
+			});
+		}
+		v4d::io::FilePath::DeleteDirectory("benchfiles_", true);
+	}
+}
@@ -1,13 +1,24 @@
 #include "Logger.h"
+#include "BinaryLogger.h"
 #include <thread>
 #include <cstring>
 
 using namespace v4d::io;
 
+std::atomic<LogRateLimiter*> LogRateLimiter::first = nullptr;
+
+LogRateLimiter::LogRateLimiter(const char* file, int line, double perSecond, uint32_t burst, uint32_t sampling)
+: file(file), line(line), sampling(sampling), interval(perSecond > 0? int64_t(1e9 / perSecond) : 0), burst(int64_t(std::max(burst, 1u) - 1) * interval) {
+	next = first.load(std::memory_order_relaxed);
+	while (!first.compare_exchange_weak(next, this, std::memory_order_release, std::memory_order_relaxed));
+}
+
 Logger::Logger() : filepath(""), useLogFile(false), verbose(false) {}
 Logger::Logger(const std::string& filepath, std::optional<bool> verbose) : filepath(filepath), useLogFile(filepath != ""), verbose(verbose.has_value() && verbose.value()) {}
 
 Logger::~Logger() {
+	ReportSuppressedMessages(true);
+	LogRateLimiter::Detach(this);
 	file.close();
 }
 
@@ -27,7 +38,28 @@ void Logger::LogToFile(const std::string& message) {
 	file << message << std::endl;
 }
 
+void Logger::ReportSuppressedMessages(bool force) {
+	int64_t now = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+	int64_t next = nextSuppressedReport.load(std::memory_order_relaxed);
+	if (force) {
+		// the reports below are logged too, they must not report again
+		nextSuppressedReport.store(now + suppressedReportInterval.load(std::memory_order_relaxed), std::memory_order_relaxed);
+	} else if (now < next || !nextSuppressedReport.compare_exchange_strong(next, now + suppressedReportInterval.load(std::memory_order_relaxed), std::memory_order_relaxed)) {
+		return;
+	}
+	LogRateLimiter::ForEach(this, [this](LogRateLimiter& limiter, const char* file, int line){
+		if (uint32_t suppressed = limiter.TakeSuppressed()) {
+			std::string filePath = file;
+			#ifdef _V4D_PROJECT_PATH
+				if (filePath.find(_V4D_PROJECT_PATH) == 0) filePath = filePath.substr(std::string(_V4D_PROJECT_PATH).length());
+			#endif
+			Log(std::ostringstream() << "WARNING: " << suppressed << " messages suppressed [" << filePath << ":" << line << "]", "1;33");
+		}
+	});
+}
+
 void Logger::Log(const std::ostream& message, const char* style) {
+	ReportSuppressedMessages();
 	std::lock_guard lock(mu);
 	std::string msg = dynamic_cast<const std::ostringstream&>(message).str();
 	try {
@@ -49,6 +81,25 @@ void Logger::Log(const std::ostream& message, const char* style) {
 	} catch(...) {}
 }
 
+void Logger::Flush() {
+	ReportSuppressedMessages(true);
+	std::lock_guard lock(mu);
+	try {
+		if (useLogFile) {
+			if (file.is_open()) file.flush();
+		} else {
+			std::cout.flush();
+			std::cerr.flush();
+		}
+	} catch(...) {}
+}
+
+void Logger::SetBinarySink(std::shared_ptr<BinaryLogger> sink) {
+	std::lock_guard lock(mu);
+	if (sink) binarySinks.push_back(sink);
+	binarySink.store(sink.get(), std::memory_order_release);
+}
+
 std::string Logger::GetCurrentThreadIdStr() const {
 	std::stringstream str("");
 	str << " [thread " << std::this_thread::get_id() << "] ";
@@ -0,0 +1,107 @@
+#include <v4d.h>
+#include <fstream>
+#include <sstream>
+#include "utilities/io/FilePath.h"
+#include "utilities/io/Logger.h"
+
+namespace v4d::tests {
+	int Logger() {
+		const std::string dir = "testfiles_logger_";
+		v4d::io::FilePath::CreateDirectory(dir);
+
+		auto readLines = [](const std::string& path){
+			std::vector<std::string> lines;
+			std::ifstream file(path);
+			for (std::string line; std::getline(file, line);) lines.push_back(line);
+			return lines;
+		};
+
+		int limitedLine = 0;
+		std::vector<std::string> flushedLines {};
+
+		// The macros log into file loggers, results are checked after
+		#pragma push_macro("V4D_LOGGER_PREFIX")
+		#pragma push_macro("V4D_LOGGER_INSTANCE")
+		#undef V4D_LOGGER_PREFIX
+		#undef V4D_LOGGER_INSTANCE
+		#define V4D_LOGGER_PREFIX ""
+		#define V4D_LOGGER_INSTANCE testLogger
+		{
+			auto testLogger = std::make_shared<v4d::io::Logger>(dir + "/sampled.log", false);
+			for (int i = 0; i < 100; ++i) LOG_SAMPLED(10, "sampled " << i)
+		}
+		{
+			auto testLogger = std::make_shared<v4d::io::Logger>(dir + "/limited.log", false);
+			testLogger->SetSuppressedReportInterval(0);
+			for (int i = 0; i < 1000; ++i) {
+				limitedLine = __LINE__ + 1;
+				LOG_WARN_LIMITED("limited " << i)
+			}
+			LOG("other message")
+		}
+		{
+			auto testLogger = std::make_shared<v4d::io::Logger>(dir + "/flushed.log", false);
+			LOG("first message") // the next report is due in V4D_LOGGER_SUPPRESSED_REPORT_INTERVAL
+			for (int i = 0; i < 1000; ++i) LOG_WARN_LIMITED("flushed " << i)
+			testLogger->Flush();
+			flushedLines = readLines(dir + "/flushed.log");
+			for (int i = 0; i < 1000; ++i) LOG_WARN_LIMITED("destroyed " << i)
+		}
+		#pragma pop_macro("V4D_LOGGER_INSTANCE")
+		#pragma pop_macro("V4D_LOGGER_PREFIX")
+
+		{// Test 1 (sampled messages, with the number of suppressed messages appended, and the last ones reported when the logger is destroyed)
+			auto lines = readLines(dir + "/sampled.log");
+			if (lines.size() != 11 || lines[0] != "sampled 0" || lines[1] != "sampled 10 (9 similar messages suppressed)" || lines[9] != "sampled 90 (9 similar messages suppressed)" || lines[10].find("WARNING: 9 messages suppressed [") != 0) {
+				LOG_ERROR("v4d::tests::Logger ERROR 1 (sampled " << lines.size() << " lines)")
+				return 1;
+			}
+		}
+
+		{// Test 2 (rate-limited messages, only the burst goes through a flood)
+			auto lines = readLines(dir + "/limited.log");
+			// the loop may take longer than a token interval on a slow machine
+			if (lines.size() < V4D_LOGGER_RATE_LIMIT_BURST + 2 || lines.size() > V4D_LOGGER_RATE_LIMIT_BURST + 5 || lines[0].find("WARNING: limited 0") != 0) {
+				LOG_ERROR("v4d::tests::Logger ERROR 2.1 (limited " << lines.size() << " lines)")
+				return 2;
+			}
+			// suppressed messages are reported before the next message
+			const std::string& report = lines[lines.size() - 2];
+			const std::string end = "Logger.cxx:" + std::to_string(limitedLine) + "]";
+			if (report.find("WARNING: ") != 0 || report.find(" messages suppressed [") == std::string::npos || report.compare(report.length() - end.length(), end.length(), end) != 0 || lines.back() != "other message") {
+				LOG_ERROR("v4d::tests::Logger ERROR 2.2 (report) " << report)
+				return 2;
+			}
+			int total = std::stoi(report.substr(9));
+			for (size_t i = 0; i < lines.size() - 2; ++i) {
+				size_t pos = lines[i].find(" (");
+				total += 1 + (pos == std::string::npos? 0 : std::stoi(lines[i].substr(pos + 2)));
+			}
+			if (total != 1000) {
+				LOG_ERROR("v4d::tests::Logger ERROR 2.3 (suppressed count) " << report)
+				return 2;
+			}
+		}
+
+		{// Test 3 (suppressed messages are reported on Flush() and when the logger is destroyed, without waiting for another message)
+			auto lines = readLines(dir + "/flushed.log");
+			auto isReport = [](const std::string& line){
+				return line.find("WARNING: ") == 0 && line.find(" messages suppressed [") != std::string::npos;
+			};
+			if (flushedLines.size() < 3 || !isReport(flushedLines.back())) {
+				LOG_ERROR("v4d::tests::Logger ERROR 3.1 (no report on flush)")
+				return 3;
+			}
+			if (lines.size() < flushedLines.size() + 2 || !isReport(lines.back()) || lines.back() == flushedLines.back()) {
+				LOG_ERROR("v4d::tests::Logger ERROR 3.2 (no report when destroyed)")
+				return 3;
+			}
+		}
+
+		if (!v4d::io::FilePath::DeleteDirectory(dir, true)) {
+			return 4;
+		}
+
+		return 0;
+	}
+}
@@ -8,8 +8,80 @@
 #include <sstream>
 #include <memory>
 #include <optional>
+#include <vector>
+#include <chrono>
+#include <algorithm>
+
+#ifndef V4D_LOGGER_RATE_LIMIT
+	#define V4D_LOGGER_RATE_LIMIT 10 // messages per second per call site for the *_LIMITED macros
+#endif
+#ifndef V4D_LOGGER_RATE_LIMIT_BURST
+	#define V4D_LOGGER_RATE_LIMIT_BURST 20 // messages that a call site can log at once before being limited
+#endif
+#ifndef V4D_LOGGER_SUPPRESSED_REPORT_INTERVAL
+	#define V4D_LOGGER_SUPPRESSED_REPORT_INTERVAL 5000 // milliseconds between reports of suppressed messages
+#endif
 
 namespace v4d::io {
+	class BinaryLogger;
+	class Logger;
+
+	// One per call site of the *_LIMITED and *_SAMPLED macros, never destroyed
+	class V4DLIB LogRateLimiter {
+		static std::atomic<LogRateLimiter*> first;
+
+		std::atomic<const Logger*> logger = nullptr; // that the suppressed messages will be reported to
+		const char* file;
+		int line;
+		uint32_t sampling; // log one of every n messages, 0 for a token bucket
+		int64_t interval; // nanoseconds per token
+		int64_t burst; // nanoseconds ahead of time that the bucket can go when full
+		std::atomic<int64_t> nextTime {0}; // when the bucket will be full again (GCRA theoretical arrival time)
+		std::atomic<uint64_t> calls {0};
+		std::atomic<uint32_t> suppressed {0};
+		LogRateLimiter* next = nullptr;
+
+	public:
+		LogRateLimiter(const char* file, int line, double perSecond, uint32_t burst, uint32_t sampling = 0);
+
+		// Whether this message should be logged, only a few atomics when it is
+		inline bool Allow(const Logger* logger) {
+			if (sampling) {
+				if (calls.fetch_add(1, std::memory_order_relaxed) % sampling == 0) return true;
+			} else {
+				int64_t now = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+				int64_t time = nextTime.load(std::memory_order_relaxed);
+				while (time - now <= burst) {
+					if (nextTime.compare_exchange_weak(time, std::max(time, now) + interval, std::memory_order_relaxed)) return true;
+				}
+			}
+			if (this->logger.load(std::memory_order_relaxed) != logger) this->logger.store(logger, std::memory_order_relaxed);
+			suppressed.fetch_add(1, std::memory_order_relaxed);
+			return false;
+		}
+
+		// Number of messages suppressed since the last call
+		inline uint32_t TakeSuppressed() {
+			return suppressed.load(std::memory_order_relaxed)? suppressed.exchange(0, std::memory_order_relaxed) : 0;
+		}
+
+		// Calls func(limiter, file, line) for each limiter of the given logger
+		template<typename Func>
+		static void ForEach(const Logger* logger, Func&& func) {
+			for (LogRateLimiter* limiter = first.load(std::memory_order_acquire); limiter; limiter = limiter->next) {
+				if (limiter->logger.load(std::memory_order_relaxed) == logger) func(*limiter, limiter->file, limiter->line);
+			}
+		}
+
+		// Called when a logger is destroyed
+		static void Detach(const Logger* logger) {
+			ForEach(logger, [logger](LogRateLimiter& limiter, const char*, int){
+				const Logger* expected = logger;
+				limiter.logger.compare_exchange_strong(expected, nullptr, std::memory_order_relaxed);
+			});
+		}
+	};
+
 	// https://misc.flogisoft.com/bash/tip_colors_and_formatting
 
 	class V4DLIB Logger {
@@ -22,7 +94,14 @@ namespace v4d::io {
 		std::once_flag readFileOnce, setVerboseOnce;
 		std::ofstream file;
 
+		std::vector<std::shared_ptr<BinaryLogger>> binarySinks {}; // kept alive until the logger is destroyed, since other threads may still be writing in a previous sink
+		std::atomic<BinaryLogger*> binarySink = nullptr;
+
+		std::atomic<int64_t> nextSuppressedReport = 0;
+		std::atomic<int64_t> suppressedReportInterval = int64_t(V4D_LOGGER_SUPPRESSED_REPORT_INTERVAL) * 1000000;
+
 		void LogToFile(const std::string& message);
+		void ReportSuppressedMessages(bool force = false);
 
 	public:
 
@@ -39,6 +118,9 @@ namespace v4d::io {
 
 		void Log(const std::ostream& message, const char* style = "0");
 
+		// Reports the messages suppressed since the last report without waiting for the next message, and flushes the output (also done when the logger is destroyed)
+		void Flush();
+
 		std::string GetCurrentThreadIdStr() const;
 
 		// template<typename T>
@@ -62,6 +144,19 @@ namespace v4d::io {
 			verbose = isVerbose;
 		}
 
+		// Minimum delay between reports of messages suppressed by the *_LIMITED and *_SAMPLED macros
+		inline void SetSuppressedReportInterval(int milliseconds) {
+			suppressedReportInterval = int64_t(milliseconds) * 1000000;
+			nextSuppressedReport = 0;
+		}
+
+		// LOG_FMT* macros write into this sink instead of formatting text, nullptr to go back to text logging
+		void SetBinarySink(std::shared_ptr<BinaryLogger> sink);
+
+		inline BinaryLogger* GetBinarySink() const {
+			return binarySink.load(std::memory_order_acquire);
+		}
+
 	};
 }
 
@@ -121,6 +216,28 @@ V4DLIB std::ostream& operator<<(std::ostream& stream, const std::vector<byte>& b
 #define LOG_WARN_VERBOSE(msg) {if (V4D_LOGGER_INSTANCE->IsVerbose()) LOG_WARN(msg)};
 #define LOG_ERROR_VERBOSE(msg) {if (V4D_LOGGER_INSTANCE->IsVerbose()) LOG_ERROR(msg)};
 
+// Rate-limited and sampled, for messages that a remote peer or a hot loop can trigger repeatedly
+// The number of suppressed messages is appended to the next message of the same call site, and reported by the logger with its next message (at most once per interval), on Flush() and when it is destroyed
+#define __V4D_LOG_LIMITED(logMacro, perSecond, burst, sampling, msg) {\
+	static v4d::io::LogRateLimiter __v4dLogLimiter(__FILE__, __LINE__, perSecond, burst, sampling);\
+	if (__v4dLogLimiter.Allow(V4D_LOGGER_INSTANCE.get())) {\
+		if (uint32_t __v4dSuppressed = __v4dLogLimiter.TakeSuppressed()) logMacro(msg << " (" << __v4dSuppressed << " similar messages suppressed)")\
+		else logMacro(msg)\
+	}\
+}
+// At most V4D_LOGGER_RATE_LIMIT per second
+#define LOG_LIMITED(msg) __V4D_LOG_LIMITED(LOG, V4D_LOGGER_RATE_LIMIT, V4D_LOGGER_RATE_LIMIT_BURST, 0, msg)
+#define LOG_VERBOSE_LIMITED(msg) {if (V4D_LOGGER_INSTANCE->IsVerbose()) __V4D_LOG_LIMITED(LOG_VERBOSE, V4D_LOGGER_RATE_LIMIT, V4D_LOGGER_RATE_LIMIT_BURST, 0, msg)}
+#define LOG_WARN_LIMITED(msg) __V4D_LOG_LIMITED(LOG_WARN, V4D_LOGGER_RATE_LIMIT, V4D_LOGGER_RATE_LIMIT_BURST, 0, msg)
+#define LOG_ERROR_LIMITED(msg) __V4D_LOG_LIMITED(LOG_ERROR, V4D_LOGGER_RATE_LIMIT, V4D_LOGGER_RATE_LIMIT_BURST, 0, msg)
+#define LOG_ERROR_VERBOSE_LIMITED(msg) {if (V4D_LOGGER_INSTANCE->IsVerbose()) LOG_ERROR_LIMITED(msg)}
+// One of every n messages
+#define LOG_SAMPLED(n, msg) __V4D_LOG_LIMITED(LOG, 0, 0, n, msg)
+#define LOG_VERBOSE_SAMPLED(n, msg) {if (V4D_LOGGER_INSTANCE->IsVerbose()) __V4D_LOG_LIMITED(LOG_VERBOSE, 0, 0, n, msg)}
+#define LOG_WARN_SAMPLED(n, msg) __V4D_LOG_LIMITED(LOG_WARN, 0, 0, n, msg)
+#define LOG_ERROR_SAMPLED(n, msg) __V4D_LOG_LIMITED(LOG_ERROR, 0, 0, n, msg)
+
+// Structured logging for hot paths (LOG_FMT...) is defined in BinaryLogger.h
 
 // Fatal errors that should Log the event and terminate the application
 
@@ -0,0 +1,38 @@
+#include <v4d.h>
+#include "helpers/Benchmark.hpp"
+#include "utilities/io/Socket.h"
+
+namespace v4d::benchmarks {
+	void Socket() {
+		using v4d::Benchmark;
+
+		v4d::io::Socket server(v4d::io::TCP);
+		server.Bind(44445);
+		server.StartListeningThread(10, [](v4d::io::SocketPtr socket) {
+			socket->SetLogErrors(false);
+			try {
+				for (;;) {
+					auto data = socket->Read<std::vector, byte>();
+					socket->Write<uint32_t>(uint32_t(data.size()));
+					socket->Flush();
+				}
+			} catch (v4d::io::Socket::disconnected_error&) {}
+		});
+
+		v4d::io::Socket client(v4d::io::TCP);
+		client.Connect("127.0.0.1", 44445);
+
+		for (size_t size : {64, 65536}) {
+			std::vector<byte> data(size, 42);
+			// One round trip per operation, the server replies with the number of bytes it received
+			Benchmark::Run("Socket TCP loopback round trip " + std::to_string(size) + "B", [&]{
+				client.Write(data);
+				client.Flush();
+				Benchmark::DoNotOptimize(client.Read<uint32_t>());
+			}, size);
+		}
+
+		client.Disconnect();
+		server.Disconnect();
+	}
+}
@@ -221,6 +221,39 @@ namespace v4d::tests {
 			}
 		}
 
+		{// Test 7 (a string size larger than V4D_SOCKET_MAX_READ_SIZE is rejected without allocating it)
+			int result = 100;
+
+			v4d::io::Socket server(v4d::io::TCP);
+
+			server.Bind(44444);
+
+			server.StartListeningThread(10, [](v4d::io::SocketPtr socket) {
+				socket->SetLogErrors(false);
+				auto msg = socket->Read<std::string>();
+				int a = socket->Read<int>();
+				socket->Write<int>(a * 2);
+				socket->Write<short>(msg.empty()? 58 : 0);
+				socket->Flush();
+			});
+
+			v4d::io::Socket client(v4d::io::TCP);
+			client.Connect("127.0.0.1", 44444);
+			client.WriteSize(size_t(1) << 40);
+			client.Write<int>(21);
+			client.Flush();
+
+			result -= client.Read<int>();
+			result -= client.Read<short>();
+
+			client.Disconnect();
+			server.Disconnect();
+
+			if (result != 0) {
+				return 4;
+			}
+		}
+
 		return 0;
 	}
 }
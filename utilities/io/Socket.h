@@ -28,6 +28,10 @@
 	#define SOCKET_BUFFER_SIZE 1400 // Typical MTU size minus header
 #endif
 
+#ifndef V4D_SOCKET_MAX_READ_SIZE
+	#define V4D_SOCKET_MAX_READ_SIZE 16777216 // largest string, container or stream read at once from a socket (in bytes), larger sizes received are considered corrupted
+#endif
+
 #ifdef _WINDOWS
 	#define MSG_CONFIRM 0
 	#define MSG_DONTWAIT 0x40
@@ -110,6 +114,11 @@ namespace v4d::io {
 		}
 
 		virtual std::vector<byte> GetData() override;
+
+		// The peer decides what sizes we read, so they are bounded instead of trusting them with an allocation
+		virtual size_t GetReadableSize() override {
+			return V4D_SOCKET_MAX_READ_SIZE;
+		}
 		
 		inline sockaddr_in GetRemoteAddr() const {
 			return remoteAddr;
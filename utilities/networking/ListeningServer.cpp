@@ -1,10 +1,19 @@
+#include <optional>
 #include "ListeningServer.h"
 #include "utilities/io/Logger.h"
 #include "utilities/crypto/SHA.h"
 #include "utilities/crypto/Random.h"
+#include "utilities/processing/Profiler.h"
 
 using namespace v4d::networking;
 
+// Clients that support stream encodings append the latest one they support at the end of their handshake data (older clients do not)
+static std::optional<v4d::data::Stream::ENCODING> ReadProposedEncoding(v4d::data::ReadOnlyStream& stream) {
+	if (stream.GetDataBufferRemaining() == 0) return std::nullopt;
+	byte proposed = stream.Read<byte>();
+	return v4d::data::Stream::ENCODING(std::min(proposed, byte(v4d::data::Stream::LATEST_ENCODING)));
+}
+
 ListeningServer::ListeningServer(std::shared_ptr<ClientPool> clientPool, v4d::io::SOCKET_TYPE type, std::shared_ptr<v4d::crypto::RSA> serverPrivateKey)
 : clientPool(clientPool), listeningSocket(std::make_shared<v4d::io::Socket>(type)), rsa(serverPrivateKey) {}
 
@@ -21,6 +30,7 @@ void ListeningServer::Start(uint16_t port) {
 		return;
 	}
 	listeningSocket->StartListeningThread(listenInterval, [this](v4d::io::SocketPtr socket){
+		V4D_PROFILE_ZONE("ListeningServer request")
 		HandleNewConnection(std::move(socket));
 	});
 }
@@ -35,9 +45,12 @@ bool ListeningServer::IsListening() const {
 
 void ListeningServer::HandleNewConnection(v4d::io::SocketPtr socket){
 	try {
+		// The handshake is always LEGACY (UDP datagrams all share the same socket)
+		socket->SetEncoding(v4d::data::Stream::ENCODING::LEGACY);
+
 		// If receive nothing after timeout, Disconnect now!
 		if (socket->IsTCP() && socket->Poll(newConnectionFirstByteTimeout) <= 0) {
-			LOG_ERROR_VERBOSE("ListeningServer: new connection failed to send first data in time")
+			LOG_ERROR_VERBOSE_LIMITED("ListeningServer: new connection failed to send first data in time")
 			socket->Disconnect();
 			return;
 		}
@@ -45,7 +58,7 @@ void ListeningServer::HandleNewConnection(v4d::io::SocketPtr socket){
 		// If first byte received is not HELLO, Disconnect now!
 		byte hello = socket->Read<byte>();
 		if (hello != ZAP::HELLO) {
-			LOG_ERROR_VERBOSE("ListeningServer: new connection first data was not the HELLO byte")
+			LOG_ERROR_VERBOSE_LIMITED("ListeningServer: new connection first data was not the HELLO byte")
 			socket->Disconnect();
 			return;
 		}
@@ -55,14 +68,14 @@ void ListeningServer::HandleNewConnection(v4d::io::SocketPtr socket){
 
 		// If no more data was sent, Disconnect now!
 		if (socket->IsTCP() && socket->Poll(newConnectionFirstByteTimeout) <= 0) {
-			LOG_ERROR_VERBOSE("ListeningServer: new connection type " << (int)clientType << " failed to send authentication request in time")
+			LOG_ERROR_VERBOSE_LIMITED("ListeningServer: new connection type " << (int)clientType << " failed to send authentication request in time")
 			socket->Disconnect();
 			return;
 		}
 		
 		// Client Requests
 		byte request = socket->Read<byte>();
-		if (socket->IsTCP()) LOG_VERBOSE("New client connection type " << (int)clientType << " request " << (int)request << " from " << socket->GetIncomingIP() << ":" << socket->GetIncomingPort())
+		if (socket->IsTCP()) LOG_VERBOSE_LIMITED("New client connection type " << (int)clientType << " request " << (int)request << " from " << socket->GetIncomingIP() << ":" << socket->GetIncomingPort())
 		
 		switch (request) {
 
@@ -86,7 +99,7 @@ void ListeningServer::HandleNewConnection(v4d::io::SocketPtr socket){
 					socket->Flush();
 					socket->Disconnect();
 				} else {
-					LOG_ERROR("ListeningServer: Received new connection request for PUBKEY over UDP")
+					LOG_ERROR_LIMITED("ListeningServer: Received new connection request for PUBKEY over UDP")
 				}
 			break;
 			
@@ -96,7 +109,7 @@ void ListeningServer::HandleNewConnection(v4d::io::SocketPtr socket){
 					socket->Flush();
 					socket->Disconnect();
 				} else {
-					LOG_ERROR("ListeningServer: Received new connection request for PING over UDP")
+					LOG_ERROR_LIMITED("ListeningServer: Received new connection request for PING over UDP")
 				}
 			break;
 
@@ -105,12 +118,12 @@ void ListeningServer::HandleNewConnection(v4d::io::SocketPtr socket){
 			break;
 
 			default:
-				LOG_ERROR("ListeningServer: Received unrecognized request")
+				LOG_ERROR_LIMITED("ListeningServer: Received unrecognized request")
 				socket->Disconnect();
 		}
 	} catch(v4d::io::Socket::disconnected_error&) {
 		socket->Disconnect();
-		LOG("Server: Client disconnected")
+		LOG_LIMITED("Server: Client disconnected")
 		return;
 	}
 }
@@ -123,7 +136,7 @@ bool ListeningServer::ValidateAppName(v4d::io::SocketPtr socket, uint64_t client
 			socket->Flush();
 			socket->Disconnect();
 		}
-		LOG_ERROR("ListeningServer new connection : received wrong AppName")
+		LOG_ERROR_LIMITED("ListeningServer new connection : received wrong AppName")
 		return false;
 	}
 	return true;
@@ -137,18 +150,19 @@ bool ListeningServer::ValidateVersion(v4d::io::SocketPtr socket, uint16_t client
 			socket->Flush();
 			socket->Disconnect();
 		}
-		LOG_ERROR("ListeningServer new connection : received wrong Version")
+		LOG_ERROR_LIMITED("ListeningServer new connection : received wrong Version")
 		return false;
 	}
 	return true;
 }
 
 void ListeningServer::ExtendedRequest(v4d::io::SocketPtr socket, byte /*clientType*/) {
-	LOG_ERROR("ListeningServer: Received new connection extended request but has not been implemented")
+	LOG_ERROR_LIMITED("ListeningServer: Received new connection extended request but has not been implemented")
 	socket->Disconnect();
 }
 
 void ListeningServer::TokenRequest(v4d::io::SocketPtr socket, byte clientType) {
+	V4D_PROFILE_ZONE("ListeningServer::TokenRequest")
 	int32_t clientID = socket->Read<int32_t>();
 	auto client = clientPool->GetClient(clientID);
 	{
@@ -163,6 +177,7 @@ void ListeningServer::TokenRequest(v4d::io::SocketPtr socket, byte clientType) {
 		}
 		auto encryptedToken = socket->ReadEncryptedStream(client->aes.get());
 		auto[increment, token] = zapdata::ClientToken::ConstructFromStream(encryptedToken);
+		auto encoding = ReadProposedEncoding(encryptedToken);
 		// Compare token with client's token
 		if (strcmp(token.c_str(), client->token.c_str()) != 0) {
 			if (socket->IsTCP()) {
@@ -186,14 +201,21 @@ void ListeningServer::TokenRequest(v4d::io::SocketPtr socket, byte clientType) {
 		}
 		client->requestIncrement = increment;
 		if (socket->IsTCP()) {
-			*socket << ZAP::OK;
+			if (encoding.has_value()) {
+				*socket << ZAP::OKENC << byte(encoding.value());
+			} else {
+				*socket << ZAP::OK;
+			}
 			socket->Flush();
 		}
+		socket->SetEncoding(encoding.value_or(v4d::data::Stream::ENCODING::LEGACY));
+		socket->SetSchemaNegotiation(socket->IsTCP() && socket->GetEncoding() != v4d::data::Stream::ENCODING::LEGACY); // peers that negotiate an encoding also understand STREAMABLE_VERSIONED without field table
 	}
 	HandleNewClient(socket, client, clientType);
 }
 
 void ListeningServer::AnonymousRequest(v4d::io::SocketPtr socket, byte clientType) {
+	V4D_PROFILE_ZONE("ListeningServer::AnonymousRequest")
 	IncomingClientPtr client = Authenticate(nullptr, nullptr);
 	if (!client) {
 		if (socket->IsTCP()) {
@@ -213,6 +235,7 @@ void ListeningServer::AnonymousRequest(v4d::io::SocketPtr socket, byte clientTyp
 }
 
 void ListeningServer::AuthRequest(v4d::io::SocketPtr socket, byte clientType) {
+	V4D_PROFILE_ZONE("ListeningServer::AuthRequest")
 	// Receive AUTH data
 	v4d::data::ReadOnlyStream encryptedStream = rsa? socket->ReadEncryptedStream(rsa.get()) : socket->ReadStream();
 	v4d::data::ReadOnlyStream plainStream = socket->ReadStream();
@@ -239,9 +262,11 @@ void ListeningServer::AuthRequest(v4d::io::SocketPtr socket, byte clientType) {
 	// Prepare response
 	client->token = GenerateToken();
 	client->aes = std::make_unique<v4d::crypto::AES>(encryptedStream.Read<std::string>());
+	auto encoding = ReadProposedEncoding(encryptedStream);
 	if (socket->IsTCP()) {
 		v4d::data::Stream tokenAndId(10+client->token.size() + sizeof(client->id));
 		tokenAndId << client->token << client->id;
+		if (encoding.has_value()) tokenAndId << byte(encoding.value());
 		// Send response
 		*socket << ZAP::OK;
 		if (rsa) *socket << rsa->Sign(authData);
@@ -250,6 +275,8 @@ void ListeningServer::AuthRequest(v4d::io::SocketPtr socket, byte clientType) {
 	if (socket->IsTCP()) {
 		socket->Flush();
 	}
+	socket->SetEncoding(encoding.value_or(v4d::data::Stream::ENCODING::LEGACY));
+	socket->SetSchemaNegotiation(socket->IsTCP() && socket->GetEncoding() != v4d::data::Stream::ENCODING::LEGACY);
 	HandleNewClient(socket, client, clientType);
 }
 
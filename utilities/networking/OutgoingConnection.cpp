@@ -14,12 +14,12 @@ OutgoingConnection::OutgoingConnection(int32_t id, std::string token, v4d::io::S
 	}
 
 OutgoingConnection::OutgoingConnection(OutgoingConnection* src)
-: id(src->id), token(src->token), socket(std::make_shared<v4d::io::Socket>(src->socket->GetSocketType())), rsa(src->rsa), aes(src->aes.GetHexKey()) {
+: id(src->id), token(src->token), socket(std::make_shared<v4d::io::Socket>(src->socket->GetSocketType())), rsa(src->rsa), aes(src->aes.GetHexKey()), encoding(src->encoding) {
 	socket->SetRemoteAddr(src->socket->GetRemoteAddr());
 }
 
 OutgoingConnection::OutgoingConnection(OutgoingConnection* src, v4d::io::SOCKET_TYPE type)
-: id(src->id), token(src->token), socket(std::make_shared<v4d::io::Socket>(type)), rsa(src->rsa), aes(src->aes.GetHexKey()) {
+: id(src->id), token(src->token), socket(std::make_shared<v4d::io::Socket>(type)), rsa(src->rsa), aes(src->aes.GetHexKey()), encoding(src->encoding) {
 	socket->SetRemoteAddr(src->socket->GetRemoteAddr());
 }
 
@@ -45,6 +45,7 @@ void OutgoingConnection::SendHello(byte clientType) {
 bool OutgoingConnection::Connect(std::string ip, uint16_t port, byte clientType) {
 	Connect:
 	socket->Connect(ip, port);
+	socket->SetEncoding(v4d::data::Stream::ENCODING::LEGACY);
 	SendHello(clientType);
 
 	if (id != -1) {
@@ -86,6 +87,7 @@ bool OutgoingConnection::ConnectCommunicateAsync(std::string ip, uint16_t port,
 std::string OutgoingConnection::GetServerPublicKey(std::string ip, uint16_t port) {
 	std::string publicKey{""};
 	socket->Connect(ip, port);
+	socket->SetEncoding(v4d::data::Stream::ENCODING::LEGACY);
 	SendHello();
 	LOG_VERBOSE("Getting server public key....")
 	*socket << ZAP::PUBKEY;
@@ -102,8 +104,10 @@ bool OutgoingConnection::TokenRequest() {
 	socket->Write<int32_t>(id);
 	v4d::data::Stream tokenToEncrypt(64);
 	tokenToEncrypt << zapdata::ClientToken {++requestIncrement, token};
+	tokenToEncrypt << byte(GetProposedEncoding());
 	socket->WriteEncryptedStream(&aes, tokenToEncrypt);
 	if (socket->IsUDP()) {
+		socket->SetEncoding(encoding);
 		return HandleConnection();
 	} else {
 		socket->Flush();
@@ -112,7 +116,14 @@ bool OutgoingConnection::TokenRequest() {
 			return false;
 		}
 		switch (socket->Read<byte>()) {
-			case ZAP::OK:
+			case ZAP::OK: // server does not support stream encodings
+				encoding = v4d::data::Stream::ENCODING::LEGACY;
+				return HandleConnection();
+			break;
+			case ZAP::OKENC:
+				encoding = v4d::data::Stream::ENCODING(socket->Read<byte>());
+				socket->SetEncoding(encoding);
+				socket->SetSchemaNegotiation(socket->GetEncoding() != v4d::data::Stream::ENCODING::LEGACY);
 				return HandleConnection();
 			break;
 			case ZAP::DENY:
@@ -124,7 +135,13 @@ bool OutgoingConnection::TokenRequest() {
 	return false;
 }
 
+v4d::data::Stream::ENCODING OutgoingConnection::GetProposedEncoding() const {
+	// Over UDP there is no response from the server, so we can only use what was negotiated over TCP
+	return socket->IsTCP()? v4d::data::Stream::LATEST_ENCODING : encoding;
+}
+
 bool OutgoingConnection::AnonymousRequest() {
+	encoding = v4d::data::Stream::ENCODING::LEGACY;
 	if (socket->IsUDP()) {
 		return HandleConnection();
 	} else {
@@ -149,6 +166,9 @@ bool OutgoingConnection::AnonymousRequest() {
 
 bool OutgoingConnection::AuthRequest(v4d::data::Stream& encryptedStream, v4d::data::Stream& plainStream) {
 	encryptedStream << aes.GetHexKey();
+	// The proposed encoding must fit in a single RSA block, otherwise we fallback to LEGACY
+	bool proposedEncoding = !rsa || encryptedStream.GetWriteBufferSize() < rsa->GetMaxBlockSize();
+	if (proposedEncoding) encryptedStream << byte(GetProposedEncoding());
 	if (rsa) {
 		socket->WriteEncryptedStream(rsa.get(), encryptedStream);
 	} else {
@@ -157,6 +177,8 @@ bool OutgoingConnection::AuthRequest(v4d::data::Stream& encryptedStream, v4d::da
 	socket->WriteStream(plainStream);
 	socket->Flush();
 	if (socket->IsUDP()) {
+		if (!proposedEncoding) encoding = v4d::data::Stream::ENCODING::LEGACY;
+		socket->SetEncoding(encoding);
 		return HandleConnection();
 	}
 	if (socket->Poll(connectionTimeoutMilliseconds) <= 0) {
@@ -174,6 +196,10 @@ bool OutgoingConnection::AuthRequest(v4d::data::Stream& encryptedStream, v4d::da
 			}
 			auto tokenAndId = socket->ReadEncryptedStream(&aes);
 			tokenAndId >> token >> id;
+			// Older servers do not respond with a stream encoding
+			encoding = tokenAndId.IsDataBufferEnd()? v4d::data::Stream::ENCODING::LEGACY : v4d::data::Stream::ENCODING(tokenAndId.Read<byte>());
+			socket->SetEncoding(encoding);
+			socket->SetSchemaNegotiation(socket->GetEncoding() != v4d::data::Stream::ENCODING::LEGACY);
 			return HandleConnection();
 		}
 		break;
@@ -18,6 +18,7 @@ namespace v4d::networking {
 		v4d::io::SocketPtr socket;
 		std::shared_ptr<v4d::crypto::RSA> rsa;
 		v4d::crypto::AES aes;
+		v4d::data::Stream::ENCODING encoding = v4d::data::Stream::ENCODING::LEGACY; // negotiated with the server over TCP, proposed as-is over UDP
 
 		bool runAsync = false;
 		std::thread* asyncRunThread = nullptr;
@@ -52,12 +53,18 @@ namespace v4d::networking {
 		virtual bool ConnectCommunicateAsync(std::string ip = "", uint16_t port = 0, byte clientType = 1);
 		virtual std::string GetServerPublicKey(std::string ip, uint16_t port);
 
+		virtual v4d::data::Stream::ENCODING GetProposedEncoding() const;
+
 		virtual bool TokenRequest();
 		virtual bool AnonymousRequest();
 		virtual bool AuthRequest(v4d::data::Stream& encrypted, v4d::data::Stream& plain);
 
 		virtual bool HandleConnection();
 
+		inline v4d::data::Stream::ENCODING GetEncoding() const {
+			return encoding;
+		}
+
 		virtual void Error(int code, std::string message) const;
 
 	};
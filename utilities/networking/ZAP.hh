@@ -26,6 +26,7 @@ namespace v4d::networking::ZAP {
 	const byte	ACK 	= 17;	// Acknowledged previous request
 	const byte	DENY	= 18;	// Denied / Failed
 	const byte	OK  	= 19;	// Approved / Success
+	const byte	OKENC	= 20;	// Approved / Success (+ negotiated stream encoding Byte), response to a TOKEN request that proposed a stream encoding
 
 	// Client requests to server
 	const byte 	PUBKEY	= 21; // Client asks server to send its public key (RSA)
@@ -71,6 +72,15 @@ namespace v4d::networking::ZAP {
 		ClientToken (EncryptedStream) aes		--->	(server decrypts and checks token and increment>lastIncrement with client id)
 												<---	OK (Byte)
 														Stay connected
+	------------------------------------------------------
+	Stream encoding negotiation (see v4d::data::Stream::ENCODING) : 
+		The client appends the latest encoding it supports (Byte) at the end of AuthDataAndAesKey or ClientToken.
+		Older servers ignore it, newer servers respond with the encoding to use, the lowest of both:
+			AUTH : appended at the end of tokenAndId (Byte)
+			TOKEN : OKENC (Byte) + encoding (Byte) instead of OK
+		Over UDP, there is no response, the client proposes the encoding previously negotiated over TCP.
+		The handshake itself is always LEGACY, the negotiated encoding applies to everything after it.
+		Anonymous connections stay LEGACY.
 	*/
 
 
@@ -89,6 +89,10 @@ namespace v4d::tests {
 			if (client.Connect("127.0.0.1", 44444, 1)) {
 				SLEEP(100ms) // wait for server to have the time to decrement result
 				client.Disconnect();
+				if (client.GetEncoding() != v4d::data::Stream::LATEST_ENCODING) {
+					LOG_ERROR("Networking Error Test1: Stream encoding was not negotiated with AUTH")
+					return 5;
+				}
 				if (result != 50) {
 					LOG_ERROR(result << "  Networking Error Test1: Wrong result after first connect")
 					return 4;
@@ -98,6 +102,10 @@ namespace v4d::tests {
 				if (client2.Connect("127.0.0.1", 44444, 2)) {
 					// SUCCESS
 					SLEEP(100ms) // wait for server to have the time to decrement result
+					if (client2.GetEncoding() != v4d::data::Stream::LATEST_ENCODING) {
+						LOG_ERROR("Networking Error Test1: Stream encoding was not negotiated with TOKEN")
+						return 6;
+					}
 					if (result != 0) {
 						LOG_ERROR(result << "  Networking Error Test1: Wrong result after second connect")
 					}
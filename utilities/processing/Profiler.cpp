@@ -0,0 +1,131 @@
+#include "Profiler.h"
+#include <fstream>
+#include "utilities/io/Logger.h"
+
+using namespace v4d::processing;
+
+std::atomic<bool> Profiler::enabled = false;
+std::mutex Profiler::threadBuffersMutex {};
+std::vector<std::shared_ptr<Profiler::ThreadBuffer>> Profiler::threadBuffers {};
+std::atomic<uint64_t> Profiler::nextThreadIndex = 1;
+
+Profiler::ThreadBuffer& Profiler::GetCurrentThreadBuffer() {
+	thread_local std::shared_ptr<ThreadBuffer> buffer = []{
+		std::lock_guard lock(threadBuffersMutex);
+		return threadBuffers.emplace_back(std::make_shared<ThreadBuffer>(nextThreadIndex++));
+	}();
+	return *buffer;
+}
+
+int64_t Profiler::GetTimestamp() {
+	static const auto epoch = std::chrono::steady_clock::now();
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - epoch).count();
+}
+
+void Profiler::SetThreadName(const std::string& name) {
+	auto& buffer = GetCurrentThreadBuffer();
+	std::lock_guard lock(buffer.mu);
+	buffer.threadName = name;
+}
+
+void Profiler::RecordZone(const char* name, int64_t startTimestamp, int64_t endTimestamp) {
+	Event event {};
+	event.name = name;
+	event.timestamp = startTimestamp;
+	event.duration = endTimestamp - startTimestamp;
+	event.type = EVENT_TYPE::ZONE;
+	GetCurrentThreadBuffer().Push(event);
+}
+
+void Profiler::RecordCounter(const char* name, double value) {
+	Event event {};
+	event.name = name;
+	event.timestamp = GetTimestamp();
+	event.value = value;
+	event.type = EVENT_TYPE::COUNTER;
+	GetCurrentThreadBuffer().Push(event);
+}
+
+void Profiler::Clear() {
+	std::lock_guard lock(threadBuffersMutex);
+	for (auto it = threadBuffers.begin(); it != threadBuffers.end();) {
+		// Buffers only referenced from this list belong to threads that have exited
+		if (it->use_count() == 1) {
+			it = threadBuffers.erase(it);
+		} else {
+			(*it)->first = (*it)->count.load();
+			++it;
+		}
+	}
+}
+
+size_t Profiler::GetEventCount() {
+	std::lock_guard lock(threadBuffersMutex);
+	size_t total = 0;
+	for (auto& buffer : threadBuffers) {
+		const uint64_t end = buffer->count.load(std::memory_order_acquire);
+		total += size_t(end - std::min(end, buffer->GetBegin(end)));
+	}
+	return total;
+}
+
+static void WriteJsonString(std::ostream& out, const char* str) {
+	out << '"';
+	if (str) for (const char* c = str; *c; ++c) {
+		switch (*c) {
+			case '"': out << "\\\""; break;
+			case '\\': out << "\\\\"; break;
+			case '\n': out << "\\n"; break;
+			case '\r': out << "\\r"; break;
+			case '\t': out << "\\t"; break;
+			default:
+				if (static_cast<unsigned char>(*c) < 0x20) out << ' ';
+				else out << *c;
+		}
+	}
+	out << '"';
+}
+
+void Profiler::WriteChromeTrace(std::ostream& out) {
+	std::lock_guard lock(threadBuffersMutex);
+	out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+	out << "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"tid\":0,\"args\":{\"name\":\"v4d\"}}";
+	out.precision(3);
+	out << std::fixed;
+	std::vector<Event> events {};
+	for (auto& buffer : threadBuffers) {
+		{
+			std::lock_guard bufferLock(buffer->mu);
+			if (buffer->threadName != "") {
+				out << ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << buffer->threadIndex << ",\"args\":{\"name\":";
+				WriteJsonString(out, buffer->threadName.c_str());
+				out << "}}";
+			}
+		}
+		buffer->CopyEvents(events);
+		for (const Event& event : events) {
+			out << ",\n{\"name\":";
+			WriteJsonString(out, event.name);
+			out << ",\"pid\":1,\"tid\":" << buffer->threadIndex << ",\"ts\":" << (double(event.timestamp) / 1000.0);
+			switch (event.type) {
+				case EVENT_TYPE::ZONE:
+					out << ",\"ph\":\"X\",\"dur\":" << (double(event.duration) / 1000.0) << "}";
+				break;
+				case EVENT_TYPE::COUNTER:
+					out << ",\"ph\":\"C\",\"args\":{\"value\":" << event.value << "}}";
+				break;
+			}
+		}
+	}
+	out << "\n]}\n";
+}
+
+bool Profiler::ExportChromeTrace(const std::string& filePath) {
+	std::ofstream file(filePath, std::ios::out | std::ios::trunc);
+	if (!file.is_open()) {
+		LOG_ERROR("Profiler: Cannot open file '" << filePath << "' for writing")
+		return false;
+	}
+	WriteChromeTrace(file);
+	return file.good();
+}
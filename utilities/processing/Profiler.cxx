@@ -0,0 +1,150 @@
+#include "Profiler.h"
+#include "utilities/io/Logger.h"
+#include <sstream>
+
+namespace v4d::tests {
+	int Profiler() {
+		using v4d::processing::Profiler;
+
+		Profiler::Clear();
+		Profiler::Enable();
+
+		{// Test 1 (zones and counters from multiple threads)
+			{
+				V4D_PROFILE_THREAD_NAME("Main \"test\" thread")
+				V4D_PROFILE_ZONE("outer zone")
+				{
+					V4D_PROFILE_ZONE("inner zone")
+					V4D_PROFILE_COUNTER("test counter", 42)
+				}
+			}
+			std::thread t([]{
+				V4D_PROFILE_THREAD_NAME("Second thread")
+				for (int i = 0; i < 10; ++i) {
+					V4D_PROFILE_ZONE("thread zone")
+				}
+			});
+			t.join();
+
+			#ifndef V4D_PROFILER_DISABLE
+				if (Profiler::GetEventCount() != 13) {
+					LOG_ERROR("v4d::tests::Profiler ERROR 1 (recorded " << Profiler::GetEventCount() << " events instead of 13)")
+					return 1;
+				}
+			#endif
+		}
+
+		{// Test 2 (chrome trace output)
+			std::ostringstream out;
+			Profiler::WriteChromeTrace(out);
+			std::string json = out.str();
+			#ifndef V4D_PROFILER_DISABLE
+				if (json.find("\"name\":\"inner zone\"") == std::string::npos || json.find("\"ph\":\"X\"") == std::string::npos) {
+					LOG_ERROR("v4d::tests::Profiler ERROR 2.1 (zone missing from trace)")
+					return 2;
+				}
+				if (json.find("\"ph\":\"C\",\"args\":{\"value\":42") == std::string::npos) {
+					LOG_ERROR("v4d::tests::Profiler ERROR 2.2 (counter missing from trace)")
+					return 2;
+				}
+				if (json.find("\"name\":\"Main \\\"test\\\" thread\"") == std::string::npos || json.find("\"name\":\"Second thread\"") == std::string::npos) {
+					LOG_ERROR("v4d::tests::Profiler ERROR 2.3 (thread names missing or not escaped)")
+					return 2;
+				}
+			#endif
+			if (json.substr(0, 17) != "{\"displayTimeUnit" || json.substr(json.size() - 3) != "]}\n") {
+				LOG_ERROR("v4d::tests::Profiler ERROR 2.4 (malformed trace)")
+				return 2;
+			}
+		}
+
+		{// Test 3 (ring buffer wraps around and disabled profiler records nothing)
+			Profiler::Clear();
+			for (int i = 0; i < V4D_PROFILER_THREAD_BUFFER_SIZE + 100; ++i) {
+				V4D_PROFILE_ZONE("wrap zone")
+			}
+			#ifndef V4D_PROFILER_DISABLE
+				if (Profiler::GetEventCount() != V4D_PROFILER_THREAD_BUFFER_SIZE) {
+					LOG_ERROR("v4d::tests::Profiler ERROR 3.1 (ring buffer holds " << Profiler::GetEventCount() << " events)")
+					return 3;
+				}
+			#endif
+			Profiler::Clear();
+			Profiler::Disable();
+			{
+				V4D_PROFILE_ZONE("disabled zone")
+				V4D_PROFILE_COUNTER("disabled counter", 1)
+			}
+			if (Profiler::GetEventCount() != 0) {
+				LOG_ERROR("v4d::tests::Profiler ERROR 3.2 (events recorded while disabled)")
+				return 3;
+			}
+		}
+
+		{// Test 4 (threads started after Clear() do not reuse the index of a thread that is still running)
+			Profiler::Enable();
+			std::atomic<bool> named = false, release = false;
+			std::thread exited([]{V4D_PROFILE_ZONE("exited zone")});
+			exited.join();
+			std::thread running([&]{
+				V4D_PROFILE_THREAD_NAME("Running thread")
+				named = true;
+				while (!release) std::this_thread::yield();
+				V4D_PROFILE_ZONE("running zone")
+			});
+			while (!named) std::this_thread::yield();
+			Profiler::Clear(); // removes the buffer of the exited thread
+			std::thread started([]{V4D_PROFILE_ZONE("started zone")});
+			started.join();
+			release = true;
+			running.join();
+			std::ostringstream out;
+			Profiler::WriteChromeTrace(out);
+			std::string json = out.str();
+			Profiler::Disable();
+			#ifndef V4D_PROFILER_DISABLE
+				auto tid = [&json](const std::string& zone){
+					const std::string prefix = "{\"name\":\"" + zone + "\",\"pid\":1,\"tid\":";
+					size_t pos = json.find(prefix);
+					if (pos == std::string::npos) return std::string();
+					pos += prefix.size();
+					return json.substr(pos, json.find(',', pos) - pos);
+				};
+				if (tid("running zone") == "" || tid("started zone") == "" || tid("running zone") == tid("started zone")) {
+					LOG_ERROR("v4d::tests::Profiler ERROR 4 (thread index " << tid("started zone") << " reused)")
+					return 4;
+				}
+			#endif
+		}
+
+		{// Test 5 (exporting while another thread keeps recording)
+			Profiler::Clear();
+			Profiler::Enable();
+			std::atomic<bool> stop = false;
+			std::thread recording([&stop]{
+				V4D_PROFILE_THREAD_NAME("Recording thread")
+				while (!stop) {
+					V4D_PROFILE_ZONE("recording zone")
+				}
+			});
+			for (int i = 0; i < 20; ++i) {
+				std::ostringstream out;
+				Profiler::WriteChromeTrace(out);
+				std::string json = out.str();
+				if (Profiler::GetEventCount() > V4D_PROFILER_THREAD_BUFFER_SIZE || json.substr(json.size() - 3) != "]}\n") {
+					stop = true;
+					recording.join();
+					Profiler::Disable();
+					LOG_ERROR("v4d::tests::Profiler ERROR 5 (export while recording)")
+					return 5;
+				}
+			}
+			stop = true;
+			recording.join();
+			Profiler::Disable();
+			Profiler::Clear();
+		}
+
+		return 0;
+	}
+}
@@ -0,0 +1,165 @@
+/*
+ * Lightweight instrumentation profiler
+ * Part of the Vulkan4D open-source game engine under the LGPL license - https://github.com/Vulkan4D
+ *
+ * Records scoped zones, counters and thread names into per-thread ring buffers,
+ * then exports them as Chrome trace-event JSON (chrome://tracing or https://ui.perfetto.dev).
+ *
+ * Usage:
+ * 		v4d::processing::Profiler::Enable();
+ * 		{
+ * 			V4D_PROFILE_ZONE("Physics step") // recorded from here until the end of the scope
+ * 			V4D_PROFILE_COUNTER("Entities", entities.size())
+ * 		}
+ * 		v4d::processing::Profiler::ExportChromeTrace("trace.json");
+ *
+ * Zone and counter names are NOT copied, they must be string literals (or otherwise outlive the export).
+ * Define V4D_PROFILER_DISABLE to compile out all profiler macros.
+ */
+#pragma once
+
+#include <v4d.h>
+#include <string>
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <ostream>
+#include <algorithm>
+
+#ifndef V4D_PROFILER_THREAD_BUFFER_SIZE
+	#define V4D_PROFILER_THREAD_BUFFER_SIZE 65536 // maximum number of events kept per thread, older events are overwritten
+#endif
+
+namespace v4d::processing {
+
+	class V4DLIB Profiler {
+	public:
+
+		enum class EVENT_TYPE : uint8_t {
+			ZONE,
+			COUNTER,
+		};
+
+		struct Event {
+			const char* name = nullptr;
+			int64_t timestamp = 0; // nanoseconds since Profiler epoch
+			union {
+				int64_t duration; // nanoseconds (ZONE)
+				double value; // (COUNTER)
+			};
+			EVENT_TYPE type = EVENT_TYPE::ZONE;
+			Event() : duration(0) {}
+		};
+
+		// Ring buffer of events written without locking by a single thread, kept alive after the thread exits until Clear()
+		struct ThreadBuffer {
+			std::mutex mu {}; // only for threadName
+			uint64_t threadIndex = 0;
+			std::string threadName {};
+			std::vector<Event> events {}; // allocated by the first Push(), threads that only set their name do not use memory for events
+			std::atomic<uint64_t> count = 0; // total number of events ever written into this buffer
+			std::atomic<uint64_t> writing = 0; // count + 1 as soon as the next event starts being written, readers use it to drop the events that were overwritten while they copied them
+			std::atomic<uint64_t> first = 0; // events before this one were discarded by Clear()
+
+			ThreadBuffer(uint64_t threadIndex) : threadIndex(threadIndex) {}
+
+			// Only called by the thread that owns this buffer
+			void Push(const Event& event) {
+				if (events.empty()) events.resize(V4D_PROFILER_THREAD_BUFFER_SIZE);
+				const uint64_t index = count.load(std::memory_order_relaxed);
+				writing.store(index + 1, std::memory_order_relaxed);
+				std::atomic_thread_fence(std::memory_order_release);
+				events[index % V4D_PROFILER_THREAD_BUFFER_SIZE] = event;
+				count.store(index + 1, std::memory_order_release);
+			}
+
+			// Index of the oldest event still held, given the current count
+			uint64_t GetBegin(uint64_t end) const {
+				return std::max<uint64_t>(first.load(std::memory_order_relaxed), end > V4D_PROFILER_THREAD_BUFFER_SIZE ? end - V4D_PROFILER_THREAD_BUFFER_SIZE : 0);
+			}
+
+			// Copies the events held by this buffer, oldest first, may be called from any thread while the owner keeps pushing
+			void CopyEvents(std::vector<Event>& out) const {
+				out.clear();
+				const uint64_t end = count.load(std::memory_order_acquire);
+				const uint64_t begin = GetBegin(end);
+				for (uint64_t i = begin; i < end; ++i) out.push_back(events[i % V4D_PROFILER_THREAD_BUFFER_SIZE]);
+				std::atomic_thread_fence(std::memory_order_acquire);
+				const uint64_t overwritten = writing.load(std::memory_order_relaxed);
+				if (overwritten > begin + V4D_PROFILER_THREAD_BUFFER_SIZE) {
+					out.erase(out.begin(), out.begin() + std::min<uint64_t>(out.size(), overwritten - V4D_PROFILER_THREAD_BUFFER_SIZE - begin));
+				}
+			}
+		};
+
+	private:
+		static std::atomic<bool> enabled;
+		static std::mutex threadBuffersMutex;
+		static std::vector<std::shared_ptr<ThreadBuffer>> threadBuffers;
+		static std::atomic<uint64_t> nextThreadIndex; // never reused, Clear() removes the buffers of exited threads but their events may already have been exported
+
+		static ThreadBuffer& GetCurrentThreadBuffer();
+
+	public:
+
+		static void Enable(bool enable = true) {
+			enabled = enable;
+		}
+		static void Disable() {
+			enabled = false;
+		}
+		static bool IsEnabled() {
+			return enabled.load(std::memory_order_relaxed);
+		}
+
+		// Nanoseconds elapsed since the first call to this function (the epoch of all recorded timestamps)
+		static int64_t GetTimestamp();
+
+		// Name the current thread in the exported trace (the name is copied)
+		static void SetThreadName(const std::string& name);
+
+		static void RecordZone(const char* name, int64_t startTimestamp, int64_t endTimestamp);
+		static void RecordCounter(const char* name, double value);
+
+		// Discards all recorded events (thread names are kept for threads that are still alive)
+		static void Clear();
+
+		// Number of events currently held in all ring buffers
+		static size_t GetEventCount();
+
+		static void WriteChromeTrace(std::ostream& out);
+		static bool ExportChromeTrace(const std::string& filePath);
+	};
+
+	// RAII zone, records the time elapsed between its construction and destruction
+	class ProfilerZone {
+		const char* name;
+		int64_t startTimestamp = -1;
+	public:
+		ProfilerZone(const char* name) : name(name) {
+			if (Profiler::IsEnabled()) startTimestamp = Profiler::GetTimestamp();
+		}
+		~ProfilerZone() {
+			if (startTimestamp >= 0) Profiler::RecordZone(name, startTimestamp, Profiler::GetTimestamp());
+		}
+		DELETE_COPY_MOVE_CONSTRUCTORS(ProfilerZone)
+	};
+
+}
+
+#define __V4D_PROFILER_CONCAT_(a, b) a##b
+#define __V4D_PROFILER_CONCAT(a, b) __V4D_PROFILER_CONCAT_(a, b)
+
+#ifdef V4D_PROFILER_DISABLE
+	#define V4D_PROFILE_ZONE(name)
+	#define V4D_PROFILE_FUNCTION()
+	#define V4D_PROFILE_COUNTER(name, value)
+	#define V4D_PROFILE_THREAD_NAME(name)
+#else
+	#define V4D_PROFILE_ZONE(name) v4d::processing::ProfilerZone __V4D_PROFILER_CONCAT(__v4d_profiler_zone_, __LINE__) {name};
+	#define V4D_PROFILE_FUNCTION() V4D_PROFILE_ZONE(__PRETTY_FUNCTION__)
+	#define V4D_PROFILE_COUNTER(name, value) {if (v4d::processing::Profiler::IsEnabled()) v4d::processing::Profiler::RecordCounter(name, double(value));}
+	#define V4D_PROFILE_THREAD_NAME(name) v4d::processing::Profiler::SetThreadName(name);
+#endif
@@ -0,0 +1,31 @@
+#include <v4d.h>
+#include "helpers/Benchmark.hpp"
+#include "utilities/processing/ThreadPool.h"
+
+namespace v4d::benchmarks {
+	void ThreadPool() {
+		using v4d::Benchmark;
+
+		v4d::processing::ThreadPool threadPool;
+		threadPool.RunThreads(std::max(2u, std::thread::hardware_concurrency()));
+
+		// Enqueue a batch of trivial tasks and wait until all of them have executed
+		Benchmark::Run("ThreadPool Enqueue/Execute 1000 tasks", [&threadPool]{
+			std::atomic<int> remaining = 1000;
+			for (int i = 0; i < 1000; ++i) {
+				threadPool.Enqueue([&remaining]{
+					remaining.fetch_sub(1, std::memory_order_relaxed);
+				});
+			}
+			while (remaining.load(std::memory_order_relaxed) > 0) {
+				std::this_thread::yield();
+			}
+		});
+
+		Benchmark::Run("ThreadPool Promise/get", [&threadPool]{
+			Benchmark::DoNotOptimize(threadPool.Promise([]{return 1;}).get());
+		});
+
+		threadPool.Shutdown();
+	}
+}
@@ -16,6 +16,7 @@
 #include <memory>
 #include <utility>
 #include "utilities/io/Logger.h"
+#include "utilities/processing/Profiler.h"
 
 namespace v4d::processing {
 	
@@ -106,6 +107,7 @@ namespace v4d::processing {
 			std::lock_guard threadsLock(threadsMutex);
 			threads.emplace(index, 
 				[this, index] {
+					V4D_PROFILE_THREAD_NAME("ThreadPool #" + std::to_string(index))
 					while(true) {
 						try {
 							QueuedElementType item;
@@ -136,7 +138,10 @@ namespace v4d::processing {
 								this->items.pop();
 							}
 
-							taskRunFunction(item);
+							{
+								V4D_PROFILE_ZONE("ThreadPool task")
+								taskRunFunction(item);
+							}
 							
 						} catch (std::exception& e) {
 							LOG_ERROR("Error in a ThreadPool task: " << e.what())
@@ -3,3 +3,4 @@
 // #define V4D_STREAM_UNSAFE_FAST_REINTERPRET_CAST
 // #define V4D_STREAM_UNSAFE_FAST_RW_BYTES_FOR_CONTAINERS
 // #define V4D_LOGGER_DONT_STYLE
+// #define V4D_PROFILER_DISABLE